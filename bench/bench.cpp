@@ -0,0 +1,745 @@
+#include "benchmark.hpp"
+
+#include "../cmodels/mnist/modeling_mnist.hpp"
+#include "../cmodels/resnet/modeling_resnet.hpp"
+#include "../cmodels/resnet/modeling_resnet_static.hpp"
+#include "../cmodels/runtime/data_parallel.hpp"
+#include "../cmodels/runtime/pipeline_parallel.hpp"
+#include "../cmodels/runtime/result_cache.hpp"
+#include "../nn/functional/add_op.hpp"
+#include "../nn/functional/avg_pool2d_op.hpp"
+#include "../nn/functional/batched_gemm_op.hpp"
+#include "../nn/functional/composite_pool2d_op.hpp"
+#include "../nn/functional/conv_op.hpp"
+#include "../nn/functional/gemm_op.hpp"
+#include "../nn/functional/max_pool2d_op.hpp"
+#include "../nn/functional/relu_op.hpp"
+#include "../nn/functional/topksoftmax_op.hpp"
+#include "../nn/modules/conv.hpp"
+#include "../nn/modules/flatten.hpp"
+#include "../nn/modules/linear.hpp"
+#include "../nn/modules/pooling.hpp"
+#include "../nn/modules/relu.hpp"
+#include "../nn/modules/topksoftmax.hpp"
+#include "../nn/utils.hpp"
+#include <CLI/CLI.hpp>
+#include <cstdlib>
+#include <infinicore/context/context.hpp>
+#include <infinicore/tensor.hpp>
+#include <infinirt.h>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using namespace infinicore;
+namespace functional = infinidemo::nn::functional;
+namespace models = infinidemo::models;
+namespace modules = infinidemo::nn::modules;
+namespace bench = infinidemo::bench;
+using infinidemo::bench::Case;
+using infinidemo::bench::numel;
+using infinidemo::bench::randomTensor;
+using infinidemo::bench::Workload;
+
+// 替换全局 operator new / delete，统计 heap_allocs_per_iter（其余形式的 new 默认转发到这两个函数）
+void *operator new(std::size_t size) {
+    bench::heapAllocationCounter().fetch_add(1, std::memory_order_relaxed);
+    if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace {
+
+constexpr double kF32 = 4.0;
+// 序列类 MLP 头的长度，用于批量 GEMM / 三维 Linear
+constexpr size_t kSeqLen = 16;
+
+struct Conv2dShape {
+    const char *tag;
+    size_t in_channels;
+    size_t out_channels;
+    size_t kernel;
+    size_t stride;
+    size_t padding;
+    size_t hw;
+};
+
+// ResNet-18 / ResNet-50 中有代表性的卷积层（224x224 输入）
+const std::vector<Conv2dShape> &resnetConvShapes() {
+    static const std::vector<Conv2dShape> shapes = {
+        {"stem7x7", 3, 64, 7, 2, 3, 224},
+        {"r18.s1.3x3", 64, 64, 3, 1, 1, 56},
+        {"r18.s2.3x3", 128, 128, 3, 1, 1, 28},
+        {"r18.s3.3x3", 256, 256, 3, 1, 1, 14},
+        {"r18.s4.3x3", 512, 512, 3, 1, 1, 7},
+        {"r18.s2.down3x3", 64, 128, 3, 2, 1, 56},
+        {"r50.s1.1x1in", 64, 64, 1, 1, 0, 56},
+        {"r50.s1.1x1out", 64, 256, 1, 1, 0, 56},
+        {"r50.s2.1x1in", 512, 128, 1, 1, 0, 28},
+        {"r50.s3.1x1in", 1024, 256, 1, 1, 0, 14},
+        {"r50.s4.1x1out", 512, 2048, 1, 1, 0, 7},
+    };
+    return shapes;
+}
+
+// (tag, M, K, N)：分类头与 MLP 的 GEMM 形状，M 为 batch
+const std::vector<std::tuple<const char *, size_t, size_t>> &gemmShapes() {
+    static const std::vector<std::tuple<const char *, size_t, size_t>> shapes = {
+        {"mnist.fc1", 1936, 10},
+        {"r18.classifier", 512, 1000},
+        {"r50.classifier", 2048, 1000},
+        {"mlp.up", 1024, 4096},
+        {"mlp.down", 4096, 1024},
+    };
+    return shapes;
+}
+
+std::string shapeParams(const char *tag, size_t batch) {
+    return std::string(tag) + ",N=" + std::to_string(batch);
+}
+
+size_t convOut(size_t in, size_t kernel, size_t stride, size_t padding) {
+    return (in + 2 * padding - kernel) / stride + 1;
+}
+
+template <typename M>
+void randomizeParameters(M &model) {
+    std::unordered_map<std::string, Tensor> state_dict;
+    unsigned seed = 1;
+    for (const auto &[name, param] : model.state_dict()) {
+        state_dict[name] = randomTensor(param->shape(), Device::cpu(), 0.05f, seed++);
+    }
+    model.load_state_dict(state_dict);
+}
+
+models::ResNetConfig resnetConfig(int depth) {
+    models::ResNetConfig config;
+    config.num_labels = 1000;
+    config.embedding_size = 64;
+    if (depth == 18) {
+        config.depths = {2, 2, 2, 2};
+        config.hidden_sizes = {64, 128, 256, 512};
+        config.layer_type = "basic";
+    } else if (depth == 50) {
+        config.depths = {3, 4, 6, 3};
+        config.hidden_sizes = {256, 512, 1024, 2048};
+        config.layer_type = "bottleneck";
+    } else {
+        throw std::runtime_error("Unsupported ResNet depth: " + std::to_string(depth));
+    }
+    return config;
+}
+
+// ---------------------------------------------------------------- //
+//                      nn/functional 算子
+// ---------------------------------------------------------------- //
+void registerOpBenchmarks(std::vector<Case> &cases, const Device &device, const std::vector<size_t> &batches) {
+    for (size_t batch : batches) {
+        for (const auto &[tag, k, n] : gemmShapes()) {
+            auto state = std::make_shared<std::vector<Tensor>>();
+            size_t m = batch;
+            size_t kk = k;
+            size_t n_out = n;
+            Case c;
+            c.group = "op";
+            c.name = "performGemm";
+            c.params = std::string(tag) + ",M=" + std::to_string(m) + ",K=" + std::to_string(k) + ",N=" + std::to_string(n);
+            c.workload = {2.0 * m * kk * n_out, kF32 * (m * kk + kk * n_out + m * n_out), static_cast<double>(m)};
+            c.setup = [state, m, kk, n_out, device]() {
+                *state = {randomTensor({m, kk}, device), randomTensor({n_out, kk}, device, 0.1f, 1)->permute({1, 0}),
+                          Tensor::empty({m, n_out}, DataType::F32, device)};
+            };
+            c.run = [state, device]() {
+                auto &t = *state;
+                INFINICORE_CHECK_ERROR(functional::performGemm(t[2], t[0], t[1], 1.0f, 0.0f, device));
+            };
+            cases.push_back(std::move(c));
+        }
+
+        // 序列形状 [batch, T, K] x [K, N]：权重沿 batch 广播的单次批量 GEMM
+        for (const auto &[tag, k, n] : gemmShapes()) {
+            auto state = std::make_shared<std::vector<Tensor>>();
+            size_t b = batch;
+            size_t kk = k;
+            size_t n_out = n;
+            size_t m = b * kSeqLen;
+            Case c;
+            c.group = "op";
+            c.name = "performBatchedGemm";
+            c.params = std::string(tag) + ",B=" + std::to_string(b) + ",T=" + std::to_string(kSeqLen);
+            c.workload = {2.0 * m * kk * n_out, kF32 * (m * kk + kk * n_out + m * n_out), static_cast<double>(b)};
+            c.setup = [state, b, kk, n_out, device]() {
+                *state = {randomTensor({b, kSeqLen, kk}, device), randomTensor({n_out, kk}, device, 0.1f, 1)->permute({1, 0}),
+                          Tensor::empty({b, kSeqLen, n_out}, DataType::F32, device)};
+            };
+            c.run = [state, device]() {
+                auto &t = *state;
+                INFINICORE_CHECK_ERROR(functional::performBatchedGemm(t[2], t[0], t[1], 1.0f, 0.0f, device));
+            };
+            cases.push_back(std::move(c));
+        }
+
+        for (const auto &s : resnetConvShapes()) {
+            auto state = std::make_shared<std::vector<Tensor>>();
+            size_t oh = convOut(s.hw, s.kernel, s.stride, s.padding);
+            Shape x_shape = {batch, s.in_channels, s.hw, s.hw};
+            Shape w_shape = {s.out_channels, s.in_channels, s.kernel, s.kernel};
+            Shape y_shape = {batch, s.out_channels, oh, oh};
+            Case c;
+            c.group = "op";
+            c.name = "performConv2D";
+            c.params = shapeParams(s.tag, batch);
+            c.workload = {2.0 * numel(y_shape) * s.in_channels * s.kernel * s.kernel,
+                          kF32 * (numel(x_shape) + numel(w_shape) + numel(y_shape)), static_cast<double>(batch)};
+            c.setup = [state, x_shape, w_shape, y_shape, s, device]() {
+                *state = {randomTensor(x_shape, device), randomTensor(w_shape, device, 0.05f, 1),
+                          randomTensor({s.out_channels}, device, 0.05f, 2), Tensor::empty(y_shape, DataType::F32, device)};
+            };
+            size_t stride = s.stride;
+            size_t padding = s.padding;
+            c.run = [state, stride, padding, device]() {
+                auto &t = *state;
+                INFINICORE_CHECK_ERROR(functional::performConv2D(
+                    t[3], t[0], t[1], t[2], {static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride)},
+                    {padding, padding}, {1, 1}, device));
+            };
+            cases.push_back(std::move(c));
+        }
+
+        // 逐元素算子：ResNet-18 第一 stage 的激活
+        Shape act_shape = {batch, 64, 56, 56};
+        {
+            auto state = std::make_shared<std::vector<Tensor>>();
+            Case c;
+            c.group = "op";
+            c.name = "performRelu";
+            c.params = shapeParams("r18.s1.act", batch);
+            c.workload = {static_cast<double>(numel(act_shape)), kF32 * 2 * numel(act_shape), static_cast<double>(batch)};
+            c.setup = [state, act_shape, device]() { *state = {randomTensor(act_shape, device), Tensor::empty(act_shape, DataType::F32, device)}; };
+            c.run = [state, device]() { INFINICORE_CHECK_ERROR(functional::performRelu((*state)[1], (*state)[0], device)); };
+            cases.push_back(std::move(c));
+        }
+        {
+            auto state = std::make_shared<std::vector<Tensor>>();
+            Case c;
+            c.group = "op";
+            c.name = "performAdd";
+            c.params = shapeParams("r18.s1.residual", batch);
+            c.workload = {static_cast<double>(numel(act_shape)), kF32 * 3 * numel(act_shape), static_cast<double>(batch)};
+            c.setup = [state, act_shape, device]() {
+                *state = {randomTensor(act_shape, device), randomTensor(act_shape, device, 0.1f, 1), Tensor::empty(act_shape, DataType::F32, device)};
+            };
+            c.run = [state, device]() { INFINICORE_CHECK_ERROR(functional::performAdd((*state)[2], (*state)[0], (*state)[1], device)); };
+            cases.push_back(std::move(c));
+        }
+
+        // 分类头之后的 softmax + top-5
+        {
+            Shape x_shape = {batch, 1000};
+            Shape y_shape = {batch, 5};
+            auto state = std::make_shared<std::vector<Tensor>>();
+            Case c;
+            c.group = "op";
+            c.name = "performTopksoftmax";
+            c.params = shapeParams("head.top5", batch);
+            c.workload = {3.0 * numel(x_shape), kF32 * numel(x_shape) + 8.0 * numel(y_shape), static_cast<double>(batch)};
+            c.setup = [state, x_shape, y_shape, device]() {
+                *state = {randomTensor(x_shape, device), Tensor::empty(y_shape, DataType::F32, device), Tensor::empty(y_shape, DataType::I32, device)};
+            };
+            c.run = [state, device]() { INFINICORE_CHECK_ERROR(functional::performTopksoftmax((*state)[1], (*state)[2], (*state)[0], 5, false, device)); };
+            cases.push_back(std::move(c));
+        }
+
+        // 池化：stem 的 MaxPool(3, 2, 1) 与分类头前的全局 AvgPool(7)
+        for (bool composite : {false, true}) {
+            Shape x_shape = {batch, 64, 112, 112};
+            Shape y_shape = {batch, 64, 56, 56};
+            auto state = std::make_shared<std::vector<Tensor>>();
+            Case c;
+            c.group = "op";
+            c.name = composite ? "performCompositeMaxPool2d" : "performMaxPool2d";
+            c.params = shapeParams("stem.k3s2p1", batch);
+            c.workload = {9.0 * numel(y_shape), kF32 * (numel(x_shape) + numel(y_shape)), static_cast<double>(batch)};
+            c.setup = [state, x_shape, y_shape, device]() { *state = {randomTensor(x_shape, device), Tensor::empty(y_shape, DataType::F32, device)}; };
+            c.run = [state, composite, device]() {
+                auto &t = *state;
+                if (composite) {
+                    INFINICORE_CHECK_ERROR(functional::performCompositeMaxPool2d(t[0], t[1], 3, 3, 2, 2, 1, 1, 1, 1, false, device));
+                } else {
+                    INFINICORE_CHECK_ERROR(functional::performMaxPool2d(t[0], t[1], 3, 3, 2, 2, 1, 1, 1, 1, false, device));
+                }
+            };
+            cases.push_back(std::move(c));
+        }
+        for (size_t channels : {512, 2048}) {
+            for (bool composite : {false, true}) {
+                Shape x_shape = {batch, channels, 7, 7};
+                Shape y_shape = {batch, channels, 1, 1};
+                auto state = std::make_shared<std::vector<Tensor>>();
+                Case c;
+                c.group = "op";
+                c.name = composite ? "performCompositeAvgPool2d" : "performAvgPool2d";
+                c.params = shapeParams(channels == 512 ? "r18.head.k7" : "r50.head.k7", batch);
+                c.workload = {static_cast<double>(numel(x_shape)), kF32 * (numel(x_shape) + numel(y_shape)), static_cast<double>(batch)};
+                c.setup = [state, x_shape, y_shape, device]() { *state = {randomTensor(x_shape, device), Tensor::empty(y_shape, DataType::F32, device)}; };
+                auto ones = std::make_shared<functional::composite_pool2d::OnesCache>();
+                c.run = [state, ones, composite, device]() {
+                    auto &t = *state;
+                    if (composite) {
+                        INFINICORE_CHECK_ERROR(functional::performCompositeAvgPool2d(t[0], t[1], 7, 7, 7, 7, 0, 0, 1, 1, false, *ones, device));
+                    } else {
+                        INFINICORE_CHECK_ERROR(functional::performAvgPool2d(t[0], t[1], 7, 7, 7, 7, 0, 0, 1, 1, false, device));
+                    }
+                };
+                cases.push_back(std::move(c));
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------- //
+//                      nn/modules 模块
+// ---------------------------------------------------------------- //
+void registerModuleBenchmarks(std::vector<Case> &cases, const Device &device, const std::vector<size_t> &batches) {
+    for (size_t batch : batches) {
+        {
+            auto conv = std::make_shared<modules::Conv2d>(64, 64, 3, 1, 1);
+            auto input = std::make_shared<Tensor>();
+            Shape x_shape = {batch, 64, 56, 56};
+            Case c;
+            c.group = "module";
+            c.name = "Conv2d";
+            c.params = shapeParams("r18.s1.3x3", batch);
+            c.workload = {2.0 * numel(x_shape) * 64 * 9, kF32 * (2 * numel(x_shape) + 64 * 64 * 9), static_cast<double>(batch)};
+            c.setup = [conv, input, x_shape, device]() {
+                randomizeParameters(*conv);
+                conv->to(device);
+                *input = randomTensor(x_shape, device);
+            };
+            c.run = [conv, input]() { conv->forward(*input); };
+            cases.push_back(std::move(c));
+        }
+        for (const auto &[tag, k, n] : gemmShapes()) {
+            auto linear = std::make_shared<modules::Linear>(k, n, true);
+            auto input = std::make_shared<Tensor>();
+            size_t kk = k;
+            size_t n_out = n;
+            Case c;
+            c.group = "module";
+            c.name = "Linear";
+            c.params = shapeParams(tag, batch);
+            c.workload = {2.0 * batch * kk * n_out, kF32 * (batch * kk + kk * n_out + batch * n_out), static_cast<double>(batch)};
+            c.setup = [linear, input, batch, kk, device]() {
+                randomizeParameters(*linear);
+                linear->to(device);
+                *input = randomTensor({batch, kk}, device);
+            };
+            c.run = [linear, input]() { linear->forward(*input); };
+            cases.push_back(std::move(c));
+        }
+        for (const auto &[tag, k, n] : gemmShapes()) {
+            auto linear = std::make_shared<modules::Linear>(k, n, true);
+            auto input = std::make_shared<Tensor>();
+            size_t kk = k;
+            size_t n_out = n;
+            size_t m = batch * kSeqLen;
+            Case c;
+            c.group = "module";
+            c.name = "Linear3d";
+            c.params = std::string(tag) + ",B=" + std::to_string(batch) + ",T=" + std::to_string(kSeqLen);
+            c.workload = {2.0 * m * kk * n_out, kF32 * (m * kk + kk * n_out + m * n_out), static_cast<double>(batch)};
+            c.setup = [linear, input, batch, kk, device]() {
+                randomizeParameters(*linear);
+                linear->to(device);
+                *input = randomTensor({batch, kSeqLen, kk}, device);
+            };
+            c.run = [linear, input]() { linear->forward(*input); };
+            cases.push_back(std::move(c));
+        }
+        {
+            auto relu = std::make_shared<modules::ReLU>();
+            auto input = std::make_shared<Tensor>();
+            Shape x_shape = {batch, 64, 56, 56};
+            Case c;
+            c.group = "module";
+            c.name = "ReLU";
+            c.params = shapeParams("r18.s1.act", batch);
+            c.workload = {static_cast<double>(numel(x_shape)), kF32 * 2 * numel(x_shape), static_cast<double>(batch)};
+            c.setup = [input, x_shape, device]() { *input = randomTensor(x_shape, device); };
+            c.run = [relu, input]() { relu->forward(*input); };
+            cases.push_back(std::move(c));
+        }
+        {
+            auto pool = std::make_shared<modules::MaxPool2d>(3, 2, 1);
+            auto input = std::make_shared<Tensor>();
+            Shape x_shape = {batch, 64, 112, 112};
+            Case c;
+            c.group = "module";
+            c.name = "MaxPool2d";
+            c.params = shapeParams("stem.k3s2p1", batch);
+            c.workload = {9.0 * numel(x_shape) / 4, kF32 * 1.25 * numel(x_shape), static_cast<double>(batch)};
+            c.setup = [input, x_shape, device]() { *input = randomTensor(x_shape, device); };
+            c.run = [pool, input]() { pool->forward(*input); };
+            cases.push_back(std::move(c));
+        }
+        {
+            auto pool = std::make_shared<modules::AvgPool2d>(7, 1, 0);
+            auto input = std::make_shared<Tensor>();
+            Shape x_shape = {batch, 512, 7, 7};
+            Case c;
+            c.group = "module";
+            c.name = "AvgPool2d";
+            c.params = shapeParams("r18.head.k7", batch);
+            c.workload = {static_cast<double>(numel(x_shape)), kF32 * numel(x_shape), static_cast<double>(batch)};
+            c.setup = [input, x_shape, device]() { *input = randomTensor(x_shape, device); };
+            c.run = [pool, input]() { pool->forward(*input); };
+            cases.push_back(std::move(c));
+        }
+        {
+            auto topk = std::make_shared<modules::TopkSoftmax>(5);
+            auto input = std::make_shared<Tensor>();
+            Shape x_shape = {batch, 1000};
+            Case c;
+            c.group = "module";
+            c.name = "TopkSoftmax";
+            c.params = shapeParams("head.top5", batch);
+            c.workload = {3.0 * numel(x_shape), kF32 * numel(x_shape), static_cast<double>(batch)};
+            c.setup = [input, x_shape, device]() { *input = randomTensor(x_shape, device); };
+            c.run = [topk, input]() { topk->forward(*input); };
+            cases.push_back(std::move(c));
+        }
+        {
+            auto flatten = std::make_shared<modules::Flatten>();
+            auto input = std::make_shared<Tensor>();
+            Case c;
+            c.group = "module";
+            c.name = "Flatten";
+            c.params = shapeParams("r18.head", batch);
+            c.workload = {0.0, 0.0, static_cast<double>(batch)};
+            c.setup = [input, batch, device]() { *input = randomTensor({batch, 512, 1, 1}, device); };
+            c.run = [flatten, input]() { flatten->forward(*input); };
+            cases.push_back(std::move(c));
+        }
+    }
+}
+
+// ---------------------------------------------------------------- //
+//                      端到端模型
+// ---------------------------------------------------------------- //
+// 编译期特化的 ResNet，与同深度的动态版本使用相同的权重与输入。
+// 两者 kernel 相同，batch=1 时的耗时差即框架开销（字符串分支、虚调用链）的差别
+template <typename StaticModel>
+void registerStaticResNet(std::vector<Case> &cases, const Device &device, const std::string &name, double gflop,
+                          const std::vector<size_t> &batches) {
+    for (size_t batch : batches) {
+        auto model = std::make_shared<StaticModel>(1000);
+        auto input = std::make_shared<Tensor>();
+        Case c;
+        c.group = "model";
+        c.count_allocations = true;
+        c.name = name;
+        c.params = shapeParams("224x224", batch);
+        c.workload = {gflop * 1e9 * batch, kF32 * batch * 3 * 224 * 224, static_cast<double>(batch)};
+        c.setup = [model, input, batch, device]() {
+            randomizeParameters(*model);
+            model->to_slab(device);
+            *input = randomTensor({batch, 3, 224, 224}, device, 1.0f);
+        };
+        c.run = [model, input]() {
+            Tensor pixel_values = *input;
+            model->forward(pixel_values);
+        };
+        cases.push_back(std::move(c));
+    }
+}
+
+void registerModelBenchmarks(std::vector<Case> &cases, const Device &device,
+                             const std::vector<size_t> &mnist_batches, const std::vector<size_t> &resnet_batches) {
+    for (size_t batch : mnist_batches) {
+        auto model = std::make_shared<models::MnistForImageClassification>();
+        auto input = std::make_shared<Tensor>();
+        Case c;
+        c.group = "model";
+        c.count_allocations = true;
+        c.name = "MnistForImageClassification";
+        c.params = shapeParams("28x28", batch);
+        // conv 7x7: 4x22x22 输出，fc1: 1936 -> 10
+        c.workload = {2.0 * batch * (4.0 * 22 * 22 * 49 + 1936.0 * 10), kF32 * batch * 28 * 28, static_cast<double>(batch)};
+        c.setup = [model, input, batch, device]() {
+            randomizeParameters(*model);
+            model->to_slab(device);
+            *input = randomTensor({batch, 1, 28, 28}, device, 1.0f);
+        };
+        c.run = [model, input]() { model->forward(*input); };
+        cases.push_back(std::move(c));
+    }
+    // 同一网络的融合执行器：单个 host kernel，对比上面逐算子分派的路径
+    for (size_t batch : mnist_batches) {
+        auto model = std::make_shared<models::MnistForImageClassification>();
+        auto fused = std::make_shared<std::unique_ptr<models::FusedMnistExecutor>>();
+        auto input = std::make_shared<Tensor>();
+        Case c;
+        c.group = "model";
+        c.name = "MnistFused";
+        c.params = shapeParams("28x28", batch);
+        c.workload = {2.0 * batch * (4.0 * 22 * 22 * 49 + 1936.0 * 10), kF32 * batch * 28 * 28, static_cast<double>(batch)};
+        c.setup = [model, fused, input, batch, device]() {
+            randomizeParameters(*model);
+            model->to_slab(device);
+            *fused = std::make_unique<models::FusedMnistExecutor>(*model);
+            *input = randomTensor({batch, 1, 28, 28}, device, 1.0f);
+        };
+        c.run = [fused, input]() { (*fused)->forward(*input); };
+        cases.push_back(std::move(c));
+    }
+
+    // 参考 FLOPs：ResNet-18 约 1.82 GMACs，ResNet-50 约 4.11 GMACs（224x224）
+    for (const auto &[depth, gflop] : std::vector<std::pair<int, double>>{{18, 3.64}, {50, 8.22}}) {
+        for (size_t batch : resnet_batches) {
+            auto model = std::make_shared<models::ResNetForImageClassification>(resnetConfig(depth));
+            auto input = std::make_shared<Tensor>();
+            Case c;
+            c.group = "model";
+            c.count_allocations = true;
+            c.name = "ResNet" + std::to_string(depth) + "ForImageClassification";
+            c.params = shapeParams("224x224", batch);
+            c.workload = {gflop * 1e9 * batch, kF32 * batch * 3 * 224 * 224, static_cast<double>(batch)};
+            c.setup = [model, input, batch, device]() {
+                randomizeParameters(*model);
+                model->to_slab(device);
+                *input = randomTensor({batch, 3, 224, 224}, device, 1.0f);
+            };
+            c.run = [model, input]() {
+                Tensor pixel_values = *input;
+                model->forward(pixel_values);
+            };
+            cases.push_back(std::move(c));
+        }
+    }
+    registerStaticResNet<models::static_resnet::ResNet18>(cases, device, "ResNet18Static", 3.64, resnet_batches);
+    registerStaticResNet<models::static_resnet::ResNet50>(cases, device, "ResNet50Static", 8.22, resnet_batches);
+}
+
+// 数据并行：同一个 batch 切分给 1..R 个副本（都在 device 上，CPU 上每个副本绑定一组核心），
+// main 中按 1 个副本的吞吐换算 scaling_efficiency
+void registerDataParallelBenchmarks(std::vector<Case> &cases, const Device &device, const std::vector<size_t> &replica_counts,
+                                    size_t batch, size_t cores_per_replica) {
+    using DataParallel = infinidemo::runtime::DataParallel<models::ResNetForImageClassification>;
+    for (size_t replicas : replica_counts) {
+        auto model = std::make_shared<models::ResNetForImageClassification>(resnetConfig(18));
+        auto parallel = std::make_shared<std::unique_ptr<DataParallel>>();
+        auto input = std::make_shared<Tensor>();
+        Case c;
+        c.group = "data_parallel";
+        c.name = "ResNet18ForImageClassification";
+        c.params = shapeParams("224x224", batch) + ",replicas=" + std::to_string(replicas);
+        c.workload = {3.64e9 * batch, kF32 * batch * 3 * 224 * 224, static_cast<double>(batch)};
+        c.setup = [model, parallel, input, batch, device, replicas, cores_per_replica]() {
+            randomizeParameters(*model);
+            model->to_slab(device);
+            std::vector<Device> devices(replicas, device);
+            *parallel = std::make_unique<DataParallel>(
+                [model](const Device &d) { return models::ResNetForImageClassification::replicate(*model, d); }, devices, cores_per_replica);
+            *input = randomTensor({batch, 3, 224, 224}, device, 1.0f);
+        };
+        c.run = [parallel, input]() { (*parallel)->forward(*input); };
+        cases.push_back(std::move(c));
+    }
+}
+
+// 连续输入流：每次迭代把 micro_batches 个 [micro_batch, 3, 224, 224] 的 micro-batch 依次送入流水线，
+// stages=1 即单个实例串行处理同一个流，作为对比基线
+void registerPipelineParallelBenchmarks(std::vector<Case> &cases, const Device &device, const std::vector<size_t> &stage_counts,
+                                        size_t micro_batch, size_t micro_batches, size_t cores_per_stage) {
+    using PipelineParallel = infinidemo::runtime::PipelineParallel<models::ResNetForImageClassification>;
+    for (size_t stages : stage_counts) {
+        auto model = std::make_shared<models::ResNetForImageClassification>(resnetConfig(18));
+        auto parallel = std::make_shared<std::unique_ptr<PipelineParallel>>();
+        auto inputs = std::make_shared<std::vector<Tensor>>();
+        size_t samples = micro_batch * micro_batches;
+        Case c;
+        c.group = "pipeline_parallel";
+        c.name = "ResNet18ForImageClassification";
+        c.params = shapeParams("224x224", micro_batch) + ",micro_batches=" + std::to_string(micro_batches) + ",stages=" + std::to_string(stages);
+        c.workload = {3.64e9 * samples, kF32 * samples * 3 * 224 * 224, static_cast<double>(samples)};
+        c.setup = [model, parallel, inputs, micro_batch, micro_batches, device, stages, cores_per_stage]() {
+            randomizeParameters(*model);
+            model->to_slab(device);
+            std::vector<Device> devices(stages, device);
+            *parallel = std::make_unique<PipelineParallel>(
+                [model](const Device &d) { return models::ResNetForImageClassification::replicate(*model, d); }, devices,
+                Shape{micro_batch, 3, 224, 224}, 2, cores_per_stage);
+            inputs->clear();
+            for (size_t i = 0; i < micro_batches; ++i) {
+                inputs->push_back(randomTensor({micro_batch, 3, 224, 224}, device, 1.0f));
+            }
+        };
+        c.run = [parallel, inputs]() { (*parallel)->run(*inputs); };
+        cases.push_back(std::move(c));
+    }
+}
+
+// 结果缓存：输入内容哈希的带宽，以及全部命中时 ResNet-18 的端到端耗时（只有哈希与输出行拷贝）
+void registerResultCacheBenchmarks(std::vector<Case> &cases, const Device &device, const std::vector<size_t> &batches) {
+    for (size_t batch : batches) {
+        auto input = std::make_shared<Tensor>();
+        auto digest = std::make_shared<uint64_t>(0);
+        Case c;
+        c.group = "result_cache";
+        c.name = "hashBytes";
+        c.params = shapeParams("224x224", batch);
+        c.workload = {0.0, kF32 * batch * 3 * 224 * 224, static_cast<double>(batch)};
+        c.setup = [input, batch]() { *input = randomTensor({batch, 3, 224, 224}, Device::cpu(), 1.0f); };
+        // 结果写入 digest，避免哈希被优化掉
+        c.run = [input, digest, batch]() {
+            size_t bytes = infinidemo::nn::numBytes((*input)->shape(), (*input)->dtype()) / batch;
+            for (size_t i = 0; i < batch; ++i) {
+                *digest ^= infinidemo::runtime::hashBytes((*input)->data() + i * bytes, bytes);
+            }
+        };
+        cases.push_back(std::move(c));
+    }
+
+    using CachedModel = infinidemo::runtime::CachedModel<models::ResNetForImageClassification>;
+    for (size_t batch : batches) {
+        auto model = std::make_shared<models::ResNetForImageClassification>(resnetConfig(18));
+        auto cached = std::make_shared<std::unique_ptr<CachedModel>>();
+        auto input = std::make_shared<Tensor>();
+        Case c;
+        c.group = "result_cache";
+        c.name = "ResNet18ForImageClassification";
+        c.params = shapeParams("224x224", batch) + ",hit";
+        c.workload = {0.0, kF32 * batch * 3 * 224 * 224, static_cast<double>(batch)};
+        // 全部命中：只剩哈希（设备上还有一次 D2H）与输出行的拷贝
+        c.setup = [model, cached, input, batch, device]() {
+            randomizeParameters(*model);
+            model->to_slab(device);
+            *cached = std::make_unique<CachedModel>(*model);
+            *input = randomTensor({batch, 3, 224, 224}, device, 1.0f);
+            (*cached)->forward(*input);
+        };
+        c.run = [cached, input]() { (*cached)->forward(*input); };
+        cases.push_back(std::move(c));
+    }
+}
+
+size_t replicaCount(const bench::Result &r) {
+    const std::string key = ",replicas=";
+    size_t pos = r.params.find(key);
+    return pos == std::string::npos ? 0 : std::stoul(r.params.substr(pos + key.size()));
+}
+
+// 为刚完成的数据并行 case 补充 scaling_efficiency = items_per_s(R) / (R * items_per_s(1))，
+// 1 个副本的 case 先于其它副本数运行
+void addScalingEfficiency(std::vector<bench::Result> &results) {
+    bench::Result &last = results.back();
+    if (last.group != "data_parallel") {
+        return;
+    }
+    for (const auto &r : results) {
+        if ((r.group == "data_parallel") && (replicaCount(r) == 1)) {
+            last.extra.emplace_back("scaling_efficiency", infinidemo::runtime::scalingEfficiency(last.items_per_s, r.items_per_s, replicaCount(last)));
+            return;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    CLI::App app{"InfiniDemo benchmark suite - ops, modules and end-to-end models"};
+
+    Device device = Device::cpu();
+    using PlatformConfig = std::tuple<const char *, Device::Type, const char *>;
+    const std::vector<PlatformConfig> platforms = {
+        {"--cpu,-c", Device::Type::CPU, "Use CPU device (default)"},
+        {"--nvidia", Device::Type::NVIDIA, "Use NVIDIA GPU device"},
+        {"--moore", Device::Type::MOORE, "Use MOORE device"},
+        {"--metax", Device::Type::METAX, "Use METAX device"},
+        {"--iluvatar", Device::Type::ILUVATAR, "Use ILUVATAR device"},
+        {"--hygon", Device::Type::HYGON, "Use HYGON device"},
+        {"--ascend", Device::Type::ASCEND, "Use ASCEND device"},
+        {"--cambricon", Device::Type::CAMBRICON, "Use CAMBRICON device"},
+    };
+    for (const auto &[flag_name, device_type, help_message] : platforms) {
+        Device::Type type = device_type;
+        app.add_flag(flag_name, [&device, type](bool) { device = Device(type); }, help_message);
+    }
+
+    bench::Options options;
+    std::vector<size_t> batches = {1, 8, 32};
+    std::vector<size_t> mnist_batches = {1, 64, 1024, 4096};
+    std::vector<size_t> resnet_batches = {1, 8, 32};
+    std::vector<size_t> dp_replicas = {1, 2, 4};
+    size_t dp_batch = 32;
+    size_t dp_cores_per_replica = 0;
+    std::vector<size_t> pp_stages = {1, 2, 4};
+    size_t pp_micro_batch = 8;
+    size_t pp_micro_batches = 16;
+    size_t pp_cores_per_stage = 0;
+    app.add_option("--warmup", options.warmup, "Warmup iterations excluded from statistics");
+    app.add_option("--iters", options.iters, "Timed iterations per case");
+    app.add_option("--filter", options.filter, "Only run cases whose group/name/params contain this substring");
+    app.add_option("--json", options.json_path, "Write machine-readable results to this file");
+    app.add_option("--batches", batches, "Batch sizes for op and module benchmarks");
+    app.add_option("--mnist-batches", mnist_batches, "Batch sizes for the MNIST model");
+    app.add_option("--resnet-batches", resnet_batches, "Batch sizes for the ResNet models");
+    app.add_option("--dp-replicas", dp_replicas, "Replica counts for the data-parallel ResNet-18 cases");
+    app.add_option("--dp-batch", dp_batch, "Batch size split across the data-parallel replicas");
+    app.add_option("--dp-cores-per-replica", dp_cores_per_replica, "Pin each data-parallel replica to this many cores (0: no pinning)");
+    app.add_option("--pp-stages", pp_stages, "Stage counts for the pipeline-parallel ResNet-18 cases");
+    app.add_option("--pp-micro-batch", pp_micro_batch, "Samples per micro-batch in the pipeline-parallel cases");
+    app.add_option("--pp-micro-batches", pp_micro_batches, "Micro-batches streamed through the pipeline per iteration");
+    app.add_option("--pp-cores-per-stage", pp_cores_per_stage, "Pin each pipeline stage to this many cores (0: no pinning)");
+
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError &e) {
+        return app.exit(e);
+    }
+
+    if (infinirtInit() != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to initialize InfiniRT" << std::endl;
+        return 1;
+    }
+    if (context::getDeviceCount(device.getType()) == 0) {
+        std::cerr << "No " << device.toString() << " device available" << std::endl;
+        return 1;
+    }
+    context::setDevice(device);
+
+    std::vector<Case> cases;
+    registerOpBenchmarks(cases, device, batches);
+    registerModuleBenchmarks(cases, device, batches);
+    registerModelBenchmarks(cases, device, mnist_batches, resnet_batches);
+    registerDataParallelBenchmarks(cases, device, dp_replicas, dp_batch, dp_cores_per_replica);
+    registerPipelineParallelBenchmarks(cases, device, pp_stages, pp_micro_batch, pp_micro_batches, pp_cores_per_stage);
+    registerResultCacheBenchmarks(cases, device, resnet_batches);
+
+    std::cout << "device: " << device.toString() << ", warmup: " << options.warmup << ", iters: " << options.iters << std::endl;
+    bench::printHeader();
+    std::vector<bench::Result> results;
+    for (const auto &c : cases) {
+        std::string key = c.group + "/" + c.name + "/" + c.params;
+        if (!options.filter.empty() && (key.find(options.filter) == std::string::npos)) {
+            continue;
+        }
+        results.push_back(bench::runCase(c, options));
+        addScalingEfficiency(results);
+        bench::printResult(results.back());
+    }
+
+    if (!options.json_path.empty()) {
+        bench::writeJson(options.json_path, results, device, options);
+        std::cout << "results written to " << options.json_path << std::endl;
+    }
+    return 0;
+}
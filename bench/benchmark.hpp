@@ -0,0 +1,228 @@
+#pragma once
+
+#include "../nn/debug.hpp"
+#include "../nn/memory_tracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 基准测试框架：每个 case 先预热 warmup 次（不计入统计），再计时 iters 次，
+// 输出 mean / p50 / p99、GFLOP/s、GB/s，并可写出 JSON 以便跨版本对比回归
+namespace infinidemo::bench {
+using namespace infinicore;
+
+struct Options {
+    size_t warmup = 5;
+    size_t iters = 20;
+    std::string filter;
+    std::string json_path;
+};
+
+// 单次迭代的工作量，用于换算吞吐
+struct Workload {
+    double flops = 0.0;
+    double bytes = 0.0;
+    double items = 0.0; // 例如每次迭代处理的图片数
+};
+
+struct Case {
+    std::string group;
+    std::string name;
+    std::string params;
+    Workload workload;
+    std::function<void()> setup;
+    std::function<void()> run;
+    // 计时结束后再各跑一次不计时的迭代，统计单次迭代的 host 堆分配次数（operator new）与 tensor 分配次数（MemoryTracker），
+    // 并给出计时迭代中的 ShapeCache 未命中次数
+    bool count_allocations = false;
+};
+
+struct Result {
+    std::string group;
+    std::string name;
+    std::string params;
+    size_t iters = 0;
+    double mean_ms = 0.0;
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double min_ms = 0.0;
+    double gflops = 0.0;
+    double gbps = 0.0;
+    double items_per_s = 0.0;
+    std::vector<std::pair<std::string, double>> extra;
+};
+
+// 全局 operator new 的调用次数，由 bench.cpp 中替换的 operator new 递增（包括 infinicore 内部的分配）
+inline std::atomic<size_t> &heapAllocationCounter() {
+    static std::atomic<size_t> counter{0};
+    return counter;
+}
+
+// 单次 run() 的 host 堆分配次数与经 nn::empty 等分配的 tensor 个数；两者分开统计，避免 tracker 自身的分配计入堆分配
+inline std::pair<size_t, size_t> countAllocations(const Case &c) {
+    size_t heap = heapAllocationCounter().load(std::memory_order_relaxed);
+    c.run();
+    context::syncDevice();
+    heap = heapAllocationCounter().load(std::memory_order_relaxed) - heap;
+
+    auto &tracker = infinidemo::nn::memory::MemoryTracker::instance();
+    bool was_enabled = tracker.enabled();
+    tracker.enable();
+    tracker.reset();
+    c.run();
+    context::syncDevice();
+    size_t tensors = 0;
+    for (const auto &device : tracker.stats().devices) {
+        tensors += device.allocations;
+    }
+    if (!was_enabled) {
+        tracker.disable();
+    }
+    return {heap, tensors};
+}
+
+inline double percentile(const std::vector<double> &sorted, double q) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+inline Result runCase(const Case &c, const Options &options) {
+    if (c.setup) {
+        c.setup();
+    }
+    for (size_t i = 0; i < options.warmup; ++i) {
+        c.run();
+    }
+    context::syncDevice();
+
+    std::vector<double> samples;
+    samples.reserve(options.iters);
+    size_t shape_computations = infinidemo::nn::debug::shapeComputations();
+    for (size_t i = 0; i < options.iters; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        c.run();
+        context::syncDevice();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    shape_computations = infinidemo::nn::debug::shapeComputations() - shape_computations;
+
+    Result r;
+    r.group = c.group;
+    r.name = c.name;
+    r.params = c.params;
+    r.iters = samples.size();
+    double total = 0.0;
+    for (double s : samples) {
+        total += s;
+    }
+    std::sort(samples.begin(), samples.end());
+    r.mean_ms = samples.empty() ? 0.0 : total / static_cast<double>(samples.size());
+    r.p50_ms = percentile(samples, 0.50);
+    r.p99_ms = percentile(samples, 0.99);
+    r.min_ms = samples.empty() ? 0.0 : samples.front();
+    if (r.mean_ms > 0.0) {
+        r.gflops = c.workload.flops / (r.mean_ms * 1e6);
+        r.gbps = c.workload.bytes / (r.mean_ms * 1e6);
+        r.items_per_s = c.workload.items * 1000.0 / r.mean_ms;
+    }
+    if (c.count_allocations && !samples.empty()) {
+        auto [heap, tensors] = countAllocations(c);
+        r.extra.emplace_back("heap_allocs_per_iter", static_cast<double>(heap));
+        r.extra.emplace_back("tensor_allocs_per_iter", static_cast<double>(tensors));
+        r.extra.emplace_back("shape_cache_misses_per_iter", static_cast<double>(shape_computations) / static_cast<double>(samples.size()));
+    }
+    return r;
+}
+
+inline void printHeader() {
+    std::cout << std::left << std::setw(10) << "group" << std::setw(28) << "name" << std::setw(44) << "params"
+              << std::right << std::setw(11) << "mean(ms)" << std::setw(11) << "p50(ms)" << std::setw(11) << "p99(ms)"
+              << std::setw(11) << "GFLOP/s" << std::setw(10) << "GB/s" << std::setw(12) << "items/s" << std::endl;
+}
+
+inline void printResult(const Result &r) {
+    std::cout << std::left << std::setw(10) << r.group << std::setw(28) << r.name << std::setw(44) << r.params
+              << std::right << std::fixed << std::setprecision(3)
+              << std::setw(11) << r.mean_ms << std::setw(11) << r.p50_ms << std::setw(11) << r.p99_ms
+              << std::setprecision(2) << std::setw(11) << r.gflops << std::setw(10) << r.gbps
+              << std::setw(12) << r.items_per_s;
+    for (const auto &[key, value] : r.extra) {
+        std::cout << "  " << key << "=" << value;
+    }
+    std::cout << std::endl;
+}
+
+inline std::string toJson(const std::vector<Result> &results, const Device &device, const Options &options) {
+    std::ostringstream os;
+    os << std::setprecision(6);
+    os << "{\n  \"device\": \"" << device.toString() << "\",\n  \"warmup\": " << options.warmup
+       << ",\n  \"iters\": " << options.iters << ",\n  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto &r = results[i];
+        os << "    {\"group\": \"" << r.group << "\", \"name\": \"" << r.name << "\", \"params\": \"" << r.params
+           << "\", \"iters\": " << r.iters << ", \"mean_ms\": " << r.mean_ms << ", \"p50_ms\": " << r.p50_ms
+           << ", \"p99_ms\": " << r.p99_ms << ", \"min_ms\": " << r.min_ms << ", \"gflops\": " << r.gflops
+           << ", \"gbps\": " << r.gbps << ", \"items_per_s\": " << r.items_per_s;
+        for (const auto &[key, value] : r.extra) {
+            os << ", \"" << key << "\": " << value;
+        }
+        os << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+    return os.str();
+}
+
+inline void writeJson(const std::string &path, const std::vector<Result> &results, const Device &device, const Options &options) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Failed to open json output: " + path);
+    }
+    file << toJson(results, device, options);
+}
+
+// 在 device 上创建随机初始化的 F32 tensor（固定种子，保证不同版本之间输入一致）
+inline Tensor randomTensor(const Shape &shape, const Device &device, float scale = 0.1f, unsigned seed = 0) {
+    size_t numel = 1;
+    for (auto s : shape) {
+        numel *= s;
+    }
+    Tensor host = Tensor::empty(shape, DataType::F32, Device::cpu());
+    float *data = reinterpret_cast<float *>(host->data());
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-scale, scale);
+    for (size_t i = 0; i < numel; ++i) {
+        data[i] = dist(gen);
+    }
+    if (device.getType() == Device::Type::CPU) {
+        return host;
+    }
+    return host->to(device);
+}
+
+inline size_t numel(const Shape &shape) {
+    size_t n = 1;
+    for (auto s : shape) {
+        n *= s;
+    }
+    return n;
+}
+
+} // namespace infinidemo::bench
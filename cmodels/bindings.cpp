@@ -1,10 +1,23 @@
+#include "bindings_debug.hpp"
+#include "bindings_dlpack.hpp"
+#include "bindings_image.hpp"
+#include "bindings_memory.hpp"
+#include "bindings_profiler.hpp"
+#include "bindings_runtime.hpp"
 #include "mnist/bindings_mnist.hpp"
 #include "resnet/bindings_resnet.hpp"
 #include <pybind11/pybind11.h>
 
 namespace py = pybind11;
 PYBIND11_MODULE(_infinidemo, m) {
+    infinidemo::models::bind_mnist_config(m);
     infinidemo::models::bind_mnist(m);
     infinidemo::models::bind_resnet_model(m);
     infinidemo::models::bind_resnet_config(m);
+    infinidemo::models::bind_dlpack(m);
+    infinidemo::models::bind_image(m);
+    infinidemo::models::bind_debug(m);
+    infinidemo::models::bind_profiler(m);
+    infinidemo::models::bind_memory(m);
+    infinidemo::models::bind_runtime(m);
 }
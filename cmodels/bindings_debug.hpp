@@ -0,0 +1,30 @@
+#pragma once
+
+#include "../nn/debug.hpp"
+#include <pybind11/pybind11.h>
+
+namespace py = pybind11;
+
+namespace infinidemo::models {
+// 绑定调试计数器到 _infinidemo.debug 子模块
+inline void bind_debug(py::module_ &m) {
+    py::module_ debug = m.def_submodule("debug", "Debug counters and switches for the forward hot path");
+    debug.def("cross_device_copies", &infinidemo::nn::debug::crossDeviceCopies,
+              R"doc(
+                Number of cross-device tensor copies issued through the tracked transfer path
+                (debug::toDevice and the pinned input uploader). Copies made elsewhere are not counted.
+
+                Example:
+                    >>> _infinidemo.debug.reset_cross_device_copies()
+                    >>> model.forward(x)
+                    >>> assert _infinidemo.debug.cross_device_copies() == 0
+                )doc");
+    debug.def("reset_cross_device_copies", &infinidemo::nn::debug::resetCrossDeviceCopies);
+    debug.def("set_force_composite_pooling", &infinidemo::nn::debug::setForceCompositePooling, py::arg("enable"),
+              R"doc(
+                Run MaxPool2d / AvgPool2d through the device-resident composite path on every device,
+                so the HYGON / MOORE code path can be exercised on the CPU backend.
+                )doc");
+    debug.def("force_composite_pooling", &infinidemo::nn::debug::forceCompositePooling);
+}
+} // namespace infinidemo::models
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "../nn/debug.hpp"
+#include "bindings_utils.hpp"
+#include "dlpack.hpp"
+#include <infinicore/context/context.hpp>
+#include <infinicore/tensor.hpp>
+#include <pybind11/pybind11.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace infinidemo::models {
+
+// 把 infinicore Tensor 以 DLPack（__dlpack__ / __dlpack_device__）和 buffer protocol 暴露给
+// numpy / torch，np.from_dlpack(buf) 与 np.asarray(buf) 都直接引用 tensor 的内存
+struct TensorBuffer {
+    infinicore::Tensor tensor;
+};
+
+inline std::string bufferFormat(infinicore::DataType dtype) {
+    switch (dtype) {
+    case infinicore::DataType::BOOL:
+        return "?";
+    case infinicore::DataType::I8:
+        return "b";
+    case infinicore::DataType::U8:
+        return "B";
+    case infinicore::DataType::I16:
+        return "h";
+    case infinicore::DataType::I32:
+        return py::format_descriptor<int32_t>::format();
+    case infinicore::DataType::I64:
+        return py::format_descriptor<int64_t>::format();
+    case infinicore::DataType::U16:
+        return "H";
+    case infinicore::DataType::U32:
+        return py::format_descriptor<uint32_t>::format();
+    case infinicore::DataType::U64:
+        return py::format_descriptor<uint64_t>::format();
+    case infinicore::DataType::F16:
+        return "e";
+    case infinicore::DataType::F32:
+        return "f";
+    case infinicore::DataType::F64:
+        return "d";
+    default:
+        throw py::buffer_error("dtype " + infinicore::toString(dtype) + " has no buffer format, use __dlpack__ instead");
+    }
+}
+
+inline void dlpackCapsuleDestructor(PyObject *capsule) {
+    // 只有未被消费的 capsule 才需要释放，消费者会把名字改为 used_dltensor
+    if (PyCapsule_IsValid(capsule, "dltensor")) {
+        auto *managed = static_cast<dlpack::DLManagedTensor *>(PyCapsule_GetPointer(capsule, "dltensor"));
+        managed->deleter(managed);
+    }
+}
+
+inline py::capsule toDLPackCapsule(const infinicore::Tensor &tensor) {
+    if (tensor->device().getType() != infinicore::Device::Type::CPU) {
+        // 生产者与消费者不共享 stream，导出前等待设备上的计算完成
+        infinicore::context::syncDevice();
+    }
+    dlpack::DLManagedTensor *managed = dlpack::toDLPack(tensor);
+    PyObject *capsule = PyCapsule_New(managed, "dltensor", dlpackCapsuleDestructor);
+    if (capsule == nullptr) {
+        managed->deleter(managed);
+        throw py::error_already_set();
+    }
+    return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+// 包装成 infinicore.Tensor，并让它持有 owner，保证零拷贝导入的内存与结果同生命周期
+inline py::object wrapTensor(const infinicore::Tensor &tensor, const py::object &owner) {
+    py::object wrapped = wrapTensor(tensor);
+    if (!owner.is_none()) {
+        py::setattr(wrapped, "_infinidemo_owner", owner);
+    }
+    return wrapped;
+}
+
+inline void bind_dlpack(py::module_ &m) {
+    py::class_<TensorBuffer>(m, "TensorBuffer", py::buffer_protocol())
+        .def(py::init([](py::handle tensor, bool to_host) {
+                 TensorBuffer buffer{toTensor(tensor)};
+                 if (to_host) {
+                     // 只有不在 CPU 上时才拷贝一次（计入 debug.cross_device_copies）
+                     buffer.tensor = infinidemo::nn::debug::toDevice(buffer.tensor, infinicore::Device::cpu());
+                 }
+                 return buffer;
+             }),
+             py::arg("tensor"), py::arg("to_host") = false,
+             R"doc(
+                Zero-copy view of an infinicore.Tensor for numpy / torch.
+
+                Args:
+                    tensor: infinicore.Tensor
+                    to_host: Copy to CPU first when the tensor lives on a device
+
+                Example:
+                    >>> logits = np.from_dlpack(_infinidemo.TensorBuffer(model(x), to_host=True))
+                )doc")
+        .def("__dlpack__",
+             [](const TensorBuffer &self, const py::args &, const py::kwargs &) { return toDLPackCapsule(self.tensor); })
+        .def("__dlpack_device__",
+             [](const TensorBuffer &self) {
+                 dlpack::DLDevice device = dlpack::toDLDevice(self.tensor->device());
+                 return py::make_tuple(device.device_type, device.device_id);
+             })
+        .def_buffer([](TensorBuffer &self) -> py::buffer_info {
+            if (self.tensor->device().getType() != infinicore::Device::Type::CPU) {
+                throw py::buffer_error("Buffer protocol is only available for CPU tensors, use to_host=True");
+            }
+            size_t itemsize = infinicore::dsize(self.tensor->dtype());
+            std::vector<py::ssize_t> shape(self.tensor->shape().begin(), self.tensor->shape().end());
+            std::vector<py::ssize_t> strides;
+            strides.reserve(shape.size());
+            for (auto stride : self.tensor->strides()) {
+                strides.push_back(static_cast<py::ssize_t>(stride * static_cast<infinicore::Stride>(itemsize)));
+            }
+            return py::buffer_info(self.tensor->data(), static_cast<py::ssize_t>(itemsize), bufferFormat(self.tensor->dtype()),
+                                   static_cast<py::ssize_t>(shape.size()), shape, strides);
+        })
+        .def("data_ptr", [](const TensorBuffer &self) { return reinterpret_cast<uintptr_t>(self.tensor->data()); })
+        .def_property_readonly("shape", [](const TensorBuffer &self) { return self.tensor->shape(); });
+
+    m.def(
+        "from_dlpack",
+        [](py::handle obj) {
+            ImportedTensor imported = PyObject_CheckBuffer(obj.ptr()) && !py::hasattr(obj, "__dlpack__")
+                                        ? importBuffer(obj)
+                                        : importDLPack(obj);
+            return wrapTensor(imported.tensor, imported.owner);
+        },
+        py::arg("obj"),
+        R"doc(
+            Import a DLPack-capable object (torch.Tensor, numpy.ndarray, capsule) or a buffer
+            as an infinicore.Tensor without copying. The result keeps the source alive.
+
+            Example:
+                >>> x = _infinidemo.from_dlpack(pixel_values)   # torch / numpy, no copy
+                >>> logits = model(x.to(device))
+            )doc");
+    m.def(
+        "to_dlpack",
+        [](py::handle tensor) { return toDLPackCapsule(toTensor(tensor)); },
+        py::arg("tensor"),
+        R"doc(
+            Export an infinicore.Tensor as a DLPack capsule without copying.
+            )doc");
+}
+
+} // namespace infinidemo::models
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "bindings_utils.hpp"
+#include "vision/image_processing.hpp"
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace infinidemo::models {
+
+// numpy uint8 [H, W, 3] 数组转换为 Image，需要在持有 GIL 时调用
+inline vision::Image imageFromArray(const py::array_t<uint8_t, py::array::c_style | py::array::forcecast> &array) {
+    if ((array.ndim() != 3) || (array.shape(2) != 3)) {
+        throw py::value_error("Expected a uint8 RGB array of shape [H, W, 3]");
+    }
+    vision::Image image;
+    image.height = static_cast<int>(array.shape(0));
+    image.width = static_cast<int>(array.shape(1));
+    image.data.assign(array.data(), array.data() + array.size());
+    return image;
+}
+
+// 绑定原生图像预处理到 _infinidemo.image 子模块，解码、缩放与归一化期间释放 GIL
+inline void bind_image(py::module_ &m) {
+    using vision::ImageProcessor;
+    using vision::ImageProcessorConfig;
+    py::module_ image = m.def_submodule("image", "Native image preprocessing: decode, resize, center crop, normalize");
+
+    py::enum_<vision::Resample>(image, "Resample")
+        .value("BILINEAR", vision::Resample::Bilinear)
+        .value("BICUBIC", vision::Resample::Bicubic);
+
+    py::enum_<vision::Layout>(image, "Layout")
+        .value("NCHW", vision::Layout::NCHW)
+        .value("NHWC", vision::Layout::NHWC);
+
+    py::class_<ImageProcessorConfig>(image, "ImageProcessorConfig")
+        .def(py::init<>())
+        .def_readwrite("shortest_edge", &ImageProcessorConfig::shortest_edge)
+        .def_readwrite("crop_pct", &ImageProcessorConfig::crop_pct)
+        .def_readwrite("resample", &ImageProcessorConfig::resample)
+        .def_readwrite("do_resize", &ImageProcessorConfig::do_resize)
+        .def_readwrite("do_normalize", &ImageProcessorConfig::do_normalize)
+        .def_readwrite("rescale_factor", &ImageProcessorConfig::rescale_factor)
+        .def_readwrite("image_mean", &ImageProcessorConfig::image_mean)
+        .def_readwrite("image_std", &ImageProcessorConfig::image_std)
+        .def_readwrite("layout", &ImageProcessorConfig::layout)
+        .def_readwrite("fold_scale", &ImageProcessorConfig::fold_scale);
+
+    py::class_<ImageProcessor>(image, "ImageProcessor")
+        .def(py::init<const ImageProcessorConfig &>(), py::arg("config") = ImageProcessorConfig())
+        .def_property_readonly("config", &ImageProcessor::config)
+        .def(
+            "preprocess_files",
+            [](const ImageProcessor &self, const std::vector<std::string> &paths, infinicore::Device device) {
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    std::vector<vision::Image> images;
+                    images.reserve(paths.size());
+                    for (const auto &path : paths) {
+                        images.push_back(vision::decodeImageFile(path));
+                    }
+                    output = self(images, device);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("paths"), py::arg("device") = infinicore::Device::cpu(),
+            R"doc(
+                Decode, resize, crop and normalize image files into one F32 batch.
+
+                Example:
+                    >>> pixel_values = processor.preprocess_files(["dog.jpg"], device._underlying)
+                )doc")
+        .def(
+            "preprocess_bytes",
+            [](const ImageProcessor &self, const std::vector<py::bytes> &blobs, infinicore::Device device) {
+                std::vector<std::string> encoded(blobs.begin(), blobs.end());
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    std::vector<vision::Image> images;
+                    images.reserve(encoded.size());
+                    for (const auto &data : encoded) {
+                        images.push_back(vision::decodeImage(reinterpret_cast<const uint8_t *>(data.data()), data.size()));
+                    }
+                    output = self(images, device);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("blobs"), py::arg("device") = infinicore::Device::cpu())
+        .def(
+            "preprocess_arrays",
+            [](const ImageProcessor &self, const py::list &arrays, infinicore::Device device) {
+                std::vector<vision::Image> images;
+                images.reserve(arrays.size());
+                for (py::handle item : arrays) {
+                    images.push_back(imageFromArray(py::cast<py::array_t<uint8_t, py::array::c_style | py::array::forcecast>>(item)));
+                }
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    output = self(images, device);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("arrays"), py::arg("device") = infinicore::Device::cpu(),
+            R"doc(
+                Preprocess already decoded uint8 RGB arrays of shape [H, W, 3], e.g. np.asarray(PIL.Image).
+                )doc")
+        .def(
+            "fold_normalization",
+            [](ImageProcessor &self, py::handle conv_weight) {
+                infinicore::Tensor weight = toTensor(conv_weight);
+                py::gil_scoped_release release;
+                self.foldNormalization(weight);
+            },
+            py::arg("conv_weight"),
+            R"doc(
+                Fold rescale_factor / image_std into the first conv weight [out, 3, kh, kw] in place.
+                Afterwards the processor only subtracts the mean.
+                )doc");
+}
+
+} // namespace infinidemo::models
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "../nn/memory_tracker.hpp"
+#include "bindings_utils.hpp"
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+namespace py = pybind11;
+
+namespace infinidemo::models {
+// 绑定内存统计到 _infinidemo.memory 子模块
+inline void bind_memory(py::module_ &m) {
+    using infinidemo::nn::memory::MemoryTracker;
+    py::module_ memory = m.def_submodule("memory", "Allocation tracking for forward, load_state_dict and to()");
+
+    memory.def("enable", []() { MemoryTracker::instance().enable(); },
+               "Start tracking allocations (also enabled by INFINIDEMO_TRACK_MEMORY=1).");
+    memory.def("disable", []() { MemoryTracker::instance().disable(); });
+    memory.def("is_enabled", []() { return MemoryTracker::instance().enabled(); });
+    memory.def("reset", []() { MemoryTracker::instance().reset(); },
+               "Clear cumulative counters and the histogram; peaks restart from the current bytes.");
+    memory.def(
+        "stats",
+        [](bool reset) { return globalMemoryStatsToDict(reset); },
+        py::arg("reset") = false,
+        R"doc(
+            Current / peak bytes per device, per module path and per phase, plus a power-of-two size histogram.
+            reset=True clears the counters under the same lock as the read.
+
+            Example:
+                >>> _infinidemo.memory.enable()
+                >>> _infinidemo.memory.reset()
+                >>> model.forward(x)
+                >>> print(_infinidemo.memory.stats()["report"])
+            )doc");
+}
+} // namespace infinidemo::models
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../nn/profiler.hpp"
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+
+namespace py = pybind11;
+
+namespace infinidemo::models {
+// 绑定逐层 profiler 到 _infinidemo.profiler 子模块
+inline void bind_profiler(py::module_ &m) {
+    using infinidemo::nn::profiler::Profiler;
+    py::module_ profiler = m.def_submodule("profiler", "Per-layer profiler for module forward and perform* calls");
+
+    profiler.def("is_available", &infinidemo::nn::profiler::compiledIn,
+                 "Whether the extension was built with `xmake f --profiler=y`.");
+    profiler.def("enable", []() { Profiler::instance().enable(); });
+    profiler.def("disable", []() { Profiler::instance().disable(); });
+    profiler.def("is_enabled", []() { return Profiler::instance().enabled(); });
+    profiler.def("reset", []() { Profiler::instance().reset(); });
+    profiler.def(
+        "export_chrome_trace",
+        [](const std::string &path) { Profiler::instance().exportChromeTrace(path); },
+        py::arg("path"),
+        R"doc(
+            Write the recorded events as Chrome trace JSON (open with chrome://tracing or Perfetto).
+            )doc");
+    profiler.def("summary_table", []() { return Profiler::instance().summaryTable(); });
+    profiler.def(
+        "summary",
+        []() {
+            py::list rows;
+            for (const auto &row : Profiler::instance().summary()) {
+                py::dict item;
+                item["name"] = row.name;
+                item["category"] = row.category;
+                item["shapes"] = row.shapes;
+                item["calls"] = row.calls;
+                item["wall_ms"] = row.total_wall_us / 1000.0;
+                item["device_ms"] = row.total_device_us / 1000.0;
+                item["descriptor_ms"] = row.total_descriptor_us / 1000.0;
+                item["bytes_allocated"] = row.total_bytes_allocated;
+                rows.append(item);
+            }
+            return rows;
+        },
+        R"doc(
+            Per-layer summary, one dict per module path / op name, sorted by total wall time.
+
+            Example:
+                >>> _infinidemo.profiler.enable()
+                >>> model.forward(x)
+                >>> for row in _infinidemo.profiler.summary()[:5]:
+                ...     print(row["name"], row["wall_ms"])
+            )doc");
+}
+} // namespace infinidemo::models
@@ -0,0 +1,400 @@
+#pragma once
+
+#include "bindings_image.hpp"
+#include "bindings_utils.hpp"
+#include "resnet/modeling_resnet.hpp"
+#include "runtime/data_parallel.hpp"
+#include "runtime/inference_runner.hpp"
+#include "runtime/pipeline.hpp"
+#include "runtime/pipeline_parallel.hpp"
+#include "runtime/result_cache.hpp"
+#include "runtime/shape_buckets.hpp"
+#include <algorithm>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace infinidemo::models {
+
+// 绑定流水线执行器到 _infinidemo.runtime 子模块，整个 run 期间释放 GIL
+inline void bind_runtime(py::module_ &m) {
+    using runtime::PipelineConfig;
+    py::module_ rt = m.def_submodule("runtime", "Pipelined offline classification: preprocess, H2D, forward, postprocess");
+
+    py::class_<PipelineConfig>(rt, "PipelineConfig")
+        .def(py::init<>())
+        .def_readwrite("preprocess_threads", &PipelineConfig::preprocess_threads)
+        .def_readwrite("batch_size", &PipelineConfig::batch_size)
+        .def_readwrite("queue_depth", &PipelineConfig::queue_depth)
+        .def_readwrite("top_k", &PipelineConfig::top_k)
+        .def_readwrite("device", &PipelineConfig::device);
+
+    using Runner = runtime::InferenceRunner<ResNetForImageClassification>;
+    py::class_<Runner>(rt, "InferenceRunner")
+        .def(py::init<ResNetForImageClassification &, const infinicore::Device &, size_t>(),
+             py::arg("model"), py::arg("device"), py::arg("depth") = 2, py::keep_alive<1, 2>(),
+             R"doc(
+                Request runner that uploads host inputs through pinned staging buffers.
+                With depth >= 2, forward_many enqueues the upload of request N+1 before the compute of request N and
+                synchronizes the device once at the end, so the copy overlaps that compute. On the CPU backend uploads are no-ops.
+                )doc")
+        .def(
+            "forward",
+            [](Runner &self, py::handle input) {
+                ImportedTensor imported = toInputTensor(input);
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    output = self.forward(imported.tensor);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("input"))
+        .def(
+            "forward_many",
+            [](Runner &self, const py::list &py_inputs) {
+                std::vector<ImportedTensor> imported;
+                std::vector<infinicore::Tensor> inputs;
+                for (auto item : py_inputs) {
+                    imported.push_back(toInputTensor(item));
+                    inputs.push_back(imported.back().tensor);
+                }
+                std::vector<infinicore::Tensor> outputs;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    outputs = self.forwardMany(inputs);
+                }
+                py::list result;
+                for (const auto &output : outputs) {
+                    result.append(wrapTensor(output));
+                }
+                return result;
+            },
+            py::arg("inputs"))
+        .def("stats", [](const Runner &self) {
+            const runtime::RunnerStats &stats = self.stats();
+            py::dict item;
+            item["requests"] = stats.requests;
+            item["uploaded_bytes"] = stats.uploaded_bytes;
+            item["staging_bytes"] = stats.staging_bytes;
+            item["overlapped_uploads"] = stats.overlapped_uploads;
+            item["wall_ms"] = stats.wall_ms;
+            return item;
+        });
+
+    using DataParallel = runtime::DataParallel<ResNetForImageClassification>;
+    py::class_<DataParallel>(rt, "DataParallel")
+        .def(py::init([](ResNetForImageClassification &model, const std::vector<infinicore::Device> &devices, size_t cores_per_replica) {
+                 py::gil_scoped_release release;
+                 return std::make_unique<DataParallel>(
+                     [&model](const infinicore::Device &device) { return ResNetForImageClassification::replicate(model, device); },
+                     devices, cores_per_replica);
+             }),
+             py::arg("model"), py::arg("devices"), py::arg("cores_per_replica") = 0, py::keep_alive<1, 2>(),
+             R"doc(
+                One replica of `model` per entry of `devices`, each driven by its own thread. A device may repeat
+                (e.g. several CPU replicas); replicas on the model's own device share its weights.
+                cores_per_replica > 0 pins replica i to cores [i * cores_per_replica, (i + 1) * cores_per_replica);
+                0 (default) splits all cores evenly across the CPU replicas.
+                )doc")
+        .def(
+            "forward",
+            [](DataParallel &self, py::handle input) {
+                ImportedTensor imported = toInputTensor(input);
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    output = self.forward(imported.tensor);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("input"),
+            R"doc(
+                Split the batch along N across the replicas, run the shards concurrently and return the logits in order.
+                )doc")
+        .def_property_readonly("replicas", &DataParallel::replicas)
+        .def("reset_stats", &DataParallel::resetStats)
+        .def("stats", [](const DataParallel &self) {
+            runtime::DataParallelStats stats = self.stats();
+            py::dict item;
+            item["replicas"] = stats.replicas;
+            item["batches"] = stats.batches;
+            item["samples"] = stats.samples;
+            item["wall_ms"] = stats.wall_ms;
+            item["samples_per_s"] = stats.samplesPerSecond();
+            item["utilization"] = stats.utilization();
+            item["replica_busy_ms"] = stats.replica_busy_ms;
+            return item;
+        });
+
+    using PipelineParallel = runtime::PipelineParallel<ResNetForImageClassification>;
+    py::class_<PipelineParallel>(rt, "PipelineParallel")
+        .def(py::init([](ResNetForImageClassification &model, const std::vector<infinicore::Device> &devices, const infinicore::Shape &micro_batch_shape,
+                         size_t queue_depth, size_t cores_per_stage) {
+                 py::gil_scoped_release release;
+                 return std::make_unique<PipelineParallel>(
+                     [&model](const infinicore::Device &device) { return ResNetForImageClassification::replicate(model, device); },
+                     devices, micro_batch_shape, queue_depth, cores_per_stage);
+             }),
+             py::arg("model"), py::arg("devices"), py::arg("micro_batch_shape"), py::arg("queue_depth") = 2, py::arg("cores_per_stage") = 0,
+             py::keep_alive<1, 2>(),
+             R"doc(
+                Pipeline-parallel executor: the embedder, every ResNetStage and the head are partitioned into len(devices)
+                balanced stages (profiler per-layer cost when recorded, estimated FLOPs otherwise), one thread per stage,
+                connected by bounded queues of `queue_depth` micro-batches. A device may repeat (CPU core groups);
+                cores_per_stage > 0 pins stage i to cores [i * cores_per_stage, (i + 1) * cores_per_stage).
+                )doc")
+        .def(
+            "run",
+            [](PipelineParallel &self, const py::list &py_inputs) {
+                std::vector<ImportedTensor> imported;
+                std::vector<infinicore::Tensor> inputs;
+                for (auto item : py_inputs) {
+                    imported.push_back(toInputTensor(item));
+                    inputs.push_back(imported.back().tensor);
+                }
+                std::vector<infinicore::Tensor> outputs;
+                {
+                    py::gil_scoped_release release;
+                    outputs = self.run(inputs);
+                }
+                py::list result;
+                for (const auto &output : outputs) {
+                    result.append(wrapTensor(output));
+                }
+                return result;
+            },
+            py::arg("micro_batches"),
+            R"doc(
+                Stream the micro-batches through the pipeline and return their logits in input order.
+                )doc")
+        .def(
+            "forward",
+            [](PipelineParallel &self, py::handle input, size_t micro_batch) {
+                ImportedTensor imported = toInputTensor(input);
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    output = self.forward(imported.tensor, micro_batch);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("input"), py::arg("micro_batch"),
+            R"doc(
+                Split the batch along N into micro-batches of `micro_batch` samples, stream them and return the logits in order.
+                )doc")
+        .def_property_readonly("stages", &PipelineParallel::stages)
+        .def("reset_stats", &PipelineParallel::resetStats)
+        .def("stats", [](const PipelineParallel &self) {
+            runtime::PipelineParallelStats stats = self.stats();
+            py::dict item;
+            item["stage_names"] = stats.stage_names;
+            item["stage_costs"] = stats.stage_costs;
+            item["measured_costs"] = stats.measured_costs;
+            item["micro_batches"] = stats.micro_batches;
+            item["samples"] = stats.samples;
+            item["wall_ms"] = stats.wall_ms;
+            item["samples_per_s"] = stats.samplesPerSecond();
+            item["steady_samples_per_s"] = stats.steadySamplesPerSecond();
+            item["stage_busy_ms"] = stats.stage_busy_ms;
+            item["stage_bubble_ms"] = stats.stageBubbleMs();
+            item["report"] = stats.toString();
+            return item;
+        });
+
+    using CachedModel = runtime::CachedModel<ResNetForImageClassification>;
+    py::class_<CachedModel>(rt, "CachedModel")
+        .def(py::init([](ResNetForImageClassification &model, size_t max_bytes, size_t max_entries) {
+                 runtime::ResultCacheConfig config;
+                 config.max_bytes = max_bytes;
+                 config.max_entries = max_entries;
+                 return std::make_unique<CachedModel>(model, config);
+             }),
+             py::arg("model"), py::arg("max_bytes") = size_t(256) << 20, py::arg("max_entries") = 0, py::keep_alive<1, 2>(),
+             R"doc(
+                LRU cache of per-sample outputs in front of model.forward, keyed by a SIMD hash of each sample's bytes,
+                shape and dtype. Only cache misses (deduplicated within the batch) are forwarded.
+                max_bytes bounds the cached output bytes; max_entries = 0 means no entry limit.
+                Pass host inputs: device inputs are copied back once for hashing.
+                )doc")
+        .def(
+            "forward", [](CachedModel &self, py::handle input) { return forwardNoGil(self, input); }, py::arg("input"))
+        .def("__call__", [](CachedModel &self, py::handle input) { return forwardNoGil(self, input); }, py::arg("input"))
+        .def("clear", [](CachedModel &self) { self.cache().clear(); })
+        .def("reset_stats", [](CachedModel &self) { self.cache().resetStats(); })
+        .def("stats", [](const CachedModel &self) {
+            runtime::ResultCacheStats stats = self.cache().stats();
+            py::dict item;
+            item["lookups"] = stats.lookups;
+            item["hits"] = stats.hits;
+            item["misses"] = stats.misses;
+            item["hit_rate"] = stats.hitRate();
+            item["evictions"] = stats.evictions;
+            item["entries"] = stats.entries;
+            item["bytes"] = stats.bytes;
+            item["hashed_bytes"] = stats.hashed_bytes;
+            item["hash_ms"] = stats.hash_ms;
+            return item;
+        });
+
+    py::enum_<runtime::BucketPolicy>(rt, "BucketPolicy")
+        .value("PAD", runtime::BucketPolicy::Pad)
+        .value("RESIZE", runtime::BucketPolicy::Resize);
+
+    py::class_<runtime::BucketingConfig>(rt, "BucketingConfig")
+        .def(py::init<>())
+        .def_property(
+            "buckets",
+            [](const runtime::BucketingConfig &self) {
+                std::vector<std::pair<int, int>> buckets;
+                for (const auto &b : self.buckets) {
+                    buckets.emplace_back(b.width, b.height);
+                }
+                return buckets;
+            },
+            [](runtime::BucketingConfig &self, const std::vector<std::pair<int, int>> &buckets) {
+                self.buckets.clear();
+                for (const auto &[width, height] : buckets) {
+                    self.buckets.push_back({width, height});
+                }
+            },
+            "List of (width, height) bucket sizes")
+        .def_readwrite("policy", &runtime::BucketingConfig::policy)
+        .def_readwrite("max_batch", &runtime::BucketingConfig::max_batch)
+        .def_readwrite("resample", &runtime::BucketingConfig::resample);
+
+    using ShapeBucketer = runtime::ShapeBucketer<ResNetForImageClassification>;
+    auto run_bucketed = [](ShapeBucketer &self, std::vector<vision::Image> &&images) {
+        infinicore::Tensor output;
+        {
+            py::gil_scoped_release release;
+            output = self.forward(images);
+        }
+        return wrapTensor(output);
+    };
+    py::class_<ShapeBucketer>(rt, "ShapeBucketer")
+        .def(py::init([](ResNetForImageClassification &model, const vision::ImageProcessor &processor, const runtime::BucketingConfig &config,
+                         const infinicore::Device &device) {
+                 py::gil_scoped_release release;
+                 return std::make_unique<ShapeBucketer>(model, processor, config, device);
+             }),
+             py::arg("model"), py::arg("processor"), py::arg("config"), py::arg("device") = infinicore::Device::cpu(),
+             py::keep_alive<1, 2>(), py::keep_alive<1, 3>(),
+             R"doc(
+                Map images of arbitrary size onto the configured bucket shapes (PAD: smallest bucket that fits, padded with
+                the mean color; RESIZE: bucket of the closest area) and batch requests within a bucket. The processor's
+                resize / crop settings are not applied; only its normalization is. Shape caches for every bucket and
+                batch size 1..max_batch and the pinned staging slots are built in the constructor.
+                )doc")
+        .def(
+            "forward_files",
+            [run_bucketed](ShapeBucketer &self, const std::vector<std::string> &paths) {
+                std::vector<vision::Image> images;
+                {
+                    py::gil_scoped_release release;
+                    for (const auto &path : paths) {
+                        images.push_back(vision::decodeImageFile(path));
+                    }
+                }
+                return run_bucketed(self, std::move(images));
+            },
+            py::arg("paths"),
+            R"doc(
+                Decode the files and return the logits of every image in input order, [N, num_labels].
+                )doc")
+        .def(
+            "forward_arrays",
+            [run_bucketed](ShapeBucketer &self, const py::list &arrays) {
+                std::vector<vision::Image> images;
+                for (py::handle item : arrays) {
+                    images.push_back(imageFromArray(py::cast<py::array_t<uint8_t, py::array::c_style | py::array::forcecast>>(item)));
+                }
+                return run_bucketed(self, std::move(images));
+            },
+            py::arg("arrays"),
+            R"doc(
+                Same as forward_files for decoded uint8 RGB arrays of shape [H, W, 3] with arbitrary H and W.
+                )doc")
+        .def(
+            "bucket_for", [](const ShapeBucketer &self, int width, int height) { return self.bucketFor(width, height); },
+            py::arg("width"), py::arg("height"))
+        .def("reset_stats", &ShapeBucketer::resetStats)
+        .def("stats", [](const ShapeBucketer &self) {
+            runtime::BucketingStats stats = self.stats();
+            py::list buckets;
+            for (size_t i = 0; i < stats.buckets.size(); ++i) {
+                const auto &b = stats.buckets[i];
+                py::dict item;
+                item["width"] = b.bucket.width;
+                item["height"] = b.bucket.height;
+                item["requests"] = b.requests;
+                item["hit_rate"] = stats.hitRate(i);
+                item["batches"] = b.batches;
+                item["resized"] = b.resized;
+                item["padding_waste"] = b.paddingWaste();
+                item["forward_ms"] = b.forward_ms;
+                buckets.append(item);
+            }
+            py::dict result;
+            result["requests"] = stats.requests;
+            result["padding_waste"] = stats.paddingWaste();
+            result["buckets"] = buckets;
+            result["report"] = stats.toString();
+            return result;
+        });
+
+    rt.def(
+        "classify",
+        [](ResNetForImageClassification &model, const vision::ImageProcessor &processor, const PipelineConfig &config,
+           const std::string &directory, size_t synthetic, int synthetic_width, int synthetic_height) {
+            runtime::ImageSource source = directory.empty()
+                                            ? runtime::syntheticSource(synthetic, synthetic_width, synthetic_height)
+                                            : runtime::directorySource(directory);
+            std::vector<runtime::ClassificationResult> results;
+            runtime::PipelineReport report;
+            {
+                py::gil_scoped_release release;
+                runtime::ClassificationPipeline<ResNetForImageClassification> pipeline(model, processor, config);
+                results.reserve(source.size);
+                report = pipeline.run(source, [&results](runtime::ClassificationResult &&r) { results.push_back(std::move(r)); });
+                std::sort(results.begin(), results.end(), [](const auto &a, const auto &b) { return a.index < b.index; });
+            }
+
+            py::list items;
+            for (const auto &r : results) {
+                py::list predictions;
+                for (const auto &p : r.predictions) {
+                    predictions.append(py::make_tuple(p.label, p.prob));
+                }
+                py::dict item;
+                item["index"] = r.index;
+                item["name"] = r.name;
+                item["predictions"] = predictions;
+                items.append(item);
+            }
+            return py::make_tuple(items, report.toString());
+        },
+        py::arg("model"), py::arg("processor"), py::arg("config"), py::arg("directory") = "",
+        py::arg("synthetic") = 0, py::arg("synthetic_width") = 640, py::arg("synthetic_height") = 480,
+        R"doc(
+            Classify every image of `directory` (or `synthetic` generated images) with concurrent
+            preprocess / H2D / forward / postprocess stages connected by bounded queues.
+
+            Returns:
+                (results, report): results sorted by input index, each {"index", "name",
+                "predictions": [(label, prob), ...]}; report is the per-stage throughput table.
+
+            Example:
+                >>> config = _infinidemo.runtime.PipelineConfig()
+                >>> config.device = device._underlying
+                >>> results, report = _infinidemo.runtime.classify(model, processor, config, directory="images/")
+                >>> print(report)
+            )doc");
+}
+
+} // namespace infinidemo::models
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "../nn/allocator.hpp"
+#include "../nn/debug.hpp"
+#include "../nn/memory_tracker.hpp"
+#include "../nn/modules/module.hpp"
+#include "dlpack.hpp"
+#include <infinicore/context/context.hpp>
+#include <infinicore/tensor.hpp>
+#include <pybind11/buffer_info.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace py = pybind11;
+
+// 各模型绑定共用的 Python <-> C++ 转换，以及释放 GIL 的 forward / forward_batch 实现
+namespace infinidemo::models {
+
+// 接受底层 C++ Tensor 或带 _underlying 属性的 infinicore.Tensor。
+// 先做类型检查再转换，不依赖 try/catch，热路径上没有异常开销
+inline bool tryToTensor(py::handle obj, infinicore::Tensor &out) {
+    if (py::isinstance<infinicore::Tensor>(obj)) {
+        out = obj.cast<infinicore::Tensor>();
+        return true;
+    }
+    py::object underlying = py::getattr(obj, "_underlying", py::none());
+    if (!underlying.is_none() && py::isinstance<infinicore::Tensor>(underlying)) {
+        out = underlying.cast<infinicore::Tensor>();
+        return true;
+    }
+    return false;
+}
+
+inline infinicore::Tensor toTensor(py::handle obj) {
+    infinicore::Tensor tensor;
+    if (!tryToTensor(obj, tensor)) {
+        throw py::type_error("Expected an infinicore.Tensor, got " + std::string(py::str(py::type::of(obj))));
+    }
+    return tensor;
+}
+
+// 零拷贝导入的结果：tensor 只是视图，owner 负责让底层内存在 tensor 使用期间保持有效
+struct ImportedTensor {
+    infinicore::Tensor tensor;
+    py::object owner;
+};
+
+// struct 模块的格式字符串：可选的本机 / 小端字节序前缀加一个类型字符，其它（大端、复数 "Zf" 等）抛出 TypeError
+inline infinicore::DataType dataTypeFromFormat(const std::string &format, size_t itemsize) {
+    std::string code_str = format.empty() ? "B" : format;
+    if ((code_str.size() == 2) && ((code_str[0] == '@') || (code_str[0] == '=') || (code_str[0] == '<'))) {
+        code_str = code_str.substr(1);
+    }
+    if (code_str.size() != 1) {
+        throw py::type_error("Unsupported buffer format: '" + format + "'");
+    }
+    switch (code_str[0]) {
+    case '?':
+        return infinicore::DataType::BOOL;
+    case 'b':
+        return infinicore::DataType::I8;
+    case 'B':
+        return infinicore::DataType::U8;
+    case 'h':
+        return infinicore::DataType::I16;
+    case 'H':
+        return infinicore::DataType::U16;
+    case 'e':
+        return infinicore::DataType::F16;
+    case 'f':
+        return infinicore::DataType::F32;
+    case 'd':
+        return infinicore::DataType::F64;
+    case 'i':
+    case 'l':
+    case 'q':
+        return itemsize == 8 ? infinicore::DataType::I64 : infinicore::DataType::I32;
+    case 'I':
+    case 'L':
+    case 'Q':
+        return itemsize == 8 ? infinicore::DataType::U64 : infinicore::DataType::U32;
+    default:
+        throw py::type_error("Unsupported buffer format: '" + format + "'");
+    }
+}
+
+// DLPack 导入：接受 capsule 或实现了 __dlpack__ 的对象（torch.Tensor、numpy.ndarray 等）
+inline ImportedTensor importDLPack(py::handle obj) {
+    py::object capsule = PyCapsule_CheckExact(obj.ptr()) ? py::reinterpret_borrow<py::object>(obj) : obj.attr("__dlpack__")();
+    auto *managed = static_cast<dlpack::DLManagedTensor *>(PyCapsule_GetPointer(capsule.ptr(), "dltensor"));
+    if (managed == nullptr) {
+        throw py::error_already_set();
+    }
+    // 标记 capsule 已被消费，此后由 owner 负责调用 deleter
+    PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+    py::capsule owner(managed, [](void *ptr) {
+        auto *m = static_cast<dlpack::DLManagedTensor *>(ptr);
+        if (m->deleter != nullptr) {
+            m->deleter(m);
+        }
+    });
+    return {dlpack::fromDLPack(managed, infinicore::context::getDevice()), owner};
+}
+
+// buffer protocol 导入（仅 CPU 内存），owner 为原对象本身
+inline ImportedTensor importBuffer(py::handle obj) {
+    py::buffer_info info = py::reinterpret_borrow<py::buffer>(obj).request();
+    infinicore::Shape shape(info.shape.begin(), info.shape.end());
+    infinicore::Strides strides(info.ndim);
+    for (py::ssize_t i = 0; i < info.ndim; ++i) {
+        if (info.strides[i] % info.itemsize != 0) {
+            throw py::value_error("Buffer strides must be a multiple of the item size");
+        }
+        strides[i] = info.strides[i] / info.itemsize;
+    }
+    infinicore::DataType dtype = dataTypeFromFormat(info.format, static_cast<size_t>(info.itemsize));
+    return {infinicore::Tensor::strided_from_blob(info.ptr, shape, strides, dtype, infinicore::Device::cpu()),
+            py::reinterpret_borrow<py::object>(obj)};
+}
+
+// 模型输入：除 infinicore.Tensor 外，还可以直接传入 numpy / torch 等对象，零拷贝导入
+inline ImportedTensor toInputTensor(py::handle obj) {
+    ImportedTensor imported;
+    if (tryToTensor(obj, imported.tensor)) {
+        return imported;
+    }
+    if (PyCapsule_CheckExact(obj.ptr()) || py::hasattr(obj, "__dlpack__")) {
+        return importDLPack(obj);
+    }
+    if (PyObject_CheckBuffer(obj.ptr())) {
+        return importBuffer(obj);
+    }
+    throw py::type_error("Expected an infinicore.Tensor, a DLPack capsule or a buffer, got " + std::string(py::str(py::type::of(obj))));
+}
+
+inline std::unordered_map<std::string, infinicore::Tensor> toTensorMap(const py::dict &py_state_dict) {
+    std::unordered_map<std::string, infinicore::Tensor> state_dict;
+    state_dict.reserve(py_state_dict.size());
+    for (auto item : py_state_dict) {
+        state_dict.emplace(item.first.cast<std::string>(), toTensor(item.second));
+    }
+    return state_dict;
+}
+
+inline py::dict migrationReportToDict(const infinidemo::nn::modules::MigrationReport &report) {
+    py::dict item;
+    item["parameters"] = report.parameters;
+    item["parameter_bytes"] = report.parameter_bytes;
+    item["slab_bytes"] = report.slab_bytes;
+    item["copies"] = report.copies;
+    item["elapsed_ms"] = report.elapsed_ms;
+    return item;
+}
+
+inline py::dict memoryStatsToDict(const infinidemo::nn::memory::MemoryStats &stats) {
+    py::dict devices;
+    for (const auto &d : stats.devices) {
+        py::dict item;
+        item["current_bytes"] = d.current_bytes;
+        item["peak_bytes"] = d.peak_bytes;
+        item["allocated_bytes"] = d.allocated_bytes;
+        item["allocations"] = d.allocations;
+        item["frees"] = d.frees;
+        devices[d.device.c_str()] = item;
+    }
+    py::dict modules;
+    for (const auto &m : stats.modules) {
+        py::dict item;
+        item["current_bytes"] = m.current_bytes;
+        item["peak_bytes"] = m.peak_bytes;
+        item["allocated_bytes"] = m.allocated_bytes;
+        item["allocations"] = m.allocations;
+        modules[m.module.c_str()] = item;
+    }
+    py::dict phases;
+    for (const auto &p : stats.phases) {
+        py::dict item;
+        item["allocated_bytes"] = p.allocated_bytes;
+        item["allocations"] = p.allocations;
+        phases[p.phase.c_str()] = item;
+    }
+    py::dict result;
+    result["devices"] = devices;
+    result["modules"] = modules;
+    result["phases"] = phases;
+    result["histogram"] = stats.histogram;
+    result["report"] = stats.toString();
+    return result;
+}
+
+// memory_stats 读的是进程级的 MemoryTracker（所有模型共用），不按模型过滤；reset 时读取与清零在同一把锁内完成
+inline py::dict globalMemoryStatsToDict(bool reset) {
+    auto &tracker = infinidemo::nn::memory::MemoryTracker::instance();
+    return memoryStatsToDict(reset ? tracker.statsAndReset() : tracker.stats());
+}
+
+inline constexpr const char *kGlobalMemoryStatsDoc = R"doc(
+                Process-wide allocation statistics from _infinidemo.memory, shared by every model (enable with
+                _infinidemo.memory.enable() or INFINIDEMO_TRACK_MEMORY=1): current / peak bytes per device, per module path
+                such as "resnet.encoder.stages.2.layers.0" and per phase (forward, to, load_state_dict), plus a size histogram.
+                reset=True restarts the peaks and counters atomically with the read.
+                )doc";
+
+inline py::dict warmupReportToDict(const infinidemo::nn::modules::WarmupReport &report) {
+    py::list entries;
+    for (const auto &entry : report.entries) {
+        py::dict item;
+        item["input_shape"] = entry.input_shape;
+        item["prepare_ms"] = entry.prepare_ms;
+        item["cold_ms"] = entry.cold_ms;
+        item["warm_ms"] = entry.warm_ms;
+        entries.append(item);
+    }
+    py::dict result;
+    result["entries"] = entries;
+    result["elapsed_ms"] = report.elapsed_ms;
+    return result;
+}
+
+// 把结果包装成 infinicore.Tensor 返回，Python 端不需要再包一层
+inline py::object wrapTensor(const infinicore::Tensor &tensor) {
+    // 有意不释放：避免解释器退出时析构 py::object
+    static py::object *tensor_type = new py::object(py::module_::import("infinicore").attr("Tensor"));
+    return (*tensor_type)(py::cast(tensor));
+}
+
+// 有 forward_mutex() 的模型（nn::modules::RootModule）与执行器（runtime::InferenceRunner）在释放 GIL 的调用期间持有它；没有的（FusedMnistExecutor 只读参数、
+// CachedModel 自己锁住被包装的模型）可以直接并发调用
+template <typename Model, typename = void>
+struct HasForwardMutex : std::false_type {};
+template <typename Model>
+struct HasForwardMutex<Model, std::void_t<decltype(std::declval<const Model &>().forward_mutex())>> : std::true_type {};
+
+template <typename Model>
+inline std::unique_lock<std::mutex> lockForward(const Model &self) {
+    if constexpr (HasForwardMutex<Model>::value) {
+        return std::unique_lock<std::mutex>(self.forward_mutex());
+    } else {
+        return std::unique_lock<std::mutex>();
+    }
+}
+
+// 在释放 GIL 的情况下执行 forward，多个 Python 线程可以并行推理不同的模型；同一个模型上的调用依次执行
+template <typename Model>
+inline py::object forwardNoGil(Model &self, py::handle input) {
+    ImportedTensor imported = toInputTensor(input);
+    infinicore::Tensor result;
+    {
+        py::gil_scoped_release release;
+        std::unique_lock<std::mutex> lock = lockForward(self);
+        result = self.forward(imported.tensor);
+    }
+    return wrapTensor(result);
+}
+
+// 除第 0 维外形状、dtype、device 都相同时可以拼成一个 batch
+inline bool stackable(const std::vector<infinicore::Tensor> &inputs) {
+    const auto &first = inputs.front();
+    for (const auto &t : inputs) {
+        if ((t->ndim() != first->ndim()) || (t->dtype() != first->dtype()) || !infinidemo::nn::debug::sameDevice(t->device(), first->device())) {
+            return false;
+        }
+        for (size_t d = 1; d < t->ndim(); ++d) {
+            if (t->shape()[d] != first->shape()[d]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 一次调用处理多个输入：可拼接时沿第 0 维拼成一个 batch 只跑一次 forward 再切回，
+// 否则逐个执行；整个过程只释放 / 获取一次 GIL
+template <typename Model>
+inline py::list forwardBatchNoGil(Model &self, const py::list &py_inputs) {
+    std::vector<ImportedTensor> imported;
+    std::vector<infinicore::Tensor> inputs;
+    imported.reserve(py_inputs.size());
+    inputs.reserve(py_inputs.size());
+    for (auto item : py_inputs) {
+        imported.push_back(toInputTensor(item));
+        inputs.push_back(imported.back().tensor);
+    }
+
+    std::vector<infinicore::Tensor> outputs;
+    outputs.reserve(inputs.size());
+    if (!inputs.empty()) {
+        py::gil_scoped_release release;
+        std::unique_lock<std::mutex> lock = lockForward(self);
+        if ((inputs.size() > 1) && stackable(inputs)) {
+            infinicore::Shape shape = inputs.front()->shape();
+            size_t total = 0;
+            for (const auto &t : inputs) {
+                total += t->shape()[0];
+            }
+            shape[0] = total;
+            infinicore::Tensor batch = infinidemo::nn::empty(shape, inputs.front()->dtype(), inputs.front()->device());
+            size_t offset = 0;
+            for (const auto &t : inputs) {
+                batch->narrow({{0, offset, t->shape()[0]}})->copy_from(t);
+                offset += t->shape()[0];
+            }
+
+            infinicore::Tensor result = self.forward(batch);
+            offset = 0;
+            for (const auto &t : inputs) {
+                outputs.push_back(result->narrow({{0, offset, t->shape()[0]}}));
+                offset += t->shape()[0];
+            }
+        } else {
+            for (auto &t : inputs) {
+                outputs.push_back(self.forward(t));
+            }
+        }
+    }
+
+    py::list results;
+    for (const auto &t : outputs) {
+        results.append(wrapTensor(t));
+    }
+    return results;
+}
+
+} // namespace infinidemo::models
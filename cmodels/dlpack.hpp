@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstdint>
+#include <infinicore/device.hpp>
+#include <infinicore/dtype.hpp>
+#include <infinicore/tensor.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// DLPack 零拷贝互操作：按 DLPack v0.8 的 ABI 在仓库内定义数据结构（不引入外部依赖），
+// 放在独立命名空间中，避免与其它库自带的 dlpack.h 冲突
+namespace infinidemo::dlpack {
+using namespace infinicore;
+
+enum DLDeviceType : int32_t {
+    kDLCPU = 1,
+    kDLCUDA = 2,
+    kDLCUDAHost = 3,
+    kDLROCM = 10,
+    kDLExtDev = 12,
+};
+
+enum DLDataTypeCode : uint8_t {
+    kDLInt = 0,
+    kDLUInt = 1,
+    kDLFloat = 2,
+    kDLBfloat = 4,
+    kDLBool = 6,
+};
+
+struct DLDevice {
+    int32_t device_type;
+    int32_t device_id;
+};
+
+struct DLDataType {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor {
+    void *data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t *shape;
+    int64_t *strides; // 以元素为单位，nullptr 表示行主序连续
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void *manager_ctx;
+    void (*deleter)(DLManagedTensor *self);
+};
+
+inline DLDataType toDLDataType(DataType dtype) {
+    switch (dtype) {
+    case DataType::BOOL:
+        return {kDLBool, 8, 1};
+    case DataType::I8:
+        return {kDLInt, 8, 1};
+    case DataType::I16:
+        return {kDLInt, 16, 1};
+    case DataType::I32:
+        return {kDLInt, 32, 1};
+    case DataType::I64:
+        return {kDLInt, 64, 1};
+    case DataType::U8:
+        return {kDLUInt, 8, 1};
+    case DataType::U16:
+        return {kDLUInt, 16, 1};
+    case DataType::U32:
+        return {kDLUInt, 32, 1};
+    case DataType::U64:
+        return {kDLUInt, 64, 1};
+    case DataType::F16:
+        return {kDLFloat, 16, 1};
+    case DataType::F32:
+        return {kDLFloat, 32, 1};
+    case DataType::F64:
+        return {kDLFloat, 64, 1};
+    case DataType::BF16:
+        return {kDLBfloat, 16, 1};
+    default:
+        throw std::runtime_error("DLPack: unsupported dtype " + toString(dtype));
+    }
+}
+
+inline DataType fromDLDataType(const DLDataType &dtype) {
+    if (dtype.lanes != 1) {
+        throw std::runtime_error("DLPack: vector dtypes are not supported");
+    }
+    switch (dtype.code) {
+    case kDLBool:
+        return DataType::BOOL;
+    case kDLInt:
+        switch (dtype.bits) {
+        case 8:
+            return DataType::I8;
+        case 16:
+            return DataType::I16;
+        case 32:
+            return DataType::I32;
+        case 64:
+            return DataType::I64;
+        }
+        break;
+    case kDLUInt:
+        switch (dtype.bits) {
+        case 8:
+            return DataType::U8;
+        case 16:
+            return DataType::U16;
+        case 32:
+            return DataType::U32;
+        case 64:
+            return DataType::U64;
+        }
+        break;
+    case kDLFloat:
+        switch (dtype.bits) {
+        case 16:
+            return DataType::F16;
+        case 32:
+            return DataType::F32;
+        case 64:
+            return DataType::F64;
+        }
+        break;
+    case kDLBfloat:
+        if (dtype.bits == 16) {
+            return DataType::BF16;
+        }
+        break;
+    }
+    throw std::runtime_error("DLPack: unsupported dtype code " + std::to_string(dtype.code) + " bits " + std::to_string(dtype.bits));
+}
+
+// NVIDIA / ILUVATAR / METAX 使用 CUDA 兼容的运行时，对外表现为 kDLCUDA；HYGON 为 ROCm 兼容
+inline DLDevice toDLDevice(const Device &device) {
+    int32_t id = static_cast<int32_t>(device.getIndex());
+    switch (device.getType()) {
+    case Device::Type::CPU:
+        return {kDLCPU, 0};
+    case Device::Type::NVIDIA:
+    case Device::Type::ILUVATAR:
+    case Device::Type::METAX:
+        return {kDLCUDA, id};
+    case Device::Type::HYGON:
+        return {kDLROCM, id};
+    default:
+        return {kDLExtDev, id};
+    }
+}
+
+// kDLCUDA 无法区分具体厂商，优先使用当前 context 所在的设备类型
+inline Device fromDLDevice(const DLDevice &device, const Device &current) {
+    Device::Index id = static_cast<Device::Index>(device.device_id);
+    switch (device.device_type) {
+    case kDLCPU:
+    case kDLCUDAHost:
+        return Device::cpu();
+    case kDLCUDA:
+        if ((current.getType() == Device::Type::NVIDIA) || (current.getType() == Device::Type::ILUVATAR)
+            || (current.getType() == Device::Type::METAX)) {
+            return Device(current.getType(), id);
+        }
+        return Device(Device::Type::NVIDIA, id);
+    case kDLROCM:
+        return Device(Device::Type::HYGON, id);
+    case kDLExtDev:
+        return Device(current.getType(), id);
+    default:
+        throw std::runtime_error("DLPack: unsupported device type " + std::to_string(device.device_type));
+    }
+}
+
+// 不拥有内存的 Tensor 视图，调用方需要保证 managed 在 Tensor 使用期间有效
+inline Tensor fromDLPack(const DLManagedTensor *managed, const Device &current) {
+    const DLTensor &t = managed->dl_tensor;
+    DataType dtype = fromDLDataType(t.dtype);
+    Shape shape(t.shape, t.shape + t.ndim);
+    Strides strides(t.ndim);
+    if (t.strides != nullptr) {
+        for (int32_t i = 0; i < t.ndim; ++i) {
+            strides[i] = static_cast<Stride>(t.strides[i]);
+        }
+    } else {
+        Stride stride = 1;
+        for (int32_t i = t.ndim - 1; i >= 0; --i) {
+            strides[i] = stride;
+            stride *= static_cast<Stride>(shape[i]);
+        }
+    }
+    void *data = static_cast<std::byte *>(t.data) + t.byte_offset;
+    return Tensor::strided_from_blob(data, shape, strides, dtype, fromDLDevice(t.device, current));
+}
+
+namespace detail {
+struct ExportContext {
+    Tensor tensor; // 持有引用，保证导出期间底层内存有效
+    std::vector<int64_t> shape;
+    std::vector<int64_t> strides;
+    DLManagedTensor managed;
+};
+} // namespace detail
+
+// 导出为 DLManagedTensor，消费者使用完后调用 deleter 释放
+inline DLManagedTensor *toDLPack(const Tensor &tensor) {
+    auto *ctx = new detail::ExportContext();
+    ctx->tensor = tensor;
+    const auto &shape = tensor->shape();
+    const auto &strides = tensor->strides();
+    ctx->shape.assign(shape.begin(), shape.end());
+    ctx->strides.assign(strides.begin(), strides.end());
+
+    DLTensor &t = ctx->managed.dl_tensor;
+    t.data = ctx->tensor->data();
+    t.device = toDLDevice(tensor->device());
+    t.ndim = static_cast<int32_t>(shape.size());
+    t.dtype = toDLDataType(tensor->dtype());
+    t.shape = ctx->shape.data();
+    t.strides = ctx->strides.data();
+    t.byte_offset = 0;
+    ctx->managed.manager_ctx = ctx;
+    ctx->managed.deleter = [](DLManagedTensor *self) { delete static_cast<detail::ExportContext *>(self->manager_ctx); };
+    return &ctx->managed;
+}
+
+} // namespace infinidemo::dlpack
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "../bindings_utils.hpp"
+#include "configuration_mnist.hpp"
 #include "modeling_mnist.hpp"
 #include <pybind11/functional.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 
@@ -17,117 +20,59 @@ inline void bind_mnist(py::module_ &m) {
     // 中直接声明继承关系 但 C++ 中的继承关系仍然存在，功能不受影响
     py::class_<MnistForImageClassification>(m, "MnistForImageClassification")
         // 构造函数重载1: 只有必需参数（使用默认的bias, dtype, device）
-        .def(py::init([]() { return new MnistForImageClassification(); }),
+        .def(py::init([](bool parameter_arena) { return new MnistForImageClassification(parameter_arena); }),
+             py::arg("parameter_arena") = true,
              R"doc(
                 MNIST model for image classification.
 
                 Args:
-                    in_features: Number of input features
-                    out_features: Number of output features (number of classes)
+                    parameter_arena: Place all weights in one contiguous aligned buffer (default True)
 
                 Example:
                     >>> import _infinidemo
                     >>> model = _infinidemo.MnistForImageClassification(512, 1000)
                 )doc")
+        .def(py::init([](const MnistConfig &config, bool parameter_arena) { return new MnistForImageClassification(config, parameter_arena); }),
+             py::arg("config"), py::arg("parameter_arena") = true,
+             R"doc(
+                MNIST-style model built from a MnistConfig (input channels / size, conv channels / kernel size, labels).
+                )doc")
+        .def_property_readonly("config", &MnistForImageClassification::config)
         .def(
             "forward",
-            [](MnistForImageClassification &self,
-               py::object input_obj) -> py::object {
-                // 尝试将 Python Tensor 对象转换为 C++ Tensor
-                // 支持两种方式：直接转换或通过 _underlying 属性
-                infinicore::Tensor input;
-                bool converted = false;
-
-                // 方法1: 尝试通过 _underlying 属性访问（如果存在）
-                if (py::hasattr(input_obj, "_underlying")) {
-                    try {
-                        py::object underlying = input_obj.attr("_underlying");
-                        input = py::cast<infinicore::Tensor>(underlying);
-                        converted = true;
-                    } catch (...) {
-                        // 如果 _underlying 转换失败，继续尝试其他方法
-                    }
-                }
-
-                // 方法2: 直接转换 Python Tensor 对象
-                if (!converted) {
-                    try {
-                        input = py::cast<infinicore::Tensor>(input_obj);
-                        converted = true;
-                    } catch (const py::cast_error &) {
-                        // 转换失败
-                    }
-                }
-
-                if (!converted) {
-                    std::string error_msg = "Cannot convert Python Tensor to C++ Tensor. ";
-                    error_msg += "Please ensure the input is an infinicore.Tensor object.";
-                    throw std::runtime_error(error_msg);
-                }
-
-                // forward 方法需要非const引用
-                infinicore::Tensor &input_ref = input;
-                infinicore::Tensor result = self.forward(input_ref);
-
-                // 返回结果
-                return py::cast(result);
+            [](MnistForImageClassification &self, py::handle input) -> py::object {
+                return forwardNoGil(self, input);
             },
             py::arg("input"),
             R"doc(
-                Forward pass through the MNIST model.
+                Forward pass through the MNIST model. The GIL is released while the model runs.
 
                 Args:
                     input: Input tensor of shape (batch_size, in_features) from infinicore
 
                 Returns:
-                    Output tensor of shape (batch_size, out_features)
+                    Output infinicore.Tensor of shape (batch_size, out_features)
+                )doc")
+        .def(
+            "forward_batch",
+            [](MnistForImageClassification &self, const py::list &inputs) -> py::list {
+                return forwardBatchNoGil(self, inputs);
+            },
+            py::arg("inputs"),
+            R"doc(
+                Forward pass over a list of input tensors with a single GIL release.
+                Inputs with matching trailing shapes are concatenated into one batch.
+
+                Args:
+                    inputs: List of infinicore tensors
+
+                Returns:
+                    List of output infinicore.Tensor, one per input
                 )doc")
         .def(
             "load_state_dict",
             [](MnistForImageClassification &self, py::dict _state_dict) -> void {
-                // Load state dictionary into the model
-                // Convert Python dict to C++ unordered_map and load parameters
-                std::unordered_map<std::string, infinicore::Tensor> state_dict;
-
-                // Convert Python dict to C++ unordered_map
-                for (auto item : _state_dict) {
-                    std::string key = py::cast<std::string>(item.first);
-                    py::object value_obj = py::reinterpret_borrow<py::object>(item.second);
-
-                    // Convert Python Tensor to C++ Tensor
-                    infinicore::Tensor tensor_value;
-                    bool converted = false;
-
-                    // Method 1: Try through _underlying attribute
-                    if (py::hasattr(value_obj, "_underlying")) {
-                        try {
-                            py::object underlying = value_obj.attr("_underlying");
-                            tensor_value = py::cast<infinicore::Tensor>(underlying);
-                            converted = true;
-                        } catch (...) {
-                            // Continue to next method
-                        }
-                    }
-
-                    // Method 2: Direct cast
-                    if (!converted) {
-                        try {
-                            tensor_value = py::cast<infinicore::Tensor>(value_obj);
-                            converted = true;
-                        } catch (const py::cast_error &) {
-                            // Conversion failed
-                        }
-                    }
-
-                    if (!converted) {
-                        throw std::runtime_error("Cannot convert value for key '" + key + "' to Tensor");
-                    }
-
-                    state_dict[key] = tensor_value;
-                }
-
-                // Now use the converted state_dict
-                self.load_state_dict(state_dict);
+                self.load_state_dict(toTensorMap(_state_dict));
             },
             py::arg("_state_dict"),
             R"doc(
@@ -169,8 +114,106 @@ inline void bind_mnist(py::module_ &m) {
                     >>> state_dict = model.state_dict()
                     >>> print(state_dict)
                 )doc")
+        .def(
+            "to",
+            [](MnistForImageClassification &self, infinicore::Device device, bool slab) {
+                py::gil_scoped_release release;
+                std::unique_lock<std::mutex> lock = lockForward(self);
+                if (slab) {
+                    self.to_slab(device);
+                } else {
+                    self.to(device);
+                }
+            },
+            py::arg("device"), py::arg("slab") = false,
+            R"doc(
+                Move the parameters to `device` module by module. With slab=True all parameters are packed into one
+                contiguous slab on `device` instead; that upload is asynchronous and the first forward / state_dict waits for it.
+                Tensors taken from state_dict() earlier stay valid either way.
+                )doc")
+        .def(
+            "last_migration",
+            [](const MnistForImageClassification &self) { return migrationReportToDict(self.last_migration()); },
+            R"doc(
+                Statistics of the last to(): parameters, parameter_bytes, slab_bytes (0 without slab=True), copies, elapsed_ms.
+                )doc")
+        .def(
+            "prepare",
+            [](MnistForImageClassification &self, const std::vector<size_t> &input_shape) {
+                return self.prepare(input_shape);
+            },
+            py::arg("input_shape"),
+            R"doc(
+                Cache every layer's output shape for `input_shape`; returns the logits shape.
+                )doc")
+        .def(
+            "warmup",
+            [](MnistForImageClassification &self, const std::vector<std::vector<size_t>> &shapes, const std::vector<size_t> &batch_sizes) {
+                std::vector<infinicore::Shape> sample_shapes(shapes.begin(), shapes.end());
+                infinidemo::nn::modules::WarmupReport report;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    report = self.warmup(sample_shapes, batch_sizes);
+                }
+                return warmupReportToDict(report);
+            },
+            py::arg("shapes"), py::arg("batch_sizes") = std::vector<size_t>{1},
+            R"doc(
+                Shape propagation plus two zero-filled forwards for every batch size x sample shape (e.g. [1, 28, 28]).
+                Afterwards `ready` is True. Returns {"entries": [{input_shape, prepare_ms, cold_ms, warm_ms}], "elapsed_ms"}.
+                )doc")
+        .def_property_readonly("ready", [](const MnistForImageClassification &self) { return self.serving_ready(); })
+        .def_property(
+            "require_ready", [](const MnistForImageClassification &self) { return self.requires_ready(); },
+            [](MnistForImageClassification &self, bool enabled) { self.require_ready(enabled); },
+            "When True, forward raises until warmup() has made the model ready (again after every to())")
+        .def_property_readonly("weights_loaded", &MnistForImageClassification::weights_loaded,
+                               "True once load_state_dict has set every parameter; forward raises before that")
+        .def("last_warmup", [](const MnistForImageClassification &self) { return warmupReportToDict(self.last_warmup()); })
+        .def(
+            "memory_stats",
+            [](const MnistForImageClassification &, bool reset) { return globalMemoryStatsToDict(reset); },
+            py::arg("reset") = false, kGlobalMemoryStatsDoc)
         .def("__repr__", [](const MnistForImageClassification &self) {
             return "<MnistForImageClassification>";
         });
+
+    py::class_<FusedMnistExecutor>(m, "FusedMnistExecutor")
+        .def(py::init([](const MnistForImageClassification &model, size_t tile, size_t threads) {
+                 return new FusedMnistExecutor(model, FusedExecutorConfig{tile, threads});
+             }),
+             py::arg("model"), py::arg("tile") = 16, py::arg("threads") = 0,
+             R"doc(
+                Whole-network host kernel: conv + ReLU + flatten + Linear + ReLU per batch tile of `tile` samples,
+                intermediates kept in registers / a per-thread tile buffer. Tiles are split across `threads`
+                (0: hardware concurrency). Weights are copied at construction; rebuild after load_state_dict / to.
+                )doc")
+        .def(
+            "forward",
+            [](FusedMnistExecutor &self, py::handle input) -> py::object { return forwardNoGil(self, input); },
+            py::arg("input"))
+        .def(
+            "__call__",
+            [](FusedMnistExecutor &self, py::handle input) -> py::object { return forwardNoGil(self, input); },
+            py::arg("input"))
+        .def_property_readonly("tile", [](const FusedMnistExecutor &self) { return self.config().tile; })
+        .def_property_readonly("threads", [](const FusedMnistExecutor &self) { return self.config().threads; });
+}
+
+inline void bind_mnist_config(py::module_ &m) {
+    py::class_<MnistConfig>(m, "MnistConfig")
+        .def(py::init<>())
+        .def_readwrite("num_channels", &MnistConfig::num_channels)
+        .def_readwrite("image_size", &MnistConfig::image_size)
+        .def_readwrite("conv_channels", &MnistConfig::conv_channels)
+        .def_readwrite("kernel_size", &MnistConfig::kernel_size)
+        .def_readwrite("num_labels", &MnistConfig::num_labels)
+        .def_property_readonly("in_features", &MnistConfig::inFeatures)
+        .def("__repr__", [](const MnistConfig &self) {
+            std::stringstream ss;
+            ss << self;
+            return ss.str();
+        });
 }
 } // namespace infinidemo::models
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace infinidemo::models {
+// conv(kernel_size, stride 1, 无 padding) -> ReLU -> flatten -> Linear -> ReLU。
+// 默认值即原来写死的结构：1x28x28 输入，4 个 7x7 卷积核，4x22x22 = 1936 -> 10
+struct MnistConfig {
+    int num_channels = 1;
+    int image_size = 28;
+    int conv_channels = 4;
+    int kernel_size = 7;
+    int num_labels = 10;
+
+    size_t convOutputSize() const { return static_cast<size_t>(image_size - kernel_size + 1); }
+
+    // fc1 的输入维度
+    size_t inFeatures() const { return static_cast<size_t>(conv_channels) * convOutputSize() * convOutputSize(); }
+
+    void validate() const {
+        if ((num_channels <= 0) || (conv_channels <= 0) || (num_labels <= 0) || (kernel_size <= 0) || (kernel_size > image_size)) {
+            throw std::runtime_error("Invalid MnistConfig: channels, labels and kernel_size must be positive and kernel_size <= image_size");
+        }
+    }
+};
+
+inline std::ostream &operator<<(std::ostream &os, const MnistConfig &config) {
+    os << "{ \"num_channels\": " << config.num_channels << ", \"image_size\": " << config.image_size
+       << ", \"conv_channels\": " << config.conv_channels << ", \"kernel_size\": " << config.kernel_size
+       << ", \"num_labels\": " << config.num_labels << " }";
+    return os;
+}
+
+} // namespace infinidemo::models
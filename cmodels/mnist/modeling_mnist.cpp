@@ -1,37 +1,427 @@
 #include "modeling_mnist.hpp"
+#include "../../nn/allocator.hpp"
+#include "../../nn/debug.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
 #include <infinicore/context/context.hpp>
+#include <mutex>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define INFINIDEMO_MNIST_HAS_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
 namespace infinidemo::models {
-MnistForImageClassification::MnistForImageClassification() {
-    size_t in_features = 4;
-    size_t out_features = 1;
+MnistForImageClassification::MnistForImageClassification(bool parameter_arena) : MnistForImageClassification(MnistConfig(), parameter_arena) {}
 
-    in_features = 1936;
-    out_features = 10;
-    size_t in_channels = 1;
-    size_t out_channels = 4;
-    size_t kernel_size = 7;
+MnistForImageClassification::MnistForImageClassification(const MnistConfig &config, bool parameter_arena) : config_(config) {
+    config_.validate();
+    size_t in_features = config_.inFeatures();
+    size_t out_features = static_cast<size_t>(config_.num_labels);
 
+    infinidemo::nn::modules::ParameterArenaScope arena_scope(parameter_arena);
     INFINICORE_NN_MODULE_INIT(fc1, in_features, out_features, true);
-    INFINICORE_NN_MODULE_INIT(conv1, in_channels, out_channels, kernel_size, true);
+    INFINICORE_NN_MODULE_INIT(conv1, config_.num_channels, config_.conv_channels, static_cast<size_t>(config_.kernel_size), true);
+
+    assign_module_paths();
+    if (parameter_arena) {
+        allocate_parameter_arena(Device::cpu());
+    }
 }
 
 Tensor MnistForImageClassification::forward(Tensor &input) const {
-
+    INFINIDEMO_PROFILE_MODULE("MnistForImageClassification", input);
+    ensure_parameters_ready_();
     auto output = relu_.forward(conv1_->forward(input));
+    output = flatten_.forward(output);
+
+    auto output2 = relu_.forward(fc1_->forward(output));
+    return output2;
+}
 
-    size_t temp = 1;
-    for (size_t i = 1; i < output->shape().size(); i++) {
-        temp *= output->shape()[i];
+Shape MnistForImageClassification::prepare(const Shape &input_shape) {
+    return fc1_->outputShape(flatten_.outputShape(conv1_->outputShape(input_shape)));
+}
+
+const infinidemo::nn::modules::WarmupReport &MnistForImageClassification::warmup(const std::vector<Shape> &sample_shapes, const std::vector<size_t> &batch_sizes) {
+    return warmup_shapes_(
+        sample_shapes, batch_sizes,
+        [this](const Shape &input_shape) { prepare(input_shape); },
+        [this](Tensor &input) { return forward(input); });
+}
+
+namespace {
+
+// 网络的维度，tile kernel 的参数
+struct FusedDims {
+    size_t channels;     // 输入通道
+    size_t size;         // 输入边长
+    size_t kernel;       // 卷积核边长
+    size_t out_size;     // 卷积输出边长
+    size_t conv_channels;
+    size_t in_features;  // conv_channels * out_size * out_size
+    size_t out_features;
+};
+
+struct FusedWeights {
+    const float *conv_weight;
+    const float *conv_bias;
+    const float *fc_weight;
+    const float *fc_bias;
+};
+
+// 一个样本的 conv + ReLU：每个输出像素在寄存器 / 局部变量中累加完所有 (ic, ky, kx) 后只写一次
+void convReluScalar(const float *input, const FusedDims &d, const FusedWeights &w, float *act) {
+    for (size_t oc = 0; oc < d.conv_channels; ++oc) {
+        const float *kernel = w.conv_weight + oc * d.channels * d.kernel * d.kernel;
+        for (size_t oy = 0; oy < d.out_size; ++oy) {
+            float *row = act + (oc * d.out_size + oy) * d.out_size;
+            for (size_t ox = 0; ox < d.out_size; ++ox) {
+                float acc = w.conv_bias[oc];
+                for (size_t ic = 0; ic < d.channels; ++ic) {
+                    for (size_t ky = 0; ky < d.kernel; ++ky) {
+                        const float *in = input + (ic * d.size + oy + ky) * d.size + ox;
+                        const float *k = kernel + (ic * d.kernel + ky) * d.kernel;
+                        for (size_t kx = 0; kx < d.kernel; ++kx) {
+                            acc += k[kx] * in[kx];
+                        }
+                    }
+                }
+                row[ox] = std::max(acc, 0.0f);
+            }
+        }
     }
+}
 
-    std::vector<Size> new_shape = {output->shape()[0], temp};
-    output = output->view(new_shape);
+// tile 中 count 个样本的 Linear + ReLU
+void linearReluScalar(const float *act, size_t count, const FusedDims &d, const FusedWeights &w, float *output) {
+    for (size_t j = 0; j < d.out_features; ++j) {
+        const float *weight = w.fc_weight + j * d.in_features;
+        for (size_t t = 0; t < count; ++t) {
+            const float *x = act + t * d.in_features;
+            float acc = 0.0f;
+            for (size_t f = 0; f < d.in_features; ++f) {
+                acc += weight[f] * x[f];
+            }
+            output[t * d.out_features + j] = std::max(acc + w.fc_bias[j], 0.0f);
+        }
+    }
+}
 
-    auto output2 = relu_.forward(fc1_->forward(output));
-    return output2;
+#ifdef INFINIDEMO_MNIST_HAS_AVX2_KERNEL
+__attribute__((target("avx2,fma"))) inline float horizontalSum(__m256 v) {
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+    return _mm_cvtss_f32(sum);
+}
+
+// 每次 8 个相邻的输出像素 x 4 个输出通道：4 个累加器在寄存器中互相独立，每次读入的 8 个输入像素被 4 个通道共用。
+// 行尾不足 8 个的像素用 mask 读写，不退回标量（22 像素宽的行中有 6 个在行尾）
+__attribute__((target("avx2,fma"))) void convReluAvx2(const float *input, const FusedDims &d, const FusedWeights &w, float *act) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const size_t kernel_size = d.channels * d.kernel * d.kernel;
+    for (size_t oc = 0; oc < d.conv_channels; oc += 4) {
+        // 通道数不是 4 的倍数时，多出的累加器重复计算最后一个通道，结果不写回
+        size_t c1 = std::min(oc + 1, d.conv_channels - 1);
+        size_t c2 = std::min(oc + 2, d.conv_channels - 1);
+        size_t c3 = std::min(oc + 3, d.conv_channels - 1);
+        const float *k0 = w.conv_weight + oc * kernel_size;
+        const float *k1 = w.conv_weight + c1 * kernel_size;
+        const float *k2 = w.conv_weight + c2 * kernel_size;
+        const float *k3 = w.conv_weight + c3 * kernel_size;
+        size_t block = std::min<size_t>(4, d.conv_channels - oc);
+        for (size_t oy = 0; oy < d.out_size; ++oy) {
+            for (size_t ox = 0; ox < d.out_size; ox += 8) {
+                int remaining = static_cast<int>(std::min<size_t>(8, d.out_size - ox));
+                __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(remaining), lanes);
+                __m256 acc0 = _mm256_set1_ps(w.conv_bias[oc]);
+                __m256 acc1 = _mm256_set1_ps(w.conv_bias[c1]);
+                __m256 acc2 = _mm256_set1_ps(w.conv_bias[c2]);
+                __m256 acc3 = _mm256_set1_ps(w.conv_bias[c3]);
+                for (size_t ic = 0; ic < d.channels; ++ic) {
+                    for (size_t ky = 0; ky < d.kernel; ++ky) {
+                        const float *in = input + (ic * d.size + oy + ky) * d.size + ox;
+                        size_t k = (ic * d.kernel + ky) * d.kernel;
+                        for (size_t kx = 0; kx < d.kernel; ++kx, ++k) {
+                            __m256 x = _mm256_maskload_ps(in + kx, mask);
+                            acc0 = _mm256_fmadd_ps(_mm256_broadcast_ss(k0 + k), x, acc0);
+                            acc1 = _mm256_fmadd_ps(_mm256_broadcast_ss(k1 + k), x, acc1);
+                            acc2 = _mm256_fmadd_ps(_mm256_broadcast_ss(k2 + k), x, acc2);
+                            acc3 = _mm256_fmadd_ps(_mm256_broadcast_ss(k3 + k), x, acc3);
+                        }
+                    }
+                }
+                float *out = act + (oc * d.out_size + oy) * d.out_size + ox;
+                size_t plane = d.out_size * d.out_size;
+                __m256 results[4] = {acc0, acc1, acc2, acc3};
+                for (size_t b = 0; b < block; ++b) {
+                    _mm256_maskstore_ps(out + b * plane, mask, _mm256_max_ps(results[b], zero));
+                }
+            }
+        }
+    }
+}
+
+// 4 个样本共享每次加载的 8 个权重
+__attribute__((target("avx2,fma"))) void linearReluAvx2(const float *act, size_t count, const FusedDims &d, const FusedWeights &w, float *output) {
+    size_t vec_end = d.in_features / 8 * 8;
+    for (size_t j = 0; j < d.out_features; ++j) {
+        const float *weight = w.fc_weight + j * d.in_features;
+        size_t t = 0;
+        for (; t + 4 <= count; t += 4) {
+            const float *x0 = act + t * d.in_features;
+            const float *x1 = x0 + d.in_features;
+            const float *x2 = x1 + d.in_features;
+            const float *x3 = x2 + d.in_features;
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            __m256 acc2 = _mm256_setzero_ps();
+            __m256 acc3 = _mm256_setzero_ps();
+            for (size_t f = 0; f < vec_end; f += 8) {
+                __m256 wv = _mm256_loadu_ps(weight + f);
+                acc0 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x0 + f), acc0);
+                acc1 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x1 + f), acc1);
+                acc2 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x2 + f), acc2);
+                acc3 = _mm256_fmadd_ps(wv, _mm256_loadu_ps(x3 + f), acc3);
+            }
+            float sums[4] = {horizontalSum(acc0), horizontalSum(acc1), horizontalSum(acc2), horizontalSum(acc3)};
+            for (size_t f = vec_end; f < d.in_features; ++f) {
+                sums[0] += weight[f] * x0[f];
+                sums[1] += weight[f] * x1[f];
+                sums[2] += weight[f] * x2[f];
+                sums[3] += weight[f] * x3[f];
+            }
+            for (size_t i = 0; i < 4; ++i) {
+                output[(t + i) * d.out_features + j] = std::max(sums[i] + w.fc_bias[j], 0.0f);
+            }
+        }
+        for (; t < count; ++t) {
+            const float *x = act + t * d.in_features;
+            __m256 acc = _mm256_setzero_ps();
+            for (size_t f = 0; f < vec_end; f += 8) {
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(weight + f), _mm256_loadu_ps(x + f), acc);
+            }
+            float sum = horizontalSum(acc);
+            for (size_t f = vec_end; f < d.in_features; ++f) {
+                sum += weight[f] * x[f];
+            }
+            output[t * d.out_features + j] = std::max(sum + w.fc_bias[j], 0.0f);
+        }
+    }
+}
+
+bool cpuHasAvx2Fma() {
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+}
+#endif
+
+// 模型参数拷贝为 host 上的连续 F32 数组
+std::vector<float> hostCopy(const std::unordered_map<std::string, infinicore::nn::Parameter> &state_dict, const std::string &name, size_t expected) {
+    auto it = state_dict.find(name);
+    if (it == state_dict.end()) {
+        throw std::runtime_error("FusedMnistExecutor: missing parameter " + name);
+    }
+    Tensor host = infinidemo::nn::debug::toDevice(it->second, Device::cpu());
+    if (!host->is_contiguous()) {
+        host = host->contiguous();
+    }
+    if ((host->dtype() != DataType::F32) || (host->numel() != expected)) {
+        throw std::runtime_error("FusedMnistExecutor: parameter " + name + " must be F32 with " + std::to_string(expected) + " elements");
+    }
+    const float *data = reinterpret_cast<const float *>(host->data());
+    return std::vector<float>(data, data + expected);
+}
+
+} // namespace
+
+// 常驻的 tile 线程：run(workers, job) 让编号 0..workers-1 的常驻线程执行 job(i)，调用线程执行 job(workers)，
+// 全部完成后返回。每个参与者 i 有自己的激活 buffer，跨 forward 复用
+class FusedMnistExecutor::WorkerPool {
+public:
+    explicit WorkerPool(size_t workers) : activations_(workers + 1) {
+        threads_.reserve(workers);
+        for (size_t i = 0; i < workers; ++i) {
+            threads_.emplace_back([this, i]() { loop(i); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &thread : threads_) {
+            thread.join();
+        }
+    }
+
+    size_t workers() const { return threads_.size(); }
+    std::vector<float> &activations(size_t index) { return activations_[index]; }
+
+    void run(size_t workers, const std::function<void(size_t)> &job) {
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            active_ = workers;
+            pending_ = workers;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        std::exception_ptr error;
+        try {
+            job(workers);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return pending_ == 0; });
+        job_ = nullptr;
+        if (!error) {
+            error = worker_error_;
+        }
+        worker_error_ = nullptr;
+        lock.unlock();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+private:
+    void loop(size_t index) {
+        uint64_t seen = 0;
+        while (true) {
+            const std::function<void(size_t)> *job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [this, seen]() { return stop_ || (generation_ != seen); });
+                if (stop_) {
+                    return;
+                }
+                seen = generation_;
+                if (index >= active_) {
+                    continue;
+                }
+                job = job_;
+            }
+            try {
+                (*job)(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!worker_error_) {
+                    worker_error_ = std::current_exception();
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) {
+                done_.notify_one();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::vector<std::vector<float>> activations_;
+    std::mutex run_mutex_; // 一次只运行一个 forward
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(size_t)> *job_ = nullptr;
+    size_t active_ = 0;
+    size_t pending_ = 0;
+    uint64_t generation_ = 0;
+    bool stop_ = false;
+    std::exception_ptr worker_error_;
+};
+
+FusedMnistExecutor::FusedMnistExecutor(const MnistForImageClassification &model, const FusedExecutorConfig &config)
+    : model_config_(model.config()), config_(config) {
+    if (config_.tile == 0) {
+        throw std::runtime_error("FusedMnistExecutor: tile must be positive");
+    }
+    const MnistConfig &c = model_config_;
+    size_t kernel = static_cast<size_t>(c.kernel_size);
+    auto state_dict = model.state_dict();
+    conv_weight_ = hostCopy(state_dict, "conv1.weight", static_cast<size_t>(c.conv_channels * c.num_channels) * kernel * kernel);
+    conv_bias_ = hostCopy(state_dict, "conv1.bias", static_cast<size_t>(c.conv_channels));
+    fc_weight_ = hostCopy(state_dict, "fc1.weight", static_cast<size_t>(c.num_labels) * c.inFeatures());
+    fc_bias_ = hostCopy(state_dict, "fc1.bias", static_cast<size_t>(c.num_labels));
+    size_t threads = config_.threads > 0 ? config_.threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+    pool_ = std::make_unique<WorkerPool>(threads - 1);
+}
+
+FusedMnistExecutor::~FusedMnistExecutor() = default;
+
+void FusedMnistExecutor::runTiles(const float *input, float *output, size_t begin, size_t end, std::vector<float> &activations) const {
+    const MnistConfig &c = model_config_;
+    FusedDims d{static_cast<size_t>(c.num_channels), static_cast<size_t>(c.image_size), static_cast<size_t>(c.kernel_size),
+                c.convOutputSize(), static_cast<size_t>(c.conv_channels), c.inFeatures(), static_cast<size_t>(c.num_labels)};
+    FusedWeights w{conv_weight_.data(), conv_bias_.data(), fc_weight_.data(), fc_bias_.data()};
+    size_t sample_size = d.channels * d.size * d.size;
+    activations.resize(config_.tile * d.in_features);
+
+    auto conv = convReluScalar;
+    auto linear = linearReluScalar;
+#ifdef INFINIDEMO_MNIST_HAS_AVX2_KERNEL
+    if (cpuHasAvx2Fma()) {
+        conv = convReluAvx2;
+        linear = linearReluAvx2;
+    }
+#endif
+    for (size_t tile_begin = begin; tile_begin < end; tile_begin += config_.tile) {
+        size_t count = std::min(config_.tile, end - tile_begin);
+        for (size_t t = 0; t < count; ++t) {
+            conv(input + (tile_begin + t) * sample_size, d, w, activations.data() + t * d.in_features);
+        }
+        linear(activations.data(), count, d, w, output + tile_begin * d.out_features);
+    }
+}
+
+Tensor FusedMnistExecutor::forward(const Tensor &input) const {
+    const MnistConfig &c = model_config_;
+    const Shape &shape = input->shape();
+    Shape expected{0, static_cast<size_t>(c.num_channels), static_cast<size_t>(c.image_size), static_cast<size_t>(c.image_size)};
+    if ((shape.size() != 4) || !std::equal(shape.begin() + 1, shape.end(), expected.begin() + 1) || (input->dtype() != DataType::F32)) {
+        throw std::runtime_error("FusedMnistExecutor expects an F32 [N, " + std::to_string(c.num_channels) + ", " + std::to_string(c.image_size) + ", " + std::to_string(c.image_size) + "] input");
+    }
+    size_t batch = shape[0];
+    bool on_host = input->device().getType() == Device::Type::CPU;
+    Tensor host_input = on_host ? input : infinidemo::nn::debug::toDevice(input, Device::cpu());
+    if (!host_input->is_contiguous()) {
+        host_input = host_input->contiguous();
+    }
+    Tensor host_output = infinidemo::nn::empty({batch, static_cast<size_t>(c.num_labels)}, DataType::F32, Device::cpu());
+    const float *in = reinterpret_cast<const float *>(host_input->data());
+    float *out = reinterpret_cast<float *>(host_output->data());
+
+    // 按 tile 均分给常驻线程与调用线程，最后一段在调用线程上执行；tile 数少于线程数时只唤醒需要的线程
+    size_t tiles = (batch + config_.tile - 1) / config_.tile;
+    size_t threads = std::max<size_t>(1, std::min(pool_->workers() + 1, tiles));
+    size_t tiles_per_thread = (tiles + threads - 1) / threads;
+    pool_->run(threads - 1, [&](size_t i) {
+        size_t begin = std::min(batch, i * tiles_per_thread * config_.tile);
+        size_t end = std::min(batch, (i + 1) * tiles_per_thread * config_.tile);
+        runTiles(in, out, begin, end, pool_->activations(i));
+    });
+
+    if (on_host) {
+        return host_output;
+    }
+    Tensor output = infinidemo::nn::empty(host_output->shape(), DataType::F32, input->device());
+    output->copy_from(host_output);
+    return output;
 }
 
 } // namespace infinidemo::models
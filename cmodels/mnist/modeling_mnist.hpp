@@ -3,21 +3,34 @@
 #include <infinicore/device.hpp>
 #include <infinicore/nn/module.hpp>
 #include <infinicore/tensor.hpp>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "../../nn/modules/conv.hpp"
+#include "../../nn/modules/flatten.hpp"
 #include "../../nn/modules/linear.hpp"
-#include "../../nn/modules/module.hpp"
 #include "../../nn/modules/relu.hpp"
+#include "../../nn/modules/root_module.hpp"
+#include "configuration_mnist.hpp"
 
 using namespace infinicore;
 
 namespace infinidemo::models {
-class MnistForImageClassification : public infinidemo::nn::modules::Module {
+class MnistForImageClassification : public infinidemo::nn::modules::RootModule {
 public:
-    MnistForImageClassification();
+    MnistForImageClassification(bool parameter_arena = true);
+    MnistForImageClassification(const MnistConfig &config, bool parameter_arena = true);
     Tensor forward(Tensor &input) const;
 
+    // 形状传播：计算并缓存每一层的输出形状，返回 logits 的形状
+    Shape prepare(const Shape &input_shape);
+
+    // 对 batch_sizes 与 sample_shapes（如 {1, 28, 28}）的每个组合做形状传播并运行 dummy forward，完成后 serving_ready() 为 true
+    const infinidemo::nn::modules::WarmupReport &warmup(const std::vector<Shape> &sample_shapes, const std::vector<size_t> &batch_sizes = {1});
+
+    const MnistConfig &config() const { return config_; }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -27,12 +40,46 @@ protected:
     INFINICORE_NN_MODULE(infinidemo::nn::modules::Linear, fc1);
     INFINICORE_NN_MODULE(infinidemo::nn::modules::Conv2d, conv1);
     infinidemo::nn::modules::ReLU relu_;
+    infinidemo::nn::modules::Flatten flatten_;
 
 protected:
-    size_t in_features_;
-    size_t out_features_;
-    bool has_bias_;
-    DataType dtype_;
+    MnistConfig config_;
+};
+
+struct FusedExecutorConfig {
+    size_t tile = 16;   // 每个 tile 的样本数：tile x in_features 的激活与 fc1 权重一起留在 L2 中
+    size_t threads = 0; // tile 分给多少个线程，0 表示 hardware_concurrency
+};
+
+// 整个网络的单 kernel 实现：每个 batch tile 在 host 上一次完成 conv + ReLU + flatten + Linear + ReLU。
+// 卷积的每 8 个输出像素在寄存器中累加（AVX2 + FMA，运行时检测，否则标量），ReLU 后写入线程私有的 tile buffer，
+// Linear 每次取 4 个样本共享一次权重加载；没有中间 tensor、没有算子分派，bias 也不需要先拷贝到输出中。
+// 权重在构造时拷贝为 host 上的连续数组，模型 load_state_dict / to 之后需要重新构造。
+// 输入不在 CPU 上时先整体拷回 host，输出再拷回输入所在的设备。
+// tile 线程在构造时创建并常驻（连同各自的激活 buffer），forward 不再创建线程；并发的 forward 依次使用这组线程
+class FusedMnistExecutor {
+public:
+    explicit FusedMnistExecutor(const MnistForImageClassification &model, const FusedExecutorConfig &config = FusedExecutorConfig());
+    ~FusedMnistExecutor();
+
+    // input: F32 [N, num_channels, image_size, image_size]，返回 [N, num_labels]
+    Tensor forward(const Tensor &input) const;
+
+    const MnistConfig &modelConfig() const { return model_config_; }
+    const FusedExecutorConfig &config() const { return config_; }
+
+private:
+    class WorkerPool;
+
+    void runTiles(const float *input, float *output, size_t begin, size_t end, std::vector<float> &activations) const;
+
+    MnistConfig model_config_;
+    FusedExecutorConfig config_;
+    std::vector<float> conv_weight_; // [conv_channels, num_channels, k, k]
+    std::vector<float> conv_bias_;
+    std::vector<float> fc_weight_;   // [num_labels, in_features]
+    std::vector<float> fc_bias_;
+    std::unique_ptr<WorkerPool> pool_;
 };
 
 } // namespace infinidemo::models
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../bindings_utils.hpp"
 #include "configuration_resnet.hpp"
 #include "modeling_resnet.hpp"
 #include <pybind11/functional.h>
@@ -13,25 +14,172 @@ using namespace infinidemo;
 namespace infinidemo::models {
 inline void bind_resnet_model(py::module_ &m) {
     py::class_<ResNetForImageClassification>(m, "ResNetForImageClassification")
-        .def(py::init([](ResNetConfig config) {
-                 return ResNetForImageClassification(config);
+        .def(py::init([](ResNetConfig config, bool parameter_arena) {
+                 return ResNetForImageClassification(config, parameter_arena);
              }),
-             py::arg("config"))
+             py::arg("config"), py::arg("parameter_arena") = true)
+        .def(py::init([](ResNetForImageClassification &source) {
+                 return ResNetForImageClassification::sharingWeights(source);
+             }),
+             py::arg("share_weights_with"),
+             R"doc(
+                New instance sharing the read-only weights of `share_weights_with`; only activations are private.
+                Call after share_weights_with.to(device); to() on the new instance raises.
+                )doc")
         .def(
             "forward",
-            [](ResNetForImageClassification &self, infinicore::Tensor &input)
-                -> py::object { return py::cast(self.forward(input)); },
+            [](ResNetForImageClassification &self, py::handle input)
+                -> py::object { return forwardNoGil(self, input); },
             py::arg("input"))
+        .def(
+            "forward_batch",
+            [](ResNetForImageClassification &self, const py::list &inputs)
+                -> py::list { return forwardBatchNoGil(self, inputs); },
+            py::arg("inputs"))
+        .def(
+            "predict",
+            [](ResNetForImageClassification &self, py::handle input, size_t top_k) -> py::list {
+                ImportedTensor imported = toInputTensor(input);
+                infinicore::Tensor values;
+                infinicore::Tensor indices;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    infinidemo::nn::modules::TopkSoftmaxOutput output = self.predict(imported.tensor, top_k);
+                    // 只有 [N, k] 的结果回传 host
+                    values = infinidemo::nn::debug::toDevice(output.values, infinicore::Device::cpu());
+                    indices = infinidemo::nn::debug::toDevice(output.indices, infinicore::Device::cpu());
+                }
+                const auto &id2label = self.config().id2label;
+                const float *probs = reinterpret_cast<const float *>(values->data());
+                const int32_t *labels = reinterpret_cast<const int32_t *>(indices->data());
+                size_t rows = values->shape()[0];
+                size_t k = values->shape()[1];
+                py::list result;
+                for (size_t r = 0; r < rows; ++r) {
+                    py::list row;
+                    for (size_t i = 0; i < k; ++i) {
+                        int label = labels[r * k + i];
+                        auto it = id2label.find(label);
+                        row.append(py::make_tuple(label, it != id2label.end() ? it->second : std::to_string(label), probs[r * k + i]));
+                    }
+                    result.append(row);
+                }
+                return result;
+            },
+            py::arg("input"), py::arg("top_k") = 5,
+            R"doc(
+                Forward plus fused softmax + top-k on the device; only the top-k results are copied back.
+
+                Returns:
+                    One list per batch row of (label_id, label_name, prob), sorted by prob.
+
+                Example:
+                    >>> label_id, name, prob = model.predict(x, top_k=5)[0][0]
+                )doc")
+        .def(
+            "features",
+            [](ResNetForImageClassification &self, py::handle input, int stage, bool normalize) {
+                ImportedTensor imported = toInputTensor(input);
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    output = self.features(imported.tensor, stage, normalize);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("input"), py::arg("stage") = -1, py::arg("normalize") = false,
+            R"doc(
+                Embedding-only forward: run up to ResNetStage `stage` (-1: the last one, i.e. the pooled ResNetModel output),
+                global-average-pool and return a contiguous [N, C] tensor. Flatten and the classifier are skipped.
+                normalize=True fuses a per-row L2 normalization into the pooling.
+                )doc")
+        .def("feature_size", &ResNetForImageClassification::featureSize, py::arg("stage") = -1)
+        .def(
+            "forward_tiled",
+            [](ResNetForImageClassification &self, py::handle input, size_t tile_size) {
+                ImportedTensor imported = toInputTensor(input);
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    output = self.forwardTiled(imported.tensor, tile_size);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("input"), py::arg("tile_size") = 512,
+            R"doc(
+                Spatially tiled forward for very high-resolution inputs. The feature map is computed in tiles of about
+                `tile_size` input pixels per side, each cropped with the halo given by receptive_field(), and stitched
+                before pooling, so the logits match forward(). Peak activation memory depends on tile_size, not on the
+                image size; the input may stay on the host, only one tile at a time is copied to the model's device.
+                )doc")
+        .def(
+            "features_tiled",
+            [](ResNetForImageClassification &self, py::handle input, size_t tile_size, int stage, bool normalize) {
+                ImportedTensor imported = toInputTensor(input);
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    output = self.featuresTiled(imported.tensor, tile_size, stage, normalize);
+                }
+                return wrapTensor(output);
+            },
+            py::arg("input"), py::arg("tile_size") = 512, py::arg("stage") = -1, py::arg("normalize") = false,
+            R"doc(
+                Tiled version of features(): same [N, C] embedding, computed tile by tile.
+                )doc")
+        .def(
+            "feature_map_tiled",
+            [](ResNetForImageClassification &self, py::handle input, size_t tile_size, int stage) {
+                ImportedTensor imported = toInputTensor(input);
+                infinicore::Tensor output;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    output = self.featureMapTiled(imported.tensor, tile_size, stage);
+                    infinicore::context::syncDevice();
+                }
+                return wrapTensor(output);
+            },
+            py::arg("input"), py::arg("tile_size") = 512, py::arg("stage") = -1,
+            R"doc(
+                Stitched [N, C, H', W'] output of ResNetStage `stage` before pooling, e.g. for dense prediction heads.
+                )doc")
+        .def(
+            "receptive_field",
+            [](const ResNetForImageClassification &self, int stage) {
+                infinidemo::nn::ReceptiveField field = self.receptiveField(stage);
+                py::dict result;
+                result["stride"] = field.stride;
+                result["left"] = field.left;
+                result["right"] = field.right;
+                result["size"] = field.size();
+                return result;
+            },
+            py::arg("stage") = -1,
+            R"doc(
+                Receptive field of ResNetStage `stage`: output position o depends on input [stride * o - left, stride * o + right].
+                left / right are the halo the tiled methods add around each tile.
+                )doc")
+        .def(
+            "release_classifier",
+            [](ResNetForImageClassification &self) {
+                py::gil_scoped_release release;
+                std::unique_lock<std::mutex> lock = lockForward(self);
+                return self.releaseClassifier();
+            },
+            R"doc(
+                Drop the classifier and free its weights (the parameter arena is repacked). Returns the freed bytes.
+                Afterwards forward/predict raise; features() keeps working.
+                )doc")
+        .def_property_readonly("has_classifier", &ResNetForImageClassification::hasClassifier)
         .def(
             "load_state_dict",
             [](ResNetForImageClassification &self, py::dict _state_dict) -> void {
-                std::unordered_map<std::string, infinicore::Tensor> state_dict;
-                for (auto item : _state_dict) {
-                    std::string key = py::cast<std::string>(item.first);
-                    py::object value_obj = py::reinterpret_borrow<py::object>(item.second);
-                    state_dict[key] = py::cast<infinicore::Tensor>(value_obj.attr("_underlying"));
-                }
-                self.load_state_dict(state_dict);
+                self.load_state_dict(toTensorMap(_state_dict));
             },
             py::arg("_state_dict"))
         .def("state_dict",
@@ -51,11 +199,71 @@ inline void bind_resnet_model(py::module_ &m) {
              })
         .def(
             "to",
-            [](ResNetForImageClassification &self, infinicore::Device device) {
-                self.to(device);
+            [](ResNetForImageClassification &self, infinicore::Device device, bool slab) {
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    if (slab) {
+                        self.to_slab(device);
+                    } else {
+                        self.to(device);
+                    }
+                }
                 return self;
             },
-            py::arg("device"));
+            py::arg("device"), py::arg("slab") = false,
+            R"doc(
+                Move the parameters to `device` module by module. With slab=True all parameters are packed into one
+                contiguous slab on `device` instead; that upload is asynchronous and the first forward / state_dict waits for it.
+                Raises on an instance created with share_weights_with.
+                )doc")
+        .def(
+            "last_migration",
+            [](const ResNetForImageClassification &self) { return migrationReportToDict(self.last_migration()); },
+            R"doc(
+                Statistics of the last to(): parameters, parameter_bytes, slab_bytes (0 without slab=True), copies, elapsed_ms.
+                )doc")
+        .def("has_parameter_arena", &ResNetForImageClassification::has_parameter_arena)
+        .def(
+            "prepare",
+            [](ResNetForImageClassification &self, const std::vector<size_t> &input_shape) {
+                return self.prepare(input_shape);
+            },
+            py::arg("input_shape"),
+            R"doc(
+                Propagate `input_shape` ([N, C, H, W]) through the model once and cache every layer's output shape.
+                Later forwards with this shape only do lookups. Returns the logits shape.
+                )doc")
+        .def(
+            "warmup",
+            [](ResNetForImageClassification &self, const std::vector<std::vector<size_t>> &shapes, const std::vector<size_t> &batch_sizes) {
+                std::vector<infinicore::Shape> sample_shapes(shapes.begin(), shapes.end());
+                infinidemo::nn::modules::WarmupReport report;
+                {
+                    py::gil_scoped_release release;
+                    std::unique_lock<std::mutex> lock = lockForward(self);
+                    report = self.warmup(sample_shapes, batch_sizes);
+                }
+                return warmupReportToDict(report);
+            },
+            py::arg("shapes"), py::arg("batch_sizes") = std::vector<size_t>{1},
+            R"doc(
+                Pre-build the per-shape execution state before serving: for every batch size x sample shape ([C, H, W]),
+                propagate shapes and run a zero-filled forward twice (features() once the classifier is released).
+                Afterwards `ready` is True. Returns {"entries": [{input_shape, prepare_ms, cold_ms, warm_ms}], "elapsed_ms"}.
+                )doc")
+        .def_property_readonly("ready", [](const ResNetForImageClassification &self) { return self.serving_ready(); })
+        .def_property(
+            "require_ready", [](const ResNetForImageClassification &self) { return self.requires_ready(); },
+            [](ResNetForImageClassification &self, bool enabled) { self.require_ready(enabled); },
+            "When True, forward raises until warmup() has made the model ready (again after every to())")
+        .def_property_readonly("weights_loaded", &ResNetForImageClassification::weights_loaded,
+                               "True once load_state_dict has set every parameter; forward raises before that")
+        .def("last_warmup", [](const ResNetForImageClassification &self) { return warmupReportToDict(self.last_warmup()); })
+        .def(
+            "memory_stats",
+            [](const ResNetForImageClassification &, bool reset) { return globalMemoryStatsToDict(reset); },
+            py::arg("reset") = false, kGlobalMemoryStatsDoc);
 }
 
 inline void bind_resnet_config(py::module_ &m) {
@@ -74,6 +282,7 @@ inline void bind_resnet_config(py::module_ &m) {
         .def_readwrite("torch_dtype", &ResNetConfig::torch_dtype)
         .def_readwrite("transformers_version", &ResNetConfig::transformers_version)
         .def_readwrite("num_labels", &ResNetConfig::num_labels)
+        .def_readwrite("id2label", &ResNetConfig::id2label)
         .def("__repr__", [](const ResNetConfig &self) {
             std::stringstream ss;
             ss << self;
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,7 @@ struct ResNetConfig {
     std::string transformers_version = "4.18.0.dev0";
     int num_labels = -1;                   // Additional parameters
     bool downsample_in_bottleneck = false; // Additional parameters
+    std::map<int, std::string> id2label;   // 类别下标 -> 类别名，predict 输出时使用
 };
 
 inline std::ostream &operator<<(std::ostream &os, const ResNetConfig &config) {
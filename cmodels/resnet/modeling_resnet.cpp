@@ -3,8 +3,10 @@
 #include "../../nn/modules/module.hpp"
 #include "../../nn/modules/pooling.hpp"
 #include "../../nn/modules/relu.hpp"
+#include "../runtime/spatial_tiling.hpp"
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 
 namespace {
 using namespace infinicore;
@@ -17,10 +19,15 @@ public:
     }
 
     inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetShortCut", input);
         Tensor hidden_state = convolution_->forward(input);
         return hidden_state;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const { return convolution_->outputShape(input_shape); }
+
+    inline infinidemo::nn::ReceptiveField receptiveField() const { return convolution_->receptiveField(); }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -39,6 +46,7 @@ public:
     }
 
     inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetConvLayer", input);
         Tensor hidden_state = convolution_->forward(input);
         if (activation_.empty()) {
             hidden_state = identity_.forward(hidden_state);
@@ -52,6 +60,10 @@ public:
         return hidden_state;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const { return convolution_->outputShape(input_shape); }
+
+    inline infinidemo::nn::ReceptiveField receptiveField() const { return convolution_->receptiveField(); }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -84,8 +96,9 @@ public:
     }
 
     inline Tensor forward(Tensor &hidden_state) const {
-        Tensor residual = Tensor::empty(hidden_state->shape(), hidden_state->dtype(), hidden_state->device());
-        residual->copy_from(hidden_state);
+        INFINIDEMO_PROFILE_MODULE("ResNetBasicLayer", hidden_state);
+        // 各 ResNetConvLayer 都输出新的 tensor、不写入输入，残差直接引用输入即可
+        Tensor residual = hidden_state;
 
         size_t num_layers = layer_.size();
         for (size_t i = 0; i < num_layers; ++i) {
@@ -107,6 +120,26 @@ public:
         return hidden_state;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        if (should_apply_shortcut_) {
+            shortcut_->outputShape(input_shape);
+        }
+        const Shape *shape = &input_shape;
+        for (const auto &layer : layer_) {
+            shape = &layer->outputShape(*shape);
+        }
+        return *shape;
+    }
+
+    // 主路径与 shortcut（或恒等）的并集
+    inline infinidemo::nn::ReceptiveField receptiveField() const {
+        infinidemo::nn::ReceptiveField field;
+        for (const auto &layer : layer_) {
+            field = field.then(layer->receptiveField());
+        }
+        return field.merge(should_apply_shortcut_ ? shortcut_->receptiveField() : infinidemo::nn::ReceptiveField());
+    }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -147,8 +180,9 @@ public:
     }
 
     inline Tensor forward(Tensor &hidden_state) const {
-        Tensor residual = Tensor::empty(hidden_state->shape(), hidden_state->dtype(), hidden_state->device());
-        residual->copy_from(hidden_state);
+        INFINIDEMO_PROFILE_MODULE("ResNetBottleNeckLayer", hidden_state);
+        // 各 ResNetConvLayer 都输出新的 tensor、不写入输入，残差直接引用输入即可
+        Tensor residual = hidden_state;
 
         size_t num_layers = layer_.size();
         for (size_t i = 0; i < num_layers; ++i) {
@@ -170,6 +204,26 @@ public:
         return hidden_state;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        if (should_apply_shortcut_) {
+            shortcut_->outputShape(input_shape);
+        }
+        const Shape *shape = &input_shape;
+        for (const auto &layer : layer_) {
+            shape = &layer->outputShape(*shape);
+        }
+        return *shape;
+    }
+
+    // 主路径与 shortcut（或恒等）的并集
+    inline infinidemo::nn::ReceptiveField receptiveField() const {
+        infinidemo::nn::ReceptiveField field;
+        for (const auto &layer : layer_) {
+            field = field.then(layer->receptiveField());
+        }
+        return field.merge(should_apply_shortcut_ ? shortcut_->receptiveField() : infinidemo::nn::ReceptiveField());
+    }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -209,6 +263,7 @@ public:
     }
 
     inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetStage", input);
         Tensor hidden_state = input;
         if (layer_type_ == "bottleneck") {
             size_t num_layers = layers_bottleneck_.size();
@@ -224,6 +279,28 @@ public:
         return hidden_state;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        const Shape *shape = &input_shape;
+        for (const auto &layer : layers_bottleneck_) {
+            shape = &layer->outputShape(*shape);
+        }
+        for (const auto &layer : layers_basic_) {
+            shape = &layer->outputShape(*shape);
+        }
+        return *shape;
+    }
+
+    inline infinidemo::nn::ReceptiveField receptiveField() const {
+        infinidemo::nn::ReceptiveField field;
+        for (const auto &layer : layers_bottleneck_) {
+            field = field.then(layer->receptiveField());
+        }
+        for (const auto &layer : layers_basic_) {
+            field = field.then(layer->receptiveField());
+        }
+        return field;
+    }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -262,6 +339,7 @@ public:
     }
 
     inline Tensor forward(Tensor &hidden_state) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetEncoder", hidden_state);
         size_t num_stages = stages_.size();
         for (size_t i = 0; i < num_stages; ++i) {
             hidden_state = stages_[i]->forward(hidden_state);
@@ -269,6 +347,16 @@ public:
         return hidden_state;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        const Shape *shape = &input_shape;
+        for (const auto &stage : stages_) {
+            shape = &stage->outputShape(*shape);
+        }
+        return *shape;
+    }
+
+    inline const std::vector<std::shared_ptr<ResNetStage>> &stages() const { return stages_; }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -288,6 +376,7 @@ public:
     }
 
     inline Tensor forward(Tensor &pixel_values) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetEmbeddings", pixel_values);
         int num_channels = static_cast<int>(pixel_values->shape()[1]);
         if (num_channels != num_channels_) {
             throw std::runtime_error("Channel dimension mismatch");
@@ -297,6 +386,10 @@ public:
         return embedding;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const { return pooler_->outputShape(embedder_->outputShape(input_shape)); }
+
+    inline infinidemo::nn::ReceptiveField receptiveField() const { return embedder_->receptiveField().then(pooler_->receptiveField()); }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -308,6 +401,15 @@ protected:
     const int num_channels_;
 };
 
+// 卷积段的 FLOPs 按 2 * 参数量 * 输出像素数估计，忽略 BN、ReLU 以及段内第一个卷积的步长带来的分辨率差异
+double estimateConvFlops(const infinidemo::nn::modules::Module &module, const Shape &output_shape) {
+    size_t parameters = 0;
+    for (const auto &[name, param] : module.state_dict()) {
+        parameters += param->numel();
+    }
+    return 2.0 * static_cast<double>(parameters) * static_cast<double>(output_shape[0] * output_shape[2] * output_shape[3]);
+}
+
 } // namespace
 
 namespace infinidemo::models {
@@ -318,16 +420,71 @@ public:
     ResNetModel(const ResNetConfig &config, const DataType &dtype = DataType::F32) {
         INFINICORE_NN_MODULE_INIT(embedder, config, dtype);
         INFINICORE_NN_MODULE_INIT(encoder, config, dtype);
-        INFINICORE_NN_MODULE_INIT(pooler, 7, 1, 0, false, dtype);
+        // 全局平均池化（等价于 HF 的 AdaptiveAvgPool2d((1, 1))），任意输入分辨率都得到 [N, C]
+        INFINICORE_NN_MODULE_INIT(pooler, false);
     }
 
     inline Tensor forward(Tensor &pixel_values) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetModel", pixel_values);
         Tensor embedding_output = embedder_->forward(pixel_values);
         Tensor encoder_output = encoder_->forward(embedding_output);
         Tensor pooled_output = pooler_->forward(encoder_output);
         return pooled_output;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        return pooler_->outputShape(encoder_->outputShape(embedder_->outputShape(input_shape)));
+    }
+
+    // embedder 加上前 num_stages 个 ResNetStage 的输出，不做池化
+    inline Tensor hiddenState(Tensor &pixel_values, size_t num_stages) const {
+        Tensor hidden_state = embedder_->forward(pixel_values);
+        const auto &stages = encoder_->stages();
+        for (size_t i = 0; i < num_stages; ++i) {
+            hidden_state = stages[i]->forward(hidden_state);
+        }
+        return hidden_state;
+    }
+
+    inline const Shape &hiddenStateShape(const Shape &input_shape, size_t num_stages) const {
+        const Shape *shape = &embedder_->outputShape(input_shape);
+        const auto &stages = encoder_->stages();
+        for (size_t i = 0; i < num_stages; ++i) {
+            shape = &stages[i]->outputShape(*shape);
+        }
+        return *shape;
+    }
+
+    // hiddenState(pixel_values, num_stages) 的一个输出位置依赖的输入范围
+    inline infinidemo::nn::ReceptiveField receptiveField(size_t num_stages) const {
+        infinidemo::nn::ReceptiveField field = embedder_->receptiveField();
+        const auto &stages = encoder_->stages();
+        for (size_t i = 0; i < num_stages; ++i) {
+            field = field.then(stages[i]->receptiveField());
+        }
+        return field;
+    }
+
+    size_t numStages() const { return encoder_->stages().size(); }
+
+    // embedder、每个 ResNetStage、pooler 各为一段
+    std::vector<infinidemo::nn::ForwardSegment> segments(const Shape &input_shape) const {
+        std::vector<infinidemo::nn::ForwardSegment> result;
+        const Shape *shape = &embedder_->outputShape(input_shape);
+        result.push_back({"embedder", {embedder_->module_path()}, [embedder = embedder_](Tensor &input) { return embedder->forward(input); },
+                          ::estimateConvFlops(*embedder_, *shape)});
+        const auto &stages = encoder_->stages();
+        for (size_t i = 0; i < stages.size(); ++i) {
+            shape = &stages[i]->outputShape(*shape);
+            result.push_back({"stages." + std::to_string(i), {stages[i]->module_path()},
+                              [stage = stages[i]](Tensor &input) { return stage->forward(input); },
+                              ::estimateConvFlops(*stages[i], *shape)});
+        }
+        pooler_->outputShape(*shape);
+        result.push_back({"pooler", {pooler_->module_path()}, [pooler = pooler_](Tensor &input) { return pooler->forward(input); }, 0.0});
+        return result;
+    }
+
 private:
     void to_device_(const Device &device) override {
         ;
@@ -336,10 +493,10 @@ private:
 protected:
     INFINICORE_NN_MODULE(::ResNetEmbeddings, embedder);
     INFINICORE_NN_MODULE(::ResNetEncoder, encoder);
-    INFINICORE_NN_MODULE(infinidemo::nn::modules::AvgPool2d, pooler);
+    INFINICORE_NN_MODULE(infinidemo::nn::modules::GlobalAvgPool2d, pooler);
 };
 
-ResNetForImageClassification::ResNetForImageClassification(const ResNetConfig &config) : config_(config), num_labels_(config.num_labels) {
+ResNetForImageClassification::ResNetForImageClassification(const ResNetConfig &config, bool parameter_arena) : config_(config), num_labels_(config.num_labels) {
     if (config.num_labels <= 0) {
         throw std::runtime_error("ResNetConfig num_labels must be greater than 0");
     }
@@ -348,6 +505,7 @@ ResNetForImageClassification::ResNetForImageClassification(const ResNetConfig &c
         throw std::runtime_error("Invalid data dtype: " + config.torch_dtype);
     }
 
+    infinidemo::nn::modules::ParameterArenaScope arena_scope(parameter_arena);
     INFINICORE_NN_MODULE_INIT(resnet, config, dtype);
 
     int in_features = config.hidden_sizes.back();
@@ -355,6 +513,159 @@ ResNetForImageClassification::ResNetForImageClassification(const ResNetConfig &c
     classifier_.reserve(1);
     classifier_.push_back(this->register_module<infinidemo::nn::modules::Linear>(
         "classifier.1", static_cast<size_t>(in_features), static_cast<size_t>(out_features), true, dtype));
+
+    assign_module_paths();
+    if (parameter_arena) {
+        allocate_parameter_arena(Device::cpu());
+    }
+}
+
+ResNetForImageClassification ResNetForImageClassification::sharingWeights(ResNetForImageClassification &source) {
+    // 外层 scope 使构造出的参数都是不持有内存的占位，parameter_arena=false 则不再单独分配 arena
+    infinidemo::nn::modules::ParameterArenaScope arena_scope;
+    ResNetForImageClassification replica(source.config_, false);
+    if (!source.hasClassifier()) {
+        replica.releaseClassifier();
+    }
+    replica.share_parameters_from(source);
+    return replica;
+}
+
+std::shared_ptr<ResNetForImageClassification> ResNetForImageClassification::replicate(ResNetForImageClassification &source, const Device &device) {
+    if (infinidemo::nn::debug::sameDevice(source.parameter_device(), device)) {
+        return std::make_shared<ResNetForImageClassification>(sharingWeights(source));
+    }
+    auto replica = std::make_shared<ResNetForImageClassification>(source.config_);
+    if (!source.hasClassifier()) {
+        replica->releaseClassifier();
+    }
+    std::unordered_map<std::string, Tensor> state_dict;
+    for (const auto &[name, param] : source.state_dict()) {
+        state_dict[name] = param;
+    }
+    replica->load_state_dict(state_dict);
+    replica->to_slab(device);
+    return replica;
+}
+
+Shape ResNetForImageClassification::prepare(const Shape &input_shape) {
+    if (!hasClassifier()) {
+        return prepareFeatures(input_shape);
+    }
+    return classifier_[0]->outputShape(flatten_.outputShape(resnet_->outputShape(input_shape)));
+}
+
+const infinidemo::nn::modules::WarmupReport &ResNetForImageClassification::warmup(const std::vector<Shape> &sample_shapes, const std::vector<size_t> &batch_sizes) {
+    return warmup_shapes_(
+        sample_shapes, batch_sizes,
+        [this](const Shape &input_shape) { prepare(input_shape); },
+        [this](Tensor &input) { return hasClassifier() ? forward(input) : features(input); });
+}
+
+size_t ResNetForImageClassification::featureStages(int stage) const {
+    int num_stages = static_cast<int>(resnet_->numStages());
+    if ((stage < -1) || (stage >= num_stages)) {
+        throw std::runtime_error("Invalid feature stage " + std::to_string(stage) + ", model has " + std::to_string(num_stages) + " stages");
+    }
+    return stage < 0 ? static_cast<size_t>(num_stages) : static_cast<size_t>(stage) + 1;
+}
+
+Tensor ResNetForImageClassification::features(Tensor &pixel_values, int stage, bool normalize) {
+    INFINIDEMO_PROFILE_MODULE("ResNetForImageClassification.features", pixel_values);
+    ensure_parameters_ready_();
+    Tensor hidden_state = resnet_->hiddenState(pixel_values, featureStages(stage));
+    Tensor embedding = normalize ? feature_pool_l2_.forward(hidden_state) : feature_pool_.forward(hidden_state);
+    context::syncDevice();
+    return embedding;
+}
+
+Shape ResNetForImageClassification::prepareFeatures(const Shape &input_shape, int stage) {
+    return feature_pool_.outputShape(resnet_->hiddenStateShape(input_shape, featureStages(stage)));
+}
+
+size_t ResNetForImageClassification::featureSize(int stage) const {
+    return static_cast<size_t>(config_.hidden_sizes[featureStages(stage) - 1]);
+}
+
+infinidemo::nn::ReceptiveField ResNetForImageClassification::receptiveField(int stage) const {
+    return resnet_->receptiveField(featureStages(stage));
+}
+
+Tensor ResNetForImageClassification::featureMapTiled(Tensor &pixel_values, size_t tile_size, int stage) {
+    INFINIDEMO_PROFILE_MODULE("ResNetForImageClassification.tiled", pixel_values);
+    ensure_parameters_ready_();
+    size_t num_stages = featureStages(stage);
+    Shape output_shape = resnet_->hiddenStateShape(pixel_values->shape(), num_stages);
+    infinidemo::runtime::SpatialTilePlan plan = infinidemo::runtime::planSpatialTiles(resnet_->receptiveField(num_stages), pixel_values->shape(), output_shape, tile_size);
+    Tensor feature_map = infinidemo::runtime::runSpatialTiles(pixel_values, plan, output_shape, parameter_device(),
+                                                             [this, num_stages](Tensor &tile) { return resnet_->hiddenState(tile, num_stages); });
+    return feature_map;
+}
+
+Tensor ResNetForImageClassification::featuresTiled(Tensor &pixel_values, size_t tile_size, int stage, bool normalize) {
+    Tensor feature_map = featureMapTiled(pixel_values, tile_size, stage);
+    Tensor embedding = normalize ? feature_pool_l2_.forward(feature_map) : feature_pool_.forward(feature_map);
+    context::syncDevice();
+    return embedding;
+}
+
+Tensor ResNetForImageClassification::forwardTiled(Tensor &pixel_values, size_t tile_size) {
+    if (!hasClassifier()) {
+        throw std::runtime_error("ResNetForImageClassification: classifier was released, use featuresTiled()");
+    }
+    Tensor feature_map = featureMapTiled(pixel_values, tile_size);
+    Tensor pooled_output = feature_pool_.forward(feature_map);
+    pooled_output = flatten_.forward(pooled_output);
+    Tensor logits = classifier_[0]->forward(pooled_output);
+    context::syncDevice();
+    return logits;
+}
+
+size_t ResNetForImageClassification::releaseClassifier() {
+    if (!hasClassifier()) {
+        return 0;
+    }
+    size_t released = 0;
+    for (const auto &[name, param] : classifier_[0]->state_dict()) {
+        released += infinidemo::nn::numBytes(param->shape(), param->dtype());
+    }
+    submodules_.erase("classifier.1");
+    classifier_.clear();
+    // arena / slab 中的参数不能单独释放：把剩下的参数重新打包进一块更小的 slab，旧的一块随之释放
+    // （与本模型共享权重的实例仍持有旧 slab，不受影响；本模型的权重本身是共享来的时不重新打包，旧 slab 由 source 持有）
+    if (has_parameter_arena() && !shares_parameters()) {
+        pack_slab_(parameter_device());
+    }
+    return released;
+}
+
+std::vector<infinidemo::nn::ForwardSegment> ResNetForImageClassification::segments(const Shape &input_shape) {
+    // 各段直接调用子模块，不经过 forward 的检查
+    ensure_parameters_ready_();
+    std::vector<infinidemo::nn::ForwardSegment> result = resnet_->segments(input_shape);
+    // pooler 与 flatten、classifier 合并为分类头，单独的 pooler 段太小，不值得占用一个流水线 stage
+    infinidemo::nn::ForwardSegment head = std::move(result.back());
+    result.pop_back();
+    if (!hasClassifier()) {
+        // classifier 已释放：分类头换成特征池化，流水线输出 [N, C] embedding
+        head.name = "features";
+        head.forward = [this](Tensor &input) { return feature_pool_.forward(input); };
+        prepareFeatures(input_shape);
+        result.push_back(std::move(head));
+        return result;
+    }
+    Shape logits_shape = prepare(input_shape);
+    auto pool = head.forward;
+    head.name = "head";
+    head.modules.push_back(classifier_[0]->module_path());
+    head.forward = [this, pool](Tensor &input) {
+        Tensor pooled_output = pool(input);
+        pooled_output = flatten_.forward(pooled_output);
+        return classifier_[0]->forward(pooled_output);
+    };
+    head.flops = 2.0 * static_cast<double>(logits_shape[0] * logits_shape[1]) * static_cast<double>(config_.hidden_sizes.back());
+    result.push_back(std::move(head));
+    return result;
 }
 
 void ResNetForImageClassification::to_device_(const Device &device) {
@@ -362,11 +673,29 @@ void ResNetForImageClassification::to_device_(const Device &device) {
 }
 
 Tensor ResNetForImageClassification::forward(Tensor &pixel_values) {
+    Tensor logits = forwardAsync(pixel_values);
+    context::syncDevice();
+    return logits;
+}
+
+Tensor ResNetForImageClassification::forwardAsync(Tensor &pixel_values) {
+    INFINIDEMO_PROFILE_MODULE("ResNetForImageClassification", pixel_values);
+    if (!hasClassifier()) {
+        throw std::runtime_error("ResNetForImageClassification: classifier was released, use features()");
+    }
+    ensure_parameters_ready_();
     Tensor outputs = resnet_->forward(pixel_values);
     Tensor pooled_output = flatten_.forward(outputs);
-    Tensor logits = classifier_[0]->forward(pooled_output);
+    return classifier_[0]->forward(pooled_output);
+}
+
+infinidemo::nn::modules::TopkSoftmaxOutput ResNetForImageClassification::predict(Tensor &pixel_values, size_t topk) {
+    Tensor logits = forward(pixel_values);
+    // 每个 topk 只构造一次 head，之后的 predict 直接复用
+    auto head = topk_heads_.try_emplace(topk, topk).first;
+    infinidemo::nn::modules::TopkSoftmaxOutput output = head->second.forward(logits);
     context::syncDevice();
-    return logits;
+    return output;
 }
 
 } // namespace infinidemo::models
@@ -2,31 +2,100 @@
 
 #include "../../nn/modules/flatten.hpp"
 #include "../../nn/modules/linear.hpp"
-#include "../../nn/modules/module.hpp"
+#include "../../nn/modules/pooling.hpp"
+#include "../../nn/modules/root_module.hpp"
+#include "../../nn/modules/topksoftmax.hpp"
+#include "../../nn/receptive_field.hpp"
+#include "../../nn/segment.hpp"
 #include "configuration_resnet.hpp"
 #include <infinicore/device.hpp>
 #include <infinicore/nn/module.hpp>
 #include <infinicore/tensor.hpp>
+#include <memory>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace infinidemo::models {
 
 using namespace infinicore;
 class ResNetModel;
 
-class ResNetForImageClassification : public infinidemo::nn::modules::Module {
+class ResNetForImageClassification : public infinidemo::nn::modules::RootModule {
 public:
-    ResNetForImageClassification(const ResNetConfig &config);
+    // parameter_arena 为 true 时所有权重位于同一块对齐的 host buffer 中（见 RootModule::allocate_parameter_arena）
+    ResNetForImageClassification(const ResNetConfig &config, bool parameter_arena = true);
+
+    // 与 source 共享只读权重的新实例（用于多个 serving worker），不分配任何参数内存，
+    // 每个实例只有自己的激活。source 应已完成迁移（to() / to_slab()），新实例的 to() / to_slab() 会抛出异常
+    static ResNetForImageClassification sharingWeights(ResNetForImageClassification &source);
+
+    // device 上的副本：与 source 的参数在同一设备时共享权重，否则按 config 新建、拷贝权重后 to_slab(device)
+    static std::shared_ptr<ResNetForImageClassification> replicate(ResNetForImageClassification &source, const Device &device);
     Tensor forward(Tensor &pixel_values);
 
+    // 与 forward 相同但最后不做 syncDevice：计算只提交到当前线程的 stream，返回的 logits 在调用者同步之前不可读。
+    // 连续提交多个请求（runtime::InferenceRunner::forwardMany）时只在最后同步一次，下一个请求的上传与本次计算重叠
+    Tensor forwardAsync(Tensor &pixel_values);
+
+    // 形状传播：为输入形状 [N, C, H, W] 计算并缓存每一层的输出形状，之后同形状的 forward 只做查找。
+    // 返回 logits 的形状。不调用也可以，第一次 forward 时会按同样的方式填充
+    Shape prepare(const Shape &input_shape);
+
+    // 上线前的 warmup：对 batch_sizes 与 sample_shapes（不含 batch 维的 [C, H, W]）的每个组合做形状传播并运行 dummy forward
+    // （classifier 已释放时运行 features），完成后 serving_ready() 为 true。返回每个形状的耗时
+    const infinidemo::nn::modules::WarmupReport &warmup(const std::vector<Shape> &sample_shapes, const std::vector<size_t> &batch_sizes = {1});
+
+    // 按 embedder、encoder 的每个 ResNetStage、分类头（pooler + flatten + classifier）切分的前向，
+    // 依次执行等价于 forward（最后不做 syncDevice）。各段引用本模型的子模块，模型需比返回的段活得更久
+    std::vector<infinidemo::nn::ForwardSegment> segments(const Shape &input_shape);
+
+    // 特征模式：只运行到第 stage 个 ResNetStage（-1 为最后一个，即 ResNetModel 的池化输出）为止，
+    // 全局平均池化后返回连续的 [N, C] embedding，不经过 flatten 与 classifier，可以直接用于批量相似度检索。
+    // normalize 为 true 时每行的 L2 归一化融合在池化中
+    Tensor features(Tensor &pixel_values, int stage = -1, bool normalize = false);
+
+    // features 的形状传播，返回 [N, C]
+    Shape prepareFeatures(const Shape &input_shape, int stage = -1);
+
+    // 第 stage 个 ResNetStage 的 embedding 维度 C
+    size_t featureSize(int stage = -1) const;
+
+    // 空间分块执行超大分辨率输入：特征图按 tile_size（输入像素，向下取整到累计步长的倍数）切块，
+    // 每块加上由感受野算出的 halo 单独前向，有效区域拼回整图的特征图，与整图推理的结果一致。
+    // 峰值激活内存由 tile 大小决定；pixel_values 可以留在 host 上，每次只有一块拷到模型所在的设备。
+    // featureMapTiled 返回第 stage 个 ResNetStage 输出的 [N, C, H', W']，featuresTiled / forwardTiled 在其上做全局平均池化（与分类头）。
+    // featureMapTiled 不做设备同步，由调用者在使用结果前同步（featuresTiled / forwardTiled 在池化之后同步一次）
+    Tensor featureMapTiled(Tensor &pixel_values, size_t tile_size = 512, int stage = -1);
+    Tensor featuresTiled(Tensor &pixel_values, size_t tile_size = 512, int stage = -1, bool normalize = false);
+    Tensor forwardTiled(Tensor &pixel_values, size_t tile_size = 512);
+
+    // 第 stage 个 ResNetStage 输出的感受野（累计步长与两侧 halo）
+    infinidemo::nn::ReceptiveField receptiveField(int stage = -1) const;
+
+    // 只做特征提取的服务释放 classifier 的权重，返回释放的参数字节数。classifier 从模块树中移除
+    // （state_dict 不再包含它），参数 arena 会重新打包；之后 forward / predict 抛出异常
+    size_t releaseClassifier();
+    bool hasClassifier() const { return !classifier_.empty(); }
+
+    // 可选的输出模式：在设备上完成 softmax + top-k，只返回 [N, topk] 的概率与类别下标
+    infinidemo::nn::modules::TopkSoftmaxOutput predict(Tensor &pixel_values, size_t topk = 5);
+
+    const ResNetConfig &config() const { return config_; }
+
 protected:
     void to_device_(const Device &device) override;
+    // stage 参数对应的 ResNetStage 个数
+    size_t featureStages(int stage) const;
 
 protected:
     INFINICORE_NN_MODULE(ResNetModel, resnet);
     INFINICORE_NN_MODULE_VEC(infinidemo::nn::modules::Linear, classifier);
     infinidemo::nn::modules::Flatten flatten_;
+    infinidemo::nn::modules::GlobalAvgPool2d feature_pool_{false};
+    infinidemo::nn::modules::GlobalAvgPool2d feature_pool_l2_{true};
+    std::unordered_map<size_t, infinidemo::nn::modules::TopkSoftmax> topk_heads_; // predict 按 topk 缓存的 softmax + top-k head
     ResNetConfig config_;
     int num_labels_;
 };
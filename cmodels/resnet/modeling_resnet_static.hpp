@@ -0,0 +1,431 @@
+#pragma once
+
+#include "../../nn/modules/conv.hpp"
+#include "../../nn/modules/flatten.hpp"
+#include "../../nn/modules/linear.hpp"
+#include "../../nn/modules/module.hpp"
+#include "../../nn/modules/pooling.hpp"
+#include "../../nn/modules/relu.hpp"
+#include "../../nn/modules/root_module.hpp"
+#include "configuration_resnet.hpp"
+#include <array>
+#include <cstddef>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+// 编译期特化的 ResNet：stage 数、block 类型、通道数都是模板参数。
+// forward 中没有按 layer_type / activation 字符串的运行期分支，整条调用链可以被内联，
+// 通道的衔接在编译期检查，各层的输出尺寸是 constexpr 函数。参数路径与 ResNetForImageClassification 相同，
+// 可以加载同一份 state_dict。由 ResNetConfig 构造的动态版本保持不变
+namespace infinidemo::models::static_resnet {
+using namespace infinicore;
+
+enum class BlockType {
+    Basic,
+    Bottleneck
+};
+
+// 卷积输出尺寸（与 Conv2d 相同，dilation 为 1）
+constexpr size_t convOutputSize(size_t input, size_t kernel, size_t stride, size_t padding) {
+    return (input + 2 * padding - kernel) / stride + 1;
+}
+
+// Conv2d(+ReLU)，对应动态版本的 ResNetConvLayer，参数路径为 "convolution.weight" / "convolution.bias"
+template <int In, int Out, int Kernel, int Stride, bool Relu>
+class ConvLayer : public infinidemo::nn::modules::Module {
+public:
+    static constexpr int in_channels = In;
+    static constexpr int out_channels = Out;
+    static constexpr size_t outputSize(size_t input) { return convOutputSize(input, Kernel, Stride, Kernel / 2); }
+
+    explicit ConvLayer(const DataType &dtype = DataType::F32) {
+        INFINICORE_NN_MODULE_INIT(convolution, In, Out, Kernel, Stride, Kernel / 2, 1, 1, true, dtype);
+    }
+
+    inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetConvLayer", input);
+        Tensor hidden_state = convolution_->forward(input);
+        if constexpr (Relu) {
+            hidden_state = relu_.forward(hidden_state);
+        }
+        return hidden_state;
+    }
+
+    inline const Shape &outputShape(const Shape &input_shape) const { return convolution_->outputShape(input_shape); }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    INFINICORE_NN_MODULE(infinidemo::nn::modules::Conv2d, convolution);
+    infinidemo::nn::modules::ReLU relu_;
+};
+
+// 输入不会被修改，残差直接使用输入，不需要动态版本中的拷贝
+template <int In, int Out, int Stride, bool DownsampleInBottleneck>
+class BasicBlock : public infinidemo::nn::modules::Module {
+public:
+    static constexpr bool has_shortcut = (In != Out) || (Stride != 1);
+    using Layer0 = ConvLayer<In, Out, 3, Stride, true>;
+    using Layer1 = ConvLayer<Out, Out, 3, 1, false>;
+    using ShortCut = ConvLayer<In, Out, 1, Stride, false>;
+    static constexpr size_t outputSize(size_t input) { return Layer1::outputSize(Layer0::outputSize(input)); }
+
+    explicit BasicBlock(const DataType &dtype = DataType::F32) {
+        if constexpr (has_shortcut) {
+            shortcut_ = this->register_module<ShortCut>("shortcut", dtype);
+        }
+        layer0_ = this->register_module<Layer0>("layer.0", dtype);
+        layer1_ = this->register_module<Layer1>("layer.1", dtype);
+    }
+
+    inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetBasicLayer", input);
+        Tensor hidden_state = layer0_->forward(input);
+        hidden_state = layer1_->forward(hidden_state);
+        if constexpr (has_shortcut) {
+            hidden_state += shortcut_->forward(input);
+        } else {
+            hidden_state += input;
+        }
+        return relu_.forward(hidden_state);
+    }
+
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        if constexpr (has_shortcut) {
+            shortcut_->outputShape(input_shape);
+        }
+        return layer1_->outputShape(layer0_->outputShape(input_shape));
+    }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    std::shared_ptr<ShortCut> shortcut_;
+    std::shared_ptr<Layer0> layer0_;
+    std::shared_ptr<Layer1> layer1_;
+    infinidemo::nn::modules::ReLU relu_;
+};
+
+template <int In, int Out, int Stride, bool DownsampleInBottleneck>
+class BottleneckBlock : public infinidemo::nn::modules::Module {
+public:
+    static constexpr bool has_shortcut = (In != Out) || (Stride != 1);
+    static constexpr int reduced = Out / 4;
+    using Layer0 = ConvLayer<In, reduced, 1, (DownsampleInBottleneck ? Stride : 1), true>;
+    using Layer1 = ConvLayer<reduced, reduced, 3, (DownsampleInBottleneck ? 1 : Stride), true>;
+    using Layer2 = ConvLayer<reduced, Out, 1, 1, false>;
+    using ShortCut = ConvLayer<In, Out, 1, Stride, false>;
+    static constexpr size_t outputSize(size_t input) { return Layer2::outputSize(Layer1::outputSize(Layer0::outputSize(input))); }
+
+    explicit BottleneckBlock(const DataType &dtype = DataType::F32) {
+        if constexpr (has_shortcut) {
+            shortcut_ = this->register_module<ShortCut>("shortcut", dtype);
+        }
+        layer0_ = this->register_module<Layer0>("layer.0", dtype);
+        layer1_ = this->register_module<Layer1>("layer.1", dtype);
+        layer2_ = this->register_module<Layer2>("layer.2", dtype);
+    }
+
+    inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetBottleNeckLayer", input);
+        Tensor hidden_state = layer0_->forward(input);
+        hidden_state = layer1_->forward(hidden_state);
+        hidden_state = layer2_->forward(hidden_state);
+        if constexpr (has_shortcut) {
+            hidden_state += shortcut_->forward(input);
+        } else {
+            hidden_state += input;
+        }
+        return relu_.forward(hidden_state);
+    }
+
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        if constexpr (has_shortcut) {
+            shortcut_->outputShape(input_shape);
+        }
+        return layer2_->outputShape(layer1_->outputShape(layer0_->outputShape(input_shape)));
+    }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    std::shared_ptr<ShortCut> shortcut_;
+    std::shared_ptr<Layer0> layer0_;
+    std::shared_ptr<Layer1> layer1_;
+    std::shared_ptr<Layer2> layer2_;
+    infinidemo::nn::modules::ReLU relu_;
+};
+
+template <BlockType Type, int In, int Out, int Stride, bool DownsampleInBottleneck>
+using BlockFor = std::conditional_t<Type == BlockType::Basic,
+                                    BasicBlock<In, Out, Stride, DownsampleInBottleneck>,
+                                    BottleneckBlock<In, Out, Stride, DownsampleInBottleneck>>;
+
+// 第一个 block 负责通道变换与下采样，其余 Depth - 1 个 block 类型相同，存放在定长数组中
+template <BlockType Type, int In, int Out, int Stride, int Depth, bool DownsampleInBottleneck>
+class Stage : public infinidemo::nn::modules::Module {
+public:
+    static_assert(Depth >= 1, "ResNet stage needs at least one block");
+    using First = BlockFor<Type, In, Out, Stride, DownsampleInBottleneck>;
+    using Rest = BlockFor<Type, Out, Out, 1, false>;
+    static constexpr size_t outputSize(size_t input) { return First::outputSize(input); }
+
+    explicit Stage(const DataType &dtype = DataType::F32) {
+        first_ = this->register_module<First>("layers.0", dtype);
+        for (int i = 1; i < Depth; ++i) {
+            rest_[i - 1] = this->register_module<Rest>("layers." + std::to_string(i), dtype);
+        }
+    }
+
+    inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetStage", input);
+        Tensor hidden_state = first_->forward(input);
+        for (const auto &layer : rest_) {
+            hidden_state = layer->forward(hidden_state);
+        }
+        return hidden_state;
+    }
+
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        const Shape *shape = &first_->outputShape(input_shape);
+        for (const auto &layer : rest_) {
+            shape = &layer->outputShape(*shape);
+        }
+        return *shape;
+    }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    std::shared_ptr<First> first_;
+    std::array<std::shared_ptr<Rest>, Depth - 1> rest_;
+};
+
+// 网络结构描述，例如 ResNetSpec<BlockType::Basic, 64, 4>{{2, 2, 2, 2}, {64, 128, 256, 512}}
+template <BlockType Type, int EmbeddingSize, size_t NumStages, bool DownsampleInFirstStage = false, bool DownsampleInBottleneck = false>
+struct ResNetSpec {
+    static constexpr BlockType block_type = Type;
+    static constexpr int embedding_size = EmbeddingSize;
+    static constexpr size_t num_stages = NumStages;
+    static constexpr bool downsample_in_first_stage = DownsampleInFirstStage;
+    static constexpr bool downsample_in_bottleneck = DownsampleInBottleneck;
+
+    std::array<int, NumStages> depths;
+    std::array<int, NumStages> hidden_sizes;
+
+    constexpr int stageIn(size_t i) const { return i == 0 ? EmbeddingSize : hidden_sizes[i - 1]; }
+    constexpr int stageStride(size_t i) const { return i == 0 ? (DownsampleInFirstStage ? 2 : 1) : 2; }
+
+    // 动态 config 是否描述同一个网络，用于在两种实现之间选择
+    bool matches(const ResNetConfig &config) const {
+        std::string layer_type = Type == BlockType::Basic ? "basic" : "bottleneck";
+        return (config.layer_type == layer_type) && (config.embedding_size == EmbeddingSize)
+            && (config.depths == std::vector<int>(depths.begin(), depths.end()))
+            && (config.hidden_sizes == std::vector<int>(hidden_sizes.begin(), hidden_sizes.end()))
+            && (config.downsample_in_first_stage == DownsampleInFirstStage)
+            && (config.downsample_in_bottleneck == DownsampleInBottleneck)
+            && (config.hidden_act == "relu" || config.hidden_act == "ReLU");
+    }
+
+    ResNetConfig toConfig(int num_labels) const {
+        ResNetConfig config;
+        config.layer_type = Type == BlockType::Basic ? "basic" : "bottleneck";
+        config.embedding_size = EmbeddingSize;
+        config.depths.assign(depths.begin(), depths.end());
+        config.hidden_sizes.assign(hidden_sizes.begin(), hidden_sizes.end());
+        config.downsample_in_first_stage = DownsampleInFirstStage;
+        config.downsample_in_bottleneck = DownsampleInBottleneck;
+        config.num_labels = num_labels;
+        return config;
+    }
+};
+
+inline constexpr ResNetSpec<BlockType::Basic, 64, 4> kResNet18{{2, 2, 2, 2}, {64, 128, 256, 512}};
+inline constexpr ResNetSpec<BlockType::Basic, 64, 4> kResNet34{{3, 4, 6, 3}, {64, 128, 256, 512}};
+inline constexpr ResNetSpec<BlockType::Bottleneck, 64, 4> kResNet50{{3, 4, 6, 3}, {256, 512, 1024, 2048}};
+inline constexpr ResNetSpec<BlockType::Bottleneck, 64, 4> kResNet101{{3, 4, 23, 3}, {256, 512, 1024, 2048}};
+inline constexpr ResNetSpec<BlockType::Bottleneck, 64, 4> kResNet152{{3, 8, 36, 3}, {256, 512, 1024, 2048}};
+
+template <const auto &Spec, size_t I>
+using StageAt = Stage<std::decay_t<decltype(Spec)>::block_type, Spec.stageIn(I), Spec.hidden_sizes[I], Spec.stageStride(I),
+                      Spec.depths[I], std::decay_t<decltype(Spec)>::downsample_in_bottleneck>;
+
+template <const auto &Spec, typename Indices = std::make_index_sequence<std::decay_t<decltype(Spec)>::num_stages>>
+class Encoder;
+
+// 各 stage 类型不同，存放在 tuple 中，forward 展开为固定的调用序列
+template <const auto &Spec, size_t... Is>
+class Encoder<Spec, std::index_sequence<Is...>> : public infinidemo::nn::modules::Module {
+public:
+    static constexpr size_t outputSize(size_t input) {
+        size_t size = input;
+        ((size = StageAt<Spec, Is>::outputSize(size)), ...);
+        return size;
+    }
+
+    explicit Encoder(const DataType &dtype = DataType::F32) {
+        ((std::get<Is>(stages_) = this->register_module<StageAt<Spec, Is>>("stages." + std::to_string(Is), dtype)), ...);
+    }
+
+    inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetEncoder", input);
+        Tensor hidden_state = input;
+        ((hidden_state = std::get<Is>(stages_)->forward(hidden_state)), ...);
+        return hidden_state;
+    }
+
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        const Shape *shape = &input_shape;
+        ((shape = &std::get<Is>(stages_)->outputShape(*shape)), ...);
+        return *shape;
+    }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    std::tuple<std::shared_ptr<StageAt<Spec, Is>>...> stages_;
+};
+
+// 7x7/2 卷积 + ReLU，再 3x3/2 最大池化
+template <int NumChannels, int EmbeddingSize>
+class Embeddings : public infinidemo::nn::modules::Module {
+public:
+    using Embedder = ConvLayer<NumChannels, EmbeddingSize, 7, 2, true>;
+    static constexpr size_t outputSize(size_t input) { return convOutputSize(Embedder::outputSize(input), 3, 2, 1); }
+
+    explicit Embeddings(const DataType &dtype = DataType::F32) {
+        // 模板中的成员类型是依赖类型，不能使用 INFINICORE_NN_MODULE_INIT
+        embedder_ = this->register_module<Embedder>("embedder", dtype);
+        pooler_ = this->register_module<infinidemo::nn::modules::MaxPool2d>("pooler", 3, 2, 1, 1, false, dtype);
+    }
+
+    inline Tensor forward(Tensor &pixel_values) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetEmbeddings", pixel_values);
+        if (static_cast<int>(pixel_values->shape()[1]) != NumChannels) {
+            throw std::runtime_error("Channel dimension mismatch");
+        }
+        Tensor embedding = embedder_->forward(pixel_values);
+        return pooler_->forward(embedding);
+    }
+
+    inline const Shape &outputShape(const Shape &input_shape) const { return pooler_->outputShape(embedder_->outputShape(input_shape)); }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    INFINICORE_NN_MODULE(Embedder, embedder);
+    INFINICORE_NN_MODULE(infinidemo::nn::modules::MaxPool2d, pooler);
+};
+
+// 对应动态版本的 ResNetModel：embedder、encoder、7x7 平均池化
+template <const auto &Spec, int NumChannels>
+class Body : public infinidemo::nn::modules::Module {
+public:
+    using EmbeddingsType = Embeddings<NumChannels, std::decay_t<decltype(Spec)>::embedding_size>;
+    using EncoderType = Encoder<Spec>;
+    static constexpr size_t kPoolKernel = 7;
+
+    // 编码器输出的空间尺寸
+    static constexpr size_t featureSize(size_t input) { return EncoderType::outputSize(EmbeddingsType::outputSize(input)); }
+    static_assert(featureSize(224) == kPoolKernel, "224x224 input must reach the 7x7 average pool");
+
+    explicit Body(const DataType &dtype = DataType::F32) {
+        embedder_ = this->register_module<EmbeddingsType>("embedder", dtype);
+        encoder_ = this->register_module<EncoderType>("encoder", dtype);
+        pooler_ = this->register_module<infinidemo::nn::modules::AvgPool2d>("pooler", kPoolKernel, 1, 0, false, dtype);
+    }
+
+    inline Tensor forward(Tensor &pixel_values) const {
+        INFINIDEMO_PROFILE_MODULE("ResNetModel", pixel_values);
+        Tensor embedding_output = embedder_->forward(pixel_values);
+        Tensor encoder_output = encoder_->forward(embedding_output);
+        return pooler_->forward(encoder_output);
+    }
+
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        return pooler_->outputShape(encoder_->outputShape(embedder_->outputShape(input_shape)));
+    }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    INFINICORE_NN_MODULE(EmbeddingsType, embedder);
+    INFINICORE_NN_MODULE(EncoderType, encoder);
+    INFINICORE_NN_MODULE(infinidemo::nn::modules::AvgPool2d, pooler);
+};
+
+// 参数路径与动态版本相同：resnet.embedder.embedder.*、resnet.encoder.stages.*、classifier.1.*
+template <const auto &Spec, int NumChannels = 3>
+class ResNetForImageClassificationStatic : public infinidemo::nn::modules::RootModule {
+public:
+    using SpecType = std::decay_t<decltype(Spec)>;
+    using BodyType = Body<Spec, NumChannels>;
+    static constexpr int hidden_size = Spec.hidden_sizes[SpecType::num_stages - 1];
+
+    // 输入 [N, C, size, size] 时平均池化后的特征形状，224x224 时为 [N, hidden_size, 1, 1]
+    static constexpr std::array<size_t, 4> featureShape(size_t batch, size_t size) {
+        size_t pooled = BodyType::featureSize(size) - BodyType::kPoolKernel + 1;
+        return {batch, static_cast<size_t>(hidden_size), pooled, pooled};
+    }
+
+    explicit ResNetForImageClassificationStatic(int num_labels = 1000, bool parameter_arena = true, const DataType &dtype = DataType::F32)
+        : num_labels_(num_labels) {
+        if (num_labels <= 0) {
+            throw std::runtime_error("num_labels must be greater than 0");
+        }
+        infinidemo::nn::modules::ParameterArenaScope arena_scope(parameter_arena);
+        resnet_ = this->register_module<BodyType>("resnet", dtype);
+        classifier_ = this->register_module<infinidemo::nn::modules::Linear>(
+            "classifier.1", static_cast<size_t>(hidden_size), static_cast<size_t>(num_labels), true, dtype);
+        assign_module_paths();
+        if (parameter_arena) {
+            allocate_parameter_arena(Device::cpu());
+        }
+    }
+
+    Tensor forward(Tensor &pixel_values) {
+        INFINIDEMO_PROFILE_MODULE("ResNetForImageClassification", pixel_values);
+        ensure_parameters_ready_();
+        Tensor outputs = resnet_->forward(pixel_values);
+        Tensor pooled_output = flatten_.forward(outputs);
+        Tensor logits = classifier_->forward(pooled_output);
+        context::syncDevice();
+        return logits;
+    }
+
+    // 形状传播，与 ResNetForImageClassification::prepare 相同
+    Shape prepare(const Shape &input_shape) {
+        return classifier_->outputShape(flatten_.outputShape(resnet_->outputShape(input_shape)));
+    }
+
+    int num_labels() const { return num_labels_; }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    INFINICORE_NN_MODULE(BodyType, resnet);
+    std::shared_ptr<infinidemo::nn::modules::Linear> classifier_;
+    infinidemo::nn::modules::Flatten flatten_;
+    int num_labels_;
+};
+
+using ResNet18 = ResNetForImageClassificationStatic<kResNet18>;
+using ResNet34 = ResNetForImageClassificationStatic<kResNet34>;
+using ResNet50 = ResNetForImageClassificationStatic<kResNet50>;
+using ResNet101 = ResNetForImageClassificationStatic<kResNet101>;
+using ResNet152 = ResNetForImageClassificationStatic<kResNet152>;
+
+} // namespace infinidemo::models::static_resnet
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define INFINIDEMO_RUNTIME_HAS_AVX2_HASH
+#include <immintrin.h>
+#endif
+
+// 输入内容的 128 位非加密哈希，用于按内容查找推理结果。结构与 XXH3 的累加循环相同：
+// 4 条 64 位 lane，每 32 字节一个 stripe，acc[i] += lo32(d ^ k) * hi32(d ^ k)，acc[i ^ 1] += d；
+// 每个 stripe 在 block（16 个 stripe）中的位置有各自的 key，每个 block 结束后对 acc 做一次 scramble，
+// 交换、重排 stripe 或 block（例如图像的上下翻转）都会改变结果。最后用两组 key 各做一次 avalanche 合并得到 128 位。
+// AVX2 版本一次处理一个 stripe（_mm256_mul_epu32 即 32x32->64 乘法），与标量版本结果逐位相同
+namespace infinidemo::runtime {
+
+struct ContentDigest {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator==(const ContentDigest &other) const { return (lo == other.lo) && (hi == other.hi); }
+    bool operator!=(const ContentDigest &other) const { return !(*this == other); }
+};
+
+namespace content_hash {
+
+inline constexpr size_t kStripeBytes = 32;
+inline constexpr size_t kStripesPerBlock = 16;
+inline constexpr uint64_t kLaneSeeds[4] = {0x9e3779b185ebca87ULL, 0xc2b2ae3d27d4eb4fULL, 0x165667b19e3779f9ULL, 0x85ebca77c2b2ae63ULL};
+inline constexpr uint64_t kScrambleKeys[4] = {0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL, 0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL};
+inline constexpr uint64_t kMergeKeysLo[4] = {0x78e5c0cc4ee679cbULL, 0x2172ffcc7dd05a82ULL, 0x8e2443f7744608b8ULL, 0x4c263a81e69035e0ULL};
+inline constexpr uint64_t kMergeKeysHi[4] = {0xcb00c391bb52283cULL, 0xa32e531b8b65d088ULL, 0x4ef90da297486471ULL, 0xd8acdea946ef1938ULL};
+inline constexpr uint64_t kPrime32 = 0x9e3779b1ULL;
+
+// block 内第 s 个 stripe 的 4 个 lane key（splitmix64 序列）
+inline constexpr std::array<std::array<uint64_t, 4>, kStripesPerBlock> makeStripeKeys() {
+    std::array<std::array<uint64_t, 4>, kStripesPerBlock> keys{};
+    uint64_t state = 0x3c6ef372fe94f82bULL;
+    for (size_t s = 0; s < kStripesPerBlock; ++s) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            state += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = state;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            keys[s][lane] = z ^ (z >> 31);
+        }
+    }
+    return keys;
+}
+inline constexpr std::array<std::array<uint64_t, 4>, kStripesPerBlock> kStripeKeys = makeStripeKeys();
+
+inline uint64_t avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+inline void scrambleScalar(uint64_t acc[4]) {
+    for (int lane = 0; lane < 4; ++lane) {
+        uint64_t a = acc[lane];
+        a ^= a >> 47;
+        a ^= kScrambleKeys[lane];
+        acc[lane] = a * kPrime32;
+    }
+}
+
+// 处理第 [first, first + count) 个 stripe，data 指向第 first 个 stripe；每个 block 的最后一个 stripe 之后 scramble
+inline void accumulateScalar(uint64_t acc[4], const uint8_t *data, size_t first, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        size_t s = (first + i) % kStripesPerBlock;
+        uint64_t d[4];
+        std::memcpy(d, data + i * kStripeBytes, kStripeBytes);
+        for (int lane = 0; lane < 4; ++lane) {
+            uint64_t dk = d[lane] ^ kStripeKeys[s][lane];
+            acc[lane] += (dk & 0xffffffffULL) * (dk >> 32);
+            acc[lane ^ 1] += d[lane];
+        }
+        if (s == kStripesPerBlock - 1) {
+            scrambleScalar(acc);
+        }
+    }
+}
+
+#ifdef INFINIDEMO_RUNTIME_HAS_AVX2_HASH
+__attribute__((target("avx2"))) inline void accumulateAvx2(uint64_t acc[4], const uint8_t *data, size_t first, size_t count) {
+    __m256i sum = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(acc));
+    const __m256i scramble_keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(kScrambleKeys));
+    const __m256i prime = _mm256_set1_epi64x(static_cast<long long>(kPrime32));
+    for (size_t i = 0; i < count; ++i) {
+        size_t s = (first + i) % kStripesPerBlock;
+        const __m256i keys = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(kStripeKeys[s].data()));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i * kStripeBytes));
+        __m256i dk = _mm256_xor_si256(d, keys);
+        __m256i product = _mm256_mul_epu32(dk, _mm256_srli_epi64(dk, 32));
+        // lane i ^ 1：交换每 128 位中的两个 64 位元素
+        __m256i swapped = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+        sum = _mm256_add_epi64(sum, _mm256_add_epi64(product, swapped));
+        if (s == kStripesPerBlock - 1) {
+            // a *= prime32，AVX2 没有 64 位乘法：lo32(a) * p + (hi32(a) * p) << 32
+            __m256i a = _mm256_xor_si256(_mm256_xor_si256(sum, _mm256_srli_epi64(sum, 47)), scramble_keys);
+            __m256i lo = _mm256_mul_epu32(a, prime);
+            __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), prime);
+            sum = _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+        }
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(acc), sum);
+}
+#endif
+
+inline bool avx2Supported() {
+#ifdef INFINIDEMO_RUNTIME_HAS_AVX2_HASH
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline uint64_t merge(const uint64_t acc[4], uint64_t start, const uint64_t keys[4]) {
+    uint64_t h = start;
+    for (int lane = 0; lane < 4; ++lane) {
+        h = avalanche(h ^ avalanche(acc[lane] ^ keys[lane]));
+    }
+    return h;
+}
+
+} // namespace content_hash
+
+// seed 用于把形状、dtype 等元数据混入结果
+inline ContentDigest hashBytes128(const void *bytes, size_t size, uint64_t seed = 0) {
+    using namespace content_hash;
+    const uint8_t *data = static_cast<const uint8_t *>(bytes);
+    uint64_t acc[4];
+    for (int lane = 0; lane < 4; ++lane) {
+        acc[lane] = kLaneSeeds[lane] ^ seed;
+    }
+    size_t stripes = size / kStripeBytes;
+#ifdef INFINIDEMO_RUNTIME_HAS_AVX2_HASH
+    if (avx2Supported()) {
+        accumulateAvx2(acc, data, 0, stripes);
+    } else {
+        accumulateScalar(acc, data, 0, stripes);
+    }
+#else
+    accumulateScalar(acc, data, 0, stripes);
+#endif
+    // 不足一个 stripe 的尾部补零后按同样方式累加，长度参与最终混合，补零不会与更长的输入冲突
+    size_t tail = size - stripes * kStripeBytes;
+    if (tail > 0) {
+        uint8_t last[kStripeBytes] = {};
+        std::memcpy(last, data + stripes * kStripeBytes, tail);
+        accumulateScalar(acc, last, stripes, 1);
+    }
+
+    uint64_t length = static_cast<uint64_t>(size);
+    return ContentDigest{merge(acc, length * 0x9e3779b97f4a7c15ULL, kMergeKeysLo), merge(acc, ~length * 0xc2b2ae3d27d4eb4fULL, kMergeKeysHi)};
+}
+
+inline uint64_t hashBytes(const void *bytes, size_t size, uint64_t seed = 0) { return hashBytes128(bytes, size, seed).lo; }
+
+} // namespace infinidemo::runtime
@@ -0,0 +1,260 @@
+#pragma once
+
+#include "../../nn/allocator.hpp"
+#include "../../nn/debug.hpp"
+#include "bounded_queue.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// 数据并行：模型在每个设备上各有一个副本，每个副本由一个常驻线程驱动。
+// forward 把 batch 沿 N 切分给各副本并发执行，再按原顺序把 logits 拼回。
+// 同一个设备可以出现多次（例如多个 CPU "设备"），此时每个副本是一组绑定到不同核心的线程
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+struct DataParallelStats {
+    size_t replicas = 0;
+    size_t batches = 0;
+    size_t samples = 0;
+    double wall_ms = 0.0;
+    std::vector<double> replica_busy_ms; // 每个副本 forward 的累计耗时
+
+    // 副本平均忙碌时间 / 墙钟时间，1.0 表示所有副本始终在计算（切分与拼接的开销为 0）
+    double utilization() const {
+        if ((wall_ms <= 0.0) || replica_busy_ms.empty()) {
+            return 0.0;
+        }
+        double busy = 0.0;
+        for (double ms : replica_busy_ms) {
+            busy += ms;
+        }
+        return busy / (wall_ms * static_cast<double>(replica_busy_ms.size()));
+    }
+
+    double samplesPerSecond() const { return wall_ms > 0.0 ? samples * 1000.0 / wall_ms : 0.0; }
+
+    std::string toString() const {
+        std::ostringstream os;
+        os << "replicas: " << replicas << ", batches: " << batches << ", samples/s: " << samplesPerSecond()
+           << ", utilization: " << utilization() * 100.0 << "%";
+        return os.str();
+    }
+};
+
+// 副本的加速比与 1 个副本时的吞吐之比，再除以副本数
+inline double scalingEfficiency(double samples_per_s, double single_replica_samples_per_s, size_t replicas) {
+    if ((single_replica_samples_per_s <= 0.0) || (replicas == 0)) {
+        return 0.0;
+    }
+    return samples_per_s / (single_replica_samples_per_s * static_cast<double>(replicas));
+}
+
+namespace detail {
+// 把当前线程绑定到 [first, first + count) 号核心，之后由它创建的计算线程继承同一个核心集合
+inline void bindCurrentThread(size_t first, size_t count) {
+#ifdef __linux__
+    size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i = 0; i < count; ++i) {
+        CPU_SET((first + i) % hardware, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)first;
+    (void)count;
+#endif
+}
+} // namespace detail
+
+template <typename Model>
+class DataParallel {
+public:
+    // 为 device 创建一个模型副本（参数已在 device 上）
+    using Factory = std::function<std::shared_ptr<Model>(const Device &)>;
+
+    // cores_per_replica > 0 时，第 i 个副本的线程绑定到第 i 组 cores_per_replica 个核心；
+    // 为 0 时把所有核心平均分给 CPU 上的副本（多个 CPU 副本不绑定时会互相抢占全部核心），其它设备上的副本不绑定
+    DataParallel(const Factory &factory, const std::vector<Device> &devices, size_t cores_per_replica = 0) {
+        if (devices.empty()) {
+            throw std::runtime_error("DataParallel: no devices");
+        }
+        stats_.replicas = devices.size();
+        stats_.replica_busy_ms.assign(devices.size(), 0.0);
+        for (size_t i = 0; i < devices.size(); ++i) {
+            auto worker = std::make_unique<Worker>();
+            worker->device = devices[i];
+            worker->model = factory(devices[i]);
+            workers_.push_back(std::move(worker));
+        }
+        std::vector<std::pair<size_t, size_t>> bindings = coreBindings(devices, cores_per_replica);
+        for (size_t i = 0; i < workers_.size(); ++i) {
+            Worker *worker = workers_[i].get();
+            std::pair<size_t, size_t> cores = bindings[i];
+            worker->thread = std::thread([this, worker, i, cores]() {
+                if (cores.second > 0) {
+                    detail::bindCurrentThread(cores.first, cores.second);
+                }
+                run(*worker, i);
+            });
+        }
+    }
+
+    DataParallel(const DataParallel &) = delete;
+    DataParallel &operator=(const DataParallel &) = delete;
+
+    ~DataParallel() {
+        for (auto &worker : workers_) {
+            worker->jobs.close();
+        }
+        for (auto &worker : workers_) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+
+    // input [N, ...]：切分为至多 replicas 份（前 N % replicas 份多一个样本），结果按原顺序拼接在 input 所在的设备上
+    Tensor forward(const Tensor &input) {
+        auto start = std::chrono::steady_clock::now();
+        size_t batch = input->shape()[0];
+        size_t shards = std::min(batch, workers_.size());
+        if (shards == 0) {
+            throw std::runtime_error("DataParallel: empty batch");
+        }
+
+        std::vector<std::future<Tensor>> results;
+        std::vector<std::pair<size_t, size_t>> ranges;
+        size_t offset = 0;
+        for (size_t i = 0; i < shards; ++i) {
+            size_t count = batch / shards + (i < batch % shards ? 1 : 0);
+            Job job;
+            job.input = input->narrow({{0, offset, count}});
+            results.push_back(job.result.get_future());
+            ranges.emplace_back(offset, count);
+            if (!workers_[i]->jobs.push(std::move(job))) {
+                throw std::runtime_error("DataParallel: worker stopped");
+            }
+            offset += count;
+        }
+
+        Tensor output;
+        for (size_t i = 0; i < shards; ++i) {
+            Tensor shard = infinidemo::nn::debug::toDevice(results[i].get(), input->device());
+            if (!output) {
+                Shape shape = shard->shape();
+                shape[0] = batch;
+                output = infinidemo::nn::empty(shape, shard->dtype(), input->device());
+            }
+            output->narrow({{0, ranges[i].first, ranges[i].second}})->copy_from(shard);
+        }
+
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.batches += 1;
+        stats_.samples += batch;
+        stats_.wall_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        return output;
+    }
+
+    size_t replicas() const { return workers_.size(); }
+    Model &replica(size_t index) { return *workers_.at(index)->model; }
+
+    DataParallelStats stats() const {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return stats_;
+    }
+
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.batches = 0;
+        stats_.samples = 0;
+        stats_.wall_ms = 0.0;
+        std::fill(stats_.replica_busy_ms.begin(), stats_.replica_busy_ms.end(), 0.0);
+    }
+
+private:
+    // 每个副本绑定的核心区间 (first, count)，count 为 0 表示不绑定
+    static std::vector<std::pair<size_t, size_t>> coreBindings(const std::vector<Device> &devices, size_t cores_per_replica) {
+        std::vector<std::pair<size_t, size_t>> bindings(devices.size(), {0, 0});
+        if (cores_per_replica > 0) {
+            for (size_t i = 0; i < devices.size(); ++i) {
+                bindings[i] = {i * cores_per_replica, cores_per_replica};
+            }
+            return bindings;
+        }
+        size_t cpu_replicas = std::count_if(devices.begin(), devices.end(), [](const Device &d) { return d.getType() == Device::Type::CPU; });
+        if (cpu_replicas < 2) {
+            return bindings;
+        }
+        size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        size_t cores = std::max<size_t>(hardware / cpu_replicas, 1);
+        size_t next = 0;
+        for (size_t i = 0; i < devices.size(); ++i) {
+            if (devices[i].getType() == Device::Type::CPU) {
+                bindings[i] = {next * cores, cores};
+                ++next;
+            }
+        }
+        return bindings;
+    }
+
+    struct Job {
+        Tensor input;
+        std::promise<Tensor> result;
+    };
+
+    struct Worker {
+        Device device = Device::cpu();
+        std::shared_ptr<Model> model;
+        BoundedQueue<Job> jobs{1};
+        std::thread thread;
+    };
+
+    void run(Worker &worker, size_t index) {
+        // context 中的当前设备与 stream 按线程保存
+        context::setDevice(worker.device);
+        while (auto job = worker.jobs.pop()) {
+            try {
+                auto start = std::chrono::steady_clock::now();
+                Tensor shard = infinidemo::nn::debug::toDevice(job->input, worker.device);
+                if (!shard->is_contiguous()) {
+                    shard = shard->contiguous();
+                }
+                Tensor logits = worker.model->forward(shard);
+                context::syncStream();
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                {
+                    std::lock_guard<std::mutex> lock(stats_mutex_);
+                    stats_.replica_busy_ms[index] += ms;
+                }
+                job->result.set_value(logits);
+            } catch (...) {
+                job->result.set_exception(std::current_exception());
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    mutable std::mutex stats_mutex_;
+    DataParallelStats stats_;
+};
+
+} // namespace infinidemo::runtime
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "staging.hpp"
+#include <chrono>
+#include <cstddef>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <infinirt.h>
+#include <mutex>
+#include <vector>
+
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+struct RunnerStats {
+    size_t requests = 0;
+    size_t uploaded_bytes = 0;
+    size_t staging_bytes = 0; // pinned staging buffer 总大小
+    // forwardMany 中请求 i + 1 的上传在请求 i 的计算结束之前就已完成的次数（由设备 event 的时间戳判断，CPU 后端上为 0）
+    size_t overlapped_uploads = 0;
+    double wall_ms = 0.0;
+};
+
+// 请求级推理执行器：host 输入经 pinned staging buffer 异步上传，
+// forwardMany 在提交请求 i 的计算之前先在上传 stream 上提交请求 i + 1 的上传，两者在设备上重叠。
+// 模型需要提供不做设备同步的 forwardAsync，整批请求只在最后同步一次。
+// 每次调用期间持有模型的 forward_mutex，与直接在模型上 forward 的其它线程互斥；
+// 执行器自身的 staging 与统计不是线程安全的，并发调用者需要持有 forward_mutex()（释放 GIL 的绑定经 lockForward 持有）
+template <typename Model>
+class InferenceRunner {
+public:
+    InferenceRunner(Model &model, const Device &device, size_t depth = 2)
+        : model_(model), device_(device), uploader_(device, depth) {}
+
+    InferenceRunner(const InferenceRunner &) = delete;
+    InferenceRunner &operator=(const InferenceRunner &) = delete;
+
+    ~InferenceRunner() {
+        for (auto events : {&upload_events_, &compute_events_}) {
+            for (infinirtEvent_t event : *events) {
+                infinirtEventDestroy(event);
+            }
+        }
+    }
+
+    Tensor forward(const Tensor &input) {
+        auto start = std::chrono::steady_clock::now();
+        context::setDevice(device_);
+        UploadSlot slot = uploader_.stage(input);
+        Tensor output;
+        {
+            std::lock_guard<std::mutex> forward_lock(model_.forward_mutex());
+            output = model_.forwardAsync(slot.device);
+            uploader_.release(slot);
+            context::syncDevice();
+        }
+        record(1, start);
+        return output;
+    }
+
+    std::vector<Tensor> forwardMany(const std::vector<Tensor> &inputs) {
+        auto start = std::chrono::steady_clock::now();
+        context::setDevice(device_);
+        std::vector<Tensor> outputs;
+        outputs.reserve(inputs.size());
+        if (inputs.empty()) {
+            return outputs;
+        }
+        // depth >= 2 时请求 i + 1 先在上传 stream 上提交（stage 不让计算 stream 等待），请求 i 的计算只等待它自己的上传，
+        // 之间没有设备同步，两者在设备上重叠。stage 取得 slot 时要等待该 slot 上一次使用者的计算结束：
+        // depth == 2 时是请求 i - 1，depth >= 3 时是更早的请求，host 不会因此停顿。
+        // depth == 1 只有一个 slot，请求 i + 1 只能在请求 i 的 slot 释放之后上传
+        bool prefetch = uploader_.depth() >= 2;
+        bool measure = prefetch && !uploader_.onHost();
+        if (measure) {
+            ensureEvents(inputs.size());
+        }
+        std::vector<bool> uploaded(inputs.size(), false);
+
+        std::lock_guard<std::mutex> forward_lock(model_.forward_mutex());
+        UploadSlot current = uploader_.stage(inputs[0], false);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            UploadSlot next;
+            bool has_next = prefetch && ((i + 1) < inputs.size());
+            if (has_next) {
+                next = uploader_.stage(inputs[i + 1], false);
+                if (measure && uploader_.owns(next)) {
+                    INFINICORE_CHECK_ERROR(infinirtEventRecord(upload_events_[i + 1], uploader_.stream()));
+                    uploaded[i + 1] = true;
+                }
+            }
+            uploader_.wait(current);
+            outputs.push_back(model_.forwardAsync(current.device));
+            if (measure) {
+                INFINICORE_CHECK_ERROR(infinirtEventRecord(compute_events_[i], context::getStream()));
+            }
+            uploader_.release(current);
+            if (has_next) {
+                current = next;
+            } else if ((i + 1) < inputs.size()) {
+                current = uploader_.stage(inputs[i + 1], false);
+            }
+        }
+        context::syncDevice();
+
+        if (measure) {
+            // 两个 event 都已完成：上传完成的时间早于计算完成的时间即为重叠
+            for (size_t i = 0; (i + 1) < inputs.size(); ++i) {
+                if (!uploaded[i + 1]) {
+                    continue;
+                }
+                float ms = 0.0f;
+                INFINICORE_CHECK_ERROR(infinirtEventElapsedTime(&ms, upload_events_[i + 1], compute_events_[i]));
+                if (ms > 0.0f) {
+                    ++stats_.overlapped_uploads;
+                }
+            }
+        }
+        record(inputs.size(), start);
+        return outputs;
+    }
+
+    const RunnerStats &stats() const { return stats_; }
+    InputUploader &uploader() { return uploader_; }
+
+    // 保护执行器自身的 staging 与统计，见类注释
+    std::mutex &forward_mutex() const { return mutex_; }
+
+private:
+    void record(size_t requests, std::chrono::steady_clock::time_point start) {
+        stats_.requests += requests;
+        stats_.uploaded_bytes = uploader_.uploadedBytes();
+        stats_.staging_bytes = uploader_.pool().allocatedBytes();
+        stats_.wall_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 每个请求一对 event（上传完成、计算完成），按最大的请求数创建并复用
+    void ensureEvents(size_t count) {
+        for (auto events : {&upload_events_, &compute_events_}) {
+            while (events->size() < count) {
+                infinirtEvent_t event = nullptr;
+                INFINICORE_CHECK_ERROR(infinirtEventCreate(&event));
+                events->push_back(event);
+            }
+        }
+    }
+
+    Model &model_;
+    Device device_;
+    InputUploader uploader_;
+    RunnerStats stats_;
+    std::vector<infinirtEvent_t> upload_events_;
+    std::vector<infinirtEvent_t> compute_events_;
+    mutable std::mutex mutex_;
+};
+
+} // namespace infinidemo::runtime
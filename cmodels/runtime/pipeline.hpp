@@ -0,0 +1,357 @@
+#pragma once
+
+#include "../vision/image_processing.hpp"
+#include "bounded_queue.hpp"
+#include "postprocess.hpp"
+#include "staging.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 离线批量分类的流水线执行器：各阶段在独立线程中并发运行，阶段之间用有界队列连接
+//   preprocess（N 个线程：解码 + 缩放 + 裁剪）
+//     -> stage（凑 batch、归一化打包进 pinned buffer、异步 H2D）
+//     -> forward（模型推理）
+//     -> postprocess（D2H、softmax + top-k，在调用 run 的线程中执行）
+// 队列容量限制了在途的图像 / batch 数量，慢的阶段会对上游形成背压
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+// 输入源：按下标加载图像，可以并发调用
+struct ImageSource {
+    size_t size = 0;
+    std::function<vision::Image(size_t)> load;
+    std::function<std::string(size_t)> name;
+};
+
+// 目录下的 jpg / jpeg / png / bmp 文件，按文件名排序
+inline ImageSource directorySource(const std::string &directory) {
+    auto paths = std::make_shared<std::vector<std::string>>();
+    for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        std::string ext = entry.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        if ((ext == ".jpg") || (ext == ".jpeg") || (ext == ".png") || (ext == ".bmp")) {
+            paths->push_back(entry.path().string());
+        }
+    }
+    std::sort(paths->begin(), paths->end());
+
+    ImageSource source;
+    source.size = paths->size();
+    source.load = [paths](size_t i) { return vision::decodeImageFile((*paths)[i]); };
+    source.name = [paths](size_t i) { return (*paths)[i]; };
+    return source;
+}
+
+// 合成输入：每张图像由 seed 和下标确定，不读磁盘，用于测量除 IO 以外的吞吐
+inline ImageSource syntheticSource(size_t count, int width, int height, uint32_t seed = 0) {
+    ImageSource source;
+    source.size = count;
+    source.load = [width, height, seed](size_t i) {
+        vision::Image image;
+        image.width = width;
+        image.height = height;
+        image.data.resize(static_cast<size_t>(width) * height * 3);
+        uint32_t state = seed ^ static_cast<uint32_t>(i * 2654435761u);
+        for (auto &v : image.data) {
+            state = state * 1664525u + 1013904223u;
+            v = static_cast<uint8_t>(state >> 24);
+        }
+        return image;
+    };
+    source.name = [](size_t i) { return "synthetic_" + std::to_string(i); };
+    return source;
+}
+
+struct PipelineConfig {
+    size_t preprocess_threads = 4;
+    size_t batch_size = 8;
+    size_t queue_depth = 4; // 每个队列最多在途的 batch 数
+    size_t top_k = 5;
+    Device device = Device::cpu();
+};
+
+struct ClassificationResult {
+    size_t index = 0;
+    std::string name;
+    std::vector<Prediction> predictions;
+};
+
+struct StageStats {
+    std::string name;
+    size_t threads = 1;
+    size_t items = 0;
+    size_t batches = 0;
+    double busy_ms = 0.0; // 所有线程处理耗时之和
+    double wait_ms = 0.0; // 所有线程等待上下游队列耗时之和
+};
+
+struct PipelineReport {
+    size_t images = 0;
+    double wall_ms = 0.0;
+    std::vector<StageStats> stages;
+
+    double imagesPerSecond() const { return wall_ms > 0.0 ? images * 1000.0 / wall_ms : 0.0; }
+
+    // 每个阶段单独运行时的吞吐（items / (busy / threads)）与利用率，吞吐最低的阶段就是瓶颈
+    std::string toString() const {
+        std::ostringstream os;
+        os << std::left << std::setw(14) << "stage" << std::right << std::setw(8) << "threads" << std::setw(10)
+           << "items" << std::setw(10) << "batches" << std::setw(14) << "busy(ms)" << std::setw(14) << "wait(ms)"
+           << std::setw(14) << "items/s" << std::setw(8) << "util\n";
+        for (const auto &s : stages) {
+            double per_thread_s = s.busy_ms / 1000.0 / static_cast<double>(s.threads);
+            double util = wall_ms > 0.0 ? s.busy_ms / (wall_ms * static_cast<double>(s.threads)) : 0.0;
+            os << std::left << std::setw(14) << s.name << std::right << std::setw(8) << s.threads << std::setw(10)
+               << s.items << std::setw(10) << s.batches << std::fixed << std::setprecision(3) << std::setw(14)
+               << s.busy_ms << std::setw(14) << s.wait_ms << std::setprecision(1) << std::setw(14)
+               << (per_thread_s > 0.0 ? s.items / per_thread_s : 0.0) << std::setw(7) << util * 100.0 << "%\n";
+        }
+        os << "total: " << images << " images in " << std::fixed << std::setprecision(3) << wall_ms << " ms, "
+           << std::setprecision(1) << imagesPerSecond() << " images/s\n";
+        return os.str();
+    }
+};
+
+namespace detail {
+inline double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+} // namespace detail
+
+template <typename Model>
+class ClassificationPipeline {
+public:
+    using Sink = std::function<void(ClassificationResult &&)>;
+
+    ClassificationPipeline(Model &model, const vision::ImageProcessor &processor, const PipelineConfig &config)
+        : model_(model), processor_(processor), config_(config), head_(std::max<size_t>(config.top_k, 1)) {
+        config_.top_k = head_.topk();
+        config_.preprocess_threads = std::max<size_t>(config_.preprocess_threads, 1);
+        config_.batch_size = std::max<size_t>(config_.batch_size, 1);
+        config_.queue_depth = std::max<size_t>(config_.queue_depth, 1);
+    }
+
+    const PipelineConfig &config() const { return config_; }
+
+    // 处理 source 中的全部图像，sink 在调用线程中按完成顺序被调用（不保证与输入顺序一致，用 index 对应）
+    PipelineReport run(const ImageSource &source, const Sink &sink) {
+        BoundedQueue<Sample> decoded(config_.queue_depth * config_.batch_size);
+        BoundedQueue<Batch> staged(config_.queue_depth);
+        BoundedQueue<Batch> computed(config_.queue_depth);
+
+        // staged 队列中的 batch，加上 stage 与 forward 线程手里各一个
+        InputUploader uploader(config_.device, config_.queue_depth + 2);
+
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        auto fail = [&](std::exception_ptr e) {
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) {
+                    error = e;
+                }
+            }
+            decoded.close();
+            staged.close();
+            computed.close();
+            uploader.close();
+        };
+
+        PipelineReport report;
+        report.stages = {{"preprocess", config_.preprocess_threads}, {"stage+h2d"}, {"forward"}, {"postprocess"}};
+        std::vector<StageStats> preprocess_stats(config_.preprocess_threads);
+        auto start = std::chrono::steady_clock::now();
+
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> running{config_.preprocess_threads};
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < config_.preprocess_threads; ++t) {
+            workers.emplace_back([&, t]() {
+                StageStats &stats = preprocess_stats[t];
+                try {
+                    for (size_t i = next.fetch_add(1); i < source.size; i = next.fetch_add(1)) {
+                        auto t0 = std::chrono::steady_clock::now();
+                        Sample sample{i, processor_.transform(source.load(i))};
+                        stats.busy_ms += detail::elapsedMs(t0);
+                        auto t1 = std::chrono::steady_clock::now();
+                        bool pushed = decoded.push(std::move(sample));
+                        stats.wait_ms += detail::elapsedMs(t1);
+                        if (!pushed) {
+                            break;
+                        }
+                        ++stats.items;
+                    }
+                } catch (...) {
+                    fail(std::current_exception());
+                }
+                if (running.fetch_sub(1) == 1) {
+                    decoded.close();
+                }
+            });
+        }
+
+        workers.emplace_back([&]() {
+            StageStats &stats = report.stages[1];
+            try {
+                context::setDevice(config_.device);
+                std::vector<size_t> indices;
+                std::vector<vision::Image> images;
+                auto flush = [&]() {
+                    auto t0 = std::chrono::steady_clock::now();
+                    // 直接归一化写进 pinned staging buffer，再从那里异步上传，不经过 pageable 内存
+                    UploadSlot slot = uploader.acquire(processor_.batchShape(images), DataType::F32);
+                    processor_.pack(images, slot.host);
+                    Batch batch{std::move(indices), uploader.upload(slot), slot.index};
+                    // forward 在另一个线程（另一个 stream）上执行，交出去之前等待拷贝完成
+                    uploader.synchronize(slot);
+                    stats.busy_ms += detail::elapsedMs(t0);
+                    stats.items += images.size();
+                    ++stats.batches;
+                    indices.clear();
+                    images.clear();
+                    auto t1 = std::chrono::steady_clock::now();
+                    bool pushed = staged.push(std::move(batch));
+                    stats.wait_ms += detail::elapsedMs(t1);
+                    return pushed;
+                };
+                while (true) {
+                    auto t0 = std::chrono::steady_clock::now();
+                    auto sample = decoded.pop();
+                    stats.wait_ms += detail::elapsedMs(t0);
+                    if (!sample) {
+                        break;
+                    }
+                    indices.push_back(sample->index);
+                    images.push_back(std::move(sample->image));
+                    if ((images.size() == config_.batch_size) && !flush()) {
+                        break;
+                    }
+                }
+                if (!images.empty()) {
+                    flush();
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            staged.close();
+        });
+
+        workers.emplace_back([&]() {
+            StageStats &stats = report.stages[2];
+            try {
+                context::setDevice(config_.device);
+                while (true) {
+                    auto t0 = std::chrono::steady_clock::now();
+                    auto batch = staged.pop();
+                    stats.wait_ms += detail::elapsedMs(t0);
+                    if (!batch) {
+                        break;
+                    }
+                    auto t1 = std::chrono::steady_clock::now();
+                    Tensor logits;
+                    {
+                        // 其它线程（例如释放 GIL 的绑定）可能同时在这个模型上 forward
+                        std::lock_guard<std::mutex> forward_lock(model_.forward_mutex());
+                        logits = model_.forward(batch->tensor);
+                    }
+                    uploader.release(batch->slot);
+                    batch->tensor = logits;
+                    if (config_.device.getType() != Device::Type::CPU) {
+                        context::syncStream();
+                    }
+                    stats.busy_ms += detail::elapsedMs(t1);
+                    stats.items += batch->indices.size();
+                    ++stats.batches;
+                    auto t2 = std::chrono::steady_clock::now();
+                    bool pushed = computed.push(std::move(*batch));
+                    stats.wait_ms += detail::elapsedMs(t2);
+                    if (!pushed) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            computed.close();
+        });
+
+        StageStats &stats = report.stages[3];
+        try {
+            context::setDevice(config_.device);
+            while (true) {
+                auto t0 = std::chrono::steady_clock::now();
+                auto batch = computed.pop();
+                stats.wait_ms += detail::elapsedMs(t0);
+                if (!batch) {
+                    break;
+                }
+                auto t1 = std::chrono::steady_clock::now();
+                // softmax + top-k 在 logits 所在的设备上完成，只有 [N, k] 拷回 host
+                auto predictions = toPredictions(head_.forward(batch->tensor));
+                stats.busy_ms += detail::elapsedMs(t1);
+                for (size_t b = 0; b < batch->indices.size(); ++b) {
+                    size_t index = batch->indices[b];
+                    sink(ClassificationResult{index, source.name ? source.name(index) : std::string(), std::move(predictions[b])});
+                }
+                stats.items += batch->indices.size();
+                ++stats.batches;
+            }
+        } catch (...) {
+            fail(std::current_exception());
+        }
+
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        report.wall_ms = detail::elapsedMs(start);
+        report.images = stats.items;
+        for (const auto &s : preprocess_stats) {
+            report.stages[0].items += s.items;
+            report.stages[0].busy_ms += s.busy_ms;
+            report.stages[0].wait_ms += s.wait_ms;
+        }
+        return report;
+    }
+
+private:
+    struct Sample {
+        size_t index;
+        vision::Image image;
+    };
+
+    struct Batch {
+        std::vector<size_t> indices;
+        Tensor tensor; // stage 之后是输入，forward 之后是 logits
+        size_t slot;   // 输入所在的 staging slot，forward 提交后释放
+    };
+
+    Model &model_;
+    vision::ImageProcessor processor_;
+    PipelineConfig config_;
+    infinidemo::nn::modules::TopkSoftmax head_;
+};
+
+} // namespace infinidemo::runtime
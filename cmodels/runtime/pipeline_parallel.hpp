@@ -0,0 +1,369 @@
+#pragma once
+
+#include "../../nn/allocator.hpp"
+#include "../../nn/debug.hpp"
+#include "../../nn/profiler.hpp"
+#include "../../nn/segment.hpp"
+#include "bounded_queue.hpp"
+#include "data_parallel.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 流水线并行：把模型的前向段（nn::ForwardSegment）按开销切成若干连续的 stage，每个 stage 由一个常驻线程
+// 在自己的设备（或 CPU 核心组）上执行，stage 之间用有界队列传递 micro-batch。
+// 连续输入流下各 stage 同时处理不同的 micro-batch，吞吐由最慢的 stage 决定
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+struct PipelineParallelStats {
+    std::vector<std::string> stage_names; // 每个 stage 包含的段，例如 "embedder+stages.0"
+    std::vector<double> stage_costs;      // 切分时使用的开销：profiler 实测的 us，或估计的 FLOPs
+    bool measured_costs = false;          // stage_costs 是否来自 profiler
+    std::vector<double> stage_busy_ms;    // 每个 stage 的累计计算时间（含跨设备拷贝）
+    size_t runs = 0;
+    size_t micro_batches = 0;
+    size_t samples = 0;
+    double wall_ms = 0.0;
+    // 稳态：从每次 run 的第一个输出到最后一个输出，不含流水线的填充与排空
+    size_t steady_samples = 0;
+    double steady_ms = 0.0;
+
+    // stage 在 run 期间没有计算的时间：填充、排空、等待上游（饥饿）或等待下游（背压）
+    std::vector<double> stageBubbleMs() const {
+        std::vector<double> bubble;
+        for (double busy : stage_busy_ms) {
+            bubble.push_back(std::max(wall_ms - busy, 0.0));
+        }
+        return bubble;
+    }
+
+    double samplesPerSecond() const { return wall_ms > 0.0 ? samples * 1000.0 / wall_ms : 0.0; }
+    double steadySamplesPerSecond() const { return steady_ms > 0.0 ? steady_samples * 1000.0 / steady_ms : 0.0; }
+
+    std::string toString() const {
+        std::ostringstream os;
+        os << "stages: " << stage_names.size() << ", micro-batches: " << micro_batches << ", samples/s: " << samplesPerSecond()
+           << ", steady-state samples/s: " << steadySamplesPerSecond() << ", costs: " << (measured_costs ? "profiler" : "estimated FLOPs") << "\n";
+        os << std::left << std::setw(8) << "stage" << std::setw(40) << "segments" << std::right << std::setw(14) << "cost"
+           << std::setw(14) << "busy(ms)" << std::setw(14) << "bubble(ms)" << std::setw(10) << "bubble%" << "\n";
+        std::vector<double> bubble = stageBubbleMs();
+        for (size_t i = 0; i < stage_names.size(); ++i) {
+            os << std::left << std::setw(8) << i << std::setw(40) << stage_names[i] << std::right << std::fixed << std::setprecision(3)
+               << std::setw(14) << std::defaultfloat << stage_costs[i] << std::fixed << std::setw(14) << stage_busy_ms[i]
+               << std::setw(14) << bubble[i] << std::setw(10) << std::setprecision(1) << (wall_ms > 0.0 ? bubble[i] * 100.0 / wall_ms : 0.0)
+               << std::defaultfloat << "\n";
+        }
+        return os.str();
+    }
+};
+
+// 每段的开销：profiler 中有所有段的 module 记录时使用平均 wall time（us），否则使用 FLOPs 估计。
+// 两种单位不能混用，只要有一段缺少记录就全部退回估计值
+inline std::vector<double> segmentCosts(const std::vector<infinidemo::nn::ForwardSegment> &segments, bool *measured = nullptr) {
+    std::vector<double> costs;
+    std::vector<infinidemo::nn::profiler::LayerSummary> rows = infinidemo::nn::profiler::Profiler::instance().summary();
+    bool complete = !rows.empty();
+    for (const auto &segment : segments) {
+        double us = 0.0;
+        for (const auto &module : segment.modules) {
+            auto it = std::find_if(rows.begin(), rows.end(), [&module](const auto &row) {
+                return (row.category == "module") && (row.name == module) && (row.calls > 0);
+            });
+            if (it == rows.end()) {
+                complete = false;
+                break;
+            }
+            us += it->total_wall_us / static_cast<double>(it->calls);
+        }
+        if (!complete) {
+            break;
+        }
+        costs.push_back(us);
+    }
+    if (!complete) {
+        costs.clear();
+        for (const auto &segment : segments) {
+            costs.push_back(segment.flops);
+        }
+    }
+    if (measured != nullptr) {
+        *measured = complete;
+    }
+    return costs;
+}
+
+// 把 costs 切成 parts 个连续区间并使最大区间和最小（段数很少，直接 DP）。
+// 返回 parts + 1 个边界，第 i 个区间为 [bounds[i], bounds[i + 1])
+inline std::vector<size_t> partitionBalanced(const std::vector<double> &costs, size_t parts) {
+    size_t n = costs.size();
+    parts = std::max<size_t>(std::min(parts, n), 1);
+    std::vector<double> prefix(n + 1, 0.0);
+    for (size_t i = 0; i < n; ++i) {
+        prefix[i + 1] = prefix[i] + costs[i];
+    }
+    const double inf = std::numeric_limits<double>::infinity();
+    // best[k][i]：前 i 段切成 k 个区间时的最大区间和，cut[k][i] 为最后一个区间的起点
+    std::vector<std::vector<double>> best(parts + 1, std::vector<double>(n + 1, inf));
+    std::vector<std::vector<size_t>> cut(parts + 1, std::vector<size_t>(n + 1, 0));
+    best[0][0] = 0.0;
+    for (size_t k = 1; k <= parts; ++k) {
+        for (size_t i = k; i <= n; ++i) {
+            for (size_t j = k - 1; j < i; ++j) {
+                double value = std::max(best[k - 1][j], prefix[i] - prefix[j]);
+                if (value < best[k][i]) {
+                    best[k][i] = value;
+                    cut[k][i] = j;
+                }
+            }
+        }
+    }
+    std::vector<size_t> bounds(parts + 1, n);
+    for (size_t k = parts, i = n; k > 0; --k) {
+        bounds[k] = i;
+        i = cut[k][i];
+        bounds[k - 1] = i;
+    }
+    return bounds;
+}
+
+template <typename Model>
+class PipelineParallel {
+public:
+    // 为 device 创建一个模型副本（参数已在 device 上），每个 stage 只执行自己副本中分到的段
+    using Factory = std::function<std::shared_ptr<Model>(const Device &)>;
+
+    // devices 的长度为 stage 数（超过段数时截断），同一设备可以重复出现（例如多个 CPU 核心组）。
+    // micro_batch_shape 用于估计各段开销并预先填充形状缓存；queue_depth 为 stage 之间可以缓存的 micro-batch 数；
+    // cores_per_stage > 0 时第 i 个 stage 的线程绑定到第 i 组 cores_per_stage 个核心
+    PipelineParallel(const Factory &factory, const std::vector<Device> &devices, const Shape &micro_batch_shape,
+                     size_t queue_depth = 2, size_t cores_per_stage = 0)
+        : output_(queue_depth) {
+        if (devices.empty()) {
+            throw std::runtime_error("PipelineParallel: no devices");
+        }
+        std::shared_ptr<Model> first = factory(devices[0]);
+        std::vector<infinidemo::nn::ForwardSegment> segments = first->segments(micro_batch_shape);
+        if (segments.empty()) {
+            throw std::runtime_error("PipelineParallel: model has no segments");
+        }
+        std::vector<double> costs = segmentCosts(segments, &stats_.measured_costs);
+        std::vector<size_t> bounds = partitionBalanced(costs, devices.size());
+
+        size_t num_stages = bounds.size() - 1;
+        for (size_t s = 0; s < num_stages; ++s) {
+            auto stage = std::make_unique<Stage>(queue_depth);
+            stage->device = devices[s];
+            stage->model = (s == 0) ? first : factory(devices[s]);
+            std::vector<infinidemo::nn::ForwardSegment> own = (s == 0) ? segments : stage->model->segments(micro_batch_shape);
+            std::string name;
+            double cost = 0.0;
+            for (size_t i = bounds[s]; i < bounds[s + 1]; ++i) {
+                name += (name.empty() ? "" : "+") + own[i].name;
+                cost += costs[i];
+                stage->segments.push_back(std::move(own[i]));
+            }
+            stats_.stage_names.push_back(name);
+            stats_.stage_costs.push_back(cost);
+            stages_.push_back(std::move(stage));
+        }
+        stats_.stage_busy_ms.assign(num_stages, 0.0);
+
+        for (size_t s = 0; s < num_stages; ++s) {
+            Stage *stage = stages_[s].get();
+            BoundedQueue<Item> *next = (s + 1 < num_stages) ? &stages_[s + 1]->input : &output_;
+            stage->thread = std::thread([this, stage, next, s, cores_per_stage]() {
+                if (cores_per_stage > 0) {
+                    detail::bindCurrentThread(s * cores_per_stage, cores_per_stage);
+                }
+                run(*stage, *next, s);
+            });
+        }
+    }
+
+    PipelineParallel(const PipelineParallel &) = delete;
+    PipelineParallel &operator=(const PipelineParallel &) = delete;
+
+    ~PipelineParallel() {
+        for (auto &stage : stages_) {
+            stage->input.close();
+        }
+        output_.close();
+        for (auto &stage : stages_) {
+            if (stage->thread.joinable()) {
+                stage->thread.join();
+            }
+        }
+    }
+
+    // 把一串 micro-batch 送入流水线，按输入顺序返回各自的输出（位于最后一个 stage 的设备上）
+    std::vector<Tensor> run(const std::vector<Tensor> &micro_batches) {
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        std::vector<Tensor> outputs;
+        if (micro_batches.empty()) {
+            return outputs;
+        }
+        auto start = std::chrono::steady_clock::now();
+        // 生产者单独一个线程，调用线程收集输出，输入流比队列长时也不会死锁
+        std::thread feeder([this, &micro_batches]() {
+            for (size_t i = 0; i < micro_batches.size(); ++i) {
+                if (!stages_[0]->input.push(Item{i, micro_batches[i], nullptr})) {
+                    return;
+                }
+            }
+        });
+
+        std::exception_ptr error;
+        size_t samples = 0;
+        size_t first_samples = 0;
+        std::chrono::steady_clock::time_point first_output;
+        outputs.reserve(micro_batches.size());
+        for (size_t i = 0; i < micro_batches.size(); ++i) {
+            auto item = output_.pop();
+            if (!item) {
+                error = std::make_exception_ptr(std::runtime_error("PipelineParallel: pipeline stopped"));
+                break;
+            }
+            if (item->error && !error) {
+                error = item->error;
+            }
+            size_t batch = micro_batches[item->index]->shape()[0];
+            samples += batch;
+            if (i == 0) {
+                first_output = std::chrono::steady_clock::now();
+                first_samples = batch;
+            }
+            outputs.push_back(item->tensor);
+        }
+        feeder.join();
+        auto end = std::chrono::steady_clock::now();
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.runs += 1;
+        stats_.micro_batches += micro_batches.size();
+        stats_.samples += samples;
+        stats_.wall_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        stats_.steady_samples += samples - first_samples;
+        stats_.steady_ms += std::chrono::duration<double, std::milli>(end - first_output).count();
+        return outputs;
+    }
+
+    // input [N, ...] 沿 N 切成每份 micro_batch 个样本（最后一份可以更小），结果按原顺序拼接在 input 所在的设备上
+    Tensor forward(const Tensor &input, size_t micro_batch) {
+        size_t batch = input->shape()[0];
+        if ((batch == 0) || (micro_batch == 0)) {
+            throw std::runtime_error("PipelineParallel: empty batch");
+        }
+        std::vector<Tensor> micro_batches;
+        for (size_t offset = 0; offset < batch; offset += micro_batch) {
+            micro_batches.push_back(input->narrow({{0, offset, std::min(micro_batch, batch - offset)}}));
+        }
+        std::vector<Tensor> results = run(micro_batches);
+
+        Tensor output;
+        size_t offset = 0;
+        for (const auto &result : results) {
+            Tensor part = infinidemo::nn::debug::toDevice(result, input->device());
+            if (!output) {
+                Shape shape = part->shape();
+                shape[0] = batch;
+                output = infinidemo::nn::empty(shape, part->dtype(), input->device());
+            }
+            size_t count = part->shape()[0];
+            output->narrow({{0, offset, count}})->copy_from(part);
+            offset += count;
+        }
+        return output;
+    }
+
+    size_t stages() const { return stages_.size(); }
+
+    PipelineParallelStats stats() const {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return stats_;
+    }
+
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.runs = 0;
+        stats_.micro_batches = 0;
+        stats_.samples = 0;
+        stats_.wall_ms = 0.0;
+        stats_.steady_samples = 0;
+        stats_.steady_ms = 0.0;
+        std::fill(stats_.stage_busy_ms.begin(), stats_.stage_busy_ms.end(), 0.0);
+    }
+
+private:
+    // 出错的 micro-batch 带着 error 继续向下游传递，保证每个输入都有一个输出，run 收齐之后再抛出
+    struct Item {
+        size_t index = 0;
+        Tensor tensor;
+        std::exception_ptr error;
+    };
+
+    struct Stage {
+        explicit Stage(size_t queue_depth) : input(queue_depth) {}
+        Device device = Device::cpu();
+        std::shared_ptr<Model> model;
+        std::vector<infinidemo::nn::ForwardSegment> segments;
+        BoundedQueue<Item> input;
+        std::thread thread;
+    };
+
+    void run(Stage &stage, BoundedQueue<Item> &next, size_t index) {
+        // context 中的当前设备与 stream 按线程保存
+        context::setDevice(stage.device);
+        while (auto item = stage.input.pop()) {
+            if (!item->error) {
+                try {
+                    auto start = std::chrono::steady_clock::now();
+                    Tensor hidden_state = infinidemo::nn::debug::toDevice(item->tensor, stage.device);
+                    if (!hidden_state->is_contiguous()) {
+                        hidden_state = hidden_state->contiguous();
+                    }
+                    for (auto &segment : stage.segments) {
+                        hidden_state = segment.forward(hidden_state);
+                    }
+                    // 下一个 stage 在另一个线程（另一个 stream）上读取结果
+                    context::syncStream();
+                    item->tensor = hidden_state;
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                    std::lock_guard<std::mutex> lock(stats_mutex_);
+                    stats_.stage_busy_ms[index] += ms;
+                } catch (...) {
+                    item->tensor = Tensor();
+                    item->error = std::current_exception();
+                }
+            }
+            if (!next.push(std::move(*item))) {
+                return;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<Stage>> stages_;
+    BoundedQueue<Item> output_;
+    std::mutex run_mutex_;
+    mutable std::mutex stats_mutex_;
+    PipelineParallelStats stats_;
+};
+
+} // namespace infinidemo::runtime
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../../nn/debug.hpp"
+#include "../../nn/modules/topksoftmax.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <infinicore/tensor.hpp>
+#include <stdexcept>
+#include <vector>
+
+// 分类结果的后处理：数值稳定的 softmax + top-k，替代 Python 端的 numpy softmax / argmax。
+// host 上的 softmaxTopK 需要整行 logits；logits 在设备上时用 nn::modules::TopkSoftmax 在设备上计算，再由 toPredictions 只拷回 [N, k]
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+struct Prediction {
+    size_t label = 0;
+    float prob = 0.0f;
+};
+
+// 对一行 logits 求 softmax 后取概率最大的 k 个，按概率从大到小排列。
+// softmax 单调，直接在 logit 上部分排序，只对选中的 k 个计算概率
+inline std::vector<Prediction> softmaxTopK(const float *logits, size_t num_classes, size_t k) {
+    k = std::min(k, num_classes);
+    if (k == 0) {
+        return {};
+    }
+    float max_logit = *std::max_element(logits, logits + num_classes);
+    double denom = 0.0;
+    for (size_t i = 0; i < num_classes; ++i) {
+        denom += std::exp(static_cast<double>(logits[i] - max_logit));
+    }
+
+    std::vector<size_t> order(num_classes);
+    for (size_t i = 0; i < num_classes; ++i) {
+        order[i] = i;
+    }
+    std::partial_sort(order.begin(), order.begin() + k, order.end(), [logits](size_t a, size_t b) {
+        return (logits[a] > logits[b]) || ((logits[a] == logits[b]) && (a < b));
+    });
+
+    std::vector<Prediction> result(k);
+    for (size_t i = 0; i < k; ++i) {
+        result[i].label = order[i];
+        result[i].prob = static_cast<float>(std::exp(static_cast<double>(logits[order[i]] - max_logit)) / denom);
+    }
+    return result;
+}
+
+// logits 为 F32 的 [N, num_classes]，可以在任意设备上，结果每行一个 vector
+inline std::vector<std::vector<Prediction>> softmaxTopK(const Tensor &logits, size_t k) {
+    if ((logits->ndim() != 2) || (logits->dtype() != DataType::F32)) {
+        throw std::runtime_error("softmaxTopK: expected F32 logits of shape [N, num_classes]");
+    }
+    Tensor host = infinidemo::nn::debug::toDevice(logits, Device::cpu())->contiguous();
+    size_t rows = host->shape()[0];
+    size_t num_classes = host->shape()[1];
+    const float *data = reinterpret_cast<const float *>(host->data());
+
+    std::vector<std::vector<Prediction>> result(rows);
+    for (size_t r = 0; r < rows; ++r) {
+        result[r] = softmaxTopK(data + r * num_classes, num_classes, k);
+    }
+    return result;
+}
+
+// nn::modules::TopkSoftmax 的输出（可以在任意设备上）：只把 [N, k] 的概率与下标拷回 host，按行展开
+inline std::vector<std::vector<Prediction>> toPredictions(const infinidemo::nn::modules::TopkSoftmaxOutput &output) {
+    Tensor values = infinidemo::nn::debug::toDevice(output.values, Device::cpu())->contiguous();
+    Tensor indices = infinidemo::nn::debug::toDevice(output.indices, Device::cpu())->contiguous();
+    size_t rows = values->shape()[0];
+    size_t k = values->shape()[1];
+    const float *probs = reinterpret_cast<const float *>(values->data());
+    const int32_t *labels = reinterpret_cast<const int32_t *>(indices->data());
+
+    std::vector<std::vector<Prediction>> result(rows, std::vector<Prediction>(k));
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t i = 0; i < k; ++i) {
+            result[r][i].label = static_cast<size_t>(labels[r * k + i]);
+            result[r][i].prob = probs[r * k + i];
+        }
+    }
+    return result;
+}
+
+} // namespace infinidemo::runtime
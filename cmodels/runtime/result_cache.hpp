@@ -0,0 +1,268 @@
+#pragma once
+
+#include "../../nn/allocator.hpp"
+#include "../../nn/debug.hpp"
+#include "content_hash.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 按内容寻址的推理结果缓存：输入的每个样本按字节内容 + 形状 + dtype 哈希，命中时直接返回缓存的输出行，
+// batch 中只有未命中的样本（同一 batch 内重复的样本只算一次）组成子 batch 进入 forward。
+// LRU 淘汰，按缓存的输出字节数与条目数设上限
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+struct ResultCacheConfig {
+    size_t max_bytes = size_t(256) << 20; // 缓存的输出 tensor 总字节数上限
+    size_t max_entries = 0;               // 0 表示不限条目数
+};
+
+struct ResultCacheStats {
+    size_t lookups = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t hashed_bytes = 0;
+    double hash_ms = 0.0;
+
+    double hitRate() const { return lookups > 0 ? static_cast<double>(hits) / lookups : 0.0; }
+
+    std::string toString() const {
+        std::ostringstream os;
+        os << "lookups: " << lookups << ", hits: " << hits << ", misses: " << misses << ", hit rate: " << hitRate() * 100.0
+           << "%, evictions: " << evictions << ", entries: " << entries << ", bytes: " << bytes << ", hash: " << hash_ms << " ms";
+        return os.str();
+    }
+};
+
+// 128 位摘要：命中时比较全部 128 位而不只是哈希表使用的 64 位，不同输入被误判为相同的概率可以忽略
+struct ResultCacheKey {
+    ContentDigest digest;
+    Shape shape;
+    DataType dtype = DataType::F32;
+
+    bool operator==(const ResultCacheKey &other) const {
+        return (digest == other.digest) && (dtype == other.dtype) && (shape == other.shape);
+    }
+};
+
+struct ResultCacheKeyHash {
+    size_t operator()(const ResultCacheKey &key) const { return static_cast<size_t>(key.digest.lo); }
+};
+
+// bytes 为一个样本的内容，shape 与 dtype 混入 seed，相同字节、不同形状的输入不会共享结果
+inline ResultCacheKey resultCacheKey(const void *bytes, size_t size, const Shape &shape, const DataType &dtype) {
+    uint64_t seed = static_cast<uint64_t>(dtype);
+    for (Size s : shape) {
+        seed = content_hash::avalanche(seed ^ static_cast<uint64_t>(s));
+    }
+    return ResultCacheKey{hashBytes128(bytes, size, seed), shape, dtype};
+}
+
+class ResultCache {
+public:
+    explicit ResultCache(const ResultCacheConfig &config = ResultCacheConfig()) : config_(config) {}
+
+    ResultCache(const ResultCache &) = delete;
+    ResultCache &operator=(const ResultCache &) = delete;
+
+    // 命中时把条目移到 LRU 头部并返回缓存的 tensor，否则返回空 tensor
+    Tensor find(const ResultCacheKey &key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.lookups;
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++stats_.misses;
+            return Tensor();
+        }
+        ++stats_.hits;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->value;
+    }
+
+    // value 应是独立持有内存的 tensor（不是更大 tensor 的视图），否则字节统计不准确。
+    // 单个条目超过 max_bytes 时不缓存
+    void insert(const ResultCacheKey &key, const Tensor &value) {
+        size_t bytes = infinidemo::nn::numBytes(value->shape(), value->dtype());
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (bytes > config_.max_bytes) {
+            return;
+        }
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            stats_.bytes -= it->second->bytes;
+            entries_.erase(it->second);
+            index_.erase(it);
+        }
+        entries_.push_front(Entry{key, value, bytes});
+        index_[key] = entries_.begin();
+        stats_.bytes += bytes;
+        while ((stats_.bytes > config_.max_bytes) || ((config_.max_entries > 0) && (entries_.size() > config_.max_entries))) {
+            const Entry &victim = entries_.back();
+            stats_.bytes -= victim.bytes;
+            index_.erase(victim.key);
+            entries_.pop_back();
+            ++stats_.evictions;
+        }
+        stats_.entries = entries_.size();
+    }
+
+    void recordHash(size_t bytes, double ms) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.hashed_bytes += bytes;
+        stats_.hash_ms += ms;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        index_.clear();
+        stats_.entries = 0;
+        stats_.bytes = 0;
+    }
+
+    // 只清零计数，保留缓存内容
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ResultCacheStats fresh;
+        fresh.entries = stats_.entries;
+        fresh.bytes = stats_.bytes;
+        stats_ = fresh;
+    }
+
+    ResultCacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    const ResultCacheConfig &config() const { return config_; }
+
+private:
+    struct Entry {
+        ResultCacheKey key;
+        Tensor value;
+        size_t bytes = 0;
+    };
+
+    ResultCacheConfig config_;
+    std::list<Entry> entries_; // 头部为最近使用
+    std::unordered_map<ResultCacheKey, std::list<Entry>::iterator, ResultCacheKeyHash> index_;
+    mutable std::mutex mutex_;
+    ResultCacheStats stats_;
+};
+
+// model.forward 前面的逐样本结果缓存。输入在设备上时先整体拷回 host 计算哈希（一次 D2H），
+// 因此最适合放在上传之前、输入仍在 host 上的位置。模型的参数版本变化（to()、load_state_dict() 等）后缓存整体失效
+template <typename Model>
+class CachedModel {
+public:
+    CachedModel(Model &model, const ResultCacheConfig &config = ResultCacheConfig())
+        : model_(model), cache_(config), parameter_version_(model.parameter_version()) {}
+
+    // input [N, ...]，返回与 model.forward(input) 相同的 [N, ...] 输出，位于模型输出所在的设备上。
+    // 命中的行从缓存拷贝（返回的 tensor 可以被调用方修改而不影响缓存）
+    Tensor forward(const Tensor &input) {
+        uint64_t version = model_.parameter_version();
+        if (parameter_version_.exchange(version) != version) {
+            cache_.clear();
+        }
+        size_t batch = input->shape()[0];
+        Shape sample_shape(input->shape().begin() + 1, input->shape().end());
+        size_t sample_bytes = infinidemo::nn::numBytes(sample_shape, input->dtype());
+
+        auto hash_start = std::chrono::steady_clock::now();
+        Tensor host = infinidemo::nn::debug::toDevice(input, Device::cpu());
+        if (!host->is_contiguous()) {
+            host = host->contiguous();
+        }
+        std::vector<ResultCacheKey> keys;
+        keys.reserve(batch);
+        for (size_t i = 0; i < batch; ++i) {
+            keys.push_back(resultCacheKey(host->data() + i * sample_bytes, sample_bytes, sample_shape, input->dtype()));
+        }
+        cache_.recordHash(batch * sample_bytes, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - hash_start).count());
+
+        // rows[i]：命中时为缓存的 [1, ...] 输出行；未命中的样本记录它在子 batch 中的位置
+        std::vector<Tensor> rows(batch);
+        std::vector<size_t> miss_slot(batch, 0);
+        std::vector<size_t> misses;
+        std::unordered_map<ResultCacheKey, size_t, ResultCacheKeyHash> pending;
+        for (size_t i = 0; i < batch; ++i) {
+            auto it = pending.find(keys[i]);
+            if (it != pending.end()) {
+                miss_slot[i] = it->second;
+                continue;
+            }
+            rows[i] = cache_.find(keys[i]);
+            if (!rows[i]) {
+                miss_slot[i] = misses.size();
+                pending.emplace(keys[i], misses.size());
+                misses.push_back(i);
+            }
+        }
+
+        Tensor computed;
+        std::unique_lock<std::mutex> forward_lock(model_.forward_mutex(), std::defer_lock);
+        if (!misses.empty()) {
+            forward_lock.lock();
+        }
+        if (misses.size() == batch) {
+            Tensor whole = input;
+            computed = model_.forward(whole);
+        } else if (!misses.empty()) {
+            Shape miss_shape = input->shape();
+            miss_shape[0] = misses.size();
+            Tensor miss_batch = infinidemo::nn::empty(miss_shape, input->dtype(), input->device());
+            for (size_t j = 0; j < misses.size(); ++j) {
+                miss_batch->narrow({{0, j, 1}})->copy_from(input->narrow({{0, misses[j], 1}}));
+            }
+            computed = model_.forward(miss_batch);
+        }
+        if (computed) {
+            for (size_t j = 0; j < misses.size(); ++j) {
+                // 缓存独立的副本，不引用整个输出 tensor
+                Tensor row = computed->narrow({{0, j, 1}});
+                Tensor owned = infinidemo::nn::empty(row->shape(), row->dtype(), row->device());
+                owned->copy_from(row);
+                cache_.insert(keys[misses[j]], owned);
+            }
+            if (misses.size() == batch) {
+                return computed;
+            }
+        }
+
+        const Tensor &reference = computed ? computed : rows[0];
+        Shape output_shape = reference->shape();
+        output_shape[0] = batch;
+        Tensor output = infinidemo::nn::empty(output_shape, reference->dtype(), reference->device());
+        for (size_t i = 0; i < batch; ++i) {
+            Tensor source = rows[i] ? rows[i] : computed->narrow({{0, miss_slot[i], 1}});
+            output->narrow({{0, i, 1}})->copy_from(source);
+        }
+        return output;
+    }
+
+    ResultCache &cache() { return cache_; }
+    const ResultCache &cache() const { return cache_; }
+    Model &model() { return model_; }
+
+private:
+    Model &model_;
+    ResultCache cache_;
+    std::atomic<uint64_t> parameter_version_; // 缓存内容对应的模型参数版本
+};
+
+} // namespace infinidemo::runtime
@@ -0,0 +1,314 @@
+#pragma once
+
+#include "../../nn/allocator.hpp"
+#include "../../nn/debug.hpp"
+#include "../vision/image_processing.hpp"
+#include "staging.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 形状分桶：任意尺寸的输入图像先映射到少量预先配置的 bucket 尺寸（填充或缩放），
+// 同一 bucket 的请求拼成一个 batch。每个 bucket 在构造时就准备好执行状态：
+// 各 batch 大小的形状缓存（model.prepare），以及按最大 bucket 预先分配的 pinned staging slot（InputUploader），
+// 因此在线上不会因为新的 H/W 再做形状推导或分配打包 buffer，打包结果经上传 stream 异步拷贝到设备。
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+enum class BucketPolicy {
+    // 放进能容纳原图的最小 bucket，右侧与下方用均值颜色填充（归一化后为 0）；
+    // 比最大 bucket 还大的图像先等比缩小。填充区域会参与全局池化，结果与原图推理不完全相同
+    Pad,
+    // 直接缩放到面积最接近的 bucket，不保持宽高比，没有填充
+    Resize,
+};
+
+struct ShapeBucket {
+    int width = 224;
+    int height = 224;
+};
+
+struct BucketingConfig {
+    std::vector<ShapeBucket> buckets = {{224, 224}};
+    BucketPolicy policy = BucketPolicy::Pad;
+    size_t max_batch = 32;
+    vision::Resample resample = vision::Resample::Bilinear;
+};
+
+struct BucketStats {
+    ShapeBucket bucket;
+    size_t requests = 0;
+    size_t batches = 0;
+    size_t resized = 0;        // 需要缩放的请求数（Pad 策略下为超过最大 bucket 的图像）
+    double image_pixels = 0.0; // 放进 bucket 的图像像素（缩放之后）
+    double bucket_pixels = 0.0;
+    double forward_ms = 0.0;
+
+    // bucket 中填充像素的占比，即浪费在填充上的计算比例
+    double paddingWaste() const { return bucket_pixels > 0.0 ? 1.0 - image_pixels / bucket_pixels : 0.0; }
+};
+
+struct BucketingStats {
+    std::vector<BucketStats> buckets;
+    size_t requests = 0;
+
+    double hitRate(size_t bucket) const { return requests > 0 ? static_cast<double>(buckets.at(bucket).requests) / requests : 0.0; }
+
+    double paddingWaste() const {
+        double image = 0.0;
+        double total = 0.0;
+        for (const auto &b : buckets) {
+            image += b.image_pixels;
+            total += b.bucket_pixels;
+        }
+        return total > 0.0 ? 1.0 - image / total : 0.0;
+    }
+
+    std::string toString() const {
+        std::ostringstream os;
+        os << "requests: " << requests << ", padding waste: " << std::fixed << std::setprecision(1) << paddingWaste() * 100.0 << "%\n";
+        os << std::left << std::setw(12) << "bucket" << std::right << std::setw(10) << "requests" << std::setw(10) << "hit%"
+           << std::setw(10) << "batches" << std::setw(10) << "resized" << std::setw(10) << "waste%" << std::setw(14) << "forward(ms)" << "\n";
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            const auto &b = buckets[i];
+            os << std::left << std::setw(12) << (std::to_string(b.bucket.width) + "x" + std::to_string(b.bucket.height)) << std::right
+               << std::setw(10) << b.requests << std::setw(10) << hitRate(i) * 100.0 << std::setw(10) << b.batches << std::setw(10) << b.resized
+               << std::setw(10) << b.paddingWaste() * 100.0 << std::setw(14) << b.forward_ms << "\n";
+        }
+        return os.str();
+    }
+};
+
+// 选择 bucket。Pad：能容纳 width x height 的面积最小的 bucket，都放不下时取面积最大的；
+// Resize：面积最接近的 bucket，相同时取宽高比更接近的
+inline size_t chooseBucket(const std::vector<ShapeBucket> &buckets, BucketPolicy policy, int width, int height) {
+    if (buckets.empty()) {
+        throw std::runtime_error("chooseBucket: no buckets configured");
+    }
+    auto area = [](const ShapeBucket &b) { return static_cast<double>(b.width) * b.height; };
+    size_t best = 0;
+    if (policy == BucketPolicy::Pad) {
+        bool fits = false;
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            bool contains = (buckets[i].width >= width) && (buckets[i].height >= height);
+            if (contains && (!fits || (area(buckets[i]) < area(buckets[best])))) {
+                best = i;
+                fits = true;
+            } else if (!fits && (area(buckets[i]) > area(buckets[best]))) {
+                best = i;
+            }
+        }
+        return best;
+    }
+    double image_area = static_cast<double>(width) * height;
+    double aspect = static_cast<double>(width) / std::max(height, 1);
+    double best_area_diff = std::numeric_limits<double>::infinity();
+    double best_aspect_diff = std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        double area_diff = std::fabs(std::log(area(buckets[i]) / std::max(image_area, 1.0)));
+        double aspect_diff = std::fabs(std::log(static_cast<double>(buckets[i].width) / buckets[i].height / aspect));
+        if ((area_diff < best_area_diff) || ((area_diff == best_area_diff) && (aspect_diff < best_aspect_diff))) {
+            best = i;
+            best_area_diff = area_diff;
+            best_aspect_diff = aspect_diff;
+        }
+    }
+    return best;
+}
+
+template <typename Model>
+class ShapeBucketer {
+public:
+    // 为每个 bucket、每个 batch 大小 1..max_batch 预先执行 model.prepare，并按最大的 bucket 分配 staging slot
+    ShapeBucketer(Model &model, const vision::ImageProcessor &processor, const BucketingConfig &config, const Device &device = Device::cpu())
+        : model_(model), processor_(processor), config_(config), device_(device), uploader_(device) {
+        if (config_.buckets.empty()) {
+            throw std::runtime_error("ShapeBucketer: no buckets configured");
+        }
+        if (processor_.config().layout != vision::Layout::NCHW) {
+            throw std::runtime_error("ShapeBucketer: the processor must produce NCHW batches");
+        }
+        config_.max_batch = std::max<size_t>(config_.max_batch, 1);
+        // 填充颜色取均值，归一化（或 fold_scale 的减均值）之后为 0，与卷积的零填充一致
+        for (int c = 0; c < 3; ++c) {
+            float value = processor_.config().do_normalize ? processor_.config().image_mean[c] / processor_.config().rescale_factor : 0.0f;
+            fill_[c] = static_cast<uint8_t>(std::clamp(std::lround(value), 0L, 255L));
+        }
+        context::setDevice(device_);
+        size_t max_pixels = 0;
+        for (const auto &bucket : config_.buckets) {
+            if ((bucket.width <= 0) || (bucket.height <= 0)) {
+                throw std::runtime_error("ShapeBucketer: invalid bucket size");
+            }
+            for (size_t n = 1; n <= config_.max_batch; ++n) {
+                model_.prepare({n, 3, static_cast<size_t>(bucket.height), static_cast<size_t>(bucket.width)});
+            }
+            max_pixels = std::max(max_pixels, static_cast<size_t>(bucket.width) * static_cast<size_t>(bucket.height));
+            BucketStats stats;
+            stats.bucket = bucket;
+            stats_.buckets.push_back(stats);
+        }
+        // 每个 slot 都按最大的 batch 分配一次，之后任何 bucket 的 batch 都放得下
+        for (size_t i = 0; i < uploader_.depth(); ++i) {
+            UploadSlot slot = uploader_.acquire({config_.max_batch, 3, max_pixels}, DataType::F32);
+            uploader_.release(slot);
+        }
+    }
+
+    ShapeBucketer(const ShapeBucketer &) = delete;
+    ShapeBucketer &operator=(const ShapeBucketer &) = delete;
+
+    size_t bucketFor(int width, int height) const { return chooseBucket(config_.buckets, config_.policy, width, height); }
+
+    // 把图像放进第 index 个 bucket：Pad 策略下返回的图像为 bucket 尺寸，原图位于左上角；
+    // image_pixels 返回其中真实图像的像素数
+    vision::Image fit(const vision::Image &image, size_t index, double *image_pixels = nullptr, bool *resized = nullptr) const {
+        const ShapeBucket &bucket = config_.buckets.at(index);
+        if (config_.policy == BucketPolicy::Resize) {
+            bool needs_resize = (image.width != bucket.width) || (image.height != bucket.height);
+            if (image_pixels != nullptr) {
+                *image_pixels = static_cast<double>(bucket.width) * bucket.height;
+            }
+            if (resized != nullptr) {
+                *resized = needs_resize;
+            }
+            return needs_resize ? vision::resizeImage(image, bucket.width, bucket.height, config_.resample) : image;
+        }
+
+        const vision::Image *source = &image;
+        vision::Image shrunk;
+        bool needs_resize = (image.width > bucket.width) || (image.height > bucket.height);
+        if (needs_resize) {
+            double scale = std::min(static_cast<double>(bucket.width) / image.width, static_cast<double>(bucket.height) / image.height);
+            int width = std::clamp(static_cast<int>(std::lround(image.width * scale)), 1, bucket.width);
+            int height = std::clamp(static_cast<int>(std::lround(image.height * scale)), 1, bucket.height);
+            shrunk = vision::resizeImage(image, width, height, config_.resample);
+            source = &shrunk;
+        }
+        if (image_pixels != nullptr) {
+            *image_pixels = static_cast<double>(source->width) * source->height;
+        }
+        if (resized != nullptr) {
+            *resized = needs_resize;
+        }
+        if ((source->width == bucket.width) && (source->height == bucket.height)) {
+            return *source;
+        }
+        vision::Image padded;
+        padded.width = bucket.width;
+        padded.height = bucket.height;
+        padded.data.resize(static_cast<size_t>(bucket.width) * bucket.height * 3);
+        for (size_t p = 0; p < padded.data.size(); p += 3) {
+            padded.data[p + 0] = fill_[0];
+            padded.data[p + 1] = fill_[1];
+            padded.data[p + 2] = fill_[2];
+        }
+        size_t row_bytes = static_cast<size_t>(source->width) * 3;
+        for (int y = 0; y < source->height; ++y) {
+            std::copy_n(source->data.data() + y * row_bytes, row_bytes, padded.data.data() + static_cast<size_t>(y) * bucket.width * 3);
+        }
+        return padded;
+    }
+
+    // 对任意尺寸的一批图像做分桶推理，返回按输入顺序排列的 [N, ...] 输出（位于 device 上）。
+    // 同一个 bucket 的图像按 max_batch 切分成若干 batch，每个 batch 直接打包进 pinned staging slot，再异步上传
+    Tensor forward(const std::vector<vision::Image> &images) {
+        std::lock_guard<std::mutex> run_lock(run_mutex_);
+        context::setDevice(device_);
+        std::vector<std::vector<size_t>> members(config_.buckets.size());
+        for (size_t i = 0; i < images.size(); ++i) {
+            members[bucketFor(images[i].width, images[i].height)].push_back(i);
+        }
+
+        Tensor output;
+        for (size_t b = 0; b < members.size(); ++b) {
+            const ShapeBucket &bucket = config_.buckets[b];
+            for (size_t begin = 0; begin < members[b].size(); begin += config_.max_batch) {
+                size_t count = std::min(config_.max_batch, members[b].size() - begin);
+                std::vector<vision::Image> fitted;
+                fitted.reserve(count);
+                double image_pixels = 0.0;
+                size_t resized = 0;
+                for (size_t j = 0; j < count; ++j) {
+                    double pixels = 0.0;
+                    bool was_resized = false;
+                    fitted.push_back(fit(images[members[b][begin + j]], b, &pixels, &was_resized));
+                    image_pixels += pixels;
+                    resized += was_resized ? 1 : 0;
+                }
+
+                auto start = std::chrono::steady_clock::now();
+                UploadSlot slot = uploader_.acquire({count, 3, static_cast<size_t>(bucket.height), static_cast<size_t>(bucket.width)}, DataType::F32);
+                processor_.pack(fitted, slot.host);
+                Tensor input = uploader_.upload(slot);
+                Tensor logits = model_.forward(input);
+                uploader_.release(slot);
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+                if (!output) {
+                    Shape shape = logits->shape();
+                    shape[0] = images.size();
+                    output = infinidemo::nn::empty(shape, logits->dtype(), logits->device());
+                }
+                for (size_t j = 0; j < count; ++j) {
+                    output->narrow({{0, members[b][begin + j], 1}})->copy_from(logits->narrow({{0, j, 1}}));
+                }
+
+                std::lock_guard<std::mutex> lock(stats_mutex_);
+                BucketStats &stats = stats_.buckets[b];
+                stats.requests += count;
+                stats.batches += 1;
+                stats.resized += resized;
+                stats.image_pixels += image_pixels;
+                stats.bucket_pixels += static_cast<double>(count) * bucket.width * bucket.height;
+                stats.forward_ms += ms;
+            }
+        }
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.requests += images.size();
+        return output;
+    }
+
+    const BucketingConfig &config() const { return config_; }
+
+    // 统计的快照，可以在另一个线程执行 forward 时读取
+    BucketingStats stats() const {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        return stats_;
+    }
+
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        for (auto &b : stats_.buckets) {
+            ShapeBucket bucket = b.bucket;
+            b = BucketStats();
+            b.bucket = bucket;
+        }
+        stats_.requests = 0;
+    }
+
+private:
+    Model &model_;
+    const vision::ImageProcessor &processor_;
+    BucketingConfig config_;
+    Device device_;
+    InputUploader uploader_;
+    uint8_t fill_[3] = {0, 0, 0};
+    BucketingStats stats_;
+    mutable std::mutex stats_mutex_;
+    std::mutex run_mutex_;
+};
+
+} // namespace infinidemo::runtime
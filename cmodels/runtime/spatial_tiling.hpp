@@ -0,0 +1,132 @@
+#pragma once
+
+#include "../../nn/allocator.hpp"
+#include "../../nn/debug.hpp"
+#include "../../nn/receptive_field.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 空间分块执行：超大分辨率输入（卫星图、病理切片）逐层的全分辨率激活放不下时，
+// 把输出特征图按行列切成块，每块只裁剪它依赖的输入区域（块本身加上由感受野算出的 halo）单独前向，再把有效区域拼回。
+//
+// 结果与整图推理逐元素一致（卷积实现按形状选择不同算法时只有浮点求和顺序上的差异）的条件：
+//   - 裁剪起点是累计步长的整数倍，每一层 tile 内的下标与整图下标只差一个整数偏移；
+//   - halo 覆盖有效区域依赖的全部输入，tile 边缘处按 padding 补零得到的错误值只落在丢弃的 halo 中；
+//   - 贴着图像边界的 tile 一直裁到边界，补零与整图相同。
+// 峰值激活内存由 tile 大小（加 halo）决定而不是图像大小；整张输入可以留在 host 上，每次只把一块拷到模型所在的设备
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+// 一个空间维度上的一块
+struct TileSpan {
+    size_t out_begin = 0; // 负责的输出位置 [out_begin, out_begin + out_count)
+    size_t out_count = 0;
+    size_t in_begin = 0; // 裁剪的输入范围（含 halo），in_begin 是累计步长的整数倍
+    size_t in_count = 0;
+    size_t local_begin = 0; // out_begin 在这一块输出中的下标
+};
+
+struct SpatialTilePlan {
+    infinidemo::nn::ReceptiveField field;
+    std::vector<TileSpan> rows;
+    std::vector<TileSpan> cols;
+
+    size_t tiles() const { return rows.size() * cols.size(); }
+
+    // 最大的一块输入的像素数，峰值激活内存与它成正比
+    size_t maxTilePixels() const {
+        size_t max_rows = 0;
+        size_t max_cols = 0;
+        for (const auto &span : rows) {
+            max_rows = std::max(max_rows, span.in_count);
+        }
+        for (const auto &span : cols) {
+            max_cols = std::max(max_cols, span.in_count);
+        }
+        return max_rows * max_cols;
+    }
+
+    std::string toString() const {
+        std::ostringstream os;
+        os << "tiles: " << rows.size() << " x " << cols.size() << ", stride: " << field.stride << ", halo: " << field.left << " / " << field.right
+           << ", max tile pixels: " << maxTilePixels();
+        return os.str();
+    }
+};
+
+// 一个维度：input_size 个输入位置得到 output_size 个输出位置，每块负责 tile_size / stride 个输出位置（至少 1 个）
+inline std::vector<TileSpan> planTileSpans(const infinidemo::nn::ReceptiveField &field, size_t input_size, size_t output_size, size_t tile_size) {
+    size_t stride = field.stride;
+    size_t per_tile = std::max<size_t>(tile_size / stride, 1);
+    std::vector<TileSpan> spans;
+    for (size_t begin = 0; begin < output_size; begin += per_tile) {
+        TileSpan span;
+        span.out_begin = begin;
+        span.out_count = std::min(per_tile, output_size - begin);
+        size_t last = begin + span.out_count - 1;
+
+        // 起点向下取整到 stride 的倍数，保证 tile 内各层的下标与整图对齐
+        ptrdiff_t first_input = static_cast<ptrdiff_t>(stride * begin) - field.left;
+        span.in_begin = first_input <= 0 ? 0 : (static_cast<size_t>(first_input) / stride) * stride;
+        if (span.in_begin >= input_size) {
+            throw std::runtime_error("planTileSpans: output size " + std::to_string(output_size) + " does not match input size " + std::to_string(input_size));
+        }
+        ptrdiff_t end_input = static_cast<ptrdiff_t>(stride * last) + field.right + 1;
+        span.in_count = std::min(input_size, static_cast<size_t>(std::max<ptrdiff_t>(end_input, 1))) - span.in_begin;
+        span.local_begin = begin - span.in_begin / stride;
+        spans.push_back(span);
+    }
+    return spans;
+}
+
+// input_shape [N, C, H, W] -> output_shape [N, C', H', W']（整图前向的输出形状）
+inline SpatialTilePlan planSpatialTiles(const infinidemo::nn::ReceptiveField &field, const Shape &input_shape, const Shape &output_shape, size_t tile_size) {
+    if ((input_shape.size() != 4) || (output_shape.size() != 4)) {
+        throw std::runtime_error("planSpatialTiles: expected [N, C, H, W] input and output shapes");
+    }
+    if ((field.left < 0) || (tile_size == 0)) {
+        throw std::runtime_error("planSpatialTiles: unsupported receptive field " + field.toString() + " or tile size " + std::to_string(tile_size));
+    }
+    SpatialTilePlan plan;
+    plan.field = field;
+    plan.rows = planTileSpans(field, input_shape[2], output_shape[2], tile_size);
+    plan.cols = planTileSpans(field, input_shape[3], output_shape[3], tile_size);
+    return plan;
+}
+
+// 按 plan 逐块执行 forward（tile [N, C, h, w] -> [N, C', h', w']），有效区域拼到 device 上的 output_shape 特征图中。
+// 同一时间只有一块的输入与激活存活
+template <typename Forward>
+Tensor runSpatialTiles(const Tensor &input, const SpatialTilePlan &plan, const Shape &output_shape, const Device &device, Forward &&forward) {
+    const Shape &input_shape = input->shape();
+    Tensor output = infinidemo::nn::empty(output_shape, input->dtype(), device);
+    for (const auto &row : plan.rows) {
+        for (const auto &col : plan.cols) {
+            Tensor tile = input->narrow({{2, row.in_begin, row.in_count}, {3, col.in_begin, col.in_count}})->contiguous();
+            if (!infinidemo::nn::debug::sameDevice(tile->device(), device)) {
+                // 先在 input 所在的设备上整理为连续，只有这一块进入模型所在的设备
+                Tensor staged = infinidemo::nn::empty({input_shape[0], input_shape[1], row.in_count, col.in_count}, input->dtype(), device);
+                staged->copy_from(tile);
+                tile = staged;
+            }
+
+            Tensor tile_output = forward(tile);
+            const Shape &tile_shape = tile_output->shape();
+            if ((tile_shape.size() != 4) || (tile_shape[1] != output_shape[1]) || (tile_shape[2] < row.local_begin + row.out_count)
+                || (tile_shape[3] < col.local_begin + col.out_count)) {
+                throw std::runtime_error("runSpatialTiles: tile output does not cover its span, check the receptive field");
+            }
+            output->narrow({{2, row.out_begin, row.out_count}, {3, col.out_begin, col.out_count}})
+                ->copy_from(tile_output->narrow({{2, row.local_begin, row.out_count}, {3, col.local_begin, col.out_count}}));
+        }
+    }
+    return output;
+}
+
+} // namespace infinidemo::runtime
@@ -0,0 +1,268 @@
+#pragma once
+
+#include "../../nn/debug.hpp"
+#include "../../nn/utils.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/memory.hpp>
+#include <infinicore/tensor.hpp>
+#include <infinirt.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// 输入上传的 host 侧 staging：
+//   PinnedBufferPool   复用 page-locked host buffer，避免每个请求都从 pageable 内存做同步 H2D
+//   InputUploader      多个 slot 轮转的异步上传（默认两个，即双缓冲），请求 N+1 的拷贝与请求 N 的计算重叠
+// 在 CPU 上两者退化为普通 host 内存，上传是 no-op，因此同一套代码可以在 CPU 后端上测试
+namespace infinidemo::runtime {
+using namespace infinicore;
+
+class PinnedBufferPool {
+public:
+    // pinned 为 false 时分配普通 host 内存（CPU 后端）
+    explicit PinnedBufferPool(bool pinned = true) : state_(std::make_shared<State>()) { state_->pinned = pinned; }
+
+    // 返回至少 bytes 大小的 buffer，最后一个引用释放后自动回到池中
+    std::shared_ptr<Memory> acquire(size_t bytes) {
+        bytes = roundUp(bytes);
+        std::shared_ptr<Memory> memory;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            auto it = state_->free.lower_bound(bytes);
+            // 最多浪费一半，避免小请求长期占住大 buffer
+            if ((it != state_->free.end()) && (it->first <= 2 * bytes)) {
+                memory = it->second;
+                state_->free.erase(it);
+            }
+        }
+        if (!memory) {
+            memory = state_->pinned ? context::allocatePinnedHostMemory(bytes) : context::allocateHostMemory(bytes);
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            state_->allocated_bytes += bytes;
+            ++state_->allocations;
+        }
+
+        std::weak_ptr<State> weak_state = state_;
+        return std::shared_ptr<Memory>(memory.get(), [weak_state, memory, bytes](Memory *) {
+            if (auto state = weak_state.lock()) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->free.emplace(bytes, memory);
+            }
+        });
+    }
+
+    size_t allocatedBytes() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->allocated_bytes;
+    }
+
+    size_t allocations() const {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->allocations;
+    }
+
+    bool pinned() const { return state_->pinned; }
+
+private:
+    // 按 2 的幂分档（最小 4 KB），不同大小的请求可以复用同一档的 buffer
+    static size_t roundUp(size_t bytes) {
+        size_t size = 4096;
+        while (size < bytes) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    struct State {
+        mutable std::mutex mutex;
+        std::multimap<size_t, std::shared_ptr<Memory>> free;
+        size_t allocated_bytes = 0;
+        size_t allocations = 0;
+        bool pinned = true;
+    };
+    std::shared_ptr<State> state_;
+};
+
+// 一个在途的上传：host 是 pinned staging tensor，device 是上传后的 tensor（CPU 上两者相同）
+struct UploadSlot {
+    size_t index = 0;
+    Tensor host;
+    Tensor device;
+};
+
+class InputUploader {
+public:
+    // depth 为 slot 数量，即同时在途（已上传、计算尚未结束）的输入数
+    InputUploader(const Device &device, size_t depth = 2)
+        : device_(device), on_host_(device.getType() == Device::Type::CPU), pool_(!on_host_), slots_(std::max<size_t>(depth, 1)) {
+        if (!on_host_) {
+            // stream、event 与 pinned 内存都属于当前 context 的设备
+            context::setDevice(device_);
+            INFINICORE_CHECK_ERROR(infinirtStreamCreate(&upload_stream_));
+            for (auto &slot : slots_) {
+                INFINICORE_CHECK_ERROR(infinirtEventCreate(&slot.uploaded));
+                INFINICORE_CHECK_ERROR(infinirtEventCreate(&slot.consumed));
+            }
+        }
+    }
+
+    InputUploader(const InputUploader &) = delete;
+    InputUploader &operator=(const InputUploader &) = delete;
+
+    ~InputUploader() {
+        if (!on_host_) {
+            infinirtStreamSynchronize(upload_stream_);
+            for (auto &slot : slots_) {
+                if (slot.consumed_recorded) {
+                    infinirtEventSynchronize(slot.consumed);
+                }
+                infinirtEventDestroy(slot.uploaded);
+                infinirtEventDestroy(slot.consumed);
+            }
+            infinirtStreamDestroy(upload_stream_);
+        }
+    }
+
+    // 取得下一个空闲 slot 的 staging tensor，调用方直接把输入写进 slot.host。
+    // 所有 slot 都在途时阻塞到最早的一个被 release 且设备上的计算结束
+    UploadSlot acquire(const Shape &shape, const DataType &dtype) {
+        size_t index;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            index = next_ % slots_.size();
+            ++next_;
+            released_.wait(lock, [this, index]() { return closed_ || !slots_[index].in_use; });
+            if (closed_) {
+                throw std::runtime_error("InputUploader: closed");
+            }
+            slots_[index].in_use = true;
+        }
+        Slot &slot = slots_[index];
+        if (slot.consumed_recorded) {
+            // 上一次使用这个 slot 的 forward 结束后，device buffer 与 pinned buffer 才能被覆盖
+            INFINICORE_CHECK_ERROR(infinirtEventSynchronize(slot.consumed));
+            slot.consumed_recorded = false;
+        }
+
+        size_t bytes = infinidemo::nn::numBytes(shape, dtype);
+        if (!slot.host_memory || (slot.capacity < bytes)) {
+            slot.host_memory = pool_.acquire(bytes);
+            if (!on_host_) {
+                slot.device_memory = context::allocateMemory(bytes);
+            }
+            slot.capacity = bytes;
+        }
+
+        UploadSlot result;
+        result.index = index;
+        result.host = Tensor::from_blob(slot.host_memory->data(), shape, dtype, Device::cpu());
+        result.device = on_host_ ? result.host : Tensor::from_blob(slot.device_memory->data(), shape, dtype, device_);
+        return result;
+    }
+
+    // 在上传 stream 上异步拷贝 slot.host -> slot.device，host 不阻塞。wait 为 true 时当前线程的计算 stream 立即排在拷贝之后；
+    // 为 false 时由调用方在提交使用 slot.device 的计算之前调用 wait(slot)，之间提交的计算不等待这次拷贝
+    Tensor upload(const UploadSlot &slot, bool wait = true) {
+        if (on_host_) {
+            return slot.device;
+        }
+        Slot &s = slots_[slot.index];
+        Tensor device = slot.device;
+        size_t bytes = infinidemo::nn::numBytes(slot.host->shape(), slot.host->dtype());
+        infinidemo::nn::debug::crossDeviceCopyCounter().fetch_add(1, std::memory_order_relaxed);
+        INFINICORE_CHECK_ERROR(infinirtMemcpyAsync(device->data(), slot.host->data(), bytes, INFINIRT_MEMCPY_H2D, upload_stream_));
+        INFINICORE_CHECK_ERROR(infinirtEventRecord(s.uploaded, upload_stream_));
+        if (wait) {
+            INFINICORE_CHECK_ERROR(infinirtStreamWaitEvent(context::getStream(), s.uploaded));
+        }
+        uploaded_bytes_ += bytes;
+        return device;
+    }
+
+    // 当前线程的计算 stream 排在 slot 的拷贝之后（upload / stage 的 wait 为 false 时使用）
+    void wait(const UploadSlot &slot) {
+        if (!on_host_ && owns(slot)) {
+            INFINICORE_CHECK_ERROR(infinirtStreamWaitEvent(context::getStream(), slots_[slot.index].uploaded));
+        }
+    }
+
+    // 等待拷贝完成，用于把 slot.device 交给另一个线程（另一个 stream）使用
+    void synchronize(const UploadSlot &slot) {
+        if (!on_host_) {
+            INFINICORE_CHECK_ERROR(infinirtEventSynchronize(slots_[slot.index].uploaded));
+        }
+    }
+
+    // 使用 slot.device 的计算已经提交到当前线程的 stream 后调用，slot 在这些计算结束后才会被复用
+    void release(const UploadSlot &slot) { release(slot.index); }
+
+    void release(size_t index) {
+        if (index >= slots_.size()) {
+            return;
+        }
+        Slot &s = slots_[index];
+        if (!on_host_) {
+            INFINICORE_CHECK_ERROR(infinirtEventRecord(s.consumed, context::getStream()));
+            s.consumed_recorded = true;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        s.in_use = false;
+        released_.notify_all();
+    }
+
+    // 唤醒并终止所有等待 slot 的 acquire（流水线出错退出时使用）
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        released_.notify_all();
+    }
+
+    // 把任意 host tensor 拷进 staging buffer 再上传（wait 见 upload）。CPU 后端上、或者输入已经在设备上时原样返回（不占用 slot）
+    UploadSlot stage(const Tensor &input, bool wait = true) {
+        if (on_host_ || (input->device().getType() != Device::Type::CPU)) {
+            return UploadSlot{slots_.size(), input, input};
+        }
+        UploadSlot slot = acquire(input->shape(), input->dtype());
+        slot.host->copy_from(input);
+        slot.device = upload(slot, wait);
+        return slot;
+    }
+
+    bool owns(const UploadSlot &slot) const { return slot.index < slots_.size(); }
+
+    size_t depth() const { return slots_.size(); }
+    bool onHost() const { return on_host_; }
+    infinirtStream_t stream() const { return upload_stream_; }
+    size_t uploadedBytes() const { return uploaded_bytes_; }
+    const PinnedBufferPool &pool() const { return pool_; }
+
+private:
+    struct Slot {
+        std::shared_ptr<Memory> host_memory;
+        std::shared_ptr<Memory> device_memory;
+        size_t capacity = 0;
+        infinirtEvent_t uploaded = nullptr;
+        infinirtEvent_t consumed = nullptr;
+        bool consumed_recorded = false;
+        bool in_use = false;
+    };
+
+    Device device_;
+    bool on_host_;
+    PinnedBufferPool pool_;
+    std::vector<Slot> slots_;
+    infinirtStream_t upload_stream_ = nullptr;
+    std::mutex mutex_;
+    std::condition_variable released_;
+    size_t next_ = 0;
+    bool closed_ = false;
+    size_t uploaded_bytes_ = 0;
+};
+
+} // namespace infinidemo::runtime
@@ -0,0 +1,367 @@
+#include "image_processing.hpp"
+#include "../../nn/allocator.hpp"
+#include "../../nn/debug.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_PNG
+#define STBI_ONLY_BMP
+#include <stb_image.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define INFINIDEMO_VISION_HAS_AVX2_KERNEL
+#include <immintrin.h>
+#endif
+
+namespace infinidemo::vision {
+
+namespace {
+
+// 与 PIL 相同的定点精度：8 位像素 * 22 位系数，留 2 位余量防止溢出
+constexpr int kPrecisionBits = 32 - 8 - 2;
+
+double bilinearFilter(double x) {
+    x = std::fabs(x);
+    return x < 1.0 ? 1.0 - x : 0.0;
+}
+
+// a = -0.5，与 PIL / torchvision antialias 一致
+double bicubicFilter(double x) {
+    constexpr double a = -0.5;
+    x = std::fabs(x);
+    if (x < 1.0) {
+        return ((a + 2.0) * x - (a + 3.0)) * x * x + 1.0;
+    }
+    if (x < 2.0) {
+        return (((x - 5.0) * x + 8.0) * x - 4.0) * a;
+    }
+    return 0.0;
+}
+
+// 每个输出位置的输入区间 [start, start + count) 与定点系数
+struct ResampleCoeffs {
+    int ksize = 0;
+    std::vector<int> start;
+    std::vector<int> count;
+    std::vector<int32_t> weights; // out_size * ksize
+};
+
+ResampleCoeffs computeCoeffs(int in_size, int out_size, Resample resample) {
+    double (*filter)(double) = resample == Resample::Bicubic ? bicubicFilter : bilinearFilter;
+    double filter_support = resample == Resample::Bicubic ? 2.0 : 1.0;
+
+    double scale = static_cast<double>(in_size) / out_size;
+    double filter_scale = std::max(scale, 1.0); // 缩小时放宽滤波器（antialias）
+    double support = filter_support * filter_scale;
+
+    ResampleCoeffs coeffs;
+    coeffs.ksize = static_cast<int>(std::ceil(support)) * 2 + 1;
+    coeffs.start.resize(out_size);
+    coeffs.count.resize(out_size);
+    coeffs.weights.assign(static_cast<size_t>(out_size) * coeffs.ksize, 0);
+
+    std::vector<double> k(coeffs.ksize);
+    for (int xx = 0; xx < out_size; ++xx) {
+        double center = (xx + 0.5) * scale;
+        int xmin = std::max(static_cast<int>(center - support + 0.5), 0);
+        int xmax = std::min(static_cast<int>(center + support + 0.5), in_size) - xmin;
+        double total = 0.0;
+        for (int x = 0; x < xmax; ++x) {
+            k[x] = filter((x + xmin - center + 0.5) / filter_scale);
+            total += k[x];
+        }
+        int32_t *w = coeffs.weights.data() + static_cast<size_t>(xx) * coeffs.ksize;
+        for (int x = 0; x < xmax; ++x) {
+            double v = total != 0.0 ? k[x] / total : 0.0;
+            w[x] = static_cast<int32_t>(v < 0.0 ? v * (1 << kPrecisionBits) - 0.5 : v * (1 << kPrecisionBits) + 0.5);
+        }
+        coeffs.start[xx] = xmin;
+        coeffs.count[xx] = xmax;
+    }
+    return coeffs;
+}
+
+inline uint8_t clip8(int32_t value) {
+    if (value >= (255 << kPrecisionBits)) {
+        return 255;
+    }
+    if (value <= 0) {
+        return 0;
+    }
+    return static_cast<uint8_t>(value >> kPrecisionBits);
+}
+
+// 沿行方向重采样：src 为 in_rows 行、每行 row_len 字节，dst 为 coeffs.start.size() 行
+void resampleRowsScalar(const uint8_t *src, size_t row_len, const ResampleCoeffs &coeffs, uint8_t *dst, size_t begin) {
+    for (size_t yy = 0; yy < coeffs.start.size(); ++yy) {
+        const int32_t *w = coeffs.weights.data() + yy * coeffs.ksize;
+        const uint8_t *base = src + static_cast<size_t>(coeffs.start[yy]) * row_len;
+        uint8_t *out = dst + yy * row_len;
+        for (size_t x = begin; x < row_len; ++x) {
+            int32_t acc = 1 << (kPrecisionBits - 1);
+            for (int y = 0; y < coeffs.count[yy]; ++y) {
+                acc += static_cast<int32_t>(base[y * row_len + x]) * w[y];
+            }
+            out[x] = clip8(acc);
+        }
+    }
+}
+
+#ifdef INFINIDEMO_VISION_HAS_AVX2_KERNEL
+// 每次处理 8 个字节，int32 累加，与标量版本的运算完全相同，返回已处理的列数
+__attribute__((target("avx2"))) size_t resampleRowsAvx2(const uint8_t *src, size_t row_len, const ResampleCoeffs &coeffs, uint8_t *dst) {
+    size_t vec_len = row_len / 8 * 8;
+    const __m256i rounding = _mm256_set1_epi32(1 << (kPrecisionBits - 1));
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max_value = _mm256_set1_epi32(255);
+    for (size_t yy = 0; yy < coeffs.start.size(); ++yy) {
+        const int32_t *w = coeffs.weights.data() + yy * coeffs.ksize;
+        const uint8_t *base = src + static_cast<size_t>(coeffs.start[yy]) * row_len;
+        uint8_t *out = dst + yy * row_len;
+        for (size_t x = 0; x < vec_len; x += 8) {
+            __m256i acc = rounding;
+            for (int y = 0; y < coeffs.count[yy]; ++y) {
+                __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(base + y * row_len + x));
+                acc = _mm256_add_epi32(acc, _mm256_mullo_epi32(_mm256_cvtepu8_epi32(bytes), _mm256_set1_epi32(w[y])));
+            }
+            // 等价于 clip8：<= 0 得 0，>= 255 << P 得 255
+            acc = _mm256_min_epi32(_mm256_srai_epi32(_mm256_max_epi32(acc, zero), kPrecisionBits), max_value);
+            __m128i packed16 = _mm_packus_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(out + x), _mm_packus_epi16(packed16, packed16));
+        }
+    }
+    return vec_len;
+}
+
+bool cpuHasAvx2() {
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+}
+#endif
+
+void resampleRows(const uint8_t *src, size_t row_len, const ResampleCoeffs &coeffs, uint8_t *dst) {
+    size_t done = 0;
+#ifdef INFINIDEMO_VISION_HAS_AVX2_KERNEL
+    if (cpuHasAvx2()) {
+        done = resampleRowsAvx2(src, row_len, coeffs, dst);
+    }
+#endif
+    if (done < row_len) {
+        resampleRowsScalar(src, row_len, coeffs, dst, done);
+    }
+}
+
+// HWC 图像的宽高转置，使水平方向的重采样也能复用按行的 SIMD 内核
+std::vector<uint8_t> transposeHW(const uint8_t *src, int height, int width) {
+    std::vector<uint8_t> dst(static_cast<size_t>(height) * width * 3);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *row = src + static_cast<size_t>(y) * width * 3;
+        for (int x = 0; x < width; ++x) {
+            uint8_t *p = dst.data() + (static_cast<size_t>(x) * height + y) * 3;
+            p[0] = row[x * 3 + 0];
+            p[1] = row[x * 3 + 1];
+            p[2] = row[x * 3 + 2];
+        }
+    }
+    return dst;
+}
+
+} // namespace
+
+Image decodeImage(const uint8_t *bytes, size_t size) {
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    uint8_t *pixels = stbi_load_from_memory(bytes, static_cast<int>(size), &width, &height, &channels, 3);
+    if (pixels == nullptr) {
+        throw std::runtime_error(std::string("Failed to decode image: ") + stbi_failure_reason());
+    }
+    Image image;
+    image.width = width;
+    image.height = height;
+    image.data.assign(pixels, pixels + static_cast<size_t>(width) * height * 3);
+    stbi_image_free(pixels);
+    return image;
+}
+
+Image decodeImageFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open image: " + path);
+    }
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return decodeImage(bytes.data(), bytes.size());
+}
+
+// 先水平后垂直，与 PIL 的顺序一致（两次之间舍入到 uint8）
+Image resizeImage(const Image &image, int width, int height, Resample resample) {
+    if ((width <= 0) || (height <= 0)) {
+        throw std::runtime_error("Invalid resize target " + std::to_string(width) + "x" + std::to_string(height));
+    }
+    Image current = image;
+    if (width != current.width) {
+        ResampleCoeffs coeffs = computeCoeffs(current.width, width, resample);
+        std::vector<uint8_t> transposed = transposeHW(current.data.data(), current.height, current.width);
+        std::vector<uint8_t> resized(static_cast<size_t>(width) * current.height * 3);
+        resampleRows(transposed.data(), static_cast<size_t>(current.height) * 3, coeffs, resized.data());
+        current.data = transposeHW(resized.data(), width, current.height);
+        current.width = width;
+    }
+    if (height != current.height) {
+        ResampleCoeffs coeffs = computeCoeffs(current.height, height, resample);
+        std::vector<uint8_t> resized(static_cast<size_t>(current.width) * height * 3);
+        resampleRows(current.data.data(), static_cast<size_t>(current.width) * 3, coeffs, resized.data());
+        current.data = std::move(resized);
+        current.height = height;
+    }
+    return current;
+}
+
+// 偏移向下取整，与 transformers.image_transforms.center_crop 的 (orig - crop) // 2 一致
+// （torchvision 的 round-half-even 在差值为奇数时会偏一个像素，例如宽 455 裁到 224 时 left 为 116 而不是 115）
+Image centerCrop(const Image &image, int width, int height) {
+    if ((width > image.width) || (height > image.height)) {
+        throw std::runtime_error("Center crop larger than the image");
+    }
+    int top = (image.height - height) / 2;
+    int left = (image.width - width) / 2;
+    Image cropped;
+    cropped.width = width;
+    cropped.height = height;
+    cropped.data.resize(static_cast<size_t>(width) * height * 3);
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *src = image.data.data() + (static_cast<size_t>(top + y) * image.width + left) * 3;
+        std::copy(src, src + static_cast<size_t>(width) * 3, cropped.data.data() + static_cast<size_t>(y) * width * 3);
+    }
+    return cropped;
+}
+
+ImageProcessor::ImageProcessor(const ImageProcessorConfig &config) : config_(config) {}
+
+Image ImageProcessor::transform(const Image &image) const {
+    if (!config_.do_resize) {
+        return image;
+    }
+    int size = config_.shortest_edge;
+    if (size >= 384) {
+        return resizeImage(image, size, size, config_.resample);
+    }
+    int short_side = static_cast<int>(size / config_.crop_pct);
+    int width = image.width;
+    int height = image.height;
+    if (width <= height) {
+        height = static_cast<int>(static_cast<int64_t>(short_side) * height / width);
+        width = short_side;
+    } else {
+        width = static_cast<int>(static_cast<int64_t>(short_side) * width / height);
+        height = short_side;
+    }
+    return centerCrop(resizeImage(image, width, height, config_.resample), size, size);
+}
+
+Shape ImageProcessor::batchShape(const std::vector<Image> &images) const {
+    if (images.empty()) {
+        throw std::runtime_error("ImageProcessor: empty batch");
+    }
+    for (const auto &image : images) {
+        if ((image.width != images.front().width) || (image.height != images.front().height)) {
+            throw std::runtime_error("ImageProcessor: images in a batch must have the same output size, enable do_resize");
+        }
+    }
+    size_t n = images.size();
+    size_t h = static_cast<size_t>(images.front().height);
+    size_t w = static_cast<size_t>(images.front().width);
+    return config_.layout == Layout::NCHW ? Shape{n, 3, h, w} : Shape{n, h, w, 3};
+}
+
+void ImageProcessor::pack(const std::vector<Image> &images, Tensor &output) const {
+    Shape shape = batchShape(images);
+    if ((output->device().getType() != Device::Type::CPU) || (output->dtype() != DataType::F32) || (output->shape() != shape) || !output->is_contiguous()) {
+        throw std::runtime_error("ImageProcessor: pack expects a contiguous F32 CPU tensor of the batch shape");
+    }
+
+    // 每个通道 out = pixel * scale + shift，用 256 项查找表完成
+    std::array<std::array<float, 256>, 3> lut;
+    for (int c = 0; c < 3; ++c) {
+        float scale = config_.rescale_factor;
+        float shift = 0.0f;
+        if (config_.do_normalize && config_.fold_scale) {
+            scale = 1.0f;
+            shift = -config_.image_mean[c] / config_.rescale_factor;
+        } else if (config_.do_normalize) {
+            scale = config_.rescale_factor / config_.image_std[c];
+            shift = -config_.image_mean[c] / config_.image_std[c];
+        }
+        for (int v = 0; v < 256; ++v) {
+            lut[c][v] = static_cast<float>(v) * scale + shift;
+        }
+    }
+
+    size_t n = images.size();
+    size_t h = static_cast<size_t>(images.front().height);
+    size_t w = static_cast<size_t>(images.front().width);
+    float *out = reinterpret_cast<float *>(output->data());
+    for (size_t i = 0; i < n; ++i) {
+        const uint8_t *src = images[i].data.data();
+        if (config_.layout == Layout::NCHW) {
+            for (size_t c = 0; c < 3; ++c) {
+                float *plane = out + (i * 3 + c) * h * w;
+                const auto &table = lut[c];
+                for (size_t p = 0; p < h * w; ++p) {
+                    plane[p] = table[src[p * 3 + c]];
+                }
+            }
+        } else {
+            float *image_out = out + i * h * w * 3;
+            for (size_t p = 0; p < h * w; ++p) {
+                image_out[p * 3 + 0] = lut[0][src[p * 3 + 0]];
+                image_out[p * 3 + 1] = lut[1][src[p * 3 + 1]];
+                image_out[p * 3 + 2] = lut[2][src[p * 3 + 2]];
+            }
+        }
+    }
+}
+
+Tensor ImageProcessor::operator()(const std::vector<Image> &images, const Device &device) const {
+    std::vector<Image> transformed;
+    transformed.reserve(images.size());
+    for (const auto &image : images) {
+        transformed.push_back(transform(image));
+    }
+    Tensor host = infinidemo::nn::empty(batchShape(transformed), DataType::F32, Device::cpu());
+    pack(transformed, host);
+    return infinidemo::nn::debug::toDevice(host, device);
+}
+
+void ImageProcessor::foldNormalization(Tensor &conv_weight) {
+    if (config_.fold_scale) {
+        throw std::runtime_error("ImageProcessor: normalization is already folded");
+    }
+    if ((conv_weight->ndim() != 4) || (conv_weight->shape()[1] != 3) || (conv_weight->dtype() != DataType::F32)) {
+        throw std::runtime_error("ImageProcessor: expected an F32 conv weight of shape [out, 3, kh, kw]");
+    }
+    Tensor host = infinidemo::nn::debug::toDevice(conv_weight, Device::cpu())->contiguous();
+    const auto &shape = host->shape();
+    size_t kernel = shape[2] * shape[3];
+    float *w = reinterpret_cast<float *>(host->data());
+    for (size_t o = 0; o < shape[0]; ++o) {
+        for (size_t c = 0; c < 3; ++c) {
+            float scale = config_.rescale_factor / config_.image_std[c];
+            float *k = w + (o * 3 + c) * kernel;
+            for (size_t i = 0; i < kernel; ++i) {
+                k[i] *= scale;
+            }
+        }
+    }
+    if (host->data() != conv_weight->data()) {
+        conv_weight->copy_from(host);
+    }
+    config_.fold_scale = true;
+}
+
+} // namespace infinidemo::vision
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <string>
+#include <vector>
+
+// 原生图像预处理：解码 -> 短边缩放 -> 中心裁剪 -> 归一化 -> 打包为 NCHW / NHWC batch。
+// 缩放、裁剪与 transformers 的 ConvNextImageProcessor（ResNet 使用的处理器）保持一致：
+//   shortest_edge < 384 时先把短边缩放到 int(shortest_edge / crop_pct)，再中心裁剪为 shortest_edge；
+//   否则直接缩放到 shortest_edge x shortest_edge。
+// 重采样与 PIL / torchvision antialias 相同（定点系数、先水平后垂直、两次之间舍入到 uint8），
+// 行方向的累加在支持 AVX2 的 CPU 上使用 SIMD 实现，结果与标量实现逐位一致。
+namespace infinidemo::vision {
+using namespace infinicore;
+
+enum class Resample {
+    Bilinear,
+    Bicubic,
+};
+
+enum class Layout {
+    NCHW,
+    NHWC,
+};
+
+struct ImageProcessorConfig {
+    int shortest_edge = 224;
+    float crop_pct = 0.875f;
+    Resample resample = Resample::Bicubic;
+    bool do_resize = true;
+    bool do_normalize = true;
+    float rescale_factor = 1.0f / 255.0f;
+    std::array<float, 3> image_mean = {0.485f, 0.456f, 0.406f};
+    std::array<float, 3> image_std = {0.229f, 0.224f, 0.225f};
+    Layout layout = Layout::NCHW;
+    // 为 true 时只输出 x - mean / rescale_factor，rescale_factor / std 由 foldNormalization 折叠进第一层卷积
+    bool fold_scale = false;
+};
+
+// 8 位 RGB 图像，HWC 排列
+struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> data;
+};
+
+Image decodeImage(const uint8_t *bytes, size_t size);
+Image decodeImageFile(const std::string &path);
+
+Image resizeImage(const Image &image, int width, int height, Resample resample);
+Image centerCrop(const Image &image, int width, int height);
+
+class ImageProcessor {
+public:
+    explicit ImageProcessor(const ImageProcessorConfig &config = ImageProcessorConfig());
+
+    const ImageProcessorConfig &config() const { return config_; }
+
+    // 缩放与裁剪，输出为 crop 尺寸的 8 位图像
+    Image transform(const Image &image) const;
+
+    // 对一批图像做完整预处理，返回 F32 的 [N, 3, H, W]（或 [N, H, W, 3]）tensor
+    Tensor operator()(const std::vector<Image> &images, const Device &device = Device::cpu()) const;
+
+    // 已经 transform 过的图像打包后的形状
+    Shape batchShape(const std::vector<Image> &images) const;
+
+    // 把已经 transform 过的图像归一化后写入调用方提供的连续 F32 CPU tensor（例如 pinned staging buffer）
+    void pack(const std::vector<Image> &images, Tensor &output) const;
+
+    // 把 rescale_factor / std 按输入通道乘进第一层卷积权重 [out, 3, kh, kw]，之后预处理只减均值。
+    // 因为零填充在"减均值"空间与归一化空间中都对应 0，折叠在边界上也是精确的
+    void foldNormalization(Tensor &conv_weight);
+
+private:
+    ImageProcessorConfig config_;
+};
+
+} // namespace infinidemo::vision
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "memory_tracker.hpp"
+#include "profiler.hpp"
+#include <cstddef>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <memory>
+
+// forward 中的 tensor 与 workspace 统一从这里分配，方便 profiler 与内存统计（memory_tracker.hpp）记录分配量
+namespace infinidemo::nn {
+using namespace infinicore;
+
+inline size_t numBytes(const Shape &shape, const DataType &dtype) {
+    size_t numel = 1;
+    for (auto s : shape) {
+        numel *= s;
+    }
+    return numel * dsize(dtype);
+}
+
+inline Tensor empty(const Shape &shape, const DataType &dtype, const Device &device) {
+    size_t bytes = numBytes(shape, dtype);
+    INFINIDEMO_PROFILE_ALLOCATION(bytes);
+    Tensor tensor = Tensor::empty(shape, dtype, device);
+    memory::trackAllocation(tensor, bytes);
+    return tensor;
+}
+
+inline Tensor zeros(const Shape &shape, const DataType &dtype, const Device &device) {
+    size_t bytes = numBytes(shape, dtype);
+    INFINIDEMO_PROFILE_ALLOCATION(bytes);
+    Tensor tensor = Tensor::zeros(shape, dtype, device);
+    memory::trackAllocation(tensor, bytes);
+    return tensor;
+}
+
+inline std::shared_ptr<Memory> allocateWorkspace(size_t size) {
+    INFINIDEMO_PROFILE_ALLOCATION(size);
+    std::shared_ptr<Memory> workspace = context::allocateMemory(size);
+    memory::trackAllocation(workspace, size);
+    return workspace;
+}
+
+} // namespace infinidemo::nn
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+
+namespace infinidemo::nn::debug {
+using namespace infinicore;
+
+// 跨设备拷贝计数器：只统计经过 toDevice() 与 InputUploader 的搬运，用于观察运行时的传输次数。
+// 绕过这两个入口的拷贝（Tensor::to、跨设备 copy_from）不会被计入，不能据此证明没有 host 往返；
+// 组合池化是否留在设备上由 test_pooling 拦截 infinirtMemcpy 检查
+inline std::atomic<size_t> &crossDeviceCopyCounter() {
+    static std::atomic<size_t> counter{0};
+    return counter;
+}
+
+inline size_t crossDeviceCopies() {
+    return crossDeviceCopyCounter().load(std::memory_order_relaxed);
+}
+
+inline void resetCrossDeviceCopies() {
+    crossDeviceCopyCounter().store(0, std::memory_order_relaxed);
+}
+
+inline bool sameDevice(const Device &lhs, const Device &rhs) {
+    return (lhs.getType() == rhs.getType()) && (lhs.getIndex() == rhs.getIndex());
+}
+
+// 带计数的 Tensor::to，设备相同时直接返回原 tensor
+inline Tensor toDevice(const Tensor &tensor, const Device &device) {
+    if (sameDevice(tensor->device(), device)) {
+        return tensor;
+    }
+    crossDeviceCopyCounter().fetch_add(1, std::memory_order_relaxed);
+    return tensor->to(device);
+}
+
+// 形状推导计数器：每次 ShapeCache 未命中、重新计算输出形状（会分配 vector）时加一，
+// 对同一输入形状重复 forward 时应保持不变
+inline std::atomic<size_t> &shapeComputationCounter() {
+    static std::atomic<size_t> counter{0};
+    return counter;
+}
+
+inline size_t shapeComputations() {
+    return shapeComputationCounter().load(std::memory_order_relaxed);
+}
+
+// 强制在任意设备上走组合池化路径（用于在 CPU 上模拟 HYGON / MOORE 的执行路径）
+inline std::atomic<bool> &forceCompositePoolingFlag() {
+    static std::atomic<bool> flag{false};
+    return flag;
+}
+
+inline void setForceCompositePooling(bool enable) {
+    forceCompositePoolingFlag().store(enable, std::memory_order_relaxed);
+}
+
+inline bool forceCompositePooling() {
+    return forceCompositePoolingFlag().load(std::memory_order_relaxed);
+}
+
+} // namespace infinidemo::nn::debug
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../allocator.hpp"
+#include "../profiler.hpp"
 #include <infinicore/context/context.hpp>
 #include <infinicore/device.hpp>
 #include <infinicore/tensor.hpp>
@@ -14,6 +16,7 @@ using namespace infinicore;
 // Performs Add operation: C = A + B
 inline infiniStatus_t performAdd(Tensor &out, const Tensor &input,
                                  const Tensor &other, Device device) {
+    INFINIDEMO_PROFILE_OP("Add", out, input, other);
     // Create InfiniOP handle
     infiniopHandle_t handle = context::getInfiniopHandle(device);
 
@@ -21,6 +24,7 @@ inline infiniStatus_t performAdd(Tensor &out, const Tensor &input,
     infiniopAddDescriptor_t add_desc = nullptr;
     infiniStatus_t status = infiniopCreateAddDescriptor(
         handle, &add_desc, out->desc(), input->desc(), other->desc());
+    INFINIDEMO_PROFILE_DESCRIPTOR_CREATED();
 
     if (status != INFINI_STATUS_SUCCESS) {
         std::cerr << "Failed to create Add descriptor: " << status << std::endl;
@@ -40,7 +44,7 @@ inline infiniStatus_t performAdd(Tensor &out, const Tensor &input,
     void *workspace = nullptr;
     std::shared_ptr<Memory> workspace_memory = nullptr;
     if (workspace_size > 0) {
-        workspace_memory = context::allocateMemory(workspace_size);
+        workspace_memory = infinidemo::nn::allocateWorkspace(workspace_size);
         workspace = workspace_memory->data();
     }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../allocator.hpp"
+#include "../profiler.hpp"
 #include <infinicore/context/context.hpp>
 #include <infinicore/device.hpp>
 #include <infinicore/tensor.hpp>
@@ -18,6 +20,7 @@ inline infiniStatus_t performAvgPool2d(const Tensor &tensor_input,
                                        int padding_h, int padding_w,
                                        int dilation_h, int dilation_w,
                                        bool ceil_mode, Device device) {
+    INFINIDEMO_PROFILE_OP("AvgPool2d", tensor_output, tensor_input);
     // Create InfiniOP handle
     infiniopHandle_t handle = context::getInfiniopHandle(device);
     // 创建AvgPool2D descriptor
@@ -26,6 +29,7 @@ inline infiniStatus_t performAvgPool2d(const Tensor &tensor_input,
         handle, &pool_desc, tensor_output->desc(), tensor_input->desc(), kernel_h,
         kernel_w, stride_h, stride_w, padding_h, padding_w, dilation_h,
         dilation_w, ceil_mode ? 1 : 0);
+    INFINIDEMO_PROFILE_DESCRIPTOR_CREATED();
 
     if (status != INFINI_STATUS_SUCCESS) {
         std::cerr << "Failed to create AvgPool2D descriptor: " << status
@@ -46,7 +50,7 @@ inline infiniStatus_t performAvgPool2d(const Tensor &tensor_input,
     void *workspace = nullptr;
     std::shared_ptr<Memory> workspace_memory = nullptr;
     if (workspace_size > 0) {
-        workspace_memory = context::allocateMemory(workspace_size);
+        workspace_memory = infinidemo::nn::allocateWorkspace(workspace_size);
         workspace = workspace_memory->data();
     }
 
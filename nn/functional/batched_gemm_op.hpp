@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../profiler.hpp"
+#include "gemm_op.hpp"
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <infiniop.h>
+#include <iostream>
+
+namespace infinidemo::nn::functional {
+using namespace infinicore;
+
+// 把二维矩阵或 batch 为 1 的三维矩阵广播成 [batch, rows, cols]，batch stride 为 0，不拷贝数据
+inline Tensor broadcastBatch(const Tensor &matrix, size_t batch) {
+    const auto &shape = matrix->shape();
+    const auto &strides = matrix->strides();
+    if (matrix->ndim() == 2) {
+        return matrix->as_strided({batch, shape[0], shape[1]}, {0, strides[0], strides[1]});
+    }
+    if (shape[0] == 1 && batch != 1) {
+        return matrix->as_strided({batch, shape[1], shape[2]}, {0, strides[1], strides[2]});
+    }
+    return matrix;
+}
+
+// Performs batched GEMM operation: C[b] = alpha * A[b] * B[b] + beta * C[b]
+// C 为 [batch, M, N]；A / B 可以是三维，也可以是二维（沿 batch 广播，例如 Linear 的权重），
+// 所有 batch 在一次 infiniopGemm 中完成
+inline infiniStatus_t performBatchedGemm(Tensor &tensor_C, const Tensor &tensor_A,
+                                         const Tensor &tensor_B, float alpha,
+                                         float beta, Device device) {
+    if (tensor_C->ndim() != 3) {
+        std::cerr << "Batched GEMM expects a 3D output, got " << tensor_C->ndim() << "D" << std::endl;
+        return INFINI_STATUS_BAD_TENSOR_SHAPE;
+    }
+    size_t batch = tensor_C->shape()[0];
+    Tensor tensor_A_batched = broadcastBatch(tensor_A, batch);
+    Tensor tensor_B_batched = broadcastBatch(tensor_B, batch);
+    if ((tensor_A_batched->shape()[0] != batch) || (tensor_B_batched->shape()[0] != batch)) {
+        std::cerr << "Batched GEMM batch size mismatch" << std::endl;
+        return INFINI_STATUS_BAD_TENSOR_SHAPE;
+    }
+    return launchGemm(tensor_C, tensor_A_batched, tensor_B_batched, alpha, beta, device);
+}
+
+} // namespace infinidemo::nn::functional
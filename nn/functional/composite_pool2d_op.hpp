@@ -0,0 +1,289 @@
+#pragma once
+
+#include "../allocator.hpp"
+#include "../debug.hpp"
+#include "../profiler.hpp"
+#include "add_op.hpp"
+#include "gemm_op.hpp"
+#include "relu_op.hpp"
+#include "sub_op.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <infiniop.h>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// 组合池化：只用 Add / Sub / ReLU / GEMM 这些各平台都有的算子在设备上完成 Pool2D，
+// 供没有原生 AvgPool2d / MaxPool2d 实现的平台（HYGON、MOORE）使用，避免 CPU 往返拷贝。
+// 思路：窗口中的每个位置 (kh, kw) 对应输入上的一个跨步视图（tap），
+//   max:  out = max(out, tap) = out + relu(tap - out)
+//   avg:  out = sum(tap) / (kernel_h * kernel_w)
+// 代价：每个 tap 都是独立的算子调用，max 每个 tap 为 Sub + ReLU + Add 三次 launch（3x3 窗口约 27 次，另加初始化的拷贝），
+// avg 每个 tap 一次 Add 再加一次 GEMM；原生池化只需一次 launch。因此只在 useCompositePool2d() 为真的平台上使用，
+// 有原生 kernel 的设备仍走 performMaxPool2d / performAvgPool2d
+namespace infinidemo::nn::functional {
+using namespace infinicore;
+
+namespace composite_pool2d {
+
+// 某个 tap 有效的输出区间 [begin, end)
+struct TapRange {
+    int tap;
+    size_t begin;
+    size_t end;
+};
+
+// 输出位置 o 读取输入 o * stride - padding + tap * dilation，返回使其落在 [0, input_size) 内的 o 区间
+inline TapRange validOutputRange(size_t input_size, size_t output_size, int tap, int stride, int padding, int dilation) {
+    long long offset = static_cast<long long>(tap) * dilation - padding;
+    long long lo = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+    long long last = static_cast<long long>(input_size) - 1 - offset;
+    long long hi = last < 0 ? 0 : last / stride + 1;
+    lo = std::min<long long>(lo, static_cast<long long>(output_size));
+    hi = std::min<long long>(std::max(hi, lo), static_cast<long long>(output_size));
+    return {tap, static_cast<size_t>(lo), static_cast<size_t>(hi)};
+}
+
+inline std::vector<TapRange> tapRanges(size_t input_size, size_t output_size, int kernel, int stride, int padding, int dilation) {
+    std::vector<TapRange> ranges;
+    ranges.reserve(kernel);
+    for (int k = 0; k < kernel; ++k) {
+        ranges.push_back(validOutputRange(input_size, output_size, k, stride, padding, dilation));
+    }
+    return ranges;
+}
+
+// 用"第一个有效 tap"把输出区间切分成若干段，用于初始化 max 的结果
+inline std::vector<TapRange> firstTapSegments(const std::vector<TapRange> &ranges) {
+    std::vector<TapRange> segments;
+    size_t covered_begin = 0;
+    size_t covered_end = 0;
+    for (const auto &r : ranges) {
+        if (r.begin >= r.end) {
+            continue;
+        }
+        if (covered_begin == covered_end) {
+            segments.push_back(r);
+            covered_begin = r.begin;
+            covered_end = r.end;
+            continue;
+        }
+        if (r.begin < covered_begin) {
+            segments.push_back({r.tap, r.begin, std::min(r.end, covered_begin)});
+        }
+        if (r.end > covered_end) {
+            segments.push_back({r.tap, std::max(r.begin, covered_end), r.end});
+        }
+        covered_begin = std::min(covered_begin, r.begin);
+        covered_end = std::max(covered_end, r.end);
+    }
+    return segments;
+}
+
+// 输入上 tap (kh, kw) 对应输出区域 [oh, oh + nh) x [ow, ow + nw) 的跨步视图
+inline Tensor tapView(const Tensor &input, const TapRange &h, const TapRange &w,
+                      int stride_h, int stride_w, int padding_h, int padding_w,
+                      int dilation_h, int dilation_w) {
+    size_t nh = h.end - h.begin;
+    size_t nw = w.end - w.begin;
+    size_t ih = static_cast<size_t>(static_cast<long long>(h.begin) * stride_h - padding_h + static_cast<long long>(h.tap) * dilation_h);
+    size_t iw = static_cast<size_t>(static_cast<long long>(w.begin) * stride_w - padding_w + static_cast<long long>(w.tap) * dilation_w);
+    const auto &shape = input->shape();
+    const auto &strides = input->strides();
+    Tensor origin = input->narrow({{2, ih, shape[2] - ih}, {3, iw, shape[3] - iw}});
+    return origin->as_strided({shape[0], shape[1], nh, nw},
+                              {strides[0], strides[1], strides[2] * stride_h, strides[3] * stride_w});
+}
+
+inline Tensor outputView(const Tensor &output, const TapRange &h, const TapRange &w) {
+    return output->narrow({{2, h.begin, h.end - h.begin}, {3, w.begin, w.end - w.begin}});
+}
+
+// 设备上常量 1 张量的缓存，由使用组合池化的模块各自持有、随模块释放（不同模块、不同设备之间互不影响）。
+// 只在需要更多元素、dtype 或设备变化时重建，返回的是前 numel(shape) 个元素的视图
+class OnesCache {
+public:
+    OnesCache() = default;
+    // 拷贝模块时共享同一个只读的 ones
+    OnesCache(const OnesCache &other) : ones_(other.snapshot()) {}
+    OnesCache &operator=(const OnesCache &other) {
+        if (this != &other) {
+            Tensor ones = other.snapshot();
+            std::lock_guard<std::mutex> lock(mutex_);
+            ones_ = ones;
+        }
+        return *this;
+    }
+
+    Tensor get(const Shape &shape, DataType dtype, const Device &device) {
+        size_t numel = 1;
+        for (auto s : shape) {
+            numel *= s;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ones_ || (ones_->numel() < numel) || (ones_->dtype() != dtype) || !infinidemo::nn::debug::sameDevice(ones_->device(), device)) {
+            ones_ = create(numel, dtype, device);
+        }
+        return ones_->narrow({{0, 0, numel}})->view(shape);
+    }
+
+private:
+    static Tensor create(size_t numel, DataType dtype, const Device &device) {
+        Tensor host = Tensor::empty({numel}, dtype, Device::cpu());
+        std::byte *data = host->data();
+        for (size_t i = 0; i < numel; ++i) {
+            if (dtype == DataType::F32) {
+                reinterpret_cast<float *>(data)[i] = 1.0f;
+            } else if (dtype == DataType::F16) {
+                reinterpret_cast<uint16_t *>(data)[i] = 0x3C00;
+            } else if (dtype == DataType::BF16) {
+                reinterpret_cast<uint16_t *>(data)[i] = 0x3F80;
+            } else {
+                throw std::runtime_error("Composite pooling: unsupported dtype");
+            }
+        }
+        return infinidemo::nn::debug::toDevice(host, device);
+    }
+
+    Tensor snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return ones_;
+    }
+
+    mutable std::mutex mutex_;
+    Tensor ones_;
+};
+
+// 每个输出位置至少有一个 tap 落在输入内时返回 true。firstTapSegments 的各段互不相交，总长度等于输出大小即完全覆盖
+inline bool coversOutput(const std::vector<TapRange> &segments, size_t output_size) {
+    size_t covered = 0;
+    for (const auto &segment : segments) {
+        covered += segment.end - segment.begin;
+    }
+    return covered == output_size;
+}
+
+} // namespace composite_pool2d
+
+// 执行组合MaxPool2D操作: output = max_pool2d(input)，结果与 performMaxPool2d 一致
+inline infiniStatus_t performCompositeMaxPool2d(const Tensor &tensor_input,
+                                                Tensor &tensor_output, int kernel_h,
+                                                int kernel_w, int stride_h, int stride_w,
+                                                int padding_h, int padding_w,
+                                                int dilation_h, int dilation_w,
+                                                bool ceil_mode, Device device) {
+    INFINIDEMO_PROFILE_OP("CompositeMaxPool2d", tensor_output, tensor_input);
+    using namespace composite_pool2d;
+    const auto &in_shape = tensor_input->shape();
+    const auto &out_shape = tensor_output->shape();
+    auto h_ranges = tapRanges(in_shape[2], out_shape[2], kernel_h, stride_h, padding_h, dilation_h);
+    auto w_ranges = tapRanges(in_shape[3], out_shape[3], kernel_w, stride_w, padding_w, dilation_w);
+
+    // 用每个输出位置的第一个有效 tap 初始化输出（padding 位置视为 -inf，不参与）。
+    // 整个窗口都落在 padding 中的输出没有有效 tap，与 PyTorch 一样拒绝这种配置（padding 不超过 kernel 的一半时不会出现）
+    auto h_segments = firstTapSegments(h_ranges);
+    auto w_segments = firstTapSegments(w_ranges);
+    if (!coversOutput(h_segments, out_shape[2]) || !coversOutput(w_segments, out_shape[3])) {
+        std::cerr << "Composite MaxPool2D: some pooling windows lie entirely in the padding" << std::endl;
+        return INFINI_STATUS_BAD_PARAM;
+    }
+    for (const auto &h : h_segments) {
+        for (const auto &w : w_segments) {
+            outputView(tensor_output, h, w)->copy_from(
+                tapView(tensor_input, h, w, stride_h, stride_w, padding_h, padding_w, dilation_h, dilation_w));
+        }
+    }
+
+    // out = out + relu(tap - out)
+    Tensor scratch = infinidemo::nn::empty(out_shape, tensor_output->dtype(), device);
+    for (const auto &h : h_ranges) {
+        for (const auto &w : w_ranges) {
+            if ((h.begin >= h.end) || (w.begin >= w.end)) {
+                continue;
+            }
+            Tensor out_view = outputView(tensor_output, h, w);
+            Tensor diff = outputView(scratch, h, w);
+            Tensor tap = tapView(tensor_input, h, w, stride_h, stride_w, padding_h, padding_w, dilation_h, dilation_w);
+
+            infiniStatus_t status = performSub(diff, tap, out_view, device);
+            if (status != INFINI_STATUS_SUCCESS) {
+                return status;
+            }
+            status = performRelu(diff, diff, device);
+            if (status != INFINI_STATUS_SUCCESS) {
+                return status;
+            }
+            status = performAdd(out_view, out_view, diff, device);
+            if (status != INFINI_STATUS_SUCCESS) {
+                return status;
+            }
+        }
+    }
+    return INFINI_STATUS_SUCCESS;
+}
+
+// 执行组合AvgPool2D操作: output = avg_pool2d(input)，padding 计入分母（count_include_pad）
+inline infiniStatus_t performCompositeAvgPool2d(const Tensor &tensor_input,
+                                                Tensor &tensor_output, int kernel_h,
+                                                int kernel_w, int stride_h, int stride_w,
+                                                int padding_h, int padding_w,
+                                                int dilation_h, int dilation_w,
+                                                bool ceil_mode, composite_pool2d::OnesCache &ones, Device device) {
+    INFINIDEMO_PROFILE_OP("CompositeAvgPool2d", tensor_output, tensor_input);
+    using namespace composite_pool2d;
+    if (ceil_mode) {
+        std::cerr << "Composite AvgPool2D does not support ceil_mode" << std::endl;
+        return INFINI_STATUS_BAD_PARAM;
+    }
+
+    const auto &in_shape = tensor_input->shape();
+    const auto &out_shape = tensor_output->shape();
+    size_t rows = out_shape[0] * out_shape[1];
+    float alpha = 1.0f / static_cast<float>(kernel_h * kernel_w);
+
+    // 全局平均池化（ResNet 的最后一层）：[N*C, H*W] x ones[H*W, 1]，一次 GEMM 完成
+    bool global = (padding_h == 0) && (padding_w == 0) && (out_shape[2] == 1) && (out_shape[3] == 1)
+               && (static_cast<size_t>(kernel_h) == in_shape[2]) && (static_cast<size_t>(kernel_w) == in_shape[3])
+               && tensor_input->is_contiguous() && tensor_output->is_contiguous();
+    if (global) {
+        size_t spatial = in_shape[2] * in_shape[3];
+        Tensor a = tensor_input->view({rows, spatial});
+        Tensor c = tensor_output->view({rows, 1});
+        return performGemm(c, a, ones.get({spatial, 1}, tensor_input->dtype(), device), alpha, 0.0f, device);
+    }
+
+    // 一般情况：逐 tap 累加，再用 [N*C*OH*OW, 1] x ones[1, 1] 的 GEMM 乘以 1 / (kh * kw)
+    Tensor sum = infinidemo::nn::zeros(out_shape, tensor_output->dtype(), device);
+    auto h_ranges = tapRanges(in_shape[2], out_shape[2], kernel_h, stride_h, padding_h, dilation_h);
+    auto w_ranges = tapRanges(in_shape[3], out_shape[3], kernel_w, stride_w, padding_w, dilation_w);
+    for (const auto &h : h_ranges) {
+        for (const auto &w : w_ranges) {
+            if ((h.begin >= h.end) || (w.begin >= w.end)) {
+                continue;
+            }
+            Tensor sum_view = outputView(sum, h, w);
+            infiniStatus_t status = performAdd(
+                sum_view, sum_view,
+                tapView(tensor_input, h, w, stride_h, stride_w, padding_h, padding_w, dilation_h, dilation_w), device);
+            if (status != INFINI_STATUS_SUCCESS) {
+                return status;
+            }
+        }
+    }
+
+    size_t numel = rows * out_shape[2] * out_shape[3];
+    Tensor c = tensor_output->is_contiguous() ? tensor_output->view({numel, 1}) : infinidemo::nn::empty({numel, 1}, tensor_output->dtype(), device);
+    infiniStatus_t status = performGemm(c, sum->view({numel, 1}), ones.get({1, 1}, tensor_input->dtype(), device), alpha, 0.0f, device);
+    if ((status == INFINI_STATUS_SUCCESS) && !tensor_output->is_contiguous()) {
+        tensor_output->copy_from(c->view(out_shape));
+    }
+    return status;
+}
+
+} // namespace infinidemo::nn::functional
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../allocator.hpp"
+#include "../profiler.hpp"
 #include <cstddef>
 #include <infinicore/context/context.hpp>
 #include <infinicore/device.hpp>
@@ -16,11 +18,11 @@ using namespace infinicore;
 // Performs 2D Convolution operation
 inline infiniStatus_t performConv2D(Tensor &output, const Tensor &input,
                                     const Tensor &weight, const Tensor &bias,
-                                    std::vector<ptrdiff_t> strides,
-                                    std::vector<size_t> pads,
-                                    std::vector<size_t> dilations,
+                                    const std::vector<ptrdiff_t> &strides,
+                                    const std::vector<size_t> &pads,
+                                    const std::vector<size_t> &dilations,
                                     Device device) {
-
+    INFINIDEMO_PROFILE_OP("Conv2D", output, input, weight);
     // Create InfiniOP handle
     infiniopHandle_t handle = context::getInfiniopHandle(device);
 
@@ -33,6 +35,7 @@ inline infiniStatus_t performConv2D(Tensor &output, const Tensor &input,
         const_cast<void *>(static_cast<const void *>(strides.data())),
         const_cast<void *>(static_cast<const void *>(dilations.data())),
         pads.size());
+    INFINIDEMO_PROFILE_DESCRIPTOR_CREATED();
 
     if (status != INFINI_STATUS_SUCCESS) {
         std::cerr << "Failed to create Conv descriptor: " << status << std::endl;
@@ -52,7 +55,7 @@ inline infiniStatus_t performConv2D(Tensor &output, const Tensor &input,
     void *workspace = nullptr;
     std::shared_ptr<Memory> workspace_memory = nullptr;
     if (workspace_size > 0) {
-        workspace_memory = context::allocateMemory(workspace_size);
+        workspace_memory = infinidemo::nn::allocateWorkspace(workspace_size);
         workspace = workspace_memory->data();
     }
 
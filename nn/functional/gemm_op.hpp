@@ -1,20 +1,26 @@
 #pragma once
 
+#include "../allocator.hpp"
+#include "../profiler.hpp"
+#include "gemm_tuning.hpp"
 #include <infinicore/context/context.hpp>
 #include <infinicore/device.hpp>
 #include <infinicore/tensor.hpp>
 #include <infiniop.h>
 #include <infinirt.h>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <mutex>
 
 namespace infinidemo::nn::functional {
 using namespace infinicore;
 
-// Performs GEMM operation: C = alpha * A * B + beta * C
-inline infiniStatus_t performGemm(Tensor &tensor_C, const Tensor &tensor_A,
-                                  const Tensor &tensor_B, float alpha,
-                                  float beta, Device device) {
+// 按原样调用 infiniopGemm: C = alpha * A * B + beta * C
+inline infiniStatus_t launchGemm(Tensor &tensor_C, const Tensor &tensor_A,
+                                 const Tensor &tensor_B, float alpha,
+                                 float beta, Device device) {
+    INFINIDEMO_PROFILE_OP("Gemm", tensor_C, tensor_A, tensor_B);
     // Create InfiniOP handle
     infiniopHandle_t handle = context::getInfiniopHandle(device);
 
@@ -22,6 +28,7 @@ inline infiniStatus_t performGemm(Tensor &tensor_C, const Tensor &tensor_A,
     infiniopGemmDescriptor_t gemm_desc = nullptr;
     infiniStatus_t status = infiniopCreateGemmDescriptor(
         handle, &gemm_desc, tensor_C->desc(), tensor_A->desc(), tensor_B->desc());
+    INFINIDEMO_PROFILE_DESCRIPTOR_CREATED();
     if (status != INFINI_STATUS_SUCCESS) {
         std::cerr << "Failed to create GEMM descriptor: " << status << std::endl;
         return status;
@@ -39,7 +46,7 @@ inline infiniStatus_t performGemm(Tensor &tensor_C, const Tensor &tensor_A,
     void *workspace = nullptr;
     std::shared_ptr<Memory> workspace_memory = nullptr;
     if (workspace_size > 0) {
-        workspace_memory = context::allocateMemory(workspace_size);
+        workspace_memory = infinidemo::nn::allocateWorkspace(workspace_size);
         workspace = workspace_memory->data();
     }
 
@@ -60,4 +67,73 @@ inline infiniStatus_t performGemm(Tensor &tensor_C, const Tensor &tensor_A,
     return INFINI_STATUS_SUCCESS;
 }
 
+// 以指定的执行方式计算 C = alpha * A * B + beta * C，结果与 launchGemm 一致
+inline infiniStatus_t performGemmWithAlgo(Tensor &tensor_C, const Tensor &tensor_A,
+                                          const Tensor &tensor_B, float alpha,
+                                          float beta, GemmAlgo algo, Device device) {
+    if (tensor_C->ndim() != 2) {
+        return launchGemm(tensor_C, tensor_A, tensor_B, alpha, beta, device);
+    }
+    switch (algo) {
+    case GemmAlgo::Transposed: {
+        // C^T = B^T * A^T，三个都是零拷贝的转置视图
+        Tensor tensor_Ct = tensor_C->permute({1, 0});
+        return launchGemm(tensor_Ct, tensor_B->permute({1, 0}), tensor_A->permute({1, 0}), alpha, beta, device);
+    }
+    case GemmAlgo::ContiguousB:
+        return launchGemm(tensor_C, tensor_A, tensor_B->is_contiguous() ? tensor_B : tensor_B->contiguous(), alpha, beta, device);
+    default:
+        return launchGemm(tensor_C, tensor_A, tensor_B, alpha, beta, device);
+    }
+}
+
+// ContiguousB 使用的 B 的行主序副本，由 B 为权重视图的模块持有：
+// 只有 B 的数据指针、形状或 epoch（参数每次变化后递增）改变时才重新打包，而不是每次 GEMM 都拷贝一次权重
+class PackedOperand {
+public:
+    PackedOperand() = default;
+    PackedOperand(const PackedOperand &other) { copyFrom(other); }
+    PackedOperand &operator=(const PackedOperand &other) {
+        if (this != &other) {
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    Tensor get(const Tensor &source, uint64_t epoch) {
+        if (source->is_contiguous()) {
+            return source;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!packed_ || (source_data_ != source->data()) || (epoch_ != epoch) || (packed_->shape() != source->shape())) {
+            packed_ = source->contiguous();
+            source_data_ = source->data();
+            epoch_ = epoch;
+        }
+        return packed_;
+    }
+
+private:
+    void copyFrom(const PackedOperand &other) {
+        std::scoped_lock lock(mutex_, other.mutex_);
+        packed_ = other.packed_;
+        source_data_ = other.source_data_;
+        epoch_ = other.epoch_;
+    }
+
+    mutable std::mutex mutex_;
+    Tensor packed_;
+    const void *source_data_ = nullptr;
+    uint64_t epoch_ = 0;
+};
+
+// Performs GEMM operation: C = alpha * A * B + beta * C
+// 若 INFINIDEMO_GEMM_TUNING_CACHE 中有该形状的调优记录，则使用记录的执行方式
+inline infiniStatus_t performGemm(Tensor &tensor_C, const Tensor &tensor_A,
+                                  const Tensor &tensor_B, float alpha,
+                                  float beta, Device device) {
+    GemmAlgo algo = GemmTuningCache::instance().lookup(tensor_C, tensor_A, tensor_B, device);
+    return performGemmWithAlgo(tensor_C, tensor_A, tensor_B, alpha, beta, algo, device);
+}
+
 } // namespace infinidemo::nn::functional
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+// GEMM 调优缓存：test_gemm 的 autotune 模式为每个形状挑选最快的执行方式并写入缓存文件，
+// performGemm 在运行时通过环境变量 INFINIDEMO_GEMM_TUNING_CACHE 指定的文件查表。
+//
+// 缓存文件每行一条记录：
+//   <device_type> <dtype> <M> <N> <K> <a_layout> <b_layout> <algo> [gflops]
+// layout 取值 row / col / strided，algo 取值见 GemmAlgo
+namespace infinidemo::nn::functional {
+using namespace infinicore;
+
+enum class GemmAlgo {
+    Default,     // 按原样调用 infiniopGemm
+    Transposed,  // 计算 C^T = B^T * A^T，换一种内存布局走后端的另一条 kernel 路径
+    ContiguousB, // 先把 B 拷成行主序连续内存，适合 B 为转置权重视图的瘦长形状
+};
+
+inline const char *toString(GemmAlgo algo) {
+    switch (algo) {
+    case GemmAlgo::Transposed:
+        return "transposed";
+    case GemmAlgo::ContiguousB:
+        return "contiguous_b";
+    default:
+        return "default";
+    }
+}
+
+// 无法识别的名字返回 false，algo 不变
+inline bool parseGemmAlgo(const std::string &name, GemmAlgo &algo) {
+    if (name == "transposed") {
+        algo = GemmAlgo::Transposed;
+    } else if (name == "contiguous_b") {
+        algo = GemmAlgo::ContiguousB;
+    } else if (name == "default") {
+        algo = GemmAlgo::Default;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 二维矩阵的内存布局
+inline const char *matrixLayout(const Tensor &t) {
+    const auto &strides = t->strides();
+    if (strides[1] == 1) {
+        return "row";
+    }
+    if (strides[0] == 1) {
+        return "col";
+    }
+    return "strided";
+}
+
+struct GemmTuningKey {
+    int device_type;
+    int dtype;
+    size_t m;
+    size_t n;
+    size_t k;
+    std::string a_layout;
+    std::string b_layout;
+
+    bool operator<(const GemmTuningKey &other) const {
+        return std::tie(device_type, dtype, m, n, k, a_layout, b_layout)
+             < std::tie(other.device_type, other.dtype, other.m, other.n, other.k, other.a_layout, other.b_layout);
+    }
+};
+
+struct GemmTuningEntry {
+    GemmAlgo algo = GemmAlgo::Default;
+    double gflops = 0.0;
+};
+
+class GemmTuningCache {
+public:
+    static GemmTuningCache &instance() {
+        static GemmTuningCache cache;
+        return cache;
+    }
+
+    static GemmTuningKey makeKey(const Tensor &c, const Tensor &a, const Tensor &b, const Device &device) {
+        return {static_cast<int>(device.getType()), static_cast<int>(c->dtype()),
+                c->shape()[0], c->shape()[1], a->shape()[1], matrixLayout(a), matrixLayout(b)};
+    }
+
+    // 未加载任何记录时只有一次原子读，不影响默认路径。
+    // 每次调用都要构造 key 并加锁查表，热路径上应按形状解析一次后保存结果（见 Linear），用 generation() 判断是否过期
+    GemmAlgo lookup(const Tensor &c, const Tensor &a, const Tensor &b, const Device &device) {
+        if (!has_entries_.load(std::memory_order_acquire) || (c->ndim() != 2)) {
+            return GemmAlgo::Default;
+        }
+        return lookup(makeKey(c, a, b, device));
+    }
+
+    GemmAlgo lookup(const GemmTuningKey &key) {
+        if (!has_entries_.load(std::memory_order_acquire)) {
+            return GemmAlgo::Default;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        return it == entries_.end() ? GemmAlgo::Default : it->second.algo;
+    }
+
+    // 记录每次变化（set / clear / load）后递增
+    uint64_t generation() const { return generation_.load(std::memory_order_acquire); }
+
+    void set(const GemmTuningKey &key, const GemmTuningEntry &entry) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[key] = entry;
+        has_entries_.store(true, std::memory_order_release);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+        has_entries_.store(false, std::memory_order_release);
+        generation_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return entries_.size();
+    }
+
+    // 读取缓存文件，文件不存在时返回 false
+    bool load(const std::string &path) {
+        std::ifstream file(path);
+        if (!file) {
+            return false;
+        }
+        std::string line;
+        size_t line_no = 0;
+        while (std::getline(file, line)) {
+            ++line_no;
+            if (line.empty() || (line[0] == '#')) {
+                continue;
+            }
+            std::istringstream is(line);
+            GemmTuningKey key;
+            std::string algo;
+            GemmTuningEntry entry;
+            if (!(is >> key.device_type >> key.dtype >> key.m >> key.n >> key.k >> key.a_layout >> key.b_layout >> algo)) {
+                std::cerr << "Ignoring malformed GEMM tuning record at " << path << ":" << line_no << std::endl;
+                continue;
+            }
+            if (!parseGemmAlgo(algo, entry.algo)) {
+                std::cerr << "Ignoring unknown GEMM algo '" << algo << "' at " << path << ":" << line_no << std::endl;
+                continue;
+            }
+            is >> entry.gflops;
+            set(key, entry);
+        }
+        return true;
+    }
+
+    void save(const std::string &path) const {
+        std::ofstream file(path);
+        if (!file) {
+            throw std::runtime_error("Failed to open GEMM tuning cache for writing: " + path);
+        }
+        file << "# device_type dtype M N K a_layout b_layout algo gflops\n";
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto &[key, entry] : entries_) {
+            file << key.device_type << " " << key.dtype << " " << key.m << " " << key.n << " " << key.k << " "
+                 << key.a_layout << " " << key.b_layout << " " << toString(entry.algo) << " " << entry.gflops << "\n";
+        }
+    }
+
+private:
+    GemmTuningCache() {
+        // 在第一次 GEMM 时构造，任何错误都只记录日志并回退到默认执行方式，不能让推理因调优文件失败
+        const char *path = std::getenv("INFINIDEMO_GEMM_TUNING_CACHE");
+        if ((path != nullptr) && (path[0] != '\0')) {
+            try {
+                if (!load(path)) {
+                    std::cerr << "GEMM tuning cache not found: " << path << ", using default algorithms" << std::endl;
+                }
+            } catch (const std::exception &error) {
+                std::cerr << "Failed to load GEMM tuning cache " << path << ": " << error.what() << ", using default algorithms" << std::endl;
+                clear();
+            }
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::map<GemmTuningKey, GemmTuningEntry> entries_;
+    std::atomic<bool> has_entries_{false};
+    std::atomic<uint64_t> generation_{0};
+};
+
+} // namespace infinidemo::nn::functional
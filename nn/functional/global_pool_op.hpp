@@ -0,0 +1,163 @@
+#pragma once
+
+#include "../allocator.hpp"
+#include "../debug.hpp"
+#include "../profiler.hpp"
+#include "avg_pool2d_op.hpp"
+#include "composite_pool2d_op.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <infiniop.h>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 全局平均池化 [N, C, H, W] -> [N, C]，可选在同一遍中完成每行的 L2 归一化（用于检索的 embedding）。
+// CPU 上只遍历一次输入：逐通道求均值的同时累加平方和，最后在 cache 中的 C 个结果上按行缩放，没有中间 tensor。
+// 其它设备先用 kernel = H x W 的 AvgPool2d 在设备上池化，需要归一化时再用 RMSNorm 在设备上完成，不经过 host
+namespace infinidemo::nn::functional {
+using namespace infinicore;
+
+// 与 torch.nn.functional.normalize 相同：x / max(||x||, eps)
+constexpr double kL2NormalizeEps = 1e-12;
+
+inline void globalAvgPoolHost(const float *input, float *output, size_t batch, size_t channels, size_t spatial, bool l2_normalize) {
+    const float inv_spatial = 1.0f / static_cast<float>(spatial);
+    for (size_t n = 0; n < batch; ++n) {
+        float *row = output + n * channels;
+        double squares = 0.0;
+        for (size_t c = 0; c < channels; ++c) {
+            const float *plane = input + (n * channels + c) * spatial;
+            float sum = 0.0f;
+            for (size_t k = 0; k < spatial; ++k) {
+                sum += plane[k];
+            }
+            row[c] = sum * inv_spatial;
+            squares += static_cast<double>(row[c]) * row[c];
+        }
+        if (l2_normalize) {
+            float scale = static_cast<float>(1.0 / std::max(std::sqrt(squares), kL2NormalizeEps));
+            for (size_t c = 0; c < channels; ++c) {
+                row[c] *= scale;
+            }
+        }
+    }
+}
+
+// 设备端的 L2 归一化借用 RMSNorm：y = x / sqrt(mean(x^2) + eps) * w，w 取常量 1 / sqrt(C) 时 y = x / sqrt(||x||^2 + C * eps)。
+// eps = kL2NormalizeEps^2 / C，与 max(||x||, kL2NormalizeEps) 只在 ||x|| 接近 eps 时有差别。
+// w 按 (C, 设备) 缓存，由 GlobalAvgPool2d 持有，拷贝模块时共享
+class L2NormWeight {
+public:
+    L2NormWeight() = default;
+    L2NormWeight(const L2NormWeight &other) : weight_(other.snapshot()) {}
+    L2NormWeight &operator=(const L2NormWeight &other) {
+        if (this != &other) {
+            Tensor weight = other.snapshot();
+            std::lock_guard<std::mutex> lock(mutex_);
+            weight_ = weight;
+        }
+        return *this;
+    }
+
+    Tensor get(size_t channels, const Device &device) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!weight_ || (weight_->numel() != channels) || !infinidemo::nn::debug::sameDevice(weight_->device(), device)) {
+            Tensor host = Tensor::empty({channels}, DataType::F32, Device::cpu());
+            std::fill_n(reinterpret_cast<float *>(host->data()), channels, static_cast<float>(1.0 / std::sqrt(static_cast<double>(channels))));
+            weight_ = infinidemo::nn::debug::toDevice(host, device);
+        }
+        return weight_;
+    }
+
+private:
+    Tensor snapshot() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return weight_;
+    }
+
+    mutable std::mutex mutex_;
+    Tensor weight_;
+};
+
+// output = input / ||input||，按行归一化 [N, C]；output 与 input 不能是同一块内存
+inline infiniStatus_t performL2NormalizeRows(Tensor &output, const Tensor &input, L2NormWeight &weight, Device device) {
+    INFINIDEMO_PROFILE_OP("L2Normalize", output, input);
+    size_t channels = input->shape()[1];
+    Tensor w = weight.get(channels, device);
+    float epsilon = static_cast<float>(kL2NormalizeEps * kL2NormalizeEps / static_cast<double>(channels));
+
+    infiniopHandle_t handle = context::getInfiniopHandle(device);
+    infiniopRMSNormDescriptor_t desc = nullptr;
+    infiniStatus_t status = infiniopCreateRMSNormDescriptor(handle, &desc, output->desc(), input->desc(), w->desc(), epsilon);
+    INFINIDEMO_PROFILE_DESCRIPTOR_CREATED();
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to create RMSNorm descriptor: " << status << std::endl;
+        return status;
+    }
+
+    size_t workspace_size = 0;
+    status = infiniopGetRMSNormWorkspaceSize(desc, &workspace_size);
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to get workspace size: " << status << std::endl;
+        infiniopDestroyRMSNormDescriptor(desc);
+        return status;
+    }
+    void *workspace = nullptr;
+    std::shared_ptr<Memory> workspace_memory = nullptr;
+    if (workspace_size > 0) {
+        workspace_memory = infinidemo::nn::allocateWorkspace(workspace_size);
+        workspace = workspace_memory->data();
+    }
+
+    status = infiniopRMSNorm(desc, workspace, workspace_size, output->data(), input->data(), w->data(), context::getStream());
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to execute RMSNorm: " << status << std::endl;
+    }
+    infiniopDestroyRMSNormDescriptor(desc);
+    return status;
+}
+
+// tensor_input: 连续的 F32 [N, C, H, W]；tensor_output: 连续的 [N, C]
+// ones: use_composite 时组合池化使用的常量缓存；norm_weight: 设备上 l2_normalize 使用的常量，均由调用的模块持有
+inline infiniStatus_t performGlobalAvgPool(const Tensor &tensor_input, Tensor &tensor_output, bool l2_normalize,
+                                           bool use_composite, composite_pool2d::OnesCache &ones, L2NormWeight &norm_weight, Device device) {
+    INFINIDEMO_PROFILE_OP("GlobalAvgPool", tensor_output, tensor_input);
+    const Shape &shape = tensor_input->shape();
+    if ((shape.size() != 4) || (tensor_output->shape() != Shape{shape[0], shape[1]})) {
+        std::cerr << "GlobalAvgPool expects [N, C, H, W] -> [N, C]" << std::endl;
+        return INFINI_STATUS_BAD_TENSOR_SHAPE;
+    }
+    if ((tensor_input->dtype() != DataType::F32) || !tensor_input->is_contiguous()) {
+        std::cerr << "GlobalAvgPool expects a contiguous F32 input" << std::endl;
+        return INFINI_STATUS_BAD_PARAM;
+    }
+    size_t batch = shape[0];
+    size_t channels = shape[1];
+
+    if (device.getType() == Device::Type::CPU) {
+        globalAvgPoolHost(reinterpret_cast<const float *>(tensor_input->data()), reinterpret_cast<float *>(tensor_output->data()),
+                          batch, channels, shape[2] * shape[3], l2_normalize);
+        return INFINI_STATUS_SUCCESS;
+    }
+
+    // 需要归一化时先池化到临时的 [N, C]，再由 RMSNorm 写入 tensor_output
+    Tensor pooled_rows = l2_normalize ? infinidemo::nn::empty({batch, channels}, tensor_output->dtype(), device) : tensor_output;
+    Tensor pooled = pooled_rows->view({batch, channels, 1, 1});
+    int kernel_h = static_cast<int>(shape[2]);
+    int kernel_w = static_cast<int>(shape[3]);
+    infiniStatus_t status = use_composite
+                              ? performCompositeAvgPool2d(tensor_input, pooled, kernel_h, kernel_w, kernel_h, kernel_w, 0, 0, 1, 1, false, ones, device)
+                              : performAvgPool2d(tensor_input, pooled, kernel_h, kernel_w, kernel_h, kernel_w, 0, 0, 1, 1, false, device);
+    if ((status != INFINI_STATUS_SUCCESS) || !l2_normalize) {
+        return status;
+    }
+    return performL2NormalizeRows(tensor_output, pooled_rows, norm_weight, device);
+}
+
+} // namespace infinidemo::nn::functional
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../allocator.hpp"
+#include "../profiler.hpp"
 #include <infinicore/context/context.hpp>
 #include <infinicore/device.hpp>
 #include <infinicore/tensor.hpp>
@@ -14,6 +16,7 @@ using namespace infinicore;
 // Performs ReLU activation operation: y = max(0, x)
 inline infiniStatus_t performRelu(Tensor &output, const Tensor &input,
                                   Device device) {
+    INFINIDEMO_PROFILE_OP("Relu", output, input);
     // Create InfiniOP handle
     infiniopHandle_t handle = context::getInfiniopHandle(device);
 
@@ -21,6 +24,7 @@ inline infiniStatus_t performRelu(Tensor &output, const Tensor &input,
     infiniopReluDescriptor_t relu_desc = nullptr;
     infiniStatus_t status = infiniopCreateReluDescriptor(
         handle, &relu_desc, output->desc(), input->desc());
+    INFINIDEMO_PROFILE_DESCRIPTOR_CREATED();
 
     if (status != INFINI_STATUS_SUCCESS) {
         std::cerr << "Failed to create ReLU descriptor: " << status << std::endl;
@@ -40,7 +44,7 @@ inline infiniStatus_t performRelu(Tensor &output, const Tensor &input,
     void *workspace = nullptr;
     std::shared_ptr<Memory> workspace_memory = nullptr;
     if (workspace_size > 0) {
-        workspace_memory = context::allocateMemory(workspace_size);
+        workspace_memory = infinidemo::nn::allocateWorkspace(workspace_size);
         workspace = workspace_memory->data();
     }
 
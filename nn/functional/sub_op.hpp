@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../allocator.hpp"
+#include "../profiler.hpp"
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <infiniop.h>
+#include <infinirt.h>
+#include <iostream>
+#include <memory>
+
+namespace infinidemo::nn::functional {
+using namespace infinicore;
+
+// Performs Sub operation: C = A - B
+inline infiniStatus_t performSub(Tensor &out, const Tensor &input,
+                                 const Tensor &other, Device device) {
+    INFINIDEMO_PROFILE_OP("Sub", out, input, other);
+    // Create InfiniOP handle
+    infiniopHandle_t handle = context::getInfiniopHandle(device);
+
+    // Create Sub descriptor
+    infiniopSubDescriptor_t sub_desc = nullptr;
+    infiniStatus_t status = infiniopCreateSubDescriptor(
+        handle, &sub_desc, out->desc(), input->desc(), other->desc());
+    INFINIDEMO_PROFILE_DESCRIPTOR_CREATED();
+
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to create Sub descriptor: " << status << std::endl;
+        return status;
+    }
+
+    // Get workspace size
+    size_t workspace_size = 0;
+    status = infiniopGetSubWorkspaceSize(sub_desc, &workspace_size);
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to get workspace size: " << status << std::endl;
+        infiniopDestroySubDescriptor(sub_desc);
+        return status;
+    }
+
+    // Allocate workspace
+    void *workspace = nullptr;
+    std::shared_ptr<Memory> workspace_memory = nullptr;
+    if (workspace_size > 0) {
+        workspace_memory = infinidemo::nn::allocateWorkspace(workspace_size);
+        workspace = workspace_memory->data();
+    }
+
+    // Execute Sub operator
+    status = infiniopSub(sub_desc, workspace, workspace_size, out->data(),
+                         input->data(), other->data(), context::getStream());
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to execute Sub: " << status << std::endl;
+        infiniopDestroySubDescriptor(sub_desc);
+        return status;
+    }
+
+    // Clean up resources
+    infiniopDestroySubDescriptor(sub_desc);
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+} // namespace infinidemo::nn::functional
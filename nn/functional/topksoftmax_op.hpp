@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../allocator.hpp"
+#include "../profiler.hpp"
+#include <infinicore/context/context.hpp>
+#include <infinicore/device.hpp>
+#include <infinicore/tensor.hpp>
+#include <infiniop.h>
+#include <infinirt.h>
+#include <iostream>
+#include <memory>
+
+namespace infinidemo::nn::functional {
+using namespace infinicore;
+
+// Performs fused softmax + top-k over the last dimension of input [N, C]:
+//   values  = topk(softmax(input)), F32 [N, topk]，从大到小
+//   indices = 对应的类别下标, I32 [N, topk]
+// normalize 为 true 时 values 在 top-k 内重新归一化（和为 1），否则为完整 softmax 的概率
+inline infiniStatus_t performTopksoftmax(Tensor &values, Tensor &indices, const Tensor &input,
+                                         size_t topk, bool normalize, Device device) {
+    INFINIDEMO_PROFILE_OP("Topksoftmax", values, input);
+    infiniopHandle_t handle = context::getInfiniopHandle(device);
+
+    // 创建Topksoftmax descriptor
+    infiniopTopksoftmaxDescriptor_t topksoftmax_desc = nullptr;
+    infiniStatus_t status = infiniopCreateTopksoftmaxDescriptor(handle, &topksoftmax_desc, input->desc());
+    INFINIDEMO_PROFILE_DESCRIPTOR_CREATED();
+
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to create Topksoftmax descriptor: " << status << std::endl;
+        return status;
+    }
+
+    // 获取workspace大小
+    size_t workspace_size = 0;
+    status = infiniopGetTopksoftmaxWorkspaceSize(topksoftmax_desc, &workspace_size);
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to get workspace size: " << status << std::endl;
+        infiniopDestroyTopksoftmaxDescriptor(topksoftmax_desc);
+        return status;
+    }
+
+    // 分配workspace
+    void *workspace = nullptr;
+    std::shared_ptr<Memory> workspace_memory = nullptr;
+    if (workspace_size > 0) {
+        workspace_memory = infinidemo::nn::allocateWorkspace(workspace_size);
+        workspace = workspace_memory->data();
+    }
+
+    // 执行Topksoftmax
+    status = infiniopTopksoftmax(topksoftmax_desc, workspace, workspace_size, values->data(), indices->data(),
+                                 input->data(), topk, normalize ? 1 : 0, context::getStream());
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to execute Topksoftmax: " << status << std::endl;
+        infiniopDestroyTopksoftmaxDescriptor(topksoftmax_desc);
+        return status;
+    }
+
+    // 清理资源
+    infiniopDestroyTopksoftmaxDescriptor(topksoftmax_desc);
+
+    return INFINI_STATUS_SUCCESS;
+}
+
+} // namespace infinidemo::nn::functional
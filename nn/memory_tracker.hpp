@@ -0,0 +1,398 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <infinicore/device.hpp>
+#include <infinicore/memory.hpp>
+#include <infinicore/tensor.hpp>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 内存统计：记录 nn::empty / nn::zeros / allocateWorkspace 以及 RootModule::to_slab 的参数 slab 与 staging buffer，
+// 按设备统计当前与峰值字节数，按大小（2 的幂）分桶的直方图，并归属到分配时所在的模块路径
+// （最内层有路径的 Module::forward，例如 "resnet.encoder.stages.2.layers.0"）与阶段（forward / to / load_state_dict）。
+//
+// 释放按 storage 检测：一次分配对应一个 storage，持有者是分配出的 tensor（或 workspace 的 Memory）以及用 shareStorage
+// 登记的视图（Flatten 的输出、参数 slab 的 narrow 视图等），全部持有者析构后在下一次分配或查询时扣除。
+// infinicore 不暴露 tensor 底层的 Memory，没有登记的视图不会延长 storage 的生命周期；infinicore 内部的分配（如 Tensor::to 的临时 buffer）不可见。
+// 运行时开关（_infinidemo.memory.enable() 或环境变量 INFINIDEMO_TRACK_MEMORY=1），关闭时每次分配只多一次原子读
+namespace infinidemo::nn::memory {
+using namespace infinicore;
+
+struct DeviceMemoryStats {
+    std::string device;
+    size_t current_bytes = 0;
+    size_t peak_bytes = 0;
+    size_t allocated_bytes = 0; // reset 以来累计分配
+    size_t allocations = 0;
+    size_t frees = 0;
+};
+
+struct ModuleMemoryStats {
+    std::string module;
+    size_t current_bytes = 0;
+    size_t peak_bytes = 0;
+    size_t allocated_bytes = 0;
+    size_t allocations = 0;
+};
+
+struct PhaseMemoryStats {
+    std::string phase;
+    size_t allocated_bytes = 0;
+    size_t allocations = 0;
+};
+
+struct MemoryStats {
+    std::vector<DeviceMemoryStats> devices;
+    std::vector<ModuleMemoryStats> modules; // 按峰值降序
+    std::vector<PhaseMemoryStats> phases;
+    std::vector<std::pair<size_t, size_t>> histogram; // (桶上界字节数, 次数)，大小在 (上界 / 2, 上界] 之间的分配
+
+    std::string toString(size_t top_modules = 16) const {
+        auto mb = [](size_t bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(3);
+        os << std::left << std::setw(16) << "device" << std::right << std::setw(14) << "current(MB)" << std::setw(14) << "peak(MB)"
+           << std::setw(14) << "alloc(MB)" << std::setw(10) << "allocs" << std::setw(10) << "frees" << "\n";
+        for (const auto &d : devices) {
+            os << std::left << std::setw(16) << d.device << std::right << std::setw(14) << mb(d.current_bytes) << std::setw(14) << mb(d.peak_bytes)
+               << std::setw(14) << mb(d.allocated_bytes) << std::setw(10) << d.allocations << std::setw(10) << d.frees << "\n";
+        }
+        os << "\n"
+           << std::left << std::setw(56) << "module" << std::right << std::setw(14) << "current(MB)" << std::setw(14) << "peak(MB)"
+           << std::setw(14) << "alloc(MB)" << std::setw(10) << "allocs" << "\n";
+        for (size_t i = 0; i < std::min(top_modules, modules.size()); ++i) {
+            const auto &m = modules[i];
+            os << std::left << std::setw(56) << m.module << std::right << std::setw(14) << mb(m.current_bytes) << std::setw(14) << mb(m.peak_bytes)
+               << std::setw(14) << mb(m.allocated_bytes) << std::setw(10) << m.allocations << "\n";
+        }
+        os << "\n";
+        for (const auto &p : phases) {
+            os << p.phase << ": " << p.allocations << " allocations, " << mb(p.allocated_bytes) << " MB\n";
+        }
+        os << "\nsize histogram:\n";
+        for (const auto &[upper, count] : histogram) {
+            os << "  <= " << std::setw(12) << upper << " B: " << count << "\n";
+        }
+        return os.str();
+    }
+};
+
+// 不属于任何有路径模块的分配（例如顶层模型自身、runtime 中的输出 tensor）
+inline const std::string kUnattributed = "(unattributed)";
+
+class MemoryTracker {
+public:
+    static MemoryTracker &instance() {
+        static MemoryTracker tracker;
+        return tracker;
+    }
+
+    void enable() { enabled_.store(true, std::memory_order_relaxed); }
+    void disable() { enabled_.store(false, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // 清零累计计数与直方图，峰值重置为当前值；仍存活的分配继续跟踪，之后的释放照常扣除
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reset_();
+    }
+
+    // owner 析构即视为释放（除非之后用 share 登记了同一块内存的视图）
+    template <typename T>
+    void record(const std::shared_ptr<T> &owner, size_t bytes, const Device &device) {
+        if (!enabled() || !owner) {
+            return;
+        }
+        const std::string &module = currentModule();
+        std::lock_guard<std::mutex> lock(mutex_);
+        sweep_();
+        countAllocation_(bytes, device.toString());
+        add_(newStorage_(owner), bytes, device.toString(), module);
+    }
+
+    // view 引用 source 的内存：source 所在 storage 的持有者中加入 view。source 没有被记录时什么都不做
+    void share(const std::shared_ptr<const void> &source, const std::shared_ptr<const void> &view) {
+        if (!enabled() || !source || !view || (source == view)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        sweep_();
+        auto it = storages_.find(source.get());
+        if ((it == storages_.end()) || (storages_.count(view.get()) > 0)) {
+            return;
+        }
+        std::shared_ptr<Storage> storage = it->second;
+        storage->owners.emplace_back(view.get(), view);
+        storages_.emplace(view.get(), std::move(storage));
+    }
+
+    // 一块 slab 按 parts（模块路径, 字节数）拆分归属，直方图与分配次数只计一次
+    void recordSlab(const std::shared_ptr<const void> &slab, size_t bytes, const Device &device,
+                    const std::vector<std::pair<std::string, size_t>> &parts) {
+        if (!enabled() || !slab) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        sweep_();
+        std::string device_name = device.toString();
+        countAllocation_(bytes, device_name);
+        std::shared_ptr<Storage> storage = newStorage_(slab);
+        size_t attributed = 0;
+        for (const auto &[module, part_bytes] : parts) {
+            add_(storage, part_bytes, device_name, module.empty() ? kUnattributed : module);
+            attributed += part_bytes;
+        }
+        // 对齐填充
+        if (bytes > attributed) {
+            add_(storage, bytes - attributed, device_name, kUnattributed);
+        }
+    }
+
+    MemoryStats stats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_();
+    }
+
+    // 读取后立即 reset，两步在同一把锁内完成，其间其它线程的分配不会丢失
+    MemoryStats statsAndReset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        MemoryStats result = stats_();
+        reset_();
+        return result;
+    }
+
+    // 当前线程所在的模块路径与阶段，由 ModuleScope / PhaseScope 设置
+    static const std::string *&threadModule() {
+        thread_local const std::string *module = nullptr;
+        return module;
+    }
+    static const char *&threadPhase() {
+        thread_local const char *phase = nullptr;
+        return phase;
+    }
+
+private:
+    MemoryTracker() {
+        const char *env = std::getenv("INFINIDEMO_TRACK_MEMORY");
+        if ((env != nullptr) && (std::strcmp(env, "0") != 0) && (env[0] != '\0')) {
+            enable();
+        }
+    }
+
+    static constexpr size_t kHistogramBuckets = 64;
+
+    // 一次分配的内存，持有者（原始指针, weak_ptr）全部析构后视为释放
+    struct Storage {
+        std::vector<std::pair<const void *, std::weak_ptr<const void>>> owners;
+    };
+
+    struct Live {
+        std::shared_ptr<Storage> storage;
+        size_t bytes;
+        DeviceMemoryStats *device;
+        ModuleMemoryStats *module;
+    };
+
+    void reset_() {
+        sweep_();
+        for (auto &[name, d] : devices_) {
+            d.peak_bytes = d.current_bytes;
+            d.allocated_bytes = 0;
+            d.allocations = 0;
+            d.frees = 0;
+        }
+        for (auto &[name, m] : modules_) {
+            m.peak_bytes = m.current_bytes;
+            m.allocated_bytes = 0;
+            m.allocations = 0;
+        }
+        phases_.clear();
+        std::fill(std::begin(histogram_), std::end(histogram_), 0);
+    }
+
+    MemoryStats stats_() {
+        sweep_();
+        MemoryStats result;
+        for (const auto &[name, d] : devices_) {
+            result.devices.push_back(d);
+        }
+        for (const auto &[name, m] : modules_) {
+            result.modules.push_back(m);
+        }
+        std::sort(result.modules.begin(), result.modules.end(),
+                  [](const ModuleMemoryStats &a, const ModuleMemoryStats &b) { return a.peak_bytes > b.peak_bytes; });
+        for (const auto &[name, p] : phases_) {
+            result.phases.push_back(p);
+        }
+        for (size_t k = 0; k < kHistogramBuckets; ++k) {
+            if (histogram_[k] > 0) {
+                result.histogram.emplace_back(size_t(1) << k, histogram_[k]);
+            }
+        }
+        return result;
+    }
+
+    static const std::string &currentModule() {
+        const std::string *module = threadModule();
+        return module != nullptr ? *module : kUnattributed;
+    }
+
+    static const char *currentPhase() {
+        if (threadPhase() != nullptr) {
+            return threadPhase();
+        }
+        return threadModule() != nullptr ? "forward" : "other";
+    }
+
+    void countAllocation_(size_t bytes, const std::string &device_name) {
+        size_t bucket = 0;
+        while ((bucket + 1 < kHistogramBuckets) && ((size_t(1) << bucket) < bytes)) {
+            ++bucket;
+        }
+        ++histogram_[bucket];
+        DeviceMemoryStats &d = device_(device_name);
+        d.allocated_bytes += bytes;
+        ++d.allocations;
+        PhaseMemoryStats &p = phases_[currentPhase()];
+        p.phase = currentPhase();
+        p.allocated_bytes += bytes;
+        ++p.allocations;
+    }
+
+    std::shared_ptr<Storage> newStorage_(const std::shared_ptr<const void> &owner) {
+        auto storage = std::make_shared<Storage>();
+        storage->owners.emplace_back(owner.get(), owner);
+        storages_[owner.get()] = storage;
+        return storage;
+    }
+
+    void add_(std::shared_ptr<Storage> storage, size_t bytes, const std::string &device_name, const std::string &module_name) {
+        DeviceMemoryStats &d = device_(device_name);
+        d.current_bytes += bytes;
+        d.peak_bytes = std::max(d.peak_bytes, d.current_bytes);
+        ModuleMemoryStats &m = modules_[module_name];
+        m.module = module_name;
+        m.current_bytes += bytes;
+        m.peak_bytes = std::max(m.peak_bytes, m.current_bytes);
+        m.allocated_bytes += bytes;
+        ++m.allocations;
+        live_.push_back(Live{std::move(storage), bytes, &d, &m});
+    }
+
+    DeviceMemoryStats &device_(const std::string &device_name) {
+        DeviceMemoryStats &d = devices_[device_name];
+        d.device = device_name;
+        return d;
+    }
+
+    // 剔除已经析构的持有者；地址可能被新的 tensor 复用，只删除仍指向本 storage 的索引
+    void prune_(Storage &storage) {
+        auto &owners = storage.owners;
+        for (size_t i = 0; i < owners.size();) {
+            if (owners[i].second.expired()) {
+                auto it = storages_.find(owners[i].first);
+                if ((it != storages_.end()) && (it->second.get() == &storage)) {
+                    storages_.erase(it);
+                }
+                owners[i] = std::move(owners.back());
+                owners.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // 扣除持有者已全部析构的分配（std::map 的元素地址稳定，Live 中保存指针）
+    void sweep_() {
+        for (size_t i = 0; i < live_.size();) {
+            prune_(*live_[i].storage);
+            if (live_[i].storage->owners.empty()) {
+                live_[i].device->current_bytes -= live_[i].bytes;
+                ++live_[i].device->frees;
+                live_[i].module->current_bytes -= live_[i].bytes;
+                live_[i] = std::move(live_.back());
+                live_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    std::atomic<bool> enabled_{false};
+    std::mutex mutex_;
+    std::vector<Live> live_;
+    std::unordered_map<const void *, std::shared_ptr<Storage>> storages_; // 持有者地址 -> storage
+    std::map<std::string, DeviceMemoryStats> devices_;
+    std::map<std::string, ModuleMemoryStats> modules_;
+    std::map<std::string, PhaseMemoryStats> phases_;
+    size_t histogram_[kHistogramBuckets] = {};
+};
+
+// Module::forward 中设置当前模块路径（由 INFINIDEMO_PROFILE_MODULE 展开），空路径的模块不覆盖外层
+class ModuleScope {
+public:
+    explicit ModuleScope(const std::string &module_path) {
+        if (!module_path.empty() && MemoryTracker::instance().enabled()) {
+            active_ = true;
+            parent_ = MemoryTracker::threadModule();
+            MemoryTracker::threadModule() = &module_path;
+        }
+    }
+    ~ModuleScope() {
+        if (active_) {
+            MemoryTracker::threadModule() = parent_;
+        }
+    }
+
+    ModuleScope(const ModuleScope &) = delete;
+    ModuleScope &operator=(const ModuleScope &) = delete;
+
+private:
+    bool active_ = false;
+    const std::string *parent_ = nullptr;
+};
+
+// RootModule::to / to_slab / load_state_dict 等非 forward 阶段
+class PhaseScope {
+public:
+    explicit PhaseScope(const char *phase) : parent_(MemoryTracker::threadPhase()) { MemoryTracker::threadPhase() = phase; }
+    ~PhaseScope() { MemoryTracker::threadPhase() = parent_; }
+
+    PhaseScope(const PhaseScope &) = delete;
+    PhaseScope &operator=(const PhaseScope &) = delete;
+
+private:
+    const char *parent_;
+};
+
+inline void trackAllocation(Tensor &tensor, size_t bytes) {
+    if (MemoryTracker::instance().enabled()) {
+        MemoryTracker::instance().record(tensor->shared_from_this(), bytes, tensor->device());
+    }
+}
+
+inline void trackAllocation(const std::shared_ptr<Memory> &memory, size_t bytes) {
+    if (MemoryTracker::instance().enabled() && memory) {
+        MemoryTracker::instance().record(memory, bytes, memory->device());
+    }
+}
+
+// view 由 source 派生（view / narrow / permute 等）并可能比 source 活得更久时调用，两者都析构后才扣除这块内存
+inline void shareStorage(const Tensor &source, const Tensor &view) {
+    if (MemoryTracker::instance().enabled()) {
+        MemoryTracker::instance().share(source->shared_from_this(), view->shared_from_this());
+    }
+}
+
+} // namespace infinidemo::nn::memory
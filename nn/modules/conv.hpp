@@ -1,6 +1,8 @@
 #pragma once
 
 #include "../functional/conv_op.hpp"
+#include "../receptive_field.hpp"
+#include "../shape_cache.hpp"
 #include "../utils.hpp"
 #include "module.hpp"
 #include <cstddef>
@@ -9,6 +11,7 @@
 #include <infinicore/tensor.hpp>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace infinidemo::nn::modules {
@@ -19,40 +22,58 @@ public:
     Conv2d(int in_channels, int out_channels, size_t kernel_size, size_t stride = 1, size_t padding = 0, size_t dilation1 = 1,
            int groups = 1, bool bias = true, const DataType &dtype = DataType::F32)
         : in_channels_(in_channels), out_channels_(out_channels), kernel_size_(kernel_size), stride_(stride), padding_(padding),
-          dilation_(dilation1), groups_(groups), has_bias_(bias), dtype_(dtype) {
+          dilation_(dilation1), groups_(groups), has_bias_(bias), dtype_(dtype),
+          pads_{padding, padding}, strides_{static_cast<ptrdiff_t>(stride), static_cast<ptrdiff_t>(stride)}, dilations_{dilation1, dilation1} {
 
-        INFINICORE_NN_PARAMETER_INIT(weight, ({static_cast<size_t>(out_channels), static_cast<size_t>(in_channels), kernel_size, kernel_size}, dtype_, device_));
+        INFINIDEMO_NN_PARAMETER_INIT(weight, ({static_cast<size_t>(out_channels), static_cast<size_t>(in_channels), kernel_size, kernel_size}, dtype_, device_));
         if (bias) {
-            INFINICORE_NN_PARAMETER_INIT(bias, ({static_cast<size_t>(out_channels)}, dtype_, device_));
+            INFINIDEMO_NN_PARAMETER_INIT(bias, ({static_cast<size_t>(out_channels)}, dtype_, device_));
         } else {
             bias_ = infinicore::nn::Parameter();
         }
     }
 
     inline Tensor forward(Tensor &input) const {
-        std::vector<size_t> pads = {padding_, padding_};
-        std::vector<ptrdiff_t> strides = {static_cast<ptrdiff_t>(stride_), static_cast<ptrdiff_t>(stride_)};
-        std::vector<size_t> dilations = {dilation_, dilation_};
-        std::vector<size_t> output_shape = computeConv2dOutputShape(input->shape(), weight_->shape(), pads, strides, dilations);
-
-        auto output = Tensor::empty(output_shape, input->dtype(), input->device());
+        INFINIDEMO_PROFILE_MODULE("Conv2d", input);
+        auto output = infinidemo::nn::empty(outputShape(input->shape()), input->dtype(), input->device());
         INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performConv2D(
-            output, input, weight_, bias_, strides, pads, dilations, input->device()));
+            output, input, weight_, bias_, strides_, pads_, dilations_, input->device()));
 
         return output;
     }
 
+    // 每个输入形状只计算一次，之后的 forward 只做查找
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        return shape_cache_.lookup(input_shape, [this](const Shape &shape) {
+            return computeConv2dOutputShape(shape, weight_->shape(), pads_, strides_, dilations_);
+        });
+    }
+
+    // 输出位置对输入位置的依赖范围，空间分块执行据此计算 halo
+    inline infinidemo::nn::ReceptiveField receptiveField() const { return infinidemo::nn::ReceptiveField::window(kernel_size_, stride_, padding_, dilation_); }
+
 private:
+    // 经 rebind_parameter_ 替换，parameters_（state_dict）与成员保持一致
     void to_device_(const Device &device) override {
         Tensor &weight_ref = weight_;
-        weight_ = weight_ref->to(device);
+        rebind_parameter_("weight", weight_ref->to(device));
         if (has_bias_) {
             Tensor &bias_ref = bias_;
-            bias_ = bias_ref->to(device);
+            rebind_parameter_("bias", bias_ref->to(device));
         }
         device_ = device;
     }
 
+    void rebind_parameter_(const std::string &name, const Tensor &tensor) override {
+        Module::rebind_parameter_(name, tensor);
+        if (name == "weight") {
+            weight_ = tensor;
+        } else if (name == "bias") {
+            bias_ = tensor;
+        }
+        device_ = tensor->device();
+    }
+
 protected:
     // 计算2D卷积输出形状
     // x_shape = [N, C, H, W], w_shape = [OC, IC, KH, KW]
@@ -96,6 +117,11 @@ protected:
     bool has_bias_;
     DataType dtype_;
     Device device_ = Device::cpu();
+    // 算子参数在构造时确定
+    std::vector<size_t> pads_;
+    std::vector<ptrdiff_t> strides_;
+    std::vector<size_t> dilations_;
+    infinidemo::nn::ShapeCache<> shape_cache_;
 };
 
 } // namespace infinidemo::nn::modules
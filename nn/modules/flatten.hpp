@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../memory_tracker.hpp"
+#include "../shape_cache.hpp"
 #include "module.hpp"
 #include <infinicore/nn/module.hpp>
 #include <infinicore/tensor.hpp>
@@ -13,7 +15,22 @@ class Flatten : public infinidemo::nn::modules::Module {
 public:
     Flatten(int start_dim = 1, int end_dim = -1) : start_dim_(start_dim), end_dim_(end_dim) {}
     inline Tensor forward(Tensor &input) const {
-        const auto &shape = input->shape();
+        INFINIDEMO_PROFILE_MODULE("Flatten", input);
+        Tensor output = input->view(outputShape(input->shape()));
+        infinidemo::nn::memory::shareStorage(input, output);
+        return output;
+    }
+
+    // 每个输入形状只计算一次，之后的 forward 只做查找
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        return shape_cache_.lookup(input_shape, [this](const Shape &shape) { return computeFlattenShape(shape); });
+    }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    Shape computeFlattenShape(const Shape &shape) const {
         const int ndim = static_cast<int>(shape.size());
         int actual_end_dim = end_dim_ < 0 ? ndim + end_dim_ : end_dim_;
 
@@ -33,16 +50,12 @@ public:
         new_shape.insert(new_shape.end(), shape.begin(), shape.begin() + start_dim_);
         new_shape.push_back(flattened_size);
         new_shape.insert(new_shape.end(), shape.begin() + actual_end_dim + 1, shape.end());
-
-        return input->view(new_shape);
+        return new_shape;
     }
 
-private:
-    void to_device_(const Device &device) override {}
-
-protected:
     int start_dim_;
     int end_dim_;
+    infinidemo::nn::ShapeCache<> shape_cache_;
 };
 
 } // namespace infinidemo::nn::modules
@@ -1,11 +1,15 @@
 #pragma once
 
+#include "../functional/batched_gemm_op.hpp"
 #include "../functional/gemm_op.hpp"
+#include "../shape_cache.hpp"
 #include "../utils.hpp"
 #include "module.hpp"
+#include <cstdint>
 #include <infinicore/device.hpp>
 #include <infinicore/nn/module.hpp>
 #include <infinicore/tensor.hpp>
+#include <string>
 
 namespace infinidemo::nn::modules {
 using namespace infinicore;
@@ -23,46 +27,117 @@ class Linear : public infinidemo::nn::modules::Module {
 public:
     Linear(size_t in_features, size_t out_features, bool bias = true, const DataType &dtype = DataType::F32)
         : in_features_(in_features), out_features_(out_features), has_bias_(bias), dtype_(dtype) {
-        INFINICORE_NN_PARAMETER_INIT(weight, ({out_features, in_features}, dtype_, device_));
+        INFINIDEMO_NN_PARAMETER_INIT(weight, ({out_features, in_features}, dtype_, device_));
         if (bias) {
-            INFINICORE_NN_PARAMETER_INIT(bias, ({out_features}, dtype_, device_));
+            INFINIDEMO_NN_PARAMETER_INIT(bias, ({out_features}, dtype_, device_));
         } else {
             bias_ = infinicore::nn::Parameter();
         }
     }
 
+    // 支持任意维度的输入 [..., in_features]：二维走单次 GEMM，
+    // 三维及以上按 [batch, rows, in_features] 一次批量 GEMM 完成，权重沿 batch 广播
     inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("Linear", input);
         Size ndim = input->ndim();
         Size out_features = weight_->shape()[0];
 
         // Assign memory to out variables
-        auto output_shape = input->shape();
-        output_shape[ndim - 1] = out_features;
-        auto output = Tensor::empty(output_shape, input->dtype(), input->device());
+        const LinearShapes &shapes = shapes_(input->shape());
+        auto output = infinidemo::nn::empty(shapes.output, input->dtype(), input->device());
 
         float alpha = 1.0f;
         float beta = 0.0f;
         if (has_bias_) {
             beta = 1.0f;
-            auto new_bias = bias_->as_strided(output->shape(), {0, 1});
+            auto new_bias = bias_->as_strided(shapes.output, shapes.bias_strides);
             output->copy_from(new_bias);
         }
-        INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performGemm(output, input, weight_->permute({1, 0}), alpha, beta, input->device()));
+
+        Tensor weight_t = weight_->permute(transpose_order_);
+        if (ndim <= 2) {
+            using infinidemo::nn::functional::GemmAlgo;
+            GemmAlgo algo = gemmAlgo_(shapes, output, input, weight_t);
+            // ContiguousB 使用打包好的行主序权重，performGemmWithAlgo 看到连续的 B 不再拷贝
+            Tensor b = algo == GemmAlgo::ContiguousB ? packed_weight_t_.get(weight_t, parameter_epoch()) : weight_t;
+            INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performGemmWithAlgo(output, input, b, alpha, beta, algo, input->device()));
+            return output;
+        }
+
+        // 三维输入直接使用（可以是非连续的 batch 视图），更高维先合并前面的维度
+        Size rows = input->shape()[ndim - 2];
+        Size batch = input->numel() / (rows * in_features_);
+        Tensor input_3d = ndim == 3 ? input : input->contiguous()->view({batch, rows, in_features_});
+        Tensor output_3d = output->view({batch, rows, out_features});
+        INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performBatchedGemm(output_3d, input_3d, weight_t, alpha, beta, input->device()));
 
         return output;
     }
 
+    inline const Shape &outputShape(const Shape &input_shape) const { return shapes_(input_shape).output; }
+
 private:
+    struct LinearShapes {
+        Shape output;
+        Strides bias_strides;
+        // 二维输入的 GEMM 执行方式，按形状从调优缓存解析一次；调优记录或设备变化后（generation / device_type 不一致）改为逐次查表
+        infinidemo::nn::functional::GemmAlgo algo = infinidemo::nn::functional::GemmAlgo::Default;
+        uint64_t tuning_generation = 0;
+        Device::Type device_type = Device::Type::CPU;
+    };
+
+    // 输出形状与广播 bias 的 stride 按输入形状缓存，forward 中不再构造 vector
+    const LinearShapes &shapes_(const Shape &input_shape) const {
+        return shape_cache_.lookup(input_shape, [this](const Shape &shape) {
+            LinearShapes shapes;
+            shapes.output = shape;
+            shapes.output.back() = out_features_;
+            // 除最后一维外 stride 均为 0，对任意维度的输出广播 bias
+            if (has_bias_) {
+                shapes.bias_strides.assign(shape.size(), 0);
+                shapes.bias_strides.back() = bias_->strides()[0];
+            }
+            if (shape.size() == 2) {
+                auto &tuning = infinidemo::nn::functional::GemmTuningCache::instance();
+                shapes.tuning_generation = tuning.generation();
+                shapes.device_type = device_.getType();
+                Tensor weight_t = weight_->permute(transpose_order_);
+                shapes.algo = tuning.lookup({static_cast<int>(device_.getType()), static_cast<int>(dtype_), shape[0], out_features_, in_features_,
+                                             "row", infinidemo::nn::functional::matrixLayout(weight_t)});
+            }
+            return shapes;
+        });
+    }
+
+    infinidemo::nn::functional::GemmAlgo gemmAlgo_(const LinearShapes &shapes, Tensor &output, const Tensor &input, const Tensor &weight_t) const {
+        auto &tuning = infinidemo::nn::functional::GemmTuningCache::instance();
+        if ((shapes.tuning_generation == tuning.generation()) && (shapes.device_type == input->device().getType())) {
+            return shapes.algo;
+        }
+        return tuning.lookup(output, input, weight_t, input->device());
+    }
+
+    // 经 rebind_parameter_ 替换，parameters_（state_dict）与成员保持一致
     void to_device_(const Device &device) override {
         Tensor &weight_ref = weight_;
-        weight_ = weight_ref->to(device);
+        rebind_parameter_("weight", weight_ref->to(device));
         if (has_bias_) {
             Tensor &bias_ref = bias_;
-            bias_ = bias_ref->to(device);
+            rebind_parameter_("bias", bias_ref->to(device));
         }
         device_ = device;
     }
 
+    void rebind_parameter_(const std::string &name, const Tensor &tensor) override {
+        Module::rebind_parameter_(name, tensor);
+        if (name == "weight") {
+            weight_ = tensor;
+        } else if (name == "bias") {
+            bias_ = tensor;
+        }
+        device_ = tensor->device();
+    }
+
 protected:
     INFINICORE_NN_PARAMETER(weight);
     INFINICORE_NN_PARAMETER(bias);
@@ -72,6 +147,9 @@ protected:
     bool has_bias_;
     DataType dtype_;
     Device device_ = Device::cpu();
+    Shape transpose_order_ = {1, 0};
+    infinidemo::nn::ShapeCache<LinearShapes> shape_cache_;
+    mutable infinidemo::nn::functional::PackedOperand packed_weight_t_;
 };
 
 } // namespace infinidemo::nn::modules
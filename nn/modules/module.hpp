@@ -1,9 +1,18 @@
 #pragma once
+#include "../allocator.hpp"
+#include "../debug.hpp"
+#include "../memory_tracker.hpp"
+#include "../profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <infinicore/context/context.hpp>
 #include <infinicore/nn/module.hpp>
 #include <infinicore/nn/parameter.hpp>
 #include <infinicore/tensor.hpp>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -11,15 +20,96 @@
 namespace infinidemo::nn::modules {
 using namespace infinicore;
 
+// 参数 arena 模式：作用域内构造的 Conv2d / Linear 不为参数单独分配内存，只创建记录形状的占位 tensor，
+// 由顶层模型在构造结束后调用 RootModule::allocate_parameter_arena 统一分配。作用域按线程生效，可以嵌套
+class ParameterArenaScope {
+public:
+    explicit ParameterArenaScope(bool enable = true) : enable_(enable) {
+        if (enable_) {
+            ++depth();
+        }
+    }
+    ~ParameterArenaScope() {
+        if (enable_) {
+            --depth();
+        }
+    }
+    ParameterArenaScope(const ParameterArenaScope &) = delete;
+    ParameterArenaScope &operator=(const ParameterArenaScope &) = delete;
+
+    static bool active() { return depth() > 0; }
+
+private:
+    static int &depth() {
+        thread_local int value = 0;
+        return value;
+    }
+    bool enable_;
+};
+
+// arena 模式下返回不持有内存的占位参数（data() 为空，由 allocate_parameter_arena / share_parameters_from 替换），
+// 否则与 infinicore::nn::Parameter 相同，单独分配
+inline infinicore::nn::Parameter makeParameter(const Shape &shape, const DataType &dtype, const Device &device) {
+    if (ParameterArenaScope::active()) {
+        return infinicore::nn::Parameter(Tensor::from_blob(nullptr, shape, dtype, device));
+    }
+    return infinicore::nn::Parameter(shape, dtype, device);
+}
+
+// 与 INFINICORE_NN_PARAMETER_INIT 相同，但参数经 makeParameter 创建，支持 arena 模式
+#define INFINIDEMO_NN_PARAMETER_INIT(name, args)                 \
+    name##_ = infinidemo::nn::modules::makeParameter args; \
+    this->register_parameter(#name, name##_)
+
 class Module : public infinicore::nn::Module {
 public:
     virtual ~Module() = default;
     virtual void to_device_(const Device &device) = 0;
+
+    // 与基类相同，另外按注册顺序记录子模块，RootModule 的参数 slab 按这个顺序布局
+    template <typename M, typename... Args>
+    std::shared_ptr<M> register_module(const std::string &name, Args &&...args) {
+        remember_registration_(submodule_order_, name);
+        return infinicore::nn::Module::register_module<M>(name, std::forward<Args>(args)...);
+    }
+
+    Tensor register_parameter(const std::string &name, infinicore::nn::Parameter param) {
+        remember_registration_(parameter_order_, name);
+        return infinicore::nn::Module::register_parameter(name, std::move(param));
+    }
+
+    // 逐模块迁移：经过每个模块的 to_device_，每个参数单独分配并阻塞拷贝。
+    // 整棵树打包进一块 slab 的迁移见 RootModule::to_slab
     void to(const Device &device) {
         to_recursively(device);
+        bump_parameter_epoch_();
         infinicore::context::syncDevice();
     }
 
+    // 与基类相同，另外递增 parameter_epoch，由参数派生的缓存随之失效
+    void load_state_dict(const std::unordered_map<std::string, Tensor> &state_dict) {
+        infinicore::nn::Module::load_state_dict(state_dict);
+        bump_parameter_epoch_();
+    }
+
+    // 进程内任意模块的参数变化（to()、load_state_dict()、重新分配或共享参数）都会递增，子模块据此判断
+    // 由自身参数派生的缓存（如 Linear 打包后的权重）是否过期，而不需要知道自己属于哪个根模块
+    static uint64_t parameter_epoch() { return parameter_epoch_().load(std::memory_order_acquire); }
+
+    // 模块在整棵树中的路径，例如 "resnet.encoder.stages.2.layers.0"，供 profiler 等按层归属使用
+    const std::string &module_path() const { return module_path_; }
+
+    // 由顶层模型在构造完成后调用一次，为所有已注册的子模块设置路径
+    void assign_module_paths(const std::string &prefix = "") {
+        module_path_ = prefix;
+        for (const auto &[sub_name, submodule] : submodules_) {
+            auto submodule_my = static_cast<Module *>(submodule.get());
+            if (submodule_my) {
+                submodule_my->assign_module_paths(prefix.empty() ? sub_name : prefix + "." + sub_name);
+            }
+        }
+    }
+
 public:
     void to_recursively(const Device &device) {
         if (parameters_.size() > 0) {
@@ -32,6 +122,76 @@ public:
             }
         }
     }
+
+    // 参数被替换为新的 tensor（例如 slab 中的视图）时调用。默认只更新 parameters_，
+    // 持有参数成员（weight_、bias_ 等）的模块需要覆盖它，同步更新成员
+    virtual void rebind_parameter_(const std::string &name, const Tensor &tensor) {
+        parameters_[name] = tensor;
+    }
+
+protected:
+    struct ParameterSlot {
+        Module *module;
+        std::string name;
+        std::string path;
+        Tensor tensor;
+        size_t offset = 0;
+        size_t bytes = 0;
+    };
+
+    static void bump_parameter_epoch_() {
+        parameter_epoch_().fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    static std::atomic<uint64_t> &parameter_epoch_() {
+        static std::atomic<uint64_t> epoch{0};
+        return epoch;
+    }
+
+    void collect_parameters_(const std::string &prefix, std::vector<ParameterSlot> &slots) {
+        for (const std::string &name : registration_order_(parameter_order_, parameters_)) {
+            slots.push_back({this, name, prefix.empty() ? name : prefix + "." + name, parameters_.at(name)});
+        }
+        for (const std::string &sub_name : registration_order_(submodule_order_, submodules_)) {
+            auto submodule_my = static_cast<Module *>(submodules_.at(sub_name).get());
+            if (submodule_my) {
+                submodule_my->collect_parameters_(prefix.empty() ? sub_name : prefix + "." + sub_name, slots);
+            }
+        }
+    }
+
+    static void remember_registration_(std::vector<std::string> &order, const std::string &name) {
+        if (std::find(order.begin(), order.end(), name) == order.end()) {
+            order.push_back(name);
+        }
+    }
+
+    // map 中的名字按注册顺序排列；已删除的名字跳过，未经本类注册的名字（例如直接调用基类的 register_modules）按字典序排在最后
+    template <typename Map>
+    static std::vector<std::string> registration_order_(const std::vector<std::string> &order, const Map &map) {
+        std::vector<std::string> names;
+        names.reserve(map.size());
+        for (const auto &name : order) {
+            if (map.count(name) > 0) {
+                names.push_back(name);
+            }
+        }
+        if (names.size() < map.size()) {
+            std::vector<std::string> rest;
+            for (const auto &item : map) {
+                if (std::find(order.begin(), order.end(), item.first) == order.end()) {
+                    rest.push_back(item.first);
+                }
+            }
+            std::sort(rest.begin(), rest.end());
+            names.insert(names.end(), rest.begin(), rest.end());
+        }
+        return names;
+    }
+
+    std::string module_path_;
+    std::vector<std::string> submodule_order_;
+    std::vector<std::string> parameter_order_;
 };
 
 } // namespace infinidemo::nn::modules
\ No newline at end of file
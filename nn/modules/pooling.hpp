@@ -1,7 +1,12 @@
 #pragma once
 
+#include "../debug.hpp"
 #include "../functional/avg_pool2d_op.hpp"
+#include "../functional/composite_pool2d_op.hpp"
+#include "../functional/global_pool_op.hpp"
 #include "../functional/max_pool2d_op.hpp"
+#include "../receptive_field.hpp"
+#include "../shape_cache.hpp"
 #include "../utils.hpp"
 #include "module.hpp"
 #include <cmath>
@@ -15,17 +20,19 @@
 namespace infinidemo::nn::modules {
 using namespace infinicore;
 
+// HYGON、MOORE 没有原生的 Pool2D 算子，改用设备上的组合池化，数据不再经过 CPU
+inline bool useCompositePool2d(const Device &device) {
+    return (device.getType() == Device::Type::HYGON) || (device.getType() == Device::Type::MOORE)
+        || infinidemo::nn::debug::forceCompositePooling();
+}
+
 class AvgPool2d : public infinidemo::nn::modules::Module {
 public:
     AvgPool2d(size_t kernel_size, size_t stride = 0, size_t padding = 0, bool ceil_mode = false, const DataType &dtype = DataType::F32)
         : kernel_size_(kernel_size), stride_(stride == 0 ? kernel_size : stride), padding_(padding), ceil_mode_(ceil_mode), dtype_(dtype) {}
 
     inline Tensor forward(Tensor &input) const {
-        Device original_device = input->device();
-        if ((original_device.getType() == Device::Type::HYGON) || (original_device.getType() == Device::Type::MOORE)) {
-            input = input->to(Device::cpu());
-        }
-
+        INFINIDEMO_PROFILE_MODULE("AvgPool2d", input);
         int kernel_h = static_cast<int>(kernel_size_);
         int kernel_w = static_cast<int>(kernel_size_);
         int stride_h = static_cast<int>(stride_);
@@ -35,21 +42,33 @@ public:
         int dilation_h = static_cast<int>(1);
         int dilation_w = static_cast<int>(1);
 
-        std::vector<size_t> output_shape = computePool2dOutputShape(
-            input->shape(), kernel_h, kernel_w, stride_h, stride_w, padding_h,
-            padding_w, dilation_h, dilation_w, ceil_mode_);
-
-        auto output = Tensor::empty(output_shape, input->dtype(), input->device());
-        INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performAvgPool2d(
-            input, output, kernel_h, kernel_w, stride_h, stride_w, padding_h,
-            padding_w, dilation_h, dilation_w, ceil_mode_, input->device()));
-
-        if ((original_device.getType() == Device::Type::HYGON) || (original_device.getType() == Device::Type::MOORE)) {
-            output = output->to(original_device);
+        auto output = infinidemo::nn::empty(outputShape(input->shape()), input->dtype(), input->device());
+        if (useCompositePool2d(input->device())) {
+            INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performCompositeAvgPool2d(
+                input, output, kernel_h, kernel_w, stride_h, stride_w, padding_h,
+                padding_w, dilation_h, dilation_w, ceil_mode_, ones_, input->device()));
+        } else {
+            INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performAvgPool2d(
+                input, output, kernel_h, kernel_w, stride_h, stride_w, padding_h,
+                padding_w, dilation_h, dilation_w, ceil_mode_, input->device()));
         }
+
         return output;
     }
 
+    // 每个输入形状只计算一次，之后的 forward 只做查找
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        return shape_cache_.lookup(input_shape, [this](const Shape &shape) {
+            int kernel = static_cast<int>(kernel_size_);
+            int stride = static_cast<int>(stride_);
+            int padding = static_cast<int>(padding_);
+            int dilation = static_cast<int>(1);
+            return computePool2dOutputShape(shape, kernel, kernel, stride, stride, padding, padding, dilation, dilation, ceil_mode_);
+        });
+    }
+
+    inline infinidemo::nn::ReceptiveField receptiveField() const { return infinidemo::nn::ReceptiveField::window(kernel_size_, stride_, padding_); }
+
 private:
     void to_device_(const Device &device) override {}
 
@@ -102,6 +121,8 @@ protected:
     size_t dilation_;
     bool ceil_mode_;
     DataType dtype_;
+    infinidemo::nn::ShapeCache<> shape_cache_;
+    mutable infinidemo::nn::functional::composite_pool2d::OnesCache ones_;
 };
 
 class MaxPool2d : public infinidemo::nn::modules::Module {
@@ -112,11 +133,7 @@ public:
           padding_(padding), dilation_(dilation), ceil_mode_(ceil_mode), dtype_(dtype) {}
 
     inline Tensor forward(Tensor &input) const {
-        Device original_device = input->device();
-        if ((original_device.getType() == Device::Type::HYGON) || (original_device.getType() == Device::Type::MOORE)) {
-            input = input->to(Device::cpu());
-        }
-
+        INFINIDEMO_PROFILE_MODULE("MaxPool2d", input);
         int kernel_h = static_cast<int>(kernel_size_);
         int kernel_w = static_cast<int>(kernel_size_);
         int stride_h = static_cast<int>(stride_);
@@ -126,21 +143,33 @@ public:
         int dilation_h = static_cast<int>(dilation_);
         int dilation_w = static_cast<int>(dilation_);
 
-        std::vector<size_t> output_shape = computePool2dOutputShape(
-            input->shape(), kernel_h, kernel_w, stride_h, stride_w, padding_h,
-            padding_w, dilation_h, dilation_w, ceil_mode_);
-
-        auto output = Tensor::empty(output_shape, input->dtype(), input->device());
-        INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performMaxPool2d(
-            input, output, kernel_h, kernel_w, stride_h, stride_w, padding_h,
-            padding_w, dilation_h, dilation_w, ceil_mode_, input->device()));
-
-        if ((original_device.getType() == Device::Type::HYGON) || (original_device.getType() == Device::Type::MOORE)) {
-            output = output->to(original_device);
+        auto output = infinidemo::nn::empty(outputShape(input->shape()), input->dtype(), input->device());
+        if (useCompositePool2d(input->device())) {
+            INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performCompositeMaxPool2d(
+                input, output, kernel_h, kernel_w, stride_h, stride_w, padding_h,
+                padding_w, dilation_h, dilation_w, ceil_mode_, input->device()));
+        } else {
+            INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performMaxPool2d(
+                input, output, kernel_h, kernel_w, stride_h, stride_w, padding_h,
+                padding_w, dilation_h, dilation_w, ceil_mode_, input->device()));
         }
+
         return output;
     }
 
+    // 每个输入形状只计算一次，之后的 forward 只做查找
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        return shape_cache_.lookup(input_shape, [this](const Shape &shape) {
+            int kernel = static_cast<int>(kernel_size_);
+            int stride = static_cast<int>(stride_);
+            int padding = static_cast<int>(padding_);
+            int dilation = static_cast<int>(dilation_);
+            return computePool2dOutputShape(shape, kernel, kernel, stride, stride, padding, padding, dilation, dilation, ceil_mode_);
+        });
+    }
+
+    inline infinidemo::nn::ReceptiveField receptiveField() const { return infinidemo::nn::ReceptiveField::window(kernel_size_, stride_, padding_, dilation_); }
+
 private:
     void to_device_(const Device &device) override {}
 
@@ -195,5 +224,40 @@ protected:
     size_t dilation_;
     bool ceil_mode_;
     DataType dtype_;
+    infinidemo::nn::ShapeCache<> shape_cache_;
+};
+
+// 全局平均池化 [N, C, H, W] -> 连续的 [N, C]，不要求输入分辨率是固定的 7x7；
+// l2_normalize 为 true 时在池化的同一遍中完成每行的 L2 归一化
+class GlobalAvgPool2d : public infinidemo::nn::modules::Module {
+public:
+    explicit GlobalAvgPool2d(bool l2_normalize = false) : l2_normalize_(l2_normalize) {}
+
+    inline Tensor forward(Tensor &input) const {
+        INFINIDEMO_PROFILE_MODULE("GlobalAvgPool2d", input);
+        Tensor contiguous_input = input->is_contiguous() ? input : input->contiguous();
+        auto output = infinidemo::nn::empty(outputShape(input->shape()), input->dtype(), input->device());
+        INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performGlobalAvgPool(
+            contiguous_input, output, l2_normalize_, useCompositePool2d(input->device()), ones_, norm_weight_, input->device()));
+        return output;
+    }
+
+    inline const Shape &outputShape(const Shape &input_shape) const {
+        return shape_cache_.lookup(input_shape, [](const Shape &shape) {
+            if (shape.size() != 4) {
+                throw std::runtime_error("GlobalAvgPool2d: expected [N, C, H, W]");
+            }
+            return Shape{shape[0], shape[1]};
+        });
+    }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    bool l2_normalize_;
+    infinidemo::nn::ShapeCache<> shape_cache_;
+    mutable infinidemo::nn::functional::composite_pool2d::OnesCache ones_;
+    mutable infinidemo::nn::functional::L2NormWeight norm_weight_;
 };
 } // namespace infinidemo::nn::modules
@@ -14,7 +14,8 @@ class ReLU : public infinidemo::nn::modules::Module {
 public:
     ReLU() = default;
     inline Tensor forward(const Tensor &input) const {
-        auto output = Tensor::empty(input->shape(), input->dtype(), input->device());
+        INFINIDEMO_PROFILE_MODULE("ReLU", input);
+        auto output = infinidemo::nn::empty(input->shape(), input->dtype(), input->device());
         INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performRelu(output, input, input->device()));
         return output;
     }
@@ -0,0 +1,527 @@
+#pragma once
+#include "../allocator.hpp"
+#include "../debug.hpp"
+#include "../memory_tracker.hpp"
+#include "../profiler.hpp"
+#include "module.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <infinicore/context/context.hpp>
+#include <infinicore/memory.hpp>
+#include <infinicore/tensor.hpp>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace infinidemo::nn::modules {
+using namespace infinicore;
+
+// 一次参数迁移的统计
+struct MigrationReport {
+    size_t parameters = 0;
+    size_t parameter_bytes = 0;
+    size_t slab_bytes = 0; // 含对齐填充，逐模块迁移时为 0
+    size_t copies = 0;     // 拷贝的次数
+    double elapsed_ms = 0.0;
+};
+
+// 一次 warmup 的统计：每个输入形状的形状传播、第一次（冷）与第二次（热）dummy forward 的耗时
+struct WarmupReport {
+    struct Entry {
+        Shape input_shape;
+        double prepare_ms = 0.0;
+        double cold_ms = 0.0;
+        double warm_ms = 0.0;
+    };
+    std::vector<Entry> entries;
+    double elapsed_ms = 0.0;
+};
+
+// 可拷贝的原子布尔量：模型按值构造后再移交给 Python，std::atomic 成员会使模型不可拷贝、不可移动
+class AtomicFlag {
+public:
+    AtomicFlag(bool value = false) : value_(value) {}
+    AtomicFlag(const AtomicFlag &other) : value_(other.load()) {}
+    AtomicFlag &operator=(const AtomicFlag &other) {
+        store(other.load());
+        return *this;
+    }
+
+    bool load() const { return value_.load(std::memory_order_acquire); }
+    void store(bool value) { value_.store(value, std::memory_order_release); }
+
+private:
+    std::atomic<bool> value_;
+};
+
+// 可拷贝、可移动的互斥量：std::mutex 放在 unique_ptr 中，拷贝时新建一个，持有它的类保留默认的拷贝 / 移动语义
+class OwnedMutex {
+public:
+    OwnedMutex() : mutex_(std::make_unique<std::mutex>()) {}
+    OwnedMutex(const OwnedMutex &) : OwnedMutex() {}
+    OwnedMutex &operator=(const OwnedMutex &) { return *this; }
+
+    std::mutex &get() const { return *mutex_; }
+
+private:
+    std::unique_ptr<std::mutex> mutex_;
+};
+
+// 顶层模型（ResNetForImageClassification、MnistForImageClassification 等）的基类：在 Module 之上管理整棵树的参数，
+// 包括参数 arena / slab、异步迁移、权重加载状态、参数版本、warmup 与 serving_ready、forward 互斥。
+// Linear、ReLU 等子模块仍直接继承 Module，不携带这些状态
+class RootModule : public Module {
+public:
+    ~RootModule() override {
+        // 异步拷贝可能仍在读 staging buffer，释放之前等待完成
+        try {
+            finish_migration();
+        } catch (...) {
+        }
+    }
+
+    // 与基类相同；to_slab() 的异步拷贝尚未完成时先等待，返回的视图可以直接读取
+    decltype(auto) state_dict() const {
+        finish_migration();
+        return infinicore::nn::Module::state_dict();
+    }
+
+    // 逐模块迁移（与 Module::to 相同，经过各模块的 to_device_）：每个参数单独分配并阻塞拷贝。
+    // 参数不再位于 arena / slab 中；与其它模型共享参数时抛出异常
+    void to(const Device &device) {
+        check_not_shared_("to");
+        finish_migration();
+        infinidemo::nn::memory::PhaseScope phase("to");
+        auto start = std::chrono::steady_clock::now();
+        serving_ready_.store(false);
+        MigrationReport report;
+        std::vector<ParameterSlot> slots;
+        collect_parameters_("", slots);
+        for (const auto &slot : slots) {
+            report.parameter_bytes += infinidemo::nn::numBytes(slot.tensor->shape(), slot.tensor->dtype());
+        }
+        report.parameters = slots.size();
+        report.copies = slots.size();
+        Module::to(device);
+        slab_ = Tensor();
+        bump_parameter_version_();
+        report.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        last_migration_ = report;
+    }
+
+    // 整棵树的参数迁移到 device 上的一块连续 slab，参数变为 slab 中的视图。
+    // 收集所有参数，在设备上一次分配一块连续的 slab（每个参数按 alignment 对齐），
+    // 在 pinned host buffer 中打包的同时按 chunk_bytes 分批提交异步 H2D，打包与拷贝重叠。
+    // 相比逐参数 to()：分配只有一次、没有碎片，同一层的权重在内存中相邻。
+    // slab 是一个一维 tensor，参数是它的 narrow 视图，共同持有 slab 的内存：state_dict() 取出的 tensor、
+    // 单独保存的子模块在模型析构或再次迁移之后仍然有效。上传是惰性完成的：返回时拷贝可能尚未完成，
+    // staging 保留到第一次使用参数时（见 finish_migration）。与其它模型共享参数时抛出异常
+    MigrationReport to_slab(const Device &device, size_t alignment = 256, size_t chunk_bytes = size_t(64) << 20) {
+        check_not_shared_("to_slab");
+        serving_ready_.store(false);
+        return pack_slab_(device, alignment, chunk_bytes);
+    }
+
+    // to_slab() 提交的异步拷贝完成之前，参数 slab 的内容尚未就绪。forward、state_dict()、load_state_dict()、再次迁移之前调用，
+    // 等待拷贝完成并释放 staging；没有未完成的迁移时只是一次原子读
+    void finish_migration() const {
+        if (!migration_pending_.load()) {
+            return;
+        }
+        static std::mutex mutex;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!migration_pending_.load()) {
+            return;
+        }
+        // 拷贝提交在调用 to_slab() 的线程的 stream 上，这里可能是另一个线程，等待整个设备
+        infinicore::context::setDevice(pending_device_);
+        infinicore::context::syncDevice();
+        pending_staging_.reset();
+        migration_pending_.store(false);
+    }
+
+    // 参数 arena：在 ParameterArenaScope 中构造的模型，参数只记录形状，构造结束后调用本函数，
+    // 按与 to_slab 相同的布局一次分配一块对齐的 buffer，所有参数成为其中的视图（未初始化，由 load_state_dict 写入）。
+    // state_dict() 返回的仍是这些视图，之后的 to_slab() 会把整块 arena 作为一个 slab 迁移
+    MigrationReport allocate_parameter_arena(const Device &device, size_t alignment = 256) {
+        infinidemo::nn::memory::PhaseScope phase("parameters");
+        auto start = std::chrono::steady_clock::now();
+        MigrationReport report;
+        std::vector<ParameterSlot> slots = plan_parameter_layout_(alignment, report);
+        if (!slots.empty() && uniform_dtype_(slots, alignment)) {
+            infinicore::context::setDevice(device);
+            INFINIDEMO_PROFILE_ALLOCATION(report.slab_bytes);
+            Tensor arena = allocate_slab_(slots, report.slab_bytes, device);
+            track_slab_(arena, report.slab_bytes, device, slots);
+            bind_slab_views_(arena, slots);
+            slab_ = arena;
+        } else {
+            // 不同 dtype 的参数各自分配
+            for (const auto &slot : slots) {
+                slot.module->rebind_parameter_(slot.name, infinidemo::nn::empty(slot.tensor->shape(), slot.tensor->dtype(), device));
+            }
+        }
+        bump_parameter_version_();
+        report.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        last_migration_ = report;
+        return report;
+    }
+
+    // 与 source 共享参数：按路径把本模型的每个参数重新绑定为 source 中同一个 tensor，并持有 source 的 arena。
+    // 两个模型结构必须相同（参数路径、形状、dtype 一致）。之后各自的 forward 只分配自己的激活，
+    // 参数只读共享，可以在不同线程中并发执行。需要在 source 迁移之后调用；共享后本模型的 to() / to_slab() 抛出异常
+    void share_parameters_from(RootModule &source) {
+        source.finish_migration();
+        std::vector<ParameterSlot> mine;
+        std::vector<ParameterSlot> theirs;
+        collect_parameters_("", mine);
+        source.collect_parameters_("", theirs);
+        if (mine.size() != theirs.size()) {
+            throw std::runtime_error("share_parameters_from: parameter count mismatch (" + std::to_string(mine.size()) + " vs " + std::to_string(theirs.size()) + ")");
+        }
+        std::unordered_map<std::string, const ParameterSlot *> by_path;
+        for (const auto &slot : theirs) {
+            by_path[slot.path] = &slot;
+        }
+        for (const auto &slot : mine) {
+            auto it = by_path.find(slot.path);
+            if (it == by_path.end()) {
+                throw std::runtime_error("share_parameters_from: missing parameter " + slot.path);
+            }
+            const Tensor &shared = it->second->tensor;
+            if ((shared->shape() != slot.tensor->shape()) || (shared->dtype() != slot.tensor->dtype())) {
+                throw std::runtime_error("share_parameters_from: shape or dtype mismatch for " + slot.path);
+            }
+            slot.module->rebind_parameter_(slot.name, shared);
+        }
+        slab_ = source.slab_;
+        weights_loaded_ = source.weights_loaded_;
+        loaded_parameters_ = source.loaded_parameters_;
+        shares_parameters_ = true;
+        last_migration_ = MigrationReport();
+        bump_parameter_version_();
+    }
+
+    // 参数是否与另一个模型共享（share_parameters_from）
+    bool shares_parameters() const { return shares_parameters_; }
+
+    // 与 infinicore::nn::Module::load_state_dict 相同，期间的分配在内存统计中归入 load_state_dict 阶段
+    // 可以分多次加载（例如每个 safetensors 文件一次），每个参数都至少加载过一次之后 weights_loaded() 才为 true
+    void load_state_dict(const std::unordered_map<std::string, Tensor> &state_dict) {
+        finish_migration();
+        infinidemo::nn::memory::PhaseScope phase("load_state_dict");
+        std::vector<ParameterSlot> slots;
+        collect_parameters_("", slots);
+        for (const auto &slot : slots) {
+            if (state_dict.count(slot.path) > 0) {
+                check_storage_(slot, "load_state_dict");
+            }
+        }
+        infinicore::nn::Module::load_state_dict(state_dict);
+        bump_parameter_version_();
+        if (weights_loaded_) {
+            return;
+        }
+        bool complete = true;
+        for (const auto &slot : slots) {
+            if (state_dict.count(slot.path) > 0) {
+                loaded_parameters_.insert(slot.path);
+            } else if (loaded_parameters_.count(slot.path) == 0) {
+                complete = false;
+            }
+        }
+        if (complete) {
+            weights_loaded_ = true;
+            loaded_parameters_.clear();
+        }
+    }
+
+    // 所有参数都已由 load_state_dict 写入（或与已加载的模型共享）。arena 与单独分配的参数在此之前都是未初始化的内存
+    bool weights_loaded() const { return weights_loaded_; }
+
+    // 参数所在的设备（没有参数时为 CPU）
+    Device parameter_device() const {
+        std::vector<ParameterSlot> slots;
+        const_cast<RootModule *>(this)->collect_parameters_("", slots);
+        return slots.empty() ? Device::cpu() : slots.front().tensor->device();
+    }
+
+    // 参数的版本号：每次 to() / to_slab() / load_state_dict() / 重新分配或共享参数后递增，
+    // 缓存了由参数计算出的结果的组件（如 runtime::CachedModel）据此判断结果是否过期
+    uint64_t parameter_version() const { return parameter_version_; }
+
+    // 参数是否都位于同一块 arena / slab 中
+    bool has_parameter_arena() const { return static_cast<bool>(slab_); }
+
+    // 最近一次 to() / to_slab() / allocate_parameter_arena() 的统计
+    const MigrationReport &last_migration() const { return last_migration_; }
+
+    // 同一个模型的 forward 共享激活、workspace 与形状缓存，不能并发执行：释放 GIL 的绑定（forwardNoGil）与
+    // 包装模型的组件（如 runtime::CachedModel）在调用 forward 期间持有这把锁，不同模型之间仍然可以并行
+    std::mutex &forward_mutex() const { return forward_mutex_.get(); }
+
+    // warmup 成功完成后为 true；to() / to_slab() 迁移后重新变为 false，需要再次 warmup。可以在其它线程中读取（就绪探针）
+    bool serving_ready() const { return serving_ready_.load(); }
+
+    // 为 true 时模型在 serving_ready 之前拒绝 forward（抛出异常），避免未 warmup 的冷请求在上线后承担首次分配等开销；
+    // warmup 自身的 dummy forward 不受影响
+    void require_ready(bool enabled) { require_ready_.store(enabled); }
+    bool requires_ready() const { return require_ready_.load(); }
+
+    // 最近一次 warmup 的统计
+    const WarmupReport &last_warmup() const { return last_warmup_; }
+
+protected:
+    // 模型的 warmup() 调用：对每个 batch_size x sample_shape 先 prepare(input_shape) 填充形状缓存，
+    // 再在参数所在设备上用全零输入 forward 两次。第一次 forward 承担描述符创建、workspace 与激活的首次分配、
+    // 内存池扩容和页面首次访问的开销，第二次的耗时即稳态延迟。全部成功后模型才标记为 serving_ready
+    template <typename Prepare, typename Forward>
+    const WarmupReport &warmup_shapes_(const std::vector<Shape> &sample_shapes, const std::vector<size_t> &batch_sizes,
+                                       Prepare &&prepare, Forward &&forward) {
+        using clock = std::chrono::steady_clock;
+        auto elapsedMs = [](clock::time_point since) { return std::chrono::duration<double, std::milli>(clock::now() - since).count(); };
+        serving_ready_.store(false);
+        // 当前线程上的 forward 属于 warmup，不受 require_ready 限制
+        struct WarmingUp {
+            const RootModule *previous;
+            explicit WarmingUp(const RootModule *module) : previous(warming_up_()) { warming_up_() = module; }
+            ~WarmingUp() { warming_up_() = previous; }
+        } warming_up(this);
+        auto start = clock::now();
+        Device device = parameter_device();
+        WarmupReport report;
+        for (size_t batch_size : batch_sizes) {
+            for (const Shape &sample_shape : sample_shapes) {
+                WarmupReport::Entry entry;
+                entry.input_shape = sample_shape;
+                entry.input_shape.insert(entry.input_shape.begin(), batch_size);
+
+                auto phase = clock::now();
+                prepare(entry.input_shape);
+                entry.prepare_ms = elapsedMs(phase);
+
+                Tensor input = infinidemo::nn::zeros(entry.input_shape, DataType::F32, device);
+                for (double *elapsed : {&entry.cold_ms, &entry.warm_ms}) {
+                    phase = clock::now();
+                    forward(input);
+                    infinicore::context::syncDevice();
+                    *elapsed = elapsedMs(phase);
+                }
+                report.entries.push_back(std::move(entry));
+            }
+        }
+        report.elapsed_ms = elapsedMs(start);
+        last_warmup_ = std::move(report);
+        serving_ready_.store(true);
+        return last_warmup_;
+    }
+
+    // 模型的 forward 入口调用：权重尚未加载时抛出异常（参数是未初始化的内存），并等待未完成的参数迁移；
+    // require_ready 时还要求已经 warmup
+    void ensure_parameters_ready_() const {
+        if (require_ready_.load() && !serving_ready_.load() && (warming_up_() != this)) {
+            throw std::runtime_error("forward before warmup(): require_ready is set and the model is not serving_ready (warm up again after to())");
+        }
+        if (!weights_loaded_) {
+            std::vector<ParameterSlot> slots;
+            const_cast<RootModule *>(this)->collect_parameters_("", slots);
+            std::string missing;
+            size_t count = 0;
+            for (const auto &slot : slots) {
+                if (loaded_parameters_.count(slot.path) == 0) {
+                    if (count < 3) {
+                        missing += (count > 0 ? ", " : "") + slot.path;
+                    }
+                    ++count;
+                }
+            }
+            throw std::runtime_error("forward before the weights were loaded: " + std::to_string(count) + " parameter(s) not set by load_state_dict (" + missing
+                                     + (count > 3 ? ", ..." : "") + ")");
+        }
+        finish_migration();
+    }
+
+    // 把当前的参数重新打包进 device 上的一块新 slab（to_slab 的实现），不改变 serving_ready。
+    // 模型自身调整参数集合后（如 releaseClassifier）也用它回收 arena 中不再使用的部分
+    MigrationReport pack_slab_(const Device &device, size_t alignment = 256, size_t chunk_bytes = size_t(64) << 20) {
+        finish_migration();
+        infinidemo::nn::memory::PhaseScope phase("to");
+        auto start = std::chrono::steady_clock::now();
+        infinicore::context::setDevice(device);
+
+        MigrationReport report;
+        std::vector<ParameterSlot> slots = plan_parameter_layout_(alignment, report);
+        bump_parameter_version_();
+        if (slots.empty()) {
+            last_migration_ = report;
+            return report;
+        }
+
+        if (!uniform_dtype_(slots, alignment)) {
+            // 不同 dtype 的参数不能是同一个 slab tensor 的视图，退回逐参数迁移
+            Module::to(device);
+            slab_ = Tensor();
+            report.slab_bytes = report.parameter_bytes;
+            report.copies = report.parameters;
+            report.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            last_migration_ = report;
+            return report;
+        }
+
+        bool on_host = device.getType() == Device::Type::CPU;
+        INFINIDEMO_PROFILE_ALLOCATION(report.slab_bytes);
+        Tensor slab = allocate_slab_(slots, report.slab_bytes, device);
+        // CPU 上直接打包进 slab；设备上先打包进 pinned staging，再分批异步上传
+        std::shared_ptr<Memory> staging;
+        std::byte *staging_data = slab->data();
+        if (!on_host) {
+            staging = infinicore::context::allocatePinnedHostMemory(report.slab_bytes);
+            infinidemo::nn::memory::trackAllocation(staging, report.slab_bytes);
+            staging_data = staging->data();
+        }
+        track_slab_(slab, report.slab_bytes, device, slots);
+
+        size_t flushed = 0;
+        auto flush = [&](size_t end) {
+            if (!on_host && (end > flushed)) {
+                infinicore::context::memcpyH2D(slab->data() + flushed, staging_data + flushed, end - flushed, true);
+                infinidemo::nn::debug::crossDeviceCopyCounter().fetch_add(1, std::memory_order_relaxed);
+                ++report.copies;
+            }
+            flushed = end;
+        };
+        for (const auto &slot : slots) {
+            check_storage_(slot, "to_slab");
+            Tensor host = infinidemo::nn::debug::toDevice(slot.tensor, Device::cpu());
+            if (!host->is_contiguous()) {
+                host = host->contiguous();
+            }
+            std::memcpy(staging_data + slot.offset, host->data(), slot.bytes);
+            if (slot.offset + slot.bytes - flushed >= chunk_bytes) {
+                flush(slot.offset + slot.bytes);
+            }
+        }
+        flush(report.slab_bytes);
+
+        bind_slab_views_(slab, slots);
+        slab_ = slab;
+        shares_parameters_ = false;
+        if (!on_host) {
+            // 拷贝完成之前 staging 不能释放，由 finish_migration() 等待并释放
+            pending_staging_ = staging;
+            pending_device_ = device;
+            migration_pending_.store(true);
+        }
+
+        report.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        last_migration_ = report;
+        return report;
+    }
+
+    // 当前线程正在 warmup 的模型
+    static const RootModule *&warming_up_() {
+        thread_local const RootModule *module = nullptr;
+        return module;
+    }
+
+    // 共享的参数属于 source 的 arena，迁移会让两个模型的参数各自为政，且原地改写会影响 source
+    void check_not_shared_(const char *what) const {
+        if (shares_parameters_) {
+            throw std::runtime_error(std::string(what) + "(): the parameters are shared with another model (share_parameters_from), move the source model instead");
+        }
+    }
+
+    void bump_parameter_version_() {
+        ++parameter_version_;
+        bump_parameter_epoch_();
+    }
+
+    // arena 模式的占位参数没有内存，分配或共享之前不能读写
+    static void check_storage_(const ParameterSlot &slot, const char *what) {
+        if ((slot.tensor->numel() > 0) && (slot.tensor->data() == nullptr)) {
+            throw std::runtime_error(std::string(what) + ": parameter " + slot.path
+                                     + " has no storage, the model was built in a ParameterArenaScope without allocate_parameter_arena() or share_parameters_from()");
+        }
+    }
+
+    // 收集整棵树的参数，按注册顺序依次按 alignment 对齐分配偏移，report 中记录参数个数与总大小。
+    // 注册顺序即 forward 中的使用顺序（按路径字符串排序会把 "stages.10" 排在 "stages.2" 之前），相邻使用的参数在 slab 中也相邻
+    std::vector<ParameterSlot> plan_parameter_layout_(size_t alignment, MigrationReport &report) {
+        std::vector<ParameterSlot> slots;
+        collect_parameters_("", slots);
+
+        size_t offset = 0;
+        for (auto &slot : slots) {
+            offset = (offset + alignment - 1) / alignment * alignment;
+            slot.offset = offset;
+            slot.bytes = infinidemo::nn::numBytes(slot.tensor->shape(), slot.tensor->dtype());
+            offset += slot.bytes;
+            report.parameter_bytes += slot.bytes;
+        }
+        report.parameters = slots.size();
+        report.slab_bytes = offset;
+        return slots;
+    }
+
+    // 所有参数 dtype 相同、对齐后的偏移是元素大小的整数倍时，才能作为同一个一维 slab tensor 的视图
+    static bool uniform_dtype_(const std::vector<ParameterSlot> &slots, size_t alignment) {
+        DataType dtype = slots.front().tensor->dtype();
+        if (alignment % infinicore::dsize(dtype) != 0) {
+            return false;
+        }
+        return std::all_of(slots.begin(), slots.end(), [&](const ParameterSlot &slot) { return slot.tensor->dtype() == dtype; });
+    }
+
+    // 一维的 slab tensor，元素类型与参数相同
+    static Tensor allocate_slab_(const std::vector<ParameterSlot> &slots, size_t bytes, const Device &device) {
+        DataType dtype = slots.front().tensor->dtype();
+        return Tensor::empty({bytes / infinicore::dsize(dtype)}, dtype, device);
+    }
+
+    // 每个参数重新绑定为 slab 的 narrow 视图，视图与 slab 共同持有内存
+    static void bind_slab_views_(const Tensor &slab, const std::vector<ParameterSlot> &slots) {
+        for (const auto &slot : slots) {
+            size_t element_size = infinicore::dsize(slot.tensor->dtype());
+            Tensor view = slab->narrow({{0, slot.offset / element_size, slot.bytes / element_size}})->view(slot.tensor->shape());
+            infinidemo::nn::memory::shareStorage(slab, view);
+            slot.module->rebind_parameter_(slot.name, view);
+        }
+    }
+
+    // 内存统计中 slab 按参数所属的模块路径拆分
+    static void track_slab_(Tensor slab, size_t bytes, const Device &device, const std::vector<ParameterSlot> &slots) {
+        auto &tracker = infinidemo::nn::memory::MemoryTracker::instance();
+        if (!tracker.enabled()) {
+            return;
+        }
+        std::vector<std::pair<std::string, size_t>> parts;
+        parts.reserve(slots.size());
+        for (const auto &slot : slots) {
+            parts.emplace_back(slot.module->module_path(), slot.bytes);
+        }
+        tracker.recordSlab(slab->shared_from_this(), bytes, device, parts);
+    }
+
+    Tensor slab_; // 参数 slab（一维 tensor），参数都是其中的视图
+    mutable std::shared_ptr<Memory> pending_staging_; // 未完成的异步上传的 staging buffer
+    Device pending_device_;
+    mutable AtomicFlag migration_pending_;
+    OwnedMutex forward_mutex_;
+    MigrationReport last_migration_;
+    WarmupReport last_warmup_;
+    uint64_t parameter_version_ = 0;
+    bool weights_loaded_ = false;
+    bool shares_parameters_ = false;
+    std::unordered_set<std::string> loaded_parameters_; // 分多次加载时已经加载过的参数路径
+    AtomicFlag serving_ready_;
+    AtomicFlag require_ready_;
+};
+
+} // namespace infinidemo::nn::modules
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "../allocator.hpp"
+#include "../debug.hpp"
+#include "../functional/topksoftmax_op.hpp"
+#include "../utils.hpp"
+#include "module.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <infinicore/device.hpp>
+#include <infinicore/nn/module.hpp>
+#include <infinicore/tensor.hpp>
+#include <stdexcept>
+
+namespace infinidemo::nn::modules {
+using namespace infinicore;
+
+// CPU 与 CUDA 兼容平台有原生的 Topksoftmax 算子；其它平台把 logits 拷回 host 后用 CPU 算子计算
+inline bool hasNativeTopksoftmax(const Device &device) {
+    switch (device.getType()) {
+    case Device::Type::CPU:
+    case Device::Type::NVIDIA:
+    case Device::Type::ILUVATAR:
+    case Device::Type::METAX:
+        return true;
+    default:
+        return false;
+    }
+}
+
+struct TopkSoftmaxOutput {
+    Tensor values;  // F32 [N, k]，概率从大到小
+    Tensor indices; // I32 [N, k]，类别下标
+};
+
+// 对 [N, C] 的 logits 做融合的 softmax + top-k，只输出 N x k 的概率与下标，
+// 回传 host 的数据量从 N x C 降到 N x k
+class TopkSoftmax : public infinidemo::nn::modules::Module {
+public:
+    TopkSoftmax(size_t topk = 5, bool normalize = false) : topk_(topk), normalize_(normalize) {
+        if (topk_ == 0) {
+            throw std::runtime_error("TopkSoftmax: topk must be greater than 0");
+        }
+    }
+
+    inline TopkSoftmaxOutput forward(const Tensor &logits) const {
+        INFINIDEMO_PROFILE_MODULE("TopkSoftmax", logits);
+        if (logits->ndim() != 2) {
+            throw std::runtime_error("TopkSoftmax: expected logits of shape [N, num_classes]");
+        }
+        size_t topk = std::min(topk_, logits->shape()[1]);
+        Tensor input = logits->is_contiguous() ? logits : logits->contiguous();
+        if (!hasNativeTopksoftmax(input->device())) {
+            input = infinidemo::nn::debug::toDevice(input, Device::cpu());
+        }
+
+        Shape shape = {input->shape()[0], topk};
+        TopkSoftmaxOutput output{infinidemo::nn::empty(shape, DataType::F32, input->device()),
+                                 infinidemo::nn::empty(shape, DataType::I32, input->device())};
+        INFINICORE_CHECK_ERROR(infinidemo::nn::functional::performTopksoftmax(
+            output.values, output.indices, input, topk, normalize_, input->device()));
+        return output;
+    }
+
+    size_t topk() const { return topk_; }
+
+private:
+    void to_device_(const Device &device) override {}
+
+protected:
+    size_t topk_;
+    bool normalize_;
+};
+
+} // namespace infinidemo::nn::modules
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "memory_tracker.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <infinicore/context/context.hpp>
+#include <infinicore/tensor.hpp>
+#include <infinirt.h>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 逐层 profiler：记录每个 Module::forward 与 perform* 调用的 wall time、device time、
+// 分配字节数、descriptor 创建耗时与 tensor 形状，导出 Chrome trace JSON 与逐层汇总表。
+//
+// 只有在编译时定义 INFINIDEMO_ENABLE_PROFILER（xmake f --profiler=y）时，
+// INFINIDEMO_PROFILE_* 宏才会展开，否则全部为空语句，热路径没有任何额外开销。
+// 编译进来但运行时未 enable() 时，每个 Scope 只做一次原子读，模块路径等字符串在 enabled() 检查之后才构造。
+//
+// 启用后每个 Scope 在结束时记录一个 device event 并 infinirtEventSynchronize 等待它完成，stream 因此被逐层串行化：
+// device time 是该层单独执行的时间，整体耗时不包含层与层、拷贝与计算之间本来会有的重叠。
+namespace infinidemo::nn::profiler {
+using namespace infinicore;
+
+struct Event {
+    std::string name;
+    std::string category;
+    std::string shapes;
+    double start_us = 0.0;
+    double wall_us = 0.0;
+    double device_us = 0.0;
+    double descriptor_us = 0.0;
+    size_t bytes_allocated = 0;
+    int thread_id = 0;
+};
+
+struct LayerSummary {
+    std::string name;
+    std::string category;
+    std::string shapes;
+    size_t calls = 0;
+    double total_wall_us = 0.0;
+    double total_device_us = 0.0;
+    double total_descriptor_us = 0.0;
+    size_t total_bytes_allocated = 0;
+};
+
+inline bool compiledIn() {
+#ifdef INFINIDEMO_ENABLE_PROFILER
+    return true;
+#else
+    return false;
+#endif
+}
+
+class Profiler {
+public:
+    static Profiler &instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    void enable() {
+        if (!compiledIn()) {
+            throw std::runtime_error("Profiler is not compiled in, rebuild with `xmake f --profiler=y`");
+        }
+        enabled_.store(true, std::memory_order_relaxed);
+    }
+    void disable() { enabled_.store(false, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.clear();
+        epoch_ = std::chrono::steady_clock::now();
+    }
+
+    double nowUs() const {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - epoch_).count();
+    }
+
+    void record(Event event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back(std::move(event));
+    }
+
+    std::vector<Event> events() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return events_;
+    }
+
+    // 按名字聚合，按总 wall time 降序
+    std::vector<LayerSummary> summary() const {
+        std::map<std::string, LayerSummary> table;
+        for (const auto &e : events()) {
+            auto &row = table[e.category + "|" + e.name];
+            row.name = e.name;
+            row.category = e.category;
+            row.shapes = e.shapes;
+            row.calls += 1;
+            row.total_wall_us += e.wall_us;
+            row.total_device_us += e.device_us;
+            row.total_descriptor_us += e.descriptor_us;
+            row.total_bytes_allocated += e.bytes_allocated;
+        }
+        std::vector<LayerSummary> rows;
+        rows.reserve(table.size());
+        for (auto &[key, row] : table) {
+            rows.push_back(std::move(row));
+        }
+        std::sort(rows.begin(), rows.end(), [](const LayerSummary &a, const LayerSummary &b) { return a.total_wall_us > b.total_wall_us; });
+        return rows;
+    }
+
+    std::string summaryTable() const {
+        std::ostringstream os;
+        os << std::left << std::setw(56) << "name" << std::setw(8) << "cat" << std::right
+           << std::setw(8) << "calls" << std::setw(14) << "wall(ms)" << std::setw(14) << "device(ms)"
+           << std::setw(14) << "desc(ms)" << std::setw(14) << "alloc(MB)" << "  shapes\n";
+        for (const auto &row : summary()) {
+            os << std::left << std::setw(56) << row.name << std::setw(8) << row.category << std::right
+               << std::setw(8) << row.calls << std::fixed << std::setprecision(3)
+               << std::setw(14) << row.total_wall_us / 1000.0
+               << std::setw(14) << row.total_device_us / 1000.0
+               << std::setw(14) << row.total_descriptor_us / 1000.0
+               << std::setw(14) << static_cast<double>(row.total_bytes_allocated) / (1024.0 * 1024.0)
+               << "  " << row.shapes << "\n";
+        }
+        return os.str();
+    }
+
+    // Chrome trace 格式（chrome://tracing 或 Perfetto 打开）
+    std::string chromeTrace() const {
+        std::ostringstream os;
+        os << "{\"traceEvents\":[";
+        bool first = true;
+        for (const auto &e : events()) {
+            if (!first) {
+                os << ",";
+            }
+            first = false;
+            os << "{\"name\":\"" << escape(e.name) << "\",\"cat\":\"" << e.category << "\",\"ph\":\"X\""
+               << ",\"ts\":" << std::fixed << std::setprecision(3) << e.start_us << ",\"dur\":" << e.wall_us
+               << ",\"pid\":0,\"tid\":" << e.thread_id
+               << ",\"args\":{\"shapes\":\"" << escape(e.shapes) << "\",\"device_us\":" << e.device_us
+               << ",\"descriptor_us\":" << e.descriptor_us << ",\"bytes_allocated\":" << e.bytes_allocated << "}}";
+        }
+        os << "],\"displayTimeUnit\":\"ms\"}";
+        return os.str();
+    }
+
+    void exportChromeTrace(const std::string &path) const {
+        std::ofstream file(path);
+        if (!file) {
+            throw std::runtime_error("Failed to open trace file: " + path);
+        }
+        file << chromeTrace();
+    }
+
+private:
+    Profiler() : epoch_(std::chrono::steady_clock::now()) {}
+
+    static std::string escape(const std::string &s) {
+        std::string out;
+        out.reserve(s.size());
+        for (char c : s) {
+            if ((c == '"') || (c == '\\')) {
+                out.push_back('\\');
+            }
+            out.push_back(c);
+        }
+        return out;
+    }
+
+    std::atomic<bool> enabled_{false};
+    mutable std::mutex mutex_;
+    std::vector<Event> events_;
+    std::chrono::steady_clock::time_point epoch_;
+};
+
+// 当前线程累计分配的字节数，Scope 用前后差值得到本层的分配量
+inline size_t &threadAllocatedBytes() {
+    thread_local size_t bytes = 0;
+    return bytes;
+}
+
+inline void recordAllocation(size_t bytes) {
+    if (Profiler::instance().enabled()) {
+        threadAllocatedBytes() += bytes;
+    }
+}
+
+inline int threadId() {
+    static std::atomic<int> next{0};
+    thread_local int id = next.fetch_add(1);
+    return id;
+}
+
+inline std::string formatShape(const Tensor &tensor) {
+    if (!tensor) {
+        return "[]";
+    }
+    std::ostringstream os;
+    os << "[";
+    const auto &shape = tensor->shape();
+    for (size_t i = 0; i < shape.size(); ++i) {
+        os << (i > 0 ? ", " : "") << shape[i];
+    }
+    os << "]";
+    return os.str();
+}
+
+class Scope {
+public:
+    template <typename... Tensors>
+    Scope(const char *category, const char *name, const Tensors &...tensors) {
+        if (Profiler::instance().enabled()) {
+            start(category, name, tensors...);
+        }
+    }
+
+    // 模块 Scope：owner->module_path() 只在 profiler 启用时读取，路径为空时使用 type_name
+    template <typename Owner, typename... Tensors>
+    Scope(const char *category, const Owner *owner, const char *type_name, const Tensors &...tensors) {
+        if (Profiler::instance().enabled()) {
+            const std::string &path = owner->module_path();
+            start(category, path.empty() ? std::string(type_name) : path, tensors...);
+        }
+    }
+
+    ~Scope() {
+        if (!active_) {
+            return;
+        }
+        Profiler &profiler = Profiler::instance();
+        if (end_event_ != nullptr) {
+            infinirtEventRecord(end_event_, context::getStream());
+            infinirtEventSynchronize(end_event_);
+            float ms = 0.0f;
+            if (infinirtEventElapsedTime(&ms, start_event_, end_event_) == INFINI_STATUS_SUCCESS) {
+                event_.device_us = static_cast<double>(ms) * 1000.0;
+            }
+        }
+        if (start_event_ != nullptr) {
+            infinirtEventDestroy(start_event_);
+        }
+        if (end_event_ != nullptr) {
+            infinirtEventDestroy(end_event_);
+        }
+        event_.wall_us = profiler.nowUs() - event_.start_us;
+        event_.bytes_allocated = threadAllocatedBytes() - bytes_at_start_;
+        current() = parent_;
+        profiler.record(std::move(event_));
+    }
+
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+    // perform* 在创建完 descriptor 后调用，记录从 Scope 开始到此刻的耗时
+    static void markDescriptorCreated() {
+        Scope *scope = current();
+        if ((scope != nullptr) && scope->active_) {
+            scope->event_.descriptor_us = Profiler::instance().nowUs() - scope->event_.start_us;
+        }
+    }
+
+private:
+    template <typename... Tensors>
+    void start(const char *category, std::string name, const Tensors &...tensors) {
+        active_ = true;
+        event_.category = category;
+        event_.name = std::move(name);
+        ((event_.shapes += (event_.shapes.empty() ? "" : " ") + formatShape(tensors)), ...);
+        event_.thread_id = threadId();
+        bytes_at_start_ = threadAllocatedBytes();
+        parent_ = current();
+        current() = this;
+
+        if ((infinirtEventCreate(&start_event_) == INFINI_STATUS_SUCCESS)
+            && (infinirtEventCreate(&end_event_) == INFINI_STATUS_SUCCESS)) {
+            infinirtEventRecord(start_event_, context::getStream());
+        }
+        event_.start_us = Profiler::instance().nowUs();
+    }
+
+    static Scope *&current() {
+        thread_local Scope *scope = nullptr;
+        return scope;
+    }
+
+    bool active_ = false;
+    Event event_;
+    size_t bytes_at_start_ = 0;
+    Scope *parent_ = nullptr;
+    infinirtEvent_t start_event_ = nullptr;
+    infinirtEvent_t end_event_ = nullptr;
+};
+
+} // namespace infinidemo::nn::profiler
+
+// INFINIDEMO_PROFILE_MODULE 总是设置内存统计的模块归属（见 memory_tracker.hpp），与 profiler 是否编译无关
+#ifdef INFINIDEMO_ENABLE_PROFILER
+#define INFINIDEMO_PROFILE_MODULE(type_name, ...)                                            \
+    infinidemo::nn::memory::ModuleScope _infinidemo_memory_scope_(this->module_path()); \
+    infinidemo::nn::profiler::Scope _infinidemo_profile_scope_("module", this, type_name, ##__VA_ARGS__)
+#define INFINIDEMO_PROFILE_OP(op_name, ...) \
+    infinidemo::nn::profiler::Scope _infinidemo_profile_scope_("op", op_name, ##__VA_ARGS__)
+#define INFINIDEMO_PROFILE_DESCRIPTOR_CREATED() infinidemo::nn::profiler::Scope::markDescriptorCreated()
+#define INFINIDEMO_PROFILE_ALLOCATION(bytes) infinidemo::nn::profiler::recordAllocation(bytes)
+#else
+#define INFINIDEMO_PROFILE_MODULE(type_name, ...) infinidemo::nn::memory::ModuleScope _infinidemo_memory_scope_(this->module_path())
+#define INFINIDEMO_PROFILE_OP(op_name, ...) ((void)0)
+#define INFINIDEMO_PROFILE_DESCRIPTOR_CREATED() ((void)0)
+#define INFINIDEMO_PROFILE_ALLOCATION(bytes) ((void)0)
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace infinidemo::nn {
+
+// 一串滑窗算子（conv / pool）在一个空间维度上的感受野：输出位置 o 依赖输入的 [stride * o - left, stride * o + right]。
+// 两个空间维度使用相同的 kernel / stride / padding，所以只记录一维。
+// 空间分块执行用它计算每个 tile 需要的 halo，以及 tile 起点必须对齐的步长
+struct ReceptiveField {
+    size_t stride = 1;
+    ptrdiff_t left = 0;
+    ptrdiff_t right = 0;
+
+    // kernel / stride / padding / dilation 的单个滑窗算子
+    static ReceptiveField window(size_t kernel_size, size_t stride, size_t padding, size_t dilation = 1) {
+        ptrdiff_t extent = static_cast<ptrdiff_t>(dilation * (kernel_size - 1));
+        return {stride, static_cast<ptrdiff_t>(padding), extent - static_cast<ptrdiff_t>(padding)};
+    }
+
+    // 串接：next 的输入是 this 的输出
+    ReceptiveField then(const ReceptiveField &next) const {
+        ptrdiff_t s = static_cast<ptrdiff_t>(stride);
+        return {stride * next.stride, s * next.left + left, s * next.right + right};
+    }
+
+    // 并联的两个分支（如残差块的主路径与 shortcut）相加：取依赖范围的并集，两者的步长必须相同
+    ReceptiveField merge(const ReceptiveField &other) const {
+        if (stride != other.stride) {
+            throw std::runtime_error("ReceptiveField: cannot merge branches with strides " + std::to_string(stride) + " and " + std::to_string(other.stride));
+        }
+        return {stride, std::max(left, other.left), std::max(right, other.right)};
+    }
+
+    // 一个输出位置依赖的输入宽度
+    size_t size() const { return static_cast<size_t>(left + right + 1); }
+
+    std::string toString() const {
+        std::ostringstream os;
+        os << "{ \"stride\": " << stride << ", \"left\": " << left << ", \"right\": " << right << ", \"size\": " << size() << " }";
+        return os.str();
+    }
+};
+
+} // namespace infinidemo::nn
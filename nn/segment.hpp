@@ -0,0 +1,22 @@
+#pragma once
+
+#include <functional>
+#include <infinicore/tensor.hpp>
+#include <string>
+#include <vector>
+
+namespace infinidemo::nn {
+using namespace infinicore;
+
+// 模型前向中可以单独执行的一段（例如 ResNet 的 embedder、一个 stage 或分类头），
+// 按顺序依次执行所有段等价于完整的 forward。流水线并行按段把模型切到不同的 worker 上
+struct ForwardSegment {
+    std::string name;
+    // 该段包含的 module path，用于在 profiler 汇总表中查找实测耗时
+    std::vector<std::string> modules;
+    std::function<Tensor(Tensor &)> forward;
+    // 为构造时的输入形状估计的 FLOPs，没有 profiler 数据时作为切分依据
+    double flops = 0.0;
+};
+
+} // namespace infinidemo::nn
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "debug.hpp"
+#include <array>
+#include <atomic>
+#include <infinicore/tensor.hpp>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace infinidemo::nn {
+using namespace infinicore;
+
+// 按输入形状缓存一个模块的输出形状与算子参数。命中时只做形状比较，不加锁、不分配内存；
+// 每个不同的输入形状只计算一次（由 prepare() 提前填充，或者在第一次 forward 时填充）。
+// 最多缓存 kCapacity 个形状，条目发布后不再修改，返回的引用在模块生命周期内有效；
+// 超出容量的形状每次重新计算，结果放在线程局部的环形缓冲中（只在当前 forward 内使用）
+template <typename Value = Shape>
+class ShapeCache {
+public:
+    static constexpr size_t kCapacity = 32;
+    static constexpr size_t kOverflowSlots = 256;
+
+    ShapeCache() = default;
+    // 模块可以被拷贝（例如按值返回的模型），拷贝时复制已有条目
+    ShapeCache(const ShapeCache &other) { copyFrom(other); }
+    ShapeCache &operator=(const ShapeCache &other) {
+        if (this != &other) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto &entry : entries_) {
+                entry.reset();
+            }
+            size_.store(0, std::memory_order_release);
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    template <typename Compute>
+    const Value &lookup(const Shape &input, Compute &&compute) const {
+        // 已发布的条目 [0, size) 只读：先看上一次命中的条目，再顺序比较
+        size_t size = size_.load(std::memory_order_acquire);
+        size_t hint = hint_.load(std::memory_order_relaxed);
+        if ((hint < size) && (entries_[hint]->first == input)) {
+            return entries_[hint]->second;
+        }
+        for (size_t i = 0; i < size; ++i) {
+            if (entries_[i]->first == input) {
+                hint_.store(i, std::memory_order_relaxed);
+                return entries_[i]->second;
+            }
+        }
+
+        debug::shapeComputationCounter().fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        size = size_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < size; ++i) {
+            if (entries_[i]->first == input) {
+                return entries_[i]->second;
+            }
+        }
+        if (size == kCapacity) {
+            thread_local std::array<Value, kOverflowSlots> overflow;
+            thread_local size_t next = 0;
+            Value &slot = overflow[next++ % kOverflowSlots];
+            slot = compute(input);
+            return slot;
+        }
+        entries_[size] = std::make_unique<std::pair<Shape, Value>>(input, compute(input));
+        size_.store(size + 1, std::memory_order_release);
+        return entries_[size]->second;
+    }
+
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+
+private:
+    // 调用方保证 this 没有并发的 lookup
+    void copyFrom(const ShapeCache &other) {
+        std::lock_guard<std::mutex> lock(other.mutex_);
+        size_t size = other.size_.load(std::memory_order_acquire);
+        for (size_t i = 0; i < size; ++i) {
+            entries_[i] = std::make_unique<std::pair<Shape, Value>>(*other.entries_[i]);
+        }
+        size_.store(size, std::memory_order_release);
+    }
+
+    mutable std::mutex mutex_;
+    mutable std::array<std::unique_ptr<std::pair<Shape, Value>>, kCapacity> entries_;
+    mutable std::atomic<size_t> size_{0};
+    mutable std::atomic<size_t> hint_{0};
+};
+
+} // namespace infinidemo::nn
@@ -1,6 +1,7 @@
+from .image_processing import ImageProcessor
 from .mnist.modeling_mnist import MnistForImageClassification
 from .module_loader import load_module
 from .resnet.configuration_resnet import ResNetConfig
 from .resnet.modeling_resnet import ResNetForImageClassification
 
-__all__ = ["MnistForImageClassification", "load_module", "ResNetConfig", "ResNetForImageClassification"]
\ No newline at end of file
+__all__ = ["ImageProcessor", "MnistForImageClassification", "load_module", "ResNetConfig", "ResNetForImageClassification"]
\ No newline at end of file
@@ -0,0 +1,63 @@
+import json
+import os
+from typing import List, Union
+
+import infinicore
+
+from .module_loader import _infinidemo
+
+# PIL.Image.Resampling 的取值
+_PIL_RESAMPLE = {
+    2: _infinidemo.image.Resample.BILINEAR,
+    3: _infinidemo.image.Resample.BICUBIC,
+}
+
+
+class ImageProcessor(_infinidemo.image.ImageProcessor):
+    """C++ 实现的图像预处理，与 transformers 的 ConvNextImageProcessor 对齐，推理期间释放 GIL"""
+
+    def __init__(self, config=None):
+        if config is None:
+            config = _infinidemo.image.ImageProcessorConfig()
+        super().__init__(config)
+
+    def preprocess(self, images: List[Union[str, bytes]], device: infinicore.device = None):
+        device = device._underlying if device is not None else infinicore.device("cpu", 0)._underlying
+        if all(isinstance(image, bytes) for image in images):
+            return super().preprocess_bytes(images, device)
+        if all(isinstance(image, (str, os.PathLike)) for image in images):
+            return super().preprocess_files([os.fspath(image) for image in images], device)
+        return super().preprocess_arrays(list(images), device)
+
+    __call__ = preprocess
+
+    def fold_into(self, model, key="resnet.embedder.embedder.convolution.weight"):
+        """把 rescale / std 折叠进模型第一层卷积，之后预处理只减均值"""
+        super().fold_normalization(model.state_dict()[key])
+        return self
+
+    @classmethod
+    def from_pretrained(cls, model_path) -> "ImageProcessor":
+        with open(os.path.join(model_path, "preprocessor_config.json"), "r", encoding="utf-8") as f:
+            config_dict = json.load(f)
+
+        config = _infinidemo.image.ImageProcessorConfig()
+        size = config_dict.get("size", {})
+        if isinstance(size, dict):
+            config.shortest_edge = size.get("shortest_edge", config.shortest_edge)
+        elif isinstance(size, int):
+            config.shortest_edge = size
+        config.crop_pct = config_dict.get("crop_pct", config.crop_pct) or 1.0
+        resample = config_dict.get("resample", 3)
+        if resample not in _PIL_RESAMPLE:
+            raise ValueError(f"Unsupported resample mode: {resample}")
+        config.resample = _PIL_RESAMPLE[resample]
+        config.do_resize = config_dict.get("do_resize", True)
+        config.do_normalize = config_dict.get("do_normalize", True)
+        if config_dict.get("do_rescale", True):
+            config.rescale_factor = config_dict.get("rescale_factor", config.rescale_factor)
+        else:
+            config.rescale_factor = 1.0
+        config.image_mean = config_dict.get("image_mean", list(config.image_mean))
+        config.image_std = config_dict.get("image_std", list(config.image_std))
+        return cls(config)
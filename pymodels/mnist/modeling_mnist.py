@@ -33,15 +33,21 @@ class MnistForImageClassification(_infinidemo.MnistForImageClassification):
         >>> print(output.shape)
     """
     
-    def __init__(self):
-        super().__init__() # 调用父类（C++绑定）的构造函数
+    def __init__(self, config=None, parameter_arena: bool = True):
+        # config: _infinidemo.MnistConfig，None 时为默认结构（1x28x28，4 个 7x7 卷积核，1936 -> 10）
+        if isinstance(config, bool):  # 兼容 MnistForImageClassification(parameter_arena)
+            config, parameter_arena = None, config
+        if config is None:
+            super().__init__(parameter_arena) # 调用父类（C++绑定）的构造函数
+        else:
+            super().__init__(config, parameter_arena)
     
     def forward(self, input):
         """
-        前向传播（重写以支持自动类型转换）
+        前向传播，C++ 端直接接受 infinicore.Tensor 并返回 infinicore.Tensor，推理期间释放 GIL
         
         Args:
-            input: 输入tensor，可以是 infinicore.Tensor
+            input: 输入tensor，infinicore.Tensor
             
         Returns:
             output: 输出tensor
@@ -52,27 +58,66 @@ class MnistForImageClassification(_infinidemo.MnistForImageClassification):
             >>> input = infinicore.randn(1, 1936)
             >>> output = model.forward(input)
         """
-        # 自动处理输入类型转换
-        if isinstance(input, infinicore.Tensor):
-            # 如果是 infinicore.Tensor，尝试使用 _underlying 属性（如果存在）
-            if hasattr(input, '_underlying'):
-                return super().forward(input._underlying)
-            else:
-                return super().forward(input)
-        
-        raise ValueError(f"Unsupported input type: {type(input)}. Expected infinicore.Tensor")
+        return super().forward(input)
     
-    def __call__(self, input):
+    def forward_batch(self, inputs):
         """
-        使模型可调用，支持 model(input) 语法
+        一次处理多个输入，形状兼容时在 C++ 端拼成一个 batch 执行
         
         Args:
-            input: 输入tensor
+            inputs: infinicore.Tensor 列表
             
         Returns:
-            output: 输出tensor
+            outputs: 与输入一一对应的输出列表
+        """
+        return super().forward_batch(inputs)
+    
+    def warmup(self, shapes=((1, 28, 28),), batch_sizes=(1,)):
+        """
+        上线前预先构建每个输入形状的执行状态：形状传播 + 两次全零输入的 forward，完成后 self.ready 为 True
+
+        Args:
+            shapes: 不含 batch 维的输入形状列表
+            batch_sizes: 需要 warmup 的 batch 大小
+
+        Returns:
+            {"entries": [{"input_shape", "prepare_ms", "cold_ms", "warm_ms"}, ...], "elapsed_ms": ...}
+        """
+        return super().warmup([list(shape) for shape in shapes], list(batch_sizes))
+
+    def memory_stats(self, reset=False):
+        """
+        进程级的分配统计，需先调用 _infinidemo.memory.enable() 或设置 INFINIDEMO_TRACK_MEMORY=1
+
+        Returns:
+            {"devices", "modules", "phases", "histogram", "report"}，reset=True 时读取后清零计数、重新统计峰值
+        """
+        return super().memory_stats(reset)
+
+    def fused(self, tile: int = 16, threads: int = 0):
+        """
+        整个网络融合为一个 host kernel 的执行器，按 batch tile 完成 conv + ReLU + Linear + ReLU，没有中间 tensor 与算子分派
+
+        Args:
+            tile: 每个 tile 的样本数
+            threads: 分配 tile 的线程数，0 表示使用全部核心
+
+        Returns:
+            可以像模型一样调用的 _infinidemo.FusedMnistExecutor；load_state_dict / to 之后需要重新创建
+        """
+        return _infinidemo.FusedMnistExecutor(self, tile=tile, threads=threads)
+
+    __call__ = forward
+
+    def to(self, *, device: infinicore.device, slab: bool = False):
+        """
+        把参数逐模块迁移到 device；slab 为 True 时打包进 device 上的一块连续 slab，异步上传，第一次 forward / state_dict 时等待完成
+
+        Returns:
+            self
         """
-        return self.forward(input)
+        super().to(device._underlying, slab)
+        return self
     
     def load_state_dict(self, state_dict, strict=None):
         """
@@ -119,11 +164,21 @@ class MnistForImageClassification(_infinidemo.MnistForImageClassification):
     @classmethod
     def from_pretrained(cls, model_path):
         """
-        从预训练模型加载模型参数
+        从预训练模型加载模型参数，model_path 下有 config.json 时按其中的字段构造模型
         """
+        import json
         from ..modeling_utils import load_model_state_dict_by_file
 
-        model = MnistForImageClassification()
+        config = None
+        config_path = os.path.join(model_path, "config.json")
+        if os.path.exists(config_path):
+            with open(config_path) as f:
+                values = json.load(f)
+            config = _infinidemo.MnistConfig()
+            for key in ("num_channels", "image_size", "conv_channels", "kernel_size", "num_labels"):
+                if key in values:
+                    setattr(config, key, int(values[key]))
+        model = MnistForImageClassification(config)
         load_model_state_dict_by_file(model, model_path, dtype=infinicore.float32)
 
         return model
@@ -10,37 +10,13 @@ import infinicore
 
 
 def infini_to_numpy(infini_tensor: infinicore.Tensor):
-    def infini_to_ctype_dtype(infini_dtype):
-        import ctypes
-
-        if infini_dtype == infinicore.int32:
-            return ctypes.c_int32
-        elif infini_dtype == infinicore.float32:
-            return ctypes.c_float
-        elif infini_dtype == infinicore.int64:
-            return ctypes.c_int64
-        else:
-            raise ValueError(f"Unsupported py_dtype: {infini_dtype}")
-
-    infini_tensor_cpu = infinicore.empty_like(
-        infini_tensor, device=infinicore.device("cpu")
-    )
-    infini_tensor_cpu.copy_(infini_tensor)
-
-    # 获取数据指针和形状信息
-    data_ptr = infini_tensor_cpu.data_ptr()
-    num_elements = infini_tensor_cpu.numel()
-    original_shape = infini_tensor_cpu.shape
-
-    # 创建1D NumPy数组（共享内存）
-    ArrayType = infini_to_ctype_dtype(infini_tensor_cpu.dtype) * num_elements
-    array = ArrayType.from_address(data_ptr)
-    np_flat = np.ctypeslib.as_array(array)
-
-    # 重塑为原始形状
-    np_array = np_flat.reshape(original_shape)
-
-    return np.copy(np_array)
+    """
+    转换为 numpy 数组：CPU tensor 通过 buffer protocol 零拷贝共享内存，
+    设备上的 tensor 只做一次 D2H 拷贝，返回的数组持有这块 host 内存
+    """
+    from .module_loader import _infinidemo
+
+    return np.asarray(_infinidemo.TensorBuffer(infini_tensor, to_host=True))
 
 
 def check_parameters(model_keys: list, already_loaded_keys: list):
@@ -41,15 +41,18 @@ class ResNetConfig(_infinidemo.ResNetConfig):
         self.torch_dtype = torch_dtype
         self.transformers_version = transformers_version
 
+        id2label = kwargs.pop("id2label", None)
+
         # 设置额外的关键字参数（用于向后兼容）
         for key, value in kwargs.items():
             if hasattr(self, key):
                 setattr(self, key, value)
 
-        self.id2label = kwargs.get("id2label", None)
         self.label2id = kwargs.get("label2id", None)
-        if self.id2label is not None:
-            self.num_labels = len(self.id2label)
+        if id2label is not None:
+            # C++ 端按整数下标查表，predict 直接返回类别名
+            self.id2label = {int(k): v for k, v in id2label.items()}
+            self.num_labels = len(id2label)
         else:
             raise ValueError("id2label is not set")
 
@@ -1,34 +1,79 @@
 import sys
 import os
 import infinicore
+from typing import List
 
 from ..module_loader import _infinidemo
 
 
 class ResNetForImageClassification(_infinidemo.ResNetForImageClassification):
-    def __init__(self, config):
-        super().__init__(config)
+    def __init__(self, config, parameter_arena: bool = True, share_weights_with=None):
+        # parameter_arena: 所有权重放在同一块连续 buffer 中，state_dict() 返回其中的视图
+        # share_weights_with: 与已有模型共享只读权重，新实例不分配参数内存
+        if share_weights_with is not None:
+            super().__init__(share_weights_with)
+        else:
+            super().__init__(config, parameter_arena)
         self.config = config
         # self.num_labels = config.num_labels
 
-    def forward(self, input: infinicore.Tensor):
-        return infinicore.Tensor(super().forward(input._underlying))
+    def forward(self, input: infinicore.Tensor) -> infinicore.Tensor:
+        # C++ 端完成 infinicore.Tensor 的拆包与包装，并在推理期间释放 GIL
+        return super().forward(input)
 
-    def __call__(self, input: infinicore.Tensor):
-        return self.forward(input)
+    def forward_batch(self, inputs: List[infinicore.Tensor]) -> List[infinicore.Tensor]:
+        return super().forward_batch(inputs)
+
+    def predict(self, input: infinicore.Tensor, top_k: int = 5):
+        # 设备上完成 softmax + top-k，返回 [[(label_id, label_name, prob), ...], ...]
+        return super().predict(input, top_k)
+
+    def features(self, input: infinicore.Tensor, stage: int = -1, normalize: bool = False) -> infinicore.Tensor:
+        # 只运行到第 stage 个 ResNetStage（-1 为最后一个）并全局池化，返回连续的 [N, C] embedding
+        return super().features(input, stage, normalize)
+
+    def forward_tiled(self, input, tile_size: int = 512):
+        # 超大分辨率输入的空间分块执行：每块加上感受野 halo 单独前向后拼回，结果与 forward 一致，峰值激活内存由 tile_size 决定
+        return super().forward_tiled(input, tile_size)
+
+    def features_tiled(self, input, tile_size: int = 512, stage: int = -1, normalize: bool = False):
+        return super().features_tiled(input, tile_size, stage, normalize)
+
+    def warmup(self, shapes, batch_sizes=(1,)):
+        # 上线前为每个 batch size x [C, H, W] 预先构建执行状态并运行 dummy forward，之后 self.ready 为 True；
+        # 返回每个形状的 prepare / 冷启动 / 稳态耗时
+        return super().warmup([list(shape) for shape in shapes], list(batch_sizes))
+
+    def memory_stats(self, reset: bool = False):
+        # 进程级的分配统计（需先 _infinidemo.memory.enable() 或设置 INFINIDEMO_TRACK_MEMORY=1）：
+        # 每个设备的当前 / 峰值字节数、按模块路径与阶段的归属、大小直方图；reset=True 读取后重新开始统计峰值
+        return super().memory_stats(reset)
+
+    __call__ = forward
 
     def load_state_dict(self, state_dict, strict=None):
         super().load_state_dict(state_dict)
 
-    def to(self, *, device: infinicore.device):
-        super().to(device._underlying)
+    def replica(self) -> "ResNetForImageClassification":
+        # 用于多个 serving worker：共享权重，每个实例只有自己的激活，需在 to() 之后调用
+        return ResNetForImageClassification(self.config, share_weights_with=self)
+
+    def with_result_cache(self, max_bytes: int = 256 << 20, max_entries: int = 0):
+        # 按输入内容缓存逐样本的输出，重复的图像不再 forward；返回的对象可以像模型一样调用
+        return _infinidemo.runtime.CachedModel(self, max_bytes=max_bytes, max_entries=max_entries)
+
+    def to(self, *, device: infinicore.device, slab: bool = False):
+        # slab=True：参数打包进 device 上的一块连续 slab（异步上传）
+        super().to(device._underlying, slab)
         return self
 
     def __repr__(self):
         return super().__repr__()
 
     @classmethod
-    def from_pretrained(cls, model_path):
+    def from_pretrained(cls, model_path, features_only: bool = False):
+        # features_only: 只用于特征提取，加载后释放 classifier 的权重
+        # 需要 warmup 时在 to(device) 之后调用 model.warmup(...)（to 会清除 ready 状态）
         from .configuration_resnet import ResNetConfig
         from ..modeling_utils import load_model_state_dict_by_file
 
@@ -36,4 +81,6 @@ class ResNetForImageClassification(_infinidemo.ResNetForImageClassification):
         config = ResNetConfig.from_pretrained(config_path)
         model = ResNetForImageClassification(config)
         load_model_state_dict_by_file(model, model_path, dtype=infinicore.float32)
+        if features_only:
+            model.release_classifier()
         return model
@@ -0,0 +1,86 @@
+import argparse
+
+import numpy as np
+
+
+# 命令行中的平台开关 -> infinicore.device 的设备类型字符串
+PLATFORM_TO_DEVICE = {
+    "cpu": "cpu",
+    "nvidia": "cuda",
+    "metax": "cuda",
+    "moore": "musa",
+    "iluvatar": "cuda",
+    "hygon": "cuda",
+    "ascend": "npu",
+    "cambricon": "mlu",
+}
+
+
+def parse_device_args(description, add_arguments=None):
+    """
+    测试脚本共用的命令行：每个平台一个 --<platform> 开关（默认 CPU），add_arguments(parser) 添加脚本自己的参数
+
+    Returns:
+        (device_str, args)，device_str 可直接传给 infinicore.device(device_str, index)
+    """
+    parser = argparse.ArgumentParser(description=description)
+    for platform in PLATFORM_TO_DEVICE.keys():
+        help_msg = f"Use {platform.upper()} device" if platform != "cpu" else "Use CPU device (default)"
+        parser.add_argument(f"--{platform}", action="store_true", help=help_msg)
+    if add_arguments is not None:
+        add_arguments(parser)
+
+    args = parser.parse_args()
+    device_str = PLATFORM_TO_DEVICE["cpu"]  # 默认值
+    for platform in PLATFORM_TO_DEVICE.keys():
+        if getattr(args, platform, False):
+            device_str = PLATFORM_TO_DEVICE[platform]
+            break
+    return device_str, args
+
+
+def check(condition, message):
+    # 不使用 assert：python -O 会去掉 assert，检查失败时脚本必须以非零状态退出
+    if not condition:
+        raise AssertionError(message)
+
+
+def assert_close(name, actual, expected, atol=1e-4, rtol=1e-4, verbose=True):
+    """
+    逐元素比较两个数组并打印最大绝对误差，超出 atol + rtol * |expected| 时抛出 AssertionError（脚本非零退出）
+
+    Returns:
+        最大绝对误差
+    """
+    actual = np.asarray(actual)
+    expected = np.asarray(expected)
+    check(actual.shape == expected.shape, f"{name}: shape {actual.shape} != {expected.shape}")
+    max_diff = float(np.abs(actual.astype(np.float64) - expected.astype(np.float64)).max()) if actual.size > 0 else 0.0
+    if verbose:
+        print(f" {name}: max abs diff {max_diff:.3e}")
+    check(np.allclose(actual, expected, atol=atol, rtol=rtol), f"{name}: max abs diff {max_diff:.3e} exceeds atol={atol}, rtol={rtol}")
+    return max_diff
+
+
+def random_mnist_state_dict(config, rng):
+    # MnistConfig 对应的随机权重（numpy float32），规模使 ReLU 前的激活有正有负
+    kernel = config.kernel_size
+    return {
+        "conv1.weight": (rng.standard_normal((config.conv_channels, config.num_channels, kernel, kernel)) * 0.1).astype(np.float32),
+        "conv1.bias": (rng.standard_normal(config.conv_channels) * 0.1).astype(np.float32),
+        "fc1.weight": (rng.standard_normal((config.num_labels, config.in_features)) * 0.02).astype(np.float32),
+        "fc1.bias": (rng.standard_normal(config.num_labels) * 0.1).astype(np.float32),
+    }
+
+
+def mnist_reference(state_dict, images):
+    """
+    MnistForImageClassification 的 numpy 参考实现（float64）：conv(stride 1, 无 padding) -> ReLU -> flatten -> Linear -> ReLU
+    """
+    weight = state_dict["conv1.weight"].astype(np.float64)
+    kernel = weight.shape[-1]
+    windows = np.lib.stride_tricks.sliding_window_view(images.astype(np.float64), (kernel, kernel), axis=(2, 3))
+    conv = np.einsum("nchwij,ocij->nohw", windows, weight) + state_dict["conv1.bias"].astype(np.float64)[None, :, None, None]
+    hidden = np.maximum(conv, 0.0).reshape(images.shape[0], -1)
+    logits = hidden @ state_dict["fc1.weight"].astype(np.float64).T + state_dict["fc1.bias"].astype(np.float64)
+    return np.maximum(logits, 0.0)
@@ -0,0 +1,52 @@
+import time
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--num-devices", type=int, default=1, help="Number of accelerators; on CPU every replica uses the CPU")
+        parser.add_argument("--replicas", type=int, nargs="+", default=[1, 2, 4])
+        parser.add_argument("--cores-per-replica", type=int, default=0, help="Pin each CPU replica to this many cores (0: split all cores evenly)")
+        parser.add_argument("--batch-size", type=int, default=32)
+        parser.add_argument("--iters", type=int, default=10)
+
+    return parse_device_args("data-parallel ResNet inference across replicas", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=infinicore.device(device_str, 0))
+
+    pixel_values = np.random.rand(args.batch_size, 3, 224, 224).astype(np.float32)
+    input = _infinidemo.from_dlpack(pixel_values)
+    reference = infini_to_numpy(model(input.to(infinicore.device(device_str, 0))))
+
+    single, base = None, None
+    for replicas in args.replicas:
+        # 同一个设备可以重复出现：CPU 上每个副本是一个独立的线程（组）
+        devices = [infinicore.device(device_str, i % args.num_devices)._underlying for i in range(replicas)]
+        parallel = _infinidemo.runtime.DataParallel(model, devices, cores_per_replica=args.cores_per_replica)
+
+        # 切分后每个样本的计算与整 batch 相同，结果必须一致
+        max_diff = assert_close(f"replicas={replicas}", infini_to_numpy(parallel.forward(input)), reference, verbose=False)
+        parallel.forward(input)  # 预热
+        parallel.reset_stats()
+        for _ in range(args.iters):
+            parallel.forward(input)
+        stats = parallel.stats()
+
+        throughput = stats["samples_per_s"]
+        if single is None:
+            single, base = throughput, replicas
+        # 相对列表中第一个副本数的吞吐
+        efficiency = throughput * base / (single * replicas)
+        print(f" replicas={replicas}: {throughput:8.1f} images/s, scaling efficiency {efficiency * 100:5.1f}%, "
+              f"utilization {stats['utilization'] * 100:5.1f}%, max abs diff {max_diff:.6f}")
+    print(" OK")
@@ -0,0 +1,94 @@
+import numpy as np
+import infinicore
+from pymodels import MnistForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, mnist_reference, parse_device_args, random_mnist_state_dict
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--batch-size", type=int, default=8)
+
+    return parse_device_args("DLPack / buffer protocol interop: inputs and outputs share memory instead of copying", add_arguments)
+
+
+def check_shares(name, array, buffer):
+    # 零拷贝：numpy 数组与 tensor 指向同一块内存；任何 host 往返都会得到新的地址
+    check(array.ctypes.data == buffer.data_ptr(), f"{name}: numpy data {array.ctypes.data:#x} != tensor data {buffer.data_ptr():#x}")
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    rng = np.random.default_rng(0)
+
+    model = MnistForImageClassification()
+    config = model.config
+    weights = random_mnist_state_dict(config, rng)
+    model.load_state_dict(weights)
+    images = rng.random((args.batch_size, config.num_channels, config.image_size, config.image_size), dtype=np.float32)
+    expected = mnist_reference(weights, images)
+
+    # 导入：DLPack 与 buffer protocol 都直接引用 numpy 的内存，之后对 numpy 的修改在 tensor 中可见
+    x = images.copy()
+    for name, imported in (("from_dlpack(ndarray)", _infinidemo.from_dlpack(x)), ("from_dlpack(memoryview)", _infinidemo.from_dlpack(memoryview(x)))):
+        buffer = _infinidemo.TensorBuffer(imported)
+        check_shares(name, x, buffer)
+        x[0, 0, 0, 0] = 42.0
+        check(np.asarray(buffer)[0, 0, 0, 0] == 42.0, f"{name}: write through numpy not visible in the imported tensor")
+        x[0, 0, 0, 0] = images[0, 0, 0, 0]
+
+    # 非连续的输入按 strides 导入，同样不拷贝
+    strided = images[:, :, ::2, ::2]
+    buffer = _infinidemo.TensorBuffer(_infinidemo.from_dlpack(strided))
+    check(buffer.data_ptr() == strided.ctypes.data, "strided import copied the input")
+    assert_close("strided import", np.asarray(buffer), strided, atol=0.0, rtol=0.0, verbose=False)
+
+    # 无符号整数：buffer protocol 的 H / I / L / Q 与 DLPack 的 kDLUInt 都映射为 U16 / U32 / U64，同样不拷贝
+    for dtype in (np.uint16, np.uint32, np.uint64):
+        values = rng.integers(0, np.iinfo(dtype).max, size=(3, 5), dtype=dtype, endpoint=True)
+        for name, imported in (("from_dlpack(ndarray)", _infinidemo.from_dlpack(values)), ("from_dlpack(memoryview)", _infinidemo.from_dlpack(memoryview(values)))):
+            name = f"{name} {np.dtype(dtype).name}"
+            buffer = _infinidemo.TensorBuffer(imported)
+            check_shares(name, values, buffer)
+            exported = np.asarray(buffer)
+            check(exported.dtype == values.dtype, f"{name}: exported dtype {exported.dtype}")
+            check(np.array_equal(exported, values), f"{name}: values changed")
+
+    # 没有对应 dtype 的格式抛出 TypeError，并指出格式
+    unsupported = memoryview(np.zeros(4, dtype=np.complex64))
+    try:
+        _infinidemo.from_dlpack(unsupported)
+    except TypeError as error:
+        check(unsupported.format in str(error), f"TypeError does not name the format {unsupported.format!r}: {error}")
+    else:
+        raise AssertionError(f"buffer format {unsupported.format!r} was accepted")
+
+    if device_str != "cpu":
+        # 设备上的输出只做一次 D2H 拷贝
+        model.to(device=device)
+        _infinidemo.debug.reset_cross_device_copies()
+        logits = infini_to_numpy(model(_infinidemo.from_dlpack(images).to(device)))
+        check(_infinidemo.debug.cross_device_copies() == 1, f"{_infinidemo.debug.cross_device_copies()} copies for one device output")
+        assert_close("logits", logits, expected)
+        print(" OK")
+        raise SystemExit(0)
+
+    # 导出：forward 直接接收 numpy，输出经 buffer protocol / DLPack / infini_to_numpy 都是同一块内存
+    _infinidemo.debug.reset_cross_device_copies()
+    output = model(images)
+    buffer = _infinidemo.TensorBuffer(output)
+    check_shares("np.asarray(TensorBuffer)", np.asarray(buffer), buffer)
+    check_shares("np.from_dlpack(TensorBuffer)", np.from_dlpack(buffer), buffer)
+    check_shares("infini_to_numpy", infini_to_numpy(output), buffer)
+    check(_infinidemo.debug.cross_device_copies() == 0, f"{_infinidemo.debug.cross_device_copies()} tracked copies on the CPU path")
+
+    logits = infini_to_numpy(output)
+    assert_close("logits", logits, expected)
+    assert_close("numpy input vs. from_dlpack input", infini_to_numpy(model(_infinidemo.from_dlpack(images))), logits, atol=0.0, rtol=0.0)
+
+    # 导出的数组与 tensor 共享内存：通过一个视图写入，另一个视图可见
+    np.asarray(buffer)[0, 0] = -1.0
+    check(infini_to_numpy(output)[0, 0] == -1.0, "exported arrays do not share the output memory")
+    print(" OK")
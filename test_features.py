@@ -0,0 +1,70 @@
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--batch-size", type=int, default=2)
+        parser.add_argument("--image-size", type=int, default=224)
+
+    return parse_device_args("ResNet features(): embedding values, L2 normalization and release_classifier", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+
+    rng = np.random.default_rng(0)
+    images = rng.random((args.batch_size, 3, args.image_size, args.image_size), dtype=np.float32)
+    x = _infinidemo.from_dlpack(images).to(device)
+
+    # 最后一个 stage 的 embedding 经 classifier 得到的 logits 与 forward 一致
+    logits = infini_to_numpy(model(x))
+    embedding = infini_to_numpy(model.features(x))
+    check(embedding.shape == (args.batch_size, model.feature_size()), f"features shape {embedding.shape}")
+    state_dict = {key: infini_to_numpy(value) for key, value in model.state_dict().items()}
+    classifier_bytes = state_dict["classifier.1.weight"].nbytes + state_dict["classifier.1.bias"].nbytes
+    weight = state_dict["classifier.1.weight"].astype(np.float64)
+    bias = state_dict["classifier.1.bias"].astype(np.float64)
+    assert_close("features @ classifier vs. forward", embedding.astype(np.float64) @ weight.T + bias, logits, atol=1e-3, rtol=1e-3)
+
+    # normalize=True（CPU 上融合在池化中，其它设备由 RMSNorm 在设备上完成）与 numpy 的按行 L2 归一化一致
+    normalized = infini_to_numpy(model.features(x, normalize=True))
+    expected = embedding / np.maximum(np.linalg.norm(embedding, axis=1, keepdims=True), 1e-12)
+    assert_close("features(normalize=True)", normalized, expected)
+    assert_close("row norms", np.linalg.norm(normalized, axis=1), np.ones(args.batch_size))
+
+    # 中间 stage 的 embedding 等于该 stage 特征图的空间均值（tile 覆盖整张图时不切分）
+    stage = 0
+    while True:
+        try:
+            size = model.feature_size(stage)
+        except RuntimeError:
+            break
+        features = infini_to_numpy(model.features(x, stage=stage))
+        feature_map = infini_to_numpy(model.feature_map_tiled(x, tile_size=args.image_size, stage=stage))
+        check(features.shape == (args.batch_size, size), f"stage {stage}: features shape {features.shape}")
+        assert_close(f"stage {stage} features vs. mean of the feature map", features, feature_map.mean(axis=(2, 3)))
+        stage += 1
+    check(stage > 1, f"only {stage} stages were checked")
+
+    # 释放 classifier 后 features 不变，forward / predict 抛出异常
+    freed = model.release_classifier()
+    check(freed == classifier_bytes, f"release_classifier freed {freed} bytes, the classifier has {classifier_bytes}")
+    check(not model.has_classifier, "has_classifier is still True after release_classifier")
+    check("classifier.1.weight" not in model.state_dict(), "classifier weight still in state_dict")
+    assert_close("features after release_classifier", infini_to_numpy(model.features(x)), embedding, atol=0.0, rtol=0.0)
+    for name, call in (("forward", lambda: model(x)), ("predict", lambda: model.predict(x))):
+        try:
+            call()
+        except RuntimeError:
+            continue
+        raise AssertionError(f"{name} did not raise after release_classifier")
+    print(" OK")
@@ -1,22 +1,56 @@
+#include "nn/functional/gemm_op.hpp"
+#include "nn/functional/gemm_tuning.hpp"
 #include <CLI/CLI.hpp>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <infinicore/context/context.hpp>
 #include <infinicore/tensor.hpp>
 #include <infiniop.h>
 #include <infinirt.h>
+#include <iomanip>
 #include <iostream>
+#include <random>
+#include <sstream>
 #include <stdexcept>
+#include <string>
 #include <tuple>
 #include <vector>
 
 using namespace infinicore;
+namespace functional = infinidemo::nn::functional;
+
+// GEMM 驱动：在 M/N/K、转置、leading dimension、alpha/beta、dtype 上做扫描，
+// 用 host 端双精度参考结果校验 performGemm，并报告 GFLOP/s。
+// --autotune 模式对每个形状尝试所有 GemmAlgo，把最快的写入调优缓存文件，
+// 运行时设置 INFINIDEMO_GEMM_TUNING_CACHE 指向该文件即可让 performGemm 使用调优结果。
+
+struct DriverOptions {
+    Device device = Device::cpu();
+    std::vector<size_t> m;
+    std::vector<size_t> n;
+    std::vector<size_t> k;
+    std::vector<std::string> trans = {"nn", "nt"};
+    std::vector<size_t> pad = {0};
+    std::vector<float> alpha = {1.0f};
+    std::vector<float> beta = {0.0f};
+    std::vector<std::string> dtype = {"f32"};
+    size_t warmup = 3;
+    size_t iters = 10;
+    bool verify = true;
+    bool autotune = false;
+    std::string cache;
+};
 
 // Parses command line arguments and selects the device.
 // CPU, NVIDIA, MOORE, METAX, ILUVATAR, HYGON, ASCEND, CAMBRICON
-Device selectDevice(int argc, char *argv[]) {
-    CLI::App app{"InfiniOP GEMM Test - Test GEMM operation using InfiniOP API"};
+DriverOptions parseOptions(int argc, char *argv[]) {
+    CLI::App app{"InfiniOP GEMM driver - sweep, verify and autotune GEMM using InfiniOP API"};
 
-    Device device = Device::cpu();
+    DriverOptions options;
 
     // Platform configuration: (flag_name, device_type, help_message)
     using PlatformConfig = std::tuple<const char *, Device::Type, const char *>;
@@ -38,10 +72,24 @@ Device selectDevice(int argc, char *argv[]) {
 
         app.add_flag(
             flag_name,
-            [&device, device_type](bool) { device = Device(device_type); },
+            [&options, device_type](bool) { options.device = Device(device_type); },
             help_message);
     }
 
+    app.add_option("-m", options.m, "Rows of A / C (default: classifier and MLP preset)");
+    app.add_option("-n", options.n, "Columns of B / C");
+    app.add_option("-k", options.k, "Columns of A / rows of B");
+    app.add_option("--trans", options.trans, "Transpose combinations of A and B: nn, nt, tn, tt");
+    app.add_option("--pad", options.pad, "Extra elements added to the leading dimension of every operand");
+    app.add_option("--alpha", options.alpha, "alpha values");
+    app.add_option("--beta", options.beta, "beta values");
+    app.add_option("--dtype", options.dtype, "Data types: f32, f16, bf16");
+    app.add_option("--warmup", options.warmup, "Warmup iterations per case");
+    app.add_option("--iters", options.iters, "Timed iterations per case");
+    app.add_flag("!--no-verify", options.verify, "Skip the host reference check");
+    app.add_flag("--autotune", options.autotune, "Try every GemmAlgo per shape and write the fastest to the tuning cache");
+    app.add_option("--cache", options.cache, "Tuning cache file (default: $INFINIDEMO_GEMM_TUNING_CACHE or gemm_tuning.cache)");
+
     try {
         app.parse(argc, argv);
     } catch (const CLI::ParseError &e) {
@@ -49,150 +97,465 @@ Device selectDevice(int argc, char *argv[]) {
         throw std::runtime_error("Failed to parse command line arguments");
     }
 
-    size_t device_count = context::getDeviceCount(device.getType());
+    size_t device_count = context::getDeviceCount(options.device.getType());
     if (device_count == 0) {
-        throw std::runtime_error("No " + device.toString() + " device available");
+        throw std::runtime_error("No " + options.device.toString() + " device available");
     }
 
-    return device;
+    return options;
 }
 
-// Performs GEMM operation: C = alpha * A * B + beta * C
-infiniStatus_t performGemm(const Tensor &tensor_A, const Tensor &tensor_B,
-                           Tensor &tensor_C, float alpha, float beta,
-                           Device device) {
-    // Create InfiniOP handle
-    infiniopHandle_t handle = context::getInfiniopHandle(device);
+// ------------------------------------------------------------------
+// dtype 转换（host 端）
+// ------------------------------------------------------------------
 
-    // Create GEMM descriptor
-    infiniopGemmDescriptor_t gemm_desc = nullptr;
-    infiniStatus_t status = infiniopCreateGemmDescriptor(
-        handle, &gemm_desc, tensor_C->desc(), tensor_A->desc(), tensor_B->desc());
-    if (status != INFINI_STATUS_SUCCESS) {
-        std::cerr << "Failed to create GEMM descriptor: " << status << std::endl;
-        return status;
+DataType parseDataType(const std::string &name) {
+    if (name == "f32") {
+        return DataType::F32;
     }
+    if (name == "f16") {
+        return DataType::F16;
+    }
+    if (name == "bf16") {
+        return DataType::BF16;
+    }
+    throw std::runtime_error("Unsupported dtype: " + name);
+}
 
-    // Get workspace
-    size_t workspace_size = 0;
-    status = infiniopGetGemmWorkspaceSize(gemm_desc, &workspace_size);
-    if (status != INFINI_STATUS_SUCCESS) {
-        std::cerr << "Failed to get workspace size: " << status << std::endl;
-        infiniopDestroyGemmDescriptor(gemm_desc);
-        return status;
+const char *dataTypeName(DataType dtype) {
+    switch (dtype) {
+    case DataType::F16:
+        return "f16";
+    case DataType::BF16:
+        return "bf16";
+    default:
+        return "f32";
     }
+}
 
-    void *workspace = nullptr;
-    std::shared_ptr<Memory> workspace_memory = nullptr;
-    if (workspace_size > 0) {
-        workspace_memory = context::allocateMemory(workspace_size);
-        workspace = workspace_memory->data();
+uint32_t floatBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits = floatBits(value);
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    int exponent = static_cast<int>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    if (exponent >= 31) {
+        return sign | 0x7C00;
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if ((rest > halfway) || ((rest == halfway) && (half & 1))) {
+            ++half;
+        }
+        return sign | static_cast<uint16_t>(half);
+    }
+    uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFF;
+    if ((rest > 0x1000) || ((rest == 0x1000) && (half & 1))) {
+        ++half;
     }
+    return sign | static_cast<uint16_t>(half);
+}
 
-    // Execute GEMM operator
-    status = infiniopGemm(gemm_desc, workspace, workspace_size, tensor_C->data(),
-                          tensor_A->data(), tensor_B->data(), alpha, beta,
-                          context::getStream());
+float halfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    if (exponent == 0) {
+        float value = std::ldexp(static_cast<float>(mantissa), -24);
+        return sign ? -value : value;
+    }
+    if (exponent == 31) {
+        return bitsFloat(sign | 0x7F800000 | (mantissa << 13));
+    }
+    return bitsFloat(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
 
-    if (status != INFINI_STATUS_SUCCESS) {
-        std::cerr << "Failed to execute GEMM: " << status << std::endl;
-        infiniopDestroyGemmDescriptor(gemm_desc);
-        return status;
+uint16_t floatToBfloat16(float value) {
+    uint32_t bits = floatBits(value);
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+float bfloat16ToFloat(uint16_t value) {
+    return bitsFloat(static_cast<uint32_t>(value) << 16);
+}
+
+void storeValue(std::byte *base, size_t index, DataType dtype, float value) {
+    if (dtype == DataType::F16) {
+        reinterpret_cast<uint16_t *>(base)[index] = floatToHalf(value);
+    } else if (dtype == DataType::BF16) {
+        reinterpret_cast<uint16_t *>(base)[index] = floatToBfloat16(value);
+    } else {
+        reinterpret_cast<float *>(base)[index] = value;
+    }
+}
+
+float loadValue(const std::byte *base, size_t index, DataType dtype) {
+    if (dtype == DataType::F16) {
+        return halfToFloat(reinterpret_cast<const uint16_t *>(base)[index]);
+    }
+    if (dtype == DataType::BF16) {
+        return bfloat16ToFloat(reinterpret_cast<const uint16_t *>(base)[index]);
+    }
+    return reinterpret_cast<const float *>(base)[index];
+}
+
+// 把 value 舍入到 dtype 可表示的值，参考结果使用与设备相同的输入
+float roundTo(DataType dtype, float value) {
+    if (dtype == DataType::F16) {
+        return halfToFloat(floatToHalf(value));
+    }
+    if (dtype == DataType::BF16) {
+        return bfloat16ToFloat(floatToBfloat16(value));
+    }
+    return value;
+}
+
+double tolerance(DataType dtype) {
+    switch (dtype) {
+    case DataType::F16:
+        return 1e-2;
+    case DataType::BF16:
+        return 4e-2;
+    default:
+        return 1e-4;
+    }
+}
+
+// ------------------------------------------------------------------
+// 测试用例
+// ------------------------------------------------------------------
+
+struct GemmCase {
+    size_t m;
+    size_t n;
+    size_t k;
+    bool trans_a;
+    bool trans_b;
+    size_t pad;
+    float alpha;
+    float beta;
+    DataType dtype;
+
+    std::string describe() const {
+        std::ostringstream os;
+        os << dataTypeName(dtype) << " M=" << m << " N=" << n << " K=" << k << " "
+           << (trans_a ? "t" : "n") << (trans_b ? "t" : "n") << " pad=" << pad
+           << " a=" << alpha << " b=" << beta;
+        return os.str();
+    }
+
+    double flops() const {
+        return 2.0 * static_cast<double>(m) * static_cast<double>(n) * static_cast<double>(k);
+    }
+};
+
+// 分类头与 MLP 的瘦长形状：(K, N)，M 为 batch
+const std::vector<std::pair<size_t, size_t>> &presetShapes() {
+    static const std::vector<std::pair<size_t, size_t>> shapes = {
+        {1936, 10},   // mnist.fc1
+        {512, 1000},  // resnet18 classifier
+        {2048, 1000}, // resnet50 classifier
+        {1024, 4096}, // mlp up
+        {4096, 1024}, // mlp down
+    };
+    return shapes;
+}
+
+std::vector<GemmCase> buildCases(const DriverOptions &options) {
+    std::vector<std::tuple<size_t, size_t, size_t>> mnk;
+    if (options.m.empty() && options.n.empty() && options.k.empty()) {
+        for (size_t m : {1, 8, 32, 128}) {
+            for (const auto &[k, n] : presetShapes()) {
+                mnk.emplace_back(m, n, k);
+            }
+        }
+    } else {
+        auto or_default = [](const std::vector<size_t> &v) { return v.empty() ? std::vector<size_t>{64} : v; };
+        for (size_t m : or_default(options.m)) {
+            for (size_t n : or_default(options.n)) {
+                for (size_t k : or_default(options.k)) {
+                    mnk.emplace_back(m, n, k);
+                }
+            }
+        }
+    }
+
+    std::vector<GemmCase> cases;
+    for (const auto &dtype_name : options.dtype) {
+        DataType dtype = parseDataType(dtype_name);
+        for (const auto &[m, n, k] : mnk) {
+            for (const auto &trans : options.trans) {
+                if ((trans.size() != 2) || (trans.find_first_not_of("nt") != std::string::npos)) {
+                    throw std::runtime_error("Invalid --trans value: " + trans);
+                }
+                for (size_t pad : options.pad) {
+                    for (float alpha : options.alpha) {
+                        for (float beta : options.beta) {
+                            cases.push_back({m, n, k, trans[0] == 't', trans[1] == 't', pad, alpha, beta, dtype});
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return cases;
+}
+
+// 逻辑形状为 rows x cols 的矩阵，底层存储带 pad 个元素的 leading dimension，
+// trans 时按列主序存储（即 [cols, rows] 存储的转置视图），与 Linear 中 weight->permute 的布局一致
+struct Matrix {
+    Tensor storage;
+    Tensor view;
+    std::vector<float> values; // 逻辑行主序、已舍入到 dtype 的数值
+};
+
+Matrix makeMatrix(size_t rows, size_t cols, bool trans, size_t pad, DataType dtype, const Device &device, unsigned seed) {
+    Matrix matrix;
+    size_t outer = trans ? cols : rows;
+    size_t inner = trans ? rows : cols;
+    size_t ld = inner + pad;
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    matrix.values.resize(rows * cols);
+    for (auto &v : matrix.values) {
+        v = roundTo(dtype, dist(gen));
+    }
+
+    Tensor host = Tensor::zeros({outer, ld}, dtype, Device::cpu());
+    std::byte *data = host->data();
+    for (size_t r = 0; r < rows; ++r) {
+        for (size_t c = 0; c < cols; ++c) {
+            size_t index = trans ? (c * ld + r) : (r * ld + c);
+            storeValue(data, index, dtype, matrix.values[r * cols + c]);
+        }
+    }
+    matrix.storage = device.getType() == Device::Type::CPU ? host : host->to(device);
+    matrix.view = matrix.storage->narrow({{1, 0, inner}});
+    if (trans) {
+        matrix.view = matrix.view->permute({1, 0});
+    }
+    return matrix;
+}
+
+struct Operands {
+    Matrix a;
+    Matrix b;
+    Matrix c;
+    Tensor c_init; // beta != 0 时用于在每次校验前恢复 C
+};
+
+Operands makeOperands(const GemmCase &gc, const Device &device) {
+    Operands ops;
+    ops.a = makeMatrix(gc.m, gc.k, gc.trans_a, gc.pad, gc.dtype, device, 1);
+    ops.b = makeMatrix(gc.k, gc.n, gc.trans_b, gc.pad, gc.dtype, device, 2);
+    ops.c = makeMatrix(gc.m, gc.n, false, gc.pad, gc.dtype, device, 3);
+    ops.c_init = ops.c.view->contiguous();
+    return ops;
+}
+
+// 返回 max|C - ref| / max(1, max|ref|)
+double verify(const GemmCase &gc, const Operands &ops) {
+    Tensor result = ops.c.view->contiguous();
+    if (result->device().getType() != Device::Type::CPU) {
+        result = result->to(Device::cpu());
+    }
+    const std::byte *data = result->data();
+
+    double max_err = 0.0;
+    double max_ref = 1.0;
+    for (size_t i = 0; i < gc.m; ++i) {
+        for (size_t j = 0; j < gc.n; ++j) {
+            double acc = 0.0;
+            for (size_t p = 0; p < gc.k; ++p) {
+                acc += static_cast<double>(ops.a.values[i * gc.k + p]) * static_cast<double>(ops.b.values[p * gc.n + j]);
+            }
+            double ref = gc.alpha * acc + gc.beta * static_cast<double>(ops.c.values[i * gc.n + j]);
+            double got = loadValue(data, i * gc.n + j, gc.dtype);
+            max_err = std::max(max_err, std::fabs(got - ref));
+            max_ref = std::max(max_ref, std::fabs(ref));
+        }
+    }
+    return max_err / max_ref;
+}
+
+struct Measurement {
+    infiniStatus_t status = INFINI_STATUS_SUCCESS;
+    double error = 0.0;
+    double ms = 0.0;
+    double gflops = 0.0;
+};
+
+// algo_override < 0 时走 performGemm（使用调优缓存），否则强制指定执行方式
+Measurement measure(const GemmCase &gc, Operands &ops, int algo_override, const DriverOptions &options) {
+    auto run = [&]() {
+        if (algo_override < 0) {
+            return functional::performGemm(ops.c.view, ops.a.view, ops.b.view, gc.alpha, gc.beta, options.device);
+        }
+        return functional::performGemmWithAlgo(ops.c.view, ops.a.view, ops.b.view, gc.alpha, gc.beta,
+                                               static_cast<functional::GemmAlgo>(algo_override), options.device);
+    };
+
+    Measurement result;
+    ops.c.view->copy_from(ops.c_init);
+    result.status = run();
+    if (result.status != INFINI_STATUS_SUCCESS) {
+        return result;
+    }
+    context::syncDevice();
+    if (options.verify) {
+        result.error = verify(gc, ops);
     }
 
-    // Synchronize device
+    for (size_t i = 0; i < options.warmup; ++i) {
+        run();
+    }
+    context::syncDevice();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < options.iters; ++i) {
+        run();
+    }
     context::syncDevice();
+    auto end = std::chrono::steady_clock::now();
+    result.ms = std::chrono::duration<double, std::milli>(end - start).count() / static_cast<double>(std::max<size_t>(options.iters, 1));
+    result.gflops = result.ms > 0.0 ? gc.flops() / (result.ms * 1e6) : 0.0;
+    return result;
+}
+
+std::string cachePath(const DriverOptions &options) {
+    if (!options.cache.empty()) {
+        return options.cache;
+    }
+    const char *env = std::getenv("INFINIDEMO_GEMM_TUNING_CACHE");
+    return ((env != nullptr) && (env[0] != '\0')) ? env : "gemm_tuning.cache";
+}
+
+// 扫描模式：按 performGemm 的实际路径（含调优缓存）校验并计时
+int runSweep(const std::vector<GemmCase> &cases, const DriverOptions &options) {
+    functional::GemmTuningCache &cache = functional::GemmTuningCache::instance();
+    if (!options.cache.empty() && !cache.load(options.cache)) {
+        std::cerr << "Tuning cache not found: " << options.cache << std::endl;
+    }
+
+    std::cout << std::left << std::setw(52) << "case" << std::setw(14) << "algo" << std::right
+              << std::setw(12) << "time(ms)" << std::setw(12) << "GFLOP/s" << std::setw(12) << "rel_err" << "  result" << std::endl;
+    int failures = 0;
+    for (const auto &gc : cases) {
+        Operands ops = makeOperands(gc, options.device);
+        functional::GemmAlgo algo = cache.lookup(ops.c.view, ops.a.view, ops.b.view, options.device);
+        Measurement m = measure(gc, ops, -1, options);
+        bool ok = (m.status == INFINI_STATUS_SUCCESS) && (!options.verify || (m.error <= tolerance(gc.dtype)));
+        failures += ok ? 0 : 1;
+        std::cout << std::left << std::setw(52) << gc.describe() << std::setw(14) << functional::toString(algo)
+                  << std::right << std::fixed << std::setprecision(4) << std::setw(12) << m.ms
+                  << std::setprecision(2) << std::setw(12) << m.gflops
+                  << std::scientific << std::setprecision(2) << std::setw(12) << m.error << std::defaultfloat
+                  << "  " << (ok ? "PASS" : "FAIL") << std::endl;
+    }
+    std::cout << "\n"
+              << cases.size() - failures << " / " << cases.size() << " cases passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
 
-    // Clean up resources
-    infiniopDestroyGemmDescriptor(gemm_desc);
+// 调优模式：每个 (dtype, M, N, K, 布局) 只调一次，选出校验通过且最快的执行方式
+int runAutotune(const std::vector<GemmCase> &cases, const DriverOptions &options) {
+    const functional::GemmAlgo algos[] = {functional::GemmAlgo::Default, functional::GemmAlgo::Transposed, functional::GemmAlgo::ContiguousB};
+    functional::GemmTuningCache &cache = functional::GemmTuningCache::instance();
+    std::string path = cachePath(options);
+    cache.load(path); // 在已有记录上增量更新
+
+    std::vector<functional::GemmTuningKey> tuned;
+    std::cout << std::left << std::setw(52) << "case" << std::setw(14) << "best" << std::right
+              << std::setw(14) << "default GF/s" << std::setw(12) << "best GF/s" << std::setw(10) << "speedup" << std::endl;
+    for (const auto &gc : cases) {
+        Operands ops = makeOperands(gc, options.device);
+        functional::GemmTuningKey key = functional::GemmTuningCache::makeKey(ops.c.view, ops.a.view, ops.b.view, options.device);
+        bool seen = std::any_of(tuned.begin(), tuned.end(), [&key](const functional::GemmTuningKey &k) { return !(k < key) && !(key < k); });
+        if (seen) {
+            continue;
+        }
+        tuned.push_back(key);
+
+        double default_gflops = 0.0;
+        functional::GemmTuningEntry best;
+        for (auto algo : algos) {
+            Measurement m = measure(gc, ops, static_cast<int>(algo), options);
+            bool ok = (m.status == INFINI_STATUS_SUCCESS) && (!options.verify || (m.error <= tolerance(gc.dtype)));
+            if (!ok) {
+                std::cerr << "  " << gc.describe() << ": " << functional::toString(algo) << " rejected" << std::endl;
+                continue;
+            }
+            if (algo == functional::GemmAlgo::Default) {
+                default_gflops = m.gflops;
+            }
+            if (m.gflops > best.gflops) {
+                best.algo = algo;
+                best.gflops = m.gflops;
+            }
+        }
+        if (best.gflops <= 0.0) {
+            continue;
+        }
+        cache.set(key, best);
+        std::cout << std::left << std::setw(52) << gc.describe() << std::setw(14) << functional::toString(best.algo)
+                  << std::right << std::fixed << std::setprecision(2) << std::setw(14) << default_gflops
+                  << std::setw(12) << best.gflops << std::setw(9)
+                  << (default_gflops > 0.0 ? best.gflops / default_gflops : 0.0) << "x" << std::defaultfloat << std::endl;
+    }
 
-    return INFINI_STATUS_SUCCESS;
+    cache.save(path);
+    std::cout << "\nSaved " << cache.size() << " tuning records to " << path << std::endl;
+    std::cout << "Use them at runtime with: export INFINIDEMO_GEMM_TUNING_CACHE=" << path << std::endl;
+    return 0;
 }
 
-void test_gemm(int argc, char *argv[]) {
+int test_gemm(int argc, char *argv[]) {
 
     // Select device
-    Device device = selectDevice(argc, argv);
-    context::setDevice(device);
+    DriverOptions options = parseOptions(argc, argv);
+    context::setDevice(options.device);
 
-    std::cout << "current device: " << device.toString() << std::endl;
+    std::cout << "current device: " << options.device.toString() << std::endl;
 
     // Infini runtime
     infiniStatus_t status = infinirtInit();
     if (status != INFINI_STATUS_SUCCESS) {
         std::cerr << "Failed to initialize InfiniRT: " << status << std::endl;
-        return;
+        return 1;
     }
 
-    // Define matrix dimensions:
-    // A: M x K,
-    // B: K x N, C: M x N
-    // C = alpha * A * B + beta * C
-    const size_t M = 2;
-    const size_t K = 3;
-    const size_t N = 4;
-    const float alpha = 1.0f;
-    const float beta = 0.0f;
+    std::vector<GemmCase> cases = buildCases(options);
 
     std::cout << "==========================================" << std::endl;
-    std::cout << "InfiniOP GEMM Test (using Tensor class)" << std::endl;
+    std::cout << "InfiniOP GEMM " << (options.autotune ? "Autotune" : "Sweep") << ": C = alpha * A * B + beta * C" << std::endl;
     std::cout << "==========================================" << std::endl;
-    std::cout << "Device: " << device.toString() << std::endl;
-    std::cout << "Matrix A: " << M << " x " << K << std::endl;
-    std::cout << "Matrix B: " << K << " x " << N << std::endl;
-    std::cout << "Matrix C: " << M << " x " << N << std::endl;
-    std::cout << "alpha: " << alpha << ", beta: " << beta << std::endl;
-
-    // Initialize input data (host memory)
-    std::vector<float> h_A(M * K);
-    std::vector<float> h_B(K * N);
-    for (size_t i = 0; i < M * K; i++) {
-        h_A[i] = static_cast<float>(i / 10.0f);
-    }
-    for (size_t i = 0; i < K * N; i++) {
-        h_B[i] = static_cast<float>(i / 10.0f);
-    }
-
-    // Create Tensor objects
-    // First create temporary tensors on CPU referencing host data
-    Device cpu_device = Device::cpu();
-    Tensor temp_A = Tensor::from_blob(h_A.data(), {M, K}, DataType::F32, cpu_device);
-    Tensor temp_B = Tensor::from_blob(h_B.data(), {K, N}, DataType::F32, cpu_device);
-
-    // Create tensors on target device and copy data
-    Tensor tensor_A = Tensor::empty({M, K}, DataType::F32, device);
-    Tensor tensor_B = Tensor::empty({K, N}, DataType::F32, device);
-    Tensor tensor_C = Tensor::zeros({M, N}, DataType::F32, device);
-
-    tensor_A->copy_from(temp_A);
-    tensor_B->copy_from(temp_B);
-
-    // Execute GEMM operation
-    std::cout << "\nExecuting GEMM..." << std::endl;
-    status = performGemm(tensor_A, tensor_B, tensor_C, alpha, beta, device);
-    if (status != INFINI_STATUS_SUCCESS) {
-        std::cerr << "GEMM operation failed: " << status << std::endl;
-        return;
-    }
-    std::cout << "\nExecuting GEMM over !\n"
-              << std::endl;
+    std::cout << "Device: " << options.device.toString() << ", cases: " << cases.size()
+              << ", warmup: " << options.warmup << ", iters: " << options.iters << std::endl;
 
-    // Print input data
-    std::cout << "Input Matrix A :" << std::endl;
-    std::cout << tensor_A << std::endl;
-
-    std::cout << "Input Matrix B :" << std::endl;
-    std::cout << tensor_B << std::endl;
-
-    std::cout << "Output Matrix C :" << std::endl;
-    std::cout << tensor_C << std::endl;
-
-    std::cout << "\nTest completed successfully!" << std::endl;
+    return options.autotune ? runAutotune(cases, options) : runSweep(cases, options);
 }
 
 int main(int argc, char *argv[]) {
 
-    test_gemm(argc, argv);
-
-    return 0;
+    return test_gemm(argc, argv);
 }
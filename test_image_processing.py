@@ -0,0 +1,38 @@
+import numpy as np
+import infinicore
+from transformers import ConvNextImageProcessor
+from pymodels.image_processing import ImageProcessor
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--shortest-edge", type=int, default=224)
+        parser.add_argument("--crop-pct", type=float, default=0.875)
+
+    return parse_device_args("native image preprocessing vs. transformers ConvNextImageProcessor", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    processor_config = _infinidemo.image.ImageProcessorConfig()
+    processor_config.shortest_edge = args.shortest_edge
+    processor_config.crop_pct = args.crop_pct
+    processor = ImageProcessor(processor_config)
+    reference = ConvNextImageProcessor(size={"shortest_edge": args.shortest_edge}, crop_pct=args.crop_pct, resample=3,
+                                       image_mean=list(processor_config.image_mean), image_std=list(processor_config.image_std))
+
+    # 短边已经是 shortest_edge / crop_pct 时缩放是恒等变换，输出只取决于中心裁剪的偏移；
+    # 长边与裁剪尺寸之差为奇数时，(orig - crop) // 2 与四舍五入相差一个像素
+    short_side = int(args.shortest_edge / args.crop_pct)
+    rng = np.random.default_rng(0)
+    sizes = [(short_side, 455), (455, short_side), (short_side, 301), (short_side, 513), (short_side, short_side + 3)]
+    for height, width in sizes:
+        image = rng.integers(0, 256, (height, width, 3), dtype=np.uint8)
+        expected = reference(images=image, return_tensors="np")["pixel_values"]
+        actual = infini_to_numpy(processor([image], device=device))
+        assert_close(f"{height}x{width}", actual, expected, atol=1e-5, rtol=1e-5)
+    print(" OK")
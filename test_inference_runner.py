@@ -0,0 +1,43 @@
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--batch-size", type=int, default=2)
+        parser.add_argument("--requests", type=int, default=6)
+
+    return parse_device_args("InferenceRunner forward / forward_many vs. plain forward", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+
+    rng = np.random.default_rng(0)
+    images = [rng.random((args.batch_size, 3, 224, 224), dtype=np.float32) for _ in range(args.requests)]
+    reference = [infini_to_numpy(model(_infinidemo.from_dlpack(x).to(device))) for x in images]
+
+    # 请求数多于 slot 数，每个 slot 都被复用；depth=1 时上传与计算共用同一个 slot
+    for depth in (1, 2, 3):
+        runner = _infinidemo.runtime.InferenceRunner(model, device._underlying, depth=depth)
+        outputs = runner.forward_many([_infinidemo.from_dlpack(x) for x in images])
+        check(len(outputs) == len(images), f"depth={depth}: {len(outputs)} outputs for {len(images)} requests")
+        for i, (y, ref) in enumerate(zip(outputs, reference)):
+            assert_close(f"depth={depth} forward_many request {i}", infini_to_numpy(y), ref, verbose=False)
+        for i, (x, ref) in enumerate(zip(images, reference)):
+            assert_close(f"depth={depth} forward request {i}", infini_to_numpy(runner.forward(_infinidemo.from_dlpack(x))), ref, verbose=False)
+        stats = runner.stats()
+        check(stats["requests"] == 2 * len(images), f"depth={depth}: stats counted {stats['requests']} requests")
+        if (device_str != "cpu") and (depth >= 2):
+            # 请求 i + 1 的上传先于请求 i 的计算提交，设备 event 显示它在请求 i 的计算结束之前就已完成
+            check(stats["overlapped_uploads"] > 0, f"depth={depth}: no upload overlapped the previous request's compute")
+        print(f" depth={depth}: {stats['requests']} requests, {stats['overlapped_uploads']} overlapped uploads, {stats['wall_ms']:.1f} ms")
+    print(" OK")
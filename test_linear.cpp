@@ -0,0 +1,280 @@
+#include "nn/functional/batched_gemm_op.hpp"
+#include "nn/modules/linear.hpp"
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <infinicore/context/context.hpp>
+#include <infinicore/tensor.hpp>
+#include <infinirt.h>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using namespace infinicore;
+namespace functional = infinidemo::nn::functional;
+namespace modules = infinidemo::nn::modules;
+
+// performBatchedGemm 与 Linear 三维及以上输入路径的数值校验：与 host 端双精度 matmul 比较。
+// 覆盖二维 / batch 为 1 的操作数沿 batch 广播（batch stride 为 0）、转置的权重视图、beta = 1 时累加广播的 bias、
+// 非连续的三维输入以及四维输入合并到 batch 维。
+
+// ------------------------------------------------------------------
+// host 数据与参考实现
+// ------------------------------------------------------------------
+
+std::vector<float> randomValues(size_t count, unsigned seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> values(count);
+    for (auto &v : values) {
+        v = dist(gen);
+    }
+    return values;
+}
+
+Tensor upload(const std::vector<float> &values, const Shape &shape, const Device &device) {
+    Tensor host = Tensor::empty(shape, DataType::F32, Device::cpu());
+    std::copy(values.begin(), values.end(), reinterpret_cast<float *>(host->data()));
+    return device.getType() == Device::Type::CPU ? host : host->to(device);
+}
+
+std::vector<float> download(const Tensor &tensor) {
+    Tensor host = tensor->device().getType() == Device::Type::CPU ? tensor : tensor->to(Device::cpu());
+    if (!host->is_contiguous()) {
+        host = host->contiguous();
+    }
+    const float *data = reinterpret_cast<const float *>(host->data());
+    return std::vector<float>(data, data + host->numel());
+}
+
+// 逻辑上的 [batch, rows, cols] 矩阵，at(b, i, j) 按 batch stride 读取（0 表示沿 batch 广播）
+struct HostMatrix {
+    std::vector<float> values;
+    size_t rows, cols, batch_stride;
+    bool transposed = false; // values 按 [cols, rows] 存放
+
+    double at(size_t b, size_t i, size_t j) const {
+        size_t offset = b * batch_stride;
+        return transposed ? values[offset + j * rows + i] : values[offset + i * cols + j];
+    }
+};
+
+// C[b] = alpha * A[b] * B[b] + beta * C0[b]
+std::vector<double> referenceGemm(const HostMatrix &a, const HostMatrix &b, const std::vector<double> &c0, size_t batch,
+                                  float alpha, float beta) {
+    size_t m = a.rows;
+    size_t k = a.cols;
+    size_t n = b.cols;
+    std::vector<double> c(batch * m * n);
+    for (size_t p = 0; p < batch; ++p) {
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                double sum = 0.0;
+                for (size_t q = 0; q < k; ++q) {
+                    sum += a.at(p, i, q) * b.at(p, q, j);
+                }
+                size_t index = (p * m + i) * n + j;
+                c[index] = alpha * sum + (beta != 0.0f ? beta * c0[index] : 0.0);
+            }
+        }
+    }
+    return c;
+}
+
+double maxError(const std::vector<float> &actual, const std::vector<double> &expected) {
+    if (actual.size() != expected.size()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    double error = 0.0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        error = std::max(error, std::fabs(static_cast<double>(actual[i]) - expected[i]));
+    }
+    return error;
+}
+
+// ------------------------------------------------------------------
+// 用例
+// ------------------------------------------------------------------
+
+struct TestCase {
+    std::string name;
+    std::function<double(const Device &)> run; // 返回最大绝对误差
+};
+
+enum class Operand {
+    Batched,   // [batch, rows, cols]
+    Broadcast, // 二维 [rows, cols]，batch stride 为 0
+    Single,    // [1, rows, cols]，batch 为 1 的三维矩阵
+};
+
+// A [batch?, m, k] * B [batch?, k, n]；b_transposed 时 B 是 [n, k] 的 permute 视图（Linear 的权重）；
+// with_bias 时 C 先写入沿 batch 与行广播的 bias，再以 beta = 1 累加
+double runBatchedGemm(const Device &device, size_t batch, size_t m, size_t n, size_t k, Operand a_kind, Operand b_kind,
+                      bool b_transposed, bool with_bias, float alpha) {
+    auto makeOperand = [&](Operand kind, size_t rows, size_t cols, bool transposed, unsigned seed, Tensor &tensor) {
+        size_t copies = kind == Operand::Batched ? batch : 1;
+        HostMatrix host{randomValues(copies * rows * cols, seed), rows, cols, kind == Operand::Batched ? rows * cols : 0, transposed};
+        Shape stored = transposed ? Shape{cols, rows} : Shape{rows, cols};
+        if (kind != Operand::Broadcast) {
+            stored.insert(stored.begin(), copies);
+        }
+        tensor = upload(host.values, stored, device);
+        if (transposed) {
+            tensor = kind == Operand::Broadcast ? tensor->permute({1, 0}) : tensor->permute({0, 2, 1});
+        }
+        return host;
+    };
+
+    Tensor a;
+    Tensor b;
+    HostMatrix host_a = makeOperand(a_kind, m, k, false, 1, a);
+    HostMatrix host_b = makeOperand(b_kind, k, n, b_transposed, 2, b);
+
+    Tensor c = Tensor::empty({batch, m, n}, DataType::F32, device);
+    std::vector<double> c0(batch * m * n, 0.0);
+    float beta = 0.0f;
+    if (with_bias) {
+        std::vector<float> bias = randomValues(n, 3);
+        Tensor bias_tensor = upload(bias, {n}, device);
+        c->copy_from(bias_tensor->as_strided({batch, m, n}, {0, 0, bias_tensor->strides()[0]}));
+        for (size_t i = 0; i < c0.size(); ++i) {
+            c0[i] = bias[i % n];
+        }
+        beta = 1.0f;
+    }
+
+    infiniStatus_t status = functional::performBatchedGemm(c, a, b, alpha, beta, device);
+    context::syncDevice();
+    if (status != INFINI_STATUS_SUCCESS) {
+        throw std::runtime_error("performBatchedGemm returned " + std::to_string(status));
+    }
+    return maxError(download(c), referenceGemm(host_a, host_b, c0, batch, alpha, beta));
+}
+
+// Linear 对 input_shape [..., rows, in] 的输出与 x * W^T + bias 比较；transposed_input 时输入是 [batch, in, rows] 的 permute 视图
+double runLinear(const Device &device, const Shape &input_shape, size_t out_features, bool bias, bool transposed_input) {
+    size_t in_features = input_shape.back();
+    size_t rows = input_shape[input_shape.size() - 2];
+    size_t batch = 1;
+    for (size_t d = 0; d + 2 < input_shape.size(); ++d) {
+        batch *= input_shape[d];
+    }
+
+    modules::Linear linear(in_features, out_features, bias);
+    std::vector<float> weight = randomValues(out_features * in_features, 4);
+    std::vector<float> bias_values = bias ? randomValues(out_features, 5) : std::vector<float>(out_features, 0.0f);
+    std::unordered_map<std::string, Tensor> state_dict = {{"weight", upload(weight, {out_features, in_features}, Device::cpu())}};
+    if (bias) {
+        state_dict["bias"] = upload(bias_values, {out_features}, Device::cpu());
+    }
+    linear.load_state_dict(state_dict);
+    linear.to(device);
+
+    HostMatrix host_x{randomValues(batch * rows * in_features, 6), rows, in_features, rows * in_features, transposed_input};
+    Tensor input;
+    if (transposed_input) {
+        input = upload(host_x.values, {batch, in_features, rows}, device)->permute({0, 2, 1});
+    } else {
+        input = upload(host_x.values, input_shape, device);
+    }
+    HostMatrix host_w{weight, in_features, out_features, 0, true};
+    std::vector<double> c0(batch * rows * out_features);
+    for (size_t i = 0; i < c0.size(); ++i) {
+        c0[i] = bias_values[i % out_features];
+    }
+
+    Tensor output = linear.forward(input);
+    context::syncDevice();
+    Shape expected_shape = input_shape;
+    expected_shape.back() = out_features;
+    if (output->shape() != expected_shape) {
+        throw std::runtime_error("Linear returned an output of the wrong shape");
+    }
+    return maxError(download(output), referenceGemm(host_x, host_w, c0, batch, 1.0f, 1.0f));
+}
+
+std::vector<TestCase> buildCases() {
+    using O = Operand;
+    return {
+        {"gemm A[4,5,7] * B[7,3]", [](const Device &d) { return runBatchedGemm(d, 4, 5, 3, 7, O::Batched, O::Broadcast, false, false, 1.0f); }},
+        {"gemm A[4,5,7] * W^T, W[3,7]", [](const Device &d) { return runBatchedGemm(d, 4, 5, 3, 7, O::Batched, O::Broadcast, true, false, 1.0f); }},
+        {"gemm A[3,6,8] * B[3,8,4]", [](const Device &d) { return runBatchedGemm(d, 3, 6, 4, 8, O::Batched, O::Batched, false, false, 1.0f); }},
+        {"gemm A[1,6,8] * B[3,8,4]", [](const Device &d) { return runBatchedGemm(d, 3, 6, 4, 8, O::Single, O::Batched, false, false, 1.0f); }},
+        {"gemm A[2,4,9] * W^T + bias", [](const Device &d) { return runBatchedGemm(d, 2, 4, 6, 9, O::Batched, O::Broadcast, true, true, 1.0f); }},
+        {"gemm alpha=0.5 + bias", [](const Device &d) { return runBatchedGemm(d, 3, 2, 5, 4, O::Batched, O::Broadcast, false, true, 0.5f); }},
+        {"linear [2,16,32] -> 24, bias", [](const Device &d) { return runLinear(d, {2, 16, 32}, 24, true, false); }},
+        {"linear [2,16,32] -> 24, no bias", [](const Device &d) { return runLinear(d, {2, 16, 32}, 24, false, false); }},
+        {"linear [2,3,5,12] -> 7, bias", [](const Device &d) { return runLinear(d, {2, 3, 5, 12}, 7, true, false); }},
+        {"linear [3,10,8] permuted -> 6, bias", [](const Device &d) { return runLinear(d, {3, 10, 8}, 6, true, true); }},
+        {"linear [1,1,20] -> 10, bias", [](const Device &d) { return runLinear(d, {1, 1, 20}, 10, true, false); }},
+    };
+}
+
+Device parseDevice(int argc, char *argv[]) {
+    CLI::App app{"Batched GEMM / 3D Linear check - values against a host reference matmul"};
+    Device device = Device::cpu();
+    using PlatformConfig = std::tuple<const char *, Device::Type, const char *>;
+    const std::vector<PlatformConfig> platforms = {
+        {"--cpu,-c", Device::Type::CPU, "Use CPU device (default)"},
+        {"--nvidia", Device::Type::NVIDIA, "Use NVIDIA GPU device"},
+        {"--moore", Device::Type::MOORE, "Use MOORE device"},
+        {"--metax", Device::Type::METAX, "Use METAX device"},
+        {"--iluvatar", Device::Type::ILUVATAR, "Use ILUVATAR device"},
+        {"--hygon", Device::Type::HYGON, "Use HYGON device"},
+        {"--ascend", Device::Type::ASCEND, "Use ASCEND device"},
+        {"--cambricon", Device::Type::CAMBRICON, "Use CAMBRICON device"},
+    };
+    for (const auto &[flag_name, device_type, help_message] : platforms) {
+        Device::Type type = device_type;
+        app.add_flag(flag_name, [&device, type](bool) { device = Device(type); }, help_message);
+    }
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError &e) {
+        app.exit(e);
+        throw std::runtime_error("Failed to parse command line arguments");
+    }
+    if (context::getDeviceCount(device.getType()) == 0) {
+        throw std::runtime_error("No " + device.toString() + " device available");
+    }
+    return device;
+}
+
+int main(int argc, char *argv[]) {
+    Device device = parseDevice(argc, argv);
+    context::setDevice(device);
+    infiniStatus_t status = infinirtInit();
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to initialize InfiniRT: " << status << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(40) << "case" << std::right << std::setw(12) << "max_err" << "  result" << std::endl;
+    const std::vector<TestCase> cases = buildCases();
+    int failures = 0;
+    for (const auto &tc : cases) {
+        double error = 0.0;
+        std::string message;
+        try {
+            error = tc.run(device);
+        } catch (const std::exception &e) {
+            error = std::numeric_limits<double>::infinity();
+            message = std::string(" (") + e.what() + ")";
+        }
+        bool ok = error <= 1e-4;
+        failures += ok ? 0 : 1;
+        std::cout << std::left << std::setw(40) << tc.name << std::right << std::scientific << std::setprecision(2) << std::setw(12)
+                  << error << std::defaultfloat << "  " << (ok ? "PASS" : "FAIL") << message << std::endl;
+    }
+    std::cout << "\n"
+              << cases.size() - failures << " / " << cases.size() << " cases passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
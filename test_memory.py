@@ -0,0 +1,49 @@
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--batch-sizes", type=int, nargs="+", default=[1, 8, 32])
+        parser.add_argument("--top", type=int, default=10, help="Modules to list, by peak bytes")
+
+    return parse_device_args("memory accounting of ResNet forward", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    _infinidemo.memory.enable()
+
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+    stats = model.memory_stats(reset=True)
+    for phase, item in stats["phases"].items():
+        print(f" {phase:>16}: {item['allocations']:4d} allocations, {item['allocated_bytes'] / 2**20:9.2f} MB")
+
+    def current_bytes():
+        return {name: item["current_bytes"] for name, item in model.memory_stats()["devices"].items()}
+
+    for batch_size in args.batch_sizes:
+        pixel_values = np.random.rand(batch_size, 3, 224, 224).astype(np.float32)
+        input = _infinidemo.from_dlpack(pixel_values).to(device)
+        # 第一次 forward 会留下形状缓存、workspace 等常驻分配，之后的 forward 结束后在用字节数必须回到基线
+        model(input)
+        baseline = current_bytes()
+        model.memory_stats(reset=True)
+        model(input)
+        stats = model.memory_stats(reset=True)
+        peak = max(item["peak_bytes"] for item in stats["devices"].values())
+        check(peak > max(baseline.values(), default=0), f"batch {batch_size}: peak {peak} B does not exceed the baseline {baseline}")
+        check(sum(item["allocations"] for item in stats["devices"].values()) > 0, f"batch {batch_size}: forward recorded no allocations")
+        after = current_bytes()
+        check(after == baseline, f"batch {batch_size}: current bytes {after} did not return to the baseline {baseline} after forward")
+        print(f"\n batch {batch_size}: peak {peak / 2**20:.2f} MB")
+        modules = sorted(stats["modules"].items(), key=lambda kv: kv[1]["peak_bytes"], reverse=True)
+        for name, item in modules[: args.top]:
+            print(f"   {name:<48} peak {item['peak_bytes'] / 2**20:9.2f} MB, {item['allocations']:4d} allocations")
+    print(" OK")
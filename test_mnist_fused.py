@@ -0,0 +1,80 @@
+import time
+import numpy as np
+import infinicore
+from pymodels import MnistForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, mnist_reference, parse_device_args, random_mnist_state_dict
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--batch-sizes", type=int, nargs="+", default=[1, 37, 4096])
+        parser.add_argument("--tile", type=int, default=16)
+        parser.add_argument("--threads", type=int, default=0)
+        parser.add_argument("--iters", type=int, default=20)
+
+    return parse_device_args("fused vs. per-op MNIST inference: values against the numpy reference and timings", add_arguments)
+
+
+def measure(fn, input, iters):
+    fn(input)  # 预热
+    start = time.perf_counter()
+    for _ in range(iters):
+        fn(input)
+    return (time.perf_counter() - start) / iters
+
+
+def custom_config():
+    # conv_channels 不是 4 的倍数（通道尾部），卷积输出边长 11 不是 SIMD 宽度的倍数（行尾部），多输入通道、非 10 类
+    config = _infinidemo.MnistConfig()
+    config.num_channels = 2
+    config.image_size = 13
+    config.conv_channels = 6
+    config.kernel_size = 3
+    config.num_labels = 7
+    return config
+
+
+def check_values(name, config, device, rng, args):
+    model = MnistForImageClassification(config)
+    weights = random_mnist_state_dict(model.config, rng)
+    model.load_state_dict(weights)
+    model.to(device=device)
+    fused = model.fused(tile=args.tile, threads=args.threads)
+    # batch 不是 tile 的整数倍时最后一个 tile 不满；重复调用复用同一组常驻线程
+    for batch_size in (1, args.tile + 3, 3 * args.tile + 5):
+        images = rng.random((batch_size, config.num_channels, config.image_size, config.image_size), dtype=np.float32)
+        input = _infinidemo.from_dlpack(images).to(device)
+        expected = mnist_reference(weights, images)
+        assert_close(f"{name} per-op, batch {batch_size}", infini_to_numpy(model(input)), expected, verbose=False)
+        for _ in range(3):
+            assert_close(f"{name} fused, batch {batch_size}", infini_to_numpy(fused(input)), expected, verbose=False)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    rng = np.random.default_rng(0)
+
+    check_values("default config", _infinidemo.MnistConfig(), device, rng, args)
+    check_values("custom config", custom_config(), device, rng, args)
+
+    model = MnistForImageClassification()
+    config = model.config
+    weights = random_mnist_state_dict(config, rng)
+    model.load_state_dict(weights)
+    model.to(device=device)
+    fused = model.fused(tile=args.tile, threads=args.threads)
+
+    for batch_size in args.batch_sizes:
+        images = rng.random((batch_size, config.num_channels, config.image_size, config.image_size), dtype=np.float32)
+        input = _infinidemo.from_dlpack(images).to(device)
+        assert_close(f"fused, batch {batch_size}", infini_to_numpy(fused(input)), mnist_reference(weights, images), verbose=False)
+        unfused_s = measure(model, input, args.iters)
+        fused_s = measure(fused, input, args.iters)
+        input_gbps = images.nbytes / fused_s / 1e9
+        print(f" batch {batch_size:5d}: per-op {unfused_s * 1000:8.3f} ms ({batch_size / unfused_s:10.1f} images/s), "
+              f"fused {fused_s * 1000:8.3f} ms ({batch_size / fused_s:10.1f} images/s, input {input_gbps:.2f} GB/s), "
+              f"speedup {unfused_s / fused_s:5.2f}x")
+    print(" OK")
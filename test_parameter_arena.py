@@ -0,0 +1,59 @@
+import numpy as np
+import infinicore
+from pymodels import MnistForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, mnist_reference, parse_device_args, random_mnist_state_dict
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--batch-size", type=int, default=8)
+
+    return parse_device_args("parameter arena: load gating, values and view lifetime", add_arguments)
+
+
+def expect_forward_error(model, input, name):
+    try:
+        model(input)
+    except RuntimeError as error:
+        print(f" {name}: forward raised as expected ({error})")
+        return
+    raise AssertionError(f"{name}: forward with unloaded weights did not raise")
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    rng = np.random.default_rng(0)
+
+    for parameter_arena in (True, False):
+        print(f"parameter_arena={parameter_arena}")
+        model = MnistForImageClassification(parameter_arena)
+        config = model.config
+        weights = random_mnist_state_dict(config, rng)
+        images = rng.random((args.batch_size, config.num_channels, config.image_size, config.image_size), dtype=np.float32)
+        input = _infinidemo.from_dlpack(images)
+
+        # 参数在 load_state_dict 之前是未初始化的内存
+        check(not model.weights_loaded, "weights_loaded before load_state_dict")
+        expect_forward_error(model, input, "before load_state_dict")
+
+        # 分两次加载（与按 safetensors 文件逐个加载相同），只加载一部分时仍然不能 forward
+        model.load_state_dict({key: value for key, value in weights.items() if key.startswith("conv1")})
+        check(not model.weights_loaded, "weights_loaded after a partial load_state_dict")
+        expect_forward_error(model, input, "after partial load")
+        model.load_state_dict({key: value for key, value in weights.items() if key.startswith("fc1")})
+        check(model.weights_loaded, "weights_loaded still False after every parameter was loaded")
+
+        expected = mnist_reference(weights, images)
+        assert_close("forward", infini_to_numpy(model(input)), expected)
+
+        # state_dict 返回 arena 中的视图，模型析构之后仍然持有内存
+        held = model.state_dict()
+        model.to(device=device)
+        assert_close("forward after to()", infini_to_numpy(model(input.to(device))), expected)
+        del model
+        for key, value in weights.items():
+            assert_close(f"held {key}", infini_to_numpy(held[key]), value, atol=0.0, rtol=0.0, verbose=False)
+        print(" OK")
@@ -0,0 +1,63 @@
+import numpy as np
+import infinicore
+from pymodels import MnistForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, parse_device_args, random_mnist_state_dict
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--batch-size", type=int, default=8)
+
+    return parse_device_args("parameter values and lifetime across to() and to(slab=True)", add_arguments)
+
+
+def check_state_dict(name, model, expected):
+    state_dict = model.state_dict()
+    check(sorted(state_dict.keys()) == sorted(expected.keys()), f"{name}: state_dict keys {sorted(state_dict.keys())}")
+    for key, value in expected.items():
+        assert_close(f"{name} {key}", infini_to_numpy(state_dict[key]), value, atol=0.0, rtol=0.0, verbose=False)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    rng = np.random.default_rng(0)
+
+    for parameter_arena, slab in ((True, True), (True, False), (False, True), (False, False)):
+        print(f"parameter_arena={parameter_arena} slab={slab}")
+        model = MnistForImageClassification(parameter_arena)
+        config = model.config
+        weights = random_mnist_state_dict(config, rng)
+        model.load_state_dict(weights)
+
+        images = rng.random((args.batch_size, config.num_channels, config.image_size, config.image_size), dtype=np.float32)
+        reference = infini_to_numpy(model(_infinidemo.from_dlpack(images)))
+
+        # to() 之前取出的参数 tensor：迁移后旧的 arena 由这些视图继续持有，内容不变
+        held_before = model.state_dict()
+        model.to(device=device, slab=slab)
+        report = model.last_migration()
+        check(report["parameters"] == len(weights), f"migrated {report['parameters']} parameters, expected {len(weights)}")
+        # 默认逐模块迁移，只有 slab=True 才打包进一块 slab
+        check((report["slab_bytes"] > 0) == slab, f"slab_bytes {report['slab_bytes']} with slab={slab}")
+        print(f" to(): {report['parameters']} parameters, slab {report['slab_bytes']} bytes, {report['elapsed_ms']:.2f} ms")
+
+        # slab 迁移只提交异步上传，紧接着的 forward 必须看到完整的参数
+        input = _infinidemo.from_dlpack(images).to(device)
+        assert_close("forward after to()", infini_to_numpy(model(input)), reference)
+        check_state_dict("after to()", model, weights)
+
+        # 第二次 to()：第一次迁移后取出的视图在参数被替换后仍然有效
+        held_after_first = model.state_dict()
+        model.to(device=device, slab=slab)
+        check_state_dict("after second to()", model, weights)
+        assert_close("forward after second to()", infini_to_numpy(model(input)), reference)
+
+        # 模型析构后，之前取出的参数仍然持有各自的内存
+        del model
+        for name, held in (("held before to()", held_before), ("held after first to()", held_after_first)):
+            for key, value in weights.items():
+                assert_close(f"{name} {key}", infini_to_numpy(held[key]), value, atol=0.0, rtol=0.0, verbose=False)
+        print(" OK")
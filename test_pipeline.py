@@ -0,0 +1,81 @@
+import argparse
+import infinicore
+from pymodels import ImageProcessor, ResNetForImageClassification
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import check
+
+
+def parseArgs():
+    platform_to_device = {
+        "cpu": "cpu",
+        "nvidia": "cuda",
+        "metax": "cuda",
+        "moore": "musa",
+        "iluvatar": "cuda",
+        "hygon": "cuda",
+        "ascend": "npu",
+        "cambricon": "mlu",
+    }
+
+    parser = argparse.ArgumentParser(description="pipelined offline ResNet classification")
+    for platform, device_str in platform_to_device.items():
+        help_msg = (
+            f"Use {platform.upper()} device"
+            if platform != "cpu"
+            else "Use CPU device (default)"
+        )
+        parser.add_argument(
+            f"--{platform}",
+            action="store_true",
+            help=help_msg,
+        )
+    parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+    parser.add_argument("--image-dir", type=str, default="", help="Directory of jpg / png / bmp images")
+    parser.add_argument("--synthetic", type=int, default=256, help="Number of synthetic images when --image-dir is not set")
+    parser.add_argument("--batch-size", type=int, default=8)
+    parser.add_argument("--preprocess-threads", type=int, default=4)
+    parser.add_argument("--queue-depth", type=int, default=4)
+    parser.add_argument("--top-k", type=int, default=5)
+
+    args = parser.parse_args()
+    device_str = platform_to_device["cpu"]  # 默认值
+    for platform in platform_to_device.keys():
+        if getattr(args, platform, False):
+            device_str = platform_to_device[platform]
+            break
+
+    return infinicore.device(device_str, 0), args
+
+
+if __name__ == "__main__":
+    device, args = parseArgs()
+    print("current device: ", device)
+
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+    processor = ImageProcessor.from_pretrained(args.model_path)
+
+    config = _infinidemo.runtime.PipelineConfig()
+    config.device = device._underlying
+    config.batch_size = args.batch_size
+    config.preprocess_threads = args.preprocess_threads
+    config.queue_depth = args.queue_depth
+    config.top_k = args.top_k
+
+    results, report = _infinidemo.runtime.classify(
+        model, processor, config, directory=args.image_dir, synthetic=args.synthetic
+    )
+
+    # top-k 在设备上计算，每个结果只有 k 个按概率降序排列的预测
+    k = min(args.top_k, len(model.config.id2label))
+    for item in results:
+        probs = [prob for _, prob in item["predictions"]]
+        check(len(probs) == k, f"{item['name']}: {len(probs)} predictions, expected {k}")
+        check(all(a >= b for a, b in zip(probs, probs[1:])), f"{item['name']}: predictions not sorted by prob")
+        check(0.0 <= probs[-1] and sum(probs) <= 1.0 + 1e-4, f"{item['name']}: probabilities out of range {probs}")
+
+    for item in results[:10]:
+        label, prob = item["predictions"][0]
+        print(f" {item['name']}: {model.config.id2label[label]}  概率: {round(prob, 3)}")
+    print()
+    print(report)
@@ -0,0 +1,55 @@
+import time
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--num-devices", type=int, default=1, help="Number of accelerators; on CPU every stage uses the CPU")
+        parser.add_argument("--stages", type=int, nargs="+", default=[2, 4])
+        parser.add_argument("--cores-per-stage", type=int, default=0, help="Pin each CPU stage to this many cores (0: no pinning)")
+        parser.add_argument("--micro-batch", type=int, default=8)
+        parser.add_argument("--micro-batches", type=int, default=32, help="Length of the input stream")
+
+    return parse_device_args("pipeline-parallel ResNet inference over a stream of micro-batches", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+
+    stream = [
+        _infinidemo.from_dlpack(np.random.rand(args.micro_batch, 3, 224, 224).astype(np.float32))
+        for _ in range(args.micro_batches)
+    ]
+
+    # 基线：单个实例依次处理整个输入流
+    model(stream[0].to(device))  # 预热
+    start = time.perf_counter()
+    reference = [infini_to_numpy(model(x.to(device))) for x in stream]
+    single = args.micro_batch * args.micro_batches / (time.perf_counter() - start)
+    print(f" single instance: {single:8.1f} images/s")
+
+    for stages in args.stages:
+        # 同一个设备可以重复出现：CPU 上每个 stage 是一个独立的线程（组）
+        devices = [infinicore.device(device_str, i % args.num_devices)._underlying for i in range(stages)]
+        pipeline = _infinidemo.runtime.PipelineParallel(
+            model, devices, [args.micro_batch, 3, 224, 224], cores_per_stage=args.cores_per_stage
+        )
+
+        pipeline.run(stream[:stages])  # 预热
+        pipeline.reset_stats()
+        outputs = pipeline.run(stream)
+        check(len(outputs) == len(reference), f"pipeline returned {len(outputs)} outputs for {len(reference)} inputs")
+        max_diff = max(assert_close(f"stages={stages} micro-batch {i}", infini_to_numpy(y), ref, verbose=False) for i, (y, ref) in enumerate(zip(outputs, reference)))
+        stats = pipeline.stats()
+        print(f" stages={pipeline.stages}: {stats['samples_per_s']:8.1f} images/s, steady-state {stats['steady_samples_per_s']:8.1f} images/s "
+              f"({stats['steady_samples_per_s'] / single:4.2f}x single instance), max abs diff {max_diff:.6f}")
+        print(stats["report"])
@@ -0,0 +1,227 @@
+#include "nn/functional/composite_pool2d_op.hpp"
+#include <CLI/CLI.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <dlfcn.h>
+#include <infinicore/context/context.hpp>
+#include <infinicore/tensor.hpp>
+#include <infinirt.h>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace infinicore;
+namespace functional = infinidemo::nn::functional;
+
+// 组合池化（HYGON / MOORE 的设备端路径）的校验：与 host 端双精度参考结果比较，
+// 并拦截 infinirtMemcpy / infinirtMemcpyAsync 统计 H2D / D2H 拷贝，预热之后的池化调用中必须为 0。
+// 拷贝计数不依赖 debug::toDevice，任何经过 host 的实现都会被发现；CPU 后端上没有设备内存，计数只起校验作用。
+
+// ------------------------------------------------------------------
+// infinirt 拷贝拦截：可执行文件中的同名定义优先于 libinfinirt（链接时加 -rdynamic），通过 RTLD_NEXT 转发
+// ------------------------------------------------------------------
+
+std::atomic<size_t> &hostTransfers() {
+    static std::atomic<size_t> count{0};
+    return count;
+}
+
+void countTransfer(infinirtMemcpyKind_t kind) {
+    if ((kind == INFINIRT_MEMCPY_H2D) || (kind == INFINIRT_MEMCPY_D2H)) {
+        hostTransfers().fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+infiniStatus_t infinirtMemcpy(void *dst, const void *src, size_t size, infinirtMemcpyKind_t kind) {
+    using Memcpy = infiniStatus_t (*)(void *, const void *, size_t, infinirtMemcpyKind_t);
+    static Memcpy next = reinterpret_cast<Memcpy>(dlsym(RTLD_NEXT, "infinirtMemcpy"));
+    countTransfer(kind);
+    return next(dst, src, size, kind);
+}
+
+infiniStatus_t infinirtMemcpyAsync(void *dst, const void *src, size_t size, infinirtMemcpyKind_t kind, infinirtStream_t stream) {
+    using MemcpyAsync = infiniStatus_t (*)(void *, const void *, size_t, infinirtMemcpyKind_t, infinirtStream_t);
+    static MemcpyAsync next = reinterpret_cast<MemcpyAsync>(dlsym(RTLD_NEXT, "infinirtMemcpyAsync"));
+    countTransfer(kind);
+    return next(dst, src, size, kind, stream);
+}
+
+// ------------------------------------------------------------------
+// 用例
+// ------------------------------------------------------------------
+
+struct PoolCase {
+    bool max;
+    size_t n, c, h, w;
+    int kernel, stride, padding, dilation;
+    bool ceil_mode;
+    bool expect_reject; // 存在整个窗口都在 padding 中的输出
+
+    std::string describe() const {
+        std::ostringstream os;
+        os << (max ? "max" : "avg") << " [" << n << "," << c << "," << h << "," << w << "] k" << kernel << " s" << stride
+           << " p" << padding << " d" << dilation << (ceil_mode ? " ceil" : "");
+        return os.str();
+    }
+
+    size_t outputSize(size_t input) const {
+        size_t effective = static_cast<size_t>(dilation * (kernel - 1) + 1);
+        size_t padded = input + 2 * static_cast<size_t>(padding);
+        size_t steps = padded - effective;
+        return (ceil_mode ? (steps + stride - 1) / stride : steps / stride) + 1;
+    }
+};
+
+std::vector<PoolCase> buildCases() {
+    return {
+        {true, 2, 3, 9, 9, 3, 2, 1, 1, false, false},   // ResNet stem
+        {true, 1, 4, 8, 7, 3, 2, 1, 1, true, false},    // ceil_mode，最后一个窗口部分越界
+        {true, 1, 2, 10, 10, 2, 2, 0, 1, false, false},
+        {true, 1, 2, 11, 11, 3, 1, 1, 2, false, false}, // dilation
+        {true, 1, 2, 4, 4, 2, 1, 2, 1, false, true},    // padding > kernel / 2：第一个窗口全部是 padding
+        {false, 2, 8, 7, 7, 7, 7, 0, 1, false, false},  // 全局平均池化（单次 GEMM）
+        {false, 1, 3, 8, 8, 3, 2, 1, 1, false, false},  // count_include_pad
+        {false, 1, 2, 9, 9, 2, 2, 0, 1, false, false},
+    };
+}
+
+std::vector<double> reference(const PoolCase &pc, const std::vector<float> &input) {
+    size_t oh = pc.outputSize(pc.h);
+    size_t ow = pc.outputSize(pc.w);
+    std::vector<double> output(pc.n * pc.c * oh * ow);
+    for (size_t plane = 0; plane < pc.n * pc.c; ++plane) {
+        const float *x = input.data() + plane * pc.h * pc.w;
+        for (size_t i = 0; i < oh; ++i) {
+            for (size_t j = 0; j < ow; ++j) {
+                double max = -std::numeric_limits<double>::infinity();
+                double sum = 0.0;
+                for (int kh = 0; kh < pc.kernel; ++kh) {
+                    for (int kw = 0; kw < pc.kernel; ++kw) {
+                        long long y = static_cast<long long>(i) * pc.stride - pc.padding + kh * pc.dilation;
+                        long long z = static_cast<long long>(j) * pc.stride - pc.padding + kw * pc.dilation;
+                        if ((y < 0) || (z < 0) || (y >= static_cast<long long>(pc.h)) || (z >= static_cast<long long>(pc.w))) {
+                            continue;
+                        }
+                        double v = x[y * pc.w + z];
+                        max = std::max(max, v);
+                        sum += v;
+                    }
+                }
+                output[(plane * oh + i) * ow + j] = pc.max ? max : sum / static_cast<double>(pc.kernel * pc.kernel);
+            }
+        }
+    }
+    return output;
+}
+
+struct Outcome {
+    infiniStatus_t status = INFINI_STATUS_SUCCESS;
+    double error = 0.0;
+    size_t transfers = 0;
+};
+
+Outcome runCase(const PoolCase &pc, const Device &device) {
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> values(pc.n * pc.c * pc.h * pc.w);
+    for (auto &v : values) {
+        v = dist(gen);
+    }
+    Tensor host = Tensor::empty({pc.n, pc.c, pc.h, pc.w}, DataType::F32, Device::cpu());
+    std::copy(values.begin(), values.end(), reinterpret_cast<float *>(host->data()));
+    Tensor input = device.getType() == Device::Type::CPU ? host : host->to(device);
+    Tensor output = Tensor::empty({pc.n, pc.c, pc.outputSize(pc.h), pc.outputSize(pc.w)}, DataType::F32, device);
+
+    functional::composite_pool2d::OnesCache ones;
+    auto run = [&]() {
+        return pc.max ? functional::performCompositeMaxPool2d(input, output, pc.kernel, pc.kernel, pc.stride, pc.stride, pc.padding,
+                                                              pc.padding, pc.dilation, pc.dilation, pc.ceil_mode, device)
+                      : functional::performCompositeAvgPool2d(input, output, pc.kernel, pc.kernel, pc.stride, pc.stride, pc.padding,
+                                                              pc.padding, pc.dilation, pc.dilation, pc.ceil_mode, ones, device);
+    };
+
+    // 第一次调用会上传平均池化用的常量 ones，不计入
+    Outcome outcome;
+    outcome.status = run();
+    context::syncDevice();
+    if (outcome.status != INFINI_STATUS_SUCCESS) {
+        return outcome;
+    }
+    hostTransfers().store(0, std::memory_order_relaxed);
+    outcome.status = run();
+    context::syncDevice();
+    outcome.transfers = hostTransfers().load(std::memory_order_relaxed);
+
+    Tensor result = device.getType() == Device::Type::CPU ? output : output->to(Device::cpu());
+    const float *data = reinterpret_cast<const float *>(result->data());
+    std::vector<double> expected = reference(pc, values);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        outcome.error = std::max(outcome.error, std::fabs(static_cast<double>(data[i]) - expected[i]));
+    }
+    return outcome;
+}
+
+Device parseDevice(int argc, char *argv[]) {
+    CLI::App app{"Composite Pool2D check - values against a host reference and no host transfers after warmup"};
+    Device device = Device::cpu();
+    using PlatformConfig = std::tuple<const char *, Device::Type, const char *>;
+    const std::vector<PlatformConfig> platforms = {
+        {"--cpu,-c", Device::Type::CPU, "Use CPU device (default)"},
+        {"--nvidia", Device::Type::NVIDIA, "Use NVIDIA GPU device"},
+        {"--moore", Device::Type::MOORE, "Use MOORE device"},
+        {"--metax", Device::Type::METAX, "Use METAX device"},
+        {"--iluvatar", Device::Type::ILUVATAR, "Use ILUVATAR device"},
+        {"--hygon", Device::Type::HYGON, "Use HYGON device"},
+        {"--ascend", Device::Type::ASCEND, "Use ASCEND device"},
+        {"--cambricon", Device::Type::CAMBRICON, "Use CAMBRICON device"},
+    };
+    for (const auto &[flag_name, device_type, help_message] : platforms) {
+        Device::Type type = device_type;
+        app.add_flag(flag_name, [&device, type](bool) { device = Device(type); }, help_message);
+    }
+    try {
+        app.parse(argc, argv);
+    } catch (const CLI::ParseError &e) {
+        app.exit(e);
+        throw std::runtime_error("Failed to parse command line arguments");
+    }
+    if (context::getDeviceCount(device.getType()) == 0) {
+        throw std::runtime_error("No " + device.toString() + " device available");
+    }
+    return device;
+}
+
+int main(int argc, char *argv[]) {
+    Device device = parseDevice(argc, argv);
+    context::setDevice(device);
+    infiniStatus_t status = infinirtInit();
+    if (status != INFINI_STATUS_SUCCESS) {
+        std::cerr << "Failed to initialize InfiniRT: " << status << std::endl;
+        return 1;
+    }
+
+    std::cout << std::left << std::setw(44) << "case" << std::right << std::setw(12) << "max_err" << std::setw(12) << "transfers"
+              << "  result" << std::endl;
+    const std::vector<PoolCase> cases = buildCases();
+    int failures = 0;
+    for (const auto &pc : cases) {
+        Outcome outcome = runCase(pc, device);
+        bool ok = pc.expect_reject ? (outcome.status == INFINI_STATUS_BAD_PARAM)
+                                   : ((outcome.status == INFINI_STATUS_SUCCESS) && (outcome.error <= 1e-5) && (outcome.transfers == 0));
+        failures += ok ? 0 : 1;
+        std::cout << std::left << std::setw(44) << pc.describe() << std::right << std::scientific << std::setprecision(2)
+                  << std::setw(12) << outcome.error << std::defaultfloat << std::setw(12) << outcome.transfers << "  "
+                  << (pc.expect_reject ? (ok ? "REJECTED" : "FAIL (expected rejection)") : (ok ? "PASS" : "FAIL")) << std::endl;
+    }
+    std::cout << "\n"
+              << cases.size() - failures << " / " << cases.size() << " cases passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
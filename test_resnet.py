@@ -3,7 +3,8 @@ import infinicore
 import argparse
 from PIL import Image
 from pymodels.modeling_utils import infini_to_numpy
-from pymodels import ResNetForImageClassification
+from pymodels.module_loader import _infinidemo
+from pymodels import ImageProcessor, ResNetForImageClassification
 from transformers import AutoImageProcessor
 from print import print_image
 
@@ -40,6 +41,11 @@ def selectDevice():
         default= "../resnet-18-fused/src/dog.jpg",
         help="Image path",
     )
+    parser.add_argument(
+        "--native-preprocess",
+        action="store_true",
+        help="Use the C++ image processor and report its difference to AutoImageProcessor",
+    )
 
     args = parser.parse_args()
     device_str = platform_to_device["cpu"]  # 默认值
@@ -50,16 +56,11 @@ def selectDevice():
 
     image_path = args.image_path
 
-    return infinicore.device(device_str, 0), image_path
-
-
-def softmax(x, axis=-1):
-    e_x = np.exp(x - np.max(x, axis=axis, keepdims=True))
-    return e_x / np.sum(e_x, axis=axis, keepdims=True)
+    return infinicore.device(device_str, 0), image_path, args.native_preprocess
 
 
 if __name__ == "__main__":
-    device, image_path = selectDevice()
+    device, image_path, native_preprocess = selectDevice()
     print("current device: ", device)
 
 
@@ -71,18 +72,20 @@ if __name__ == "__main__":
     feature_extractor = AutoImageProcessor.from_pretrained(model_path, use_fast=True)
     inputs = feature_extractor(image, return_tensors="pt")["pixel_values"]
 
-    model.to(device=device)
+    model.to(device=device, slab=True)
+    migration = model.last_migration()
+    print(f"参数迁移: {migration['parameters']} 个参数, slab {migration['slab_bytes'] / 2**20:.1f} MB, {migration['elapsed_ms']:.1f} ms")
     for i in range(1):
-        input_tensor = infinicore.from_torch(inputs)
-        predict = model.forward(input_tensor.to(device))
-
-        predict_np = infini_to_numpy(predict)
-        predict_np = softmax(predict_np)
-        predict_class = np.argmax(predict_np, axis=-1)
-        predict_probs = np.max(predict_np, axis=-1)
-
-        predict_class = predict_class.item()
-        predict_name = model.config.id2label[f"{predict_class}"]
+        # DLPack 零拷贝导入，不经过 from_torch 的拷贝
+        input_tensor = _infinidemo.from_dlpack(inputs)
+        if native_preprocess:
+            # C++ 解码 + 缩放 + 归一化，与 transformers 的结果逐元素比较
+            native_tensor = ImageProcessor.from_pretrained(model_path)([image_path])
+            max_diff = np.abs(infini_to_numpy(native_tensor) - inputs.numpy()).max()
+            print(f" native preprocess max abs diff: {max_diff:.6f}")
+            input_tensor = native_tensor
+        # 设备上完成 softmax + top-k，只回传 top-k 的下标与概率
+        predict_class, predict_name, predict_probs = model.predict(input_tensor.to(device), top_k=1)[0][0]
         print_image(image_path, width=120)
 
-        print(f" 类别: {predict_name}  概率: {round(predict_probs.item(), 3)}\n")
+        print(f" 类别: {predict_name}  概率: {round(predict_probs, 3)}\n")
@@ -0,0 +1,68 @@
+import time
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--batch-size", type=int, default=8)
+        parser.add_argument("--requests", type=int, default=64)
+        parser.add_argument("--unique", type=int, default=16, help="Number of distinct images in the stream")
+        parser.add_argument("--max-mb", type=int, default=256, help="Cache bound in MB of cached outputs")
+
+    return parse_device_args("inference result cache on a stream with repeated images", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+    cached = model.with_result_cache(max_bytes=args.max_mb << 20)
+
+    # 每个请求的 batch 从 unique 张图像中随机抽取，模拟缩略图、重复上传等流量
+    rng = np.random.default_rng(0)
+    images = rng.random((args.unique, 3, 224, 224), dtype=np.float32)
+    requests = [images[rng.integers(0, args.unique, args.batch_size)] for _ in range(args.requests)]
+
+    start = time.perf_counter()
+    reference = [infini_to_numpy(model(_infinidemo.from_dlpack(np.ascontiguousarray(x)).to(device))) for x in requests]
+    plain_s = time.perf_counter() - start
+
+    start = time.perf_counter()
+    outputs = [infini_to_numpy(cached(_infinidemo.from_dlpack(np.ascontiguousarray(x)).to(device))) for x in requests]
+    cached_s = time.perf_counter() - start
+
+    for i, (y, ref) in enumerate(zip(outputs, reference)):
+        assert_close(f"request {i}", y, ref, verbose=False)
+    stats = cached.stats()
+    print(f" uncached: {plain_s * 1000:8.1f} ms, cached: {cached_s * 1000:8.1f} ms ({plain_s / cached_s:4.2f}x)")
+    print(f" hit rate {stats['hit_rate'] * 100:5.1f}%, evictions {stats['evictions']}, entries {stats['entries']}, "
+          f"{stats['bytes'] / 1024:.1f} KB cached, hashing {stats['hash_ms']:.2f} ms for {stats['hashed_bytes'] / 2**20:.1f} MB")
+    check(stats["hits"] > 0, "repeated images never hit the cache")
+
+    # 翻转 / 重排后的图像字节相同、顺序不同，不能命中原图的结果
+    image = images[:1]
+    cached(_infinidemo.from_dlpack(np.ascontiguousarray(image)).to(device))
+    for name, variant in [("vertical flip", image[:, :, ::-1, :]), ("horizontal flip", image[:, :, :, ::-1]),
+                          ("channel swap", image[:, ::-1, :, :])]:
+        variant = np.ascontiguousarray(variant)
+        expected = infini_to_numpy(model(_infinidemo.from_dlpack(variant).to(device)))
+        actual = infini_to_numpy(cached(_infinidemo.from_dlpack(variant).to(device)))
+        assert_close(name, actual, expected)
+
+    # load_state_dict 之后缓存的结果过期，必须重新计算
+    state_dict = {key: infini_to_numpy(value) for key, value in model.state_dict().items()}
+    classifier_key = next(key for key in state_dict if key.startswith("classifier") and key.endswith("weight"))
+    state_dict[classifier_key] = np.ascontiguousarray(state_dict[classifier_key] * 2.0)
+    model.load_state_dict({key: infinicore.from_numpy(value).to(device) for key, value in state_dict.items()})
+    x = _infinidemo.from_dlpack(np.ascontiguousarray(requests[0])).to(device)
+    expected = infini_to_numpy(model(x))
+    check(np.abs(expected - reference[0]).max() > 1e-3, "modified classifier weight did not change the logits")
+    assert_close("after load_state_dict", infini_to_numpy(cached(x)), expected)
+    print(" OK")
@@ -0,0 +1,71 @@
+import time
+import numpy as np
+import infinicore
+from pymodels import ImageProcessor, ResNetForImageClassification
+from pymodels.module_loader import _infinidemo
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.testing import assert_close, check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--buckets", type=str, nargs="+", default=["224x224", "320x240", "240x320", "384x384"], help="WIDTHxHEIGHT")
+        parser.add_argument("--policy", choices=["pad", "resize"], default="pad")
+        parser.add_argument("--max-batch", type=int, default=16)
+        parser.add_argument("--requests", type=int, default=128)
+        parser.add_argument("--min-size", type=int, default=160)
+        parser.add_argument("--max-size", type=int, default=480)
+
+    return parse_device_args("shape-bucketed ResNet inference for variable-resolution images", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+    processor = ImageProcessor.from_pretrained(args.model_path)
+
+    config = _infinidemo.runtime.BucketingConfig()
+    config.buckets = [tuple(int(v) for v in b.split("x")) for b in args.buckets]
+    config.policy = _infinidemo.runtime.BucketPolicy.PAD if args.policy == "pad" else _infinidemo.runtime.BucketPolicy.RESIZE
+    config.max_batch = args.max_batch
+
+    start = time.perf_counter()
+    bucketer = _infinidemo.runtime.ShapeBucketer(model, processor, config, device._underlying)
+    print(f" buckets prepared in {(time.perf_counter() - start) * 1000:.1f} ms")
+
+    # 随机尺寸的合成图像，模拟不同分辨率的上传
+    rng = np.random.default_rng(0)
+    images = [
+        rng.integers(0, 256, (rng.integers(args.min_size, args.max_size), rng.integers(args.min_size, args.max_size), 3), dtype=np.uint8)
+        for _ in range(args.requests)
+    ]
+
+    # 尺寸恰好等于某个 bucket 的图像不经过 pad / resize，分桶结果必须与逐张按原尺寸直接推理一致
+    exact = [rng.integers(0, 256, (h, w, 3), dtype=np.uint8) for w, h in config.buckets for _ in range(2)]
+    rng.shuffle(exact)
+    bucketed = infini_to_numpy(bucketer.forward_arrays(exact))
+    check(bucketed.shape[0] == len(exact), f"{bucketed.shape[0]} logits for {len(exact)} images")
+    # 参考结果用同样的归一化参数、不做 resize 的预处理（复制字段，processor.config 引用的是 bucketer 正在使用的配置）
+    plain_config = _infinidemo.image.ImageProcessorConfig()
+    for field in ("do_normalize", "rescale_factor", "image_mean", "image_std", "layout", "fold_scale"):
+        setattr(plain_config, field, getattr(processor.config, field))
+    plain_config.do_resize = False
+    plain = ImageProcessor(plain_config)
+    for i, image in enumerate(exact):
+        expected = infini_to_numpy(model(plain.preprocess([image], device)))
+        assert_close(f"bucketed vs. unbucketed image {i} ({image.shape[1]}x{image.shape[0]})", bucketed[i : i + 1], expected, verbose=False)
+    print(" bucketed logits match unbucketed logits")
+
+    bucketer.forward_arrays(images[: args.max_batch])  # 预热
+    bucketer.reset_stats()
+    start = time.perf_counter()
+    logits = bucketer.forward_arrays(images)
+    elapsed = time.perf_counter() - start
+    print(f" {args.requests} images in {elapsed * 1000:.1f} ms ({args.requests / elapsed:.1f} images/s)")
+    stats = bucketer.stats()
+    check(stats["requests"] == args.requests, f"stats counted {stats['requests']} requests")
+    print(stats["report"])
+    print(" OK")
@@ -0,0 +1,68 @@
+import os
+import resource
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--instances", type=int, default=8, help="Number of extra instances")
+        parser.add_argument("--batch-size", type=int, default=1)
+
+    device_str, args = parse_device_args("RSS growth of ResNet instances sharing one weight set", add_arguments)
+    return infinicore.device(device_str, 0), device_str == "cpu", args
+
+
+def rssBytes():
+    # 当前常驻内存，/proc 不可用时退化为峰值
+    try:
+        with open("/proc/self/statm", "r") as f:
+            return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except OSError:
+        return resource.getrusage(resource.RUSAGE_SELF).ru_maxrss * 1024
+
+
+def measure(name, make_instance, count, input):
+    instances = []
+    before = rssBytes()
+    for _ in range(count):
+        instance = make_instance()
+        instance(input)  # 计入一次 forward 的激活
+        instances.append(instance)
+    growth = (rssBytes() - before) / count / (1 << 20)
+    print(f" {name:<16} {count} 个实例, 每个实例 RSS 增长 {growth:8.2f} MB")
+    return growth
+
+
+if __name__ == "__main__":
+    device, on_host, args = parseArgs()
+    print("current device: ", device)
+
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device, slab=True)
+    pixel_values = np.random.rand(args.batch_size, 3, 224, 224).astype(np.float32)
+    input = _infinidemo.from_dlpack(pixel_values).to(device)
+    reference = infini_to_numpy(model(input))
+    print(f" 权重大小 {model.last_migration()['slab_bytes'] / 2**20:.2f} MB")
+
+    shared = measure("shared weights", model.replica, args.instances, input)
+    copied = measure("full copy", lambda: ResNetForImageClassification.from_pretrained(args.model_path).to(device=device, slab=True), args.instances, input)
+
+    # 共享实例只读使用同一组权重，输出与原模型逐元素一致
+    assert_close("replica logits", infini_to_numpy(model.replica()(input)), reference, atol=0.0, rtol=0.0)
+
+    # 共享的权重属于原模型，迁移共享实例会抛出异常
+    try:
+        model.replica().to(device=device)
+    except RuntimeError as error:
+        print(f" replica.to() raised as expected ({error})")
+    else:
+        raise AssertionError("to() on an instance sharing weights did not raise")
+    if on_host:
+        # 设备后端上权重在显存中，host RSS 只反映激活与框架开销
+        check(shared < copied, "an instance sharing weights should grow RSS less than a full copy")
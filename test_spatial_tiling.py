@@ -0,0 +1,77 @@
+import time
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.modeling_utils import infini_to_numpy
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import assert_close, check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--image-size", type=int, nargs=2, default=[2048, 2048], help="H W")
+        parser.add_argument("--tile-sizes", type=int, nargs="+", default=[256, 512, 1024])
+        parser.add_argument("--skip-full", action="store_true", help="Do not run the full-image forward (when it does not fit)")
+        parser.add_argument("--check-size", type=int, nargs=2, default=[450, 330], help="H W of the image used for the value checks")
+        parser.add_argument("--check-tile-sizes", type=int, nargs="+", default=[96, 160])
+
+    return parse_device_args("spatially tiled ResNet inference on a high-resolution image", add_arguments)
+
+
+def check_values(model, device, args):
+    # 图像边长与 tile 都不是彼此的整数倍：右侧与下侧的 tile 只覆盖部分输出，halo 在图像边界处被截断
+    height, width = args.check_size
+    pixel_values = np.random.default_rng(0).random((1, 3, height, width), dtype=np.float32)
+    input = _infinidemo.from_dlpack(pixel_values)
+    # tile 覆盖整张图时只有一块，即整图的特征图
+    full_size = max(height, width)
+    logits = infini_to_numpy(model(input.to(device)))
+    feature_map = infini_to_numpy(model.feature_map_tiled(input, tile_size=full_size))
+    stride = model.receptive_field()["stride"]
+    for tile_size in args.check_tile_sizes:
+        cells = max(tile_size // stride, 1)
+        check(any(size % cells != 0 for size in feature_map.shape[2:]), f"tile {tile_size} does not create partial border tiles for {feature_map.shape}")
+        assert_close(f"tile {tile_size}: feature map", infini_to_numpy(model.feature_map_tiled(input, tile_size=tile_size)), feature_map, atol=1e-3, rtol=1e-3)
+        assert_close(f"tile {tile_size}: features", infini_to_numpy(model.features_tiled(input, tile_size=tile_size)), feature_map.mean(axis=(2, 3)), atol=1e-3, rtol=1e-3)
+        assert_close(f"tile {tile_size}: logits", infini_to_numpy(model.forward_tiled(input, tile_size=tile_size)), logits, atol=1e-3, rtol=1e-3)
+
+
+def peak_mb(model):
+    stats = model.memory_stats(reset=True)
+    return max((item["peak_bytes"] for item in stats["devices"].values()), default=0) / 2**20
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    _infinidemo.memory.enable()
+
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+    field = model.receptive_field()
+    print(f" receptive field: stride {field['stride']}, halo {field['left']} / {field['right']} pixels")
+    check_values(model, device, args)
+
+    height, width = args.image_size
+    pixel_values = np.random.rand(1, 3, height, width).astype(np.float32)
+    # 输入留在 host 上，分块执行时每次只有一块拷到设备
+    input = _infinidemo.from_dlpack(pixel_values)
+    model.memory_stats(reset=True)
+
+    reference = None
+    if not args.skip_full:
+        start = time.perf_counter()
+        reference = infini_to_numpy(model(input.to(device)))
+        print(f" full image {height}x{width}: {(time.perf_counter() - start) * 1000:9.2f} ms, peak {peak_mb(model):9.2f} MB")
+
+    for tile_size in args.tile_sizes:
+        model.memory_stats(reset=True)
+        start = time.perf_counter()
+        logits = infini_to_numpy(model.forward_tiled(input, tile_size=tile_size))
+        elapsed_ms = (time.perf_counter() - start) * 1000
+        line = f" tile {tile_size:5d}: {elapsed_ms:9.2f} ms, peak {peak_mb(model):9.2f} MB"
+        if reference is not None:
+            line += f", max abs diff {assert_close('tiled vs. full logits', logits, reference, atol=1e-3, rtol=1e-3, verbose=False):.2e}"
+        print(line)
+    print(" OK")
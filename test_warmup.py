@@ -0,0 +1,69 @@
+import time
+import numpy as np
+import infinicore
+from pymodels import ResNetForImageClassification
+from pymodels.module_loader import _infinidemo
+from pymodels.testing import check, parse_device_args
+
+
+def parseArgs():
+    def add_arguments(parser):
+        parser.add_argument("--model-path", type=str, default="../resnet-18-fused/")
+        parser.add_argument("--sizes", type=int, nargs="+", default=[224], help="Square input resolutions to warm up")
+        parser.add_argument("--batch-sizes", type=int, nargs="+", default=[1, 8, 32])
+        parser.add_argument("--skip-warmup", action="store_true", help="Serve cold to compare first-request latency")
+
+    return parse_device_args("startup warmup of ResNet before serving", add_arguments)
+
+
+if __name__ == "__main__":
+    device_str, args = parseArgs()
+    device = infinicore.device(device_str, 0)
+    model = ResNetForImageClassification.from_pretrained(args.model_path)
+    model.to(device=device)
+    print(f" ready before warmup: {model.ready}")
+    check(not model.ready, "model is ready before warmup")
+
+    # require_ready 时未 warmup 的 forward 被拒绝
+    model.require_ready = True
+    probe = _infinidemo.from_dlpack(np.zeros((1, 3, args.sizes[0], args.sizes[0]), dtype=np.float32)).to(device)
+    try:
+        model(probe)
+        raise AssertionError("forward before warmup was not rejected with require_ready = True")
+    except RuntimeError:
+        pass
+    model.require_ready = not args.skip_warmup
+
+    if not args.skip_warmup:
+        report = model.warmup([(3, size, size) for size in args.sizes], args.batch_sizes)
+        for entry in report["entries"]:
+            print(f" {str(entry['input_shape']):>20}: prepare {entry['prepare_ms']:7.2f} ms, "
+                  f"cold {entry['cold_ms']:8.2f} ms, warm {entry['warm_ms']:8.2f} ms")
+        print(f" warmup took {report['elapsed_ms']:.1f} ms, ready: {model.ready}")
+        check(model.ready, "model is not ready after warmup")
+        check(len(report["entries"]) == len(args.sizes) * len(args.batch_sizes), f"{len(report['entries'])} warmup entries")
+        cold = sum(entry["cold_ms"] for entry in report["entries"])
+        warm = sum(entry["warm_ms"] for entry in report["entries"])
+        check(warm < cold, f"warm forwards ({warm:.2f} ms) are not faster than the cold ones ({cold:.2f} ms)")
+
+    # 上线后的第一个真实请求
+    for batch_size in args.batch_sizes:
+        pixel_values = np.random.rand(batch_size, 3, args.sizes[0], args.sizes[0]).astype(np.float32)
+        input = _infinidemo.from_dlpack(pixel_values).to(device)
+        start = time.perf_counter()
+        model(input)
+        print(f" first request, batch {batch_size}: {(time.perf_counter() - start) * 1000:.2f} ms")
+
+    if not args.skip_warmup:
+        # to() 之后需要重新 warmup
+        model.to(device=device)
+        check(not model.ready, "model is still ready after to()")
+        try:
+            model(probe)
+            raise AssertionError("forward after to() was not rejected before the new warmup")
+        except RuntimeError:
+            pass
+        model.warmup([(3, args.sizes[0], args.sizes[0])], [1])
+        check(model.ready, "model is not ready after the second warmup")
+        model(probe)
+    print(" OK")
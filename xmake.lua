@@ -1,6 +1,14 @@
 add_rules("mode.debug", "mode.release")
 add_requires("cli11")
 add_requires("pybind11")
+add_requires("stb")
+
+option("profiler")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Enable the per-layer profiler in nn/profiler.hpp (zero overhead when disabled)")
+    add_defines("INFINIDEMO_ENABLE_PROFILER")
+option_end()
 
 target("test_gemm")
     set_kind("binary")
@@ -22,20 +30,80 @@ target("test_gemm")
 target_end()
 
 
+target("test_pooling")
+    set_kind("binary")
+    set_default(false)
+    set_languages("cxx17")
+    set_warnings("all", "error")
+
+    add_packages("cli11")
+
+    local INFINI_ROOT = os.getenv("INFINI_ROOT") or (os.getenv(is_host("windows") and "HOMEPATH" or "HOME") .. "/.infini")
+    add_includedirs(INFINI_ROOT.."/include")
+    add_linkdirs(INFINI_ROOT.."/lib")
+    add_links("infinicore_cpp_api", "infiniop", "infinirt")
+    add_syslinks("dl")
+    -- 导出可执行文件中的 infinirtMemcpy 拦截函数，使 infinicore 内部的拷贝也经过它们
+    add_ldflags("-rdynamic")
+
+    add_files("test_pooling.cpp")
+target_end()
+
+target("test_linear")
+    set_kind("binary")
+    set_default(false)
+    set_languages("cxx17")
+    set_warnings("all", "error")
+
+    add_packages("cli11")
+
+    local INFINI_ROOT = os.getenv("INFINI_ROOT") or (os.getenv(is_host("windows") and "HOMEPATH" or "HOME") .. "/.infini")
+    add_includedirs(INFINI_ROOT.."/include")
+    add_linkdirs(INFINI_ROOT.."/lib")
+    add_links("infinicore_cpp_api", "infiniop", "infinirt")
+
+    add_files("test_linear.cpp")
+target_end()
+
+
+target("bench")
+    set_kind("binary")
+    set_default(false)
+    set_languages("cxx17")
+    set_warnings("all", "error")
+    add_options("profiler")
+
+    add_packages("cli11")
+
+    local INFINI_ROOT = os.getenv("INFINI_ROOT") or (os.getenv(is_host("windows") and "HOMEPATH" or "HOME") .. "/.infini")
+    add_includedirs(INFINI_ROOT.."/include")
+    add_linkdirs(INFINI_ROOT.."/lib")
+    add_links("infinicore_cpp_api", "infiniop", "infinirt")
+
+    add_files("bench/bench.cpp")
+    add_files("cmodels/resnet/modeling_resnet.cpp")
+    add_files("cmodels/mnist/modeling_mnist.cpp")
+target_end()
+
+
 target("_infinidemo")
     set_kind("shared")
     set_default(true)
     set_languages("cxx17")
     set_warnings("all", "error")
     set_targetdir("$(buildir)")
+    add_options("profiler")
 
     -- Add pybind11 package (automatically configures Python paths)
     add_packages("pybind11")
+    -- stb_image 用于原生图像解码
+    add_packages("stb")
     
     -- Add source files
     -- Add model implementation files
     add_files("cmodels/resnet/modeling_resnet.cpp")
     add_files("cmodels/mnist/modeling_mnist.cpp")
+    add_files("cmodels/vision/image_processing.cpp")
     add_files("cmodels/bindings.cpp")
     
     -- Add include directories